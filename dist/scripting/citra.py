@@ -3,20 +3,30 @@ import struct
 import random
 import enum
 
-CURRENT_REQUEST_VERSION = 1
-MAX_REQUEST_DATA_SIZE = 32
+CURRENT_REQUEST_VERSION = 2
+MAX_REQUEST_DATA_SIZE = 0x100000
+MAX_BATCH_RANGES = 0x1000
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadMemoryBatch = 3,
+    WriteMemoryBatch = 4,
+    SetMemoryWatches = 5,
+    MemoryWatchUpdate = 6
 
 CITRA_PORT = "45987"
+CITRA_PUBLISH_PORT = "45988"
 
 class Citra:
-    def __init__(self, address="127.0.0.1", port=CITRA_PORT):
+    def __init__(self, address="127.0.0.1", port=CITRA_PORT, publish_port=CITRA_PUBLISH_PORT):
         self.context = zmq.Context()
         self.socket = self.context.socket(zmq.REQ)
         self.socket.connect("tcp://" + address + ":" + port)
+        self.publish_address = "tcp://" + address + ":" + publish_port
+        self.subscriber = None
+        self.watches = []
+        self.watch_request_id = None
 
     def is_connected(self):
         return self.socket is not None
@@ -90,6 +100,111 @@ class Citra:
                 return False
         return True
 
+    def _request(self, request_type, request_data):
+        request, request_id = self._generate_header(request_type, len(request_data))
+        self.socket.send(request + request_data)
+        return self._read_and_validate_header(self.socket.recv(), request_id, request_type), request_id
+
+    def read_memory_batch(self, ranges):
+        """
+        Reads several ranges of memory in a single request.
+
+        >>> c.read_memory_batch([(0x100000, 4), (0x100008, 2)])
+        [b'\\x07\\x00\\x00\\xeb', b'\\x00\\x00']
+        """
+        results = []
+        for start in range(0, len(ranges), MAX_BATCH_RANGES):
+            batch = ranges[start:start + MAX_BATCH_RANGES]
+            request_data = struct.pack("I", len(batch))
+            for read_address, read_size in batch:
+                request_data += struct.pack("II", read_address, read_size)
+
+            reply_data, _ = self._request(RequestType.ReadMemoryBatch, request_data)
+            if reply_data is None or len(reply_data) != sum(size for _, size in batch):
+                return None
+
+            offset = 0
+            for _, read_size in batch:
+                results.append(reply_data[offset:offset + read_size])
+                offset += read_size
+        return results
+
+    def write_memory_batch(self, writes):
+        """
+        Writes several ranges of memory in a single request.
+
+        >>> c.write_memory_batch([(0x100000, b"\\xff\\xff\\xff\\xff"), (0x100008, b"\\xff")])
+        True
+        >>> c.write_memory_batch([(0x100000, b"\\x07\\x00\\x00\\xeb"), (0x100008, b"\\x00")])
+        True
+        """
+        for start in range(0, len(writes), MAX_BATCH_RANGES):
+            batch = writes[start:start + MAX_BATCH_RANGES]
+            request_data = struct.pack("I", len(batch))
+            for write_address, write_contents in batch:
+                request_data += struct.pack("II", write_address, len(write_contents))
+                request_data += write_contents
+
+            if self._request(RequestType.WriteMemoryBatch, request_data)[0] is None:
+                return False
+        return True
+
+    def watch_memory(self, ranges):
+        """
+        Sets the ranges of memory which Citra sends every frame, replacing the previous ones.
+        An empty list stops the updates.
+
+        >>> c.watch_memory([(0x100000, 4)])
+        True
+        >>> frame, contents = c.wait_for_watch_update()
+        >>> contents
+        [b'\\x07\\x00\\x00\\xeb']
+        >>> c.watch_memory([])
+        True
+        """
+        if self.subscriber is None:
+            self.subscriber = self.context.socket(zmq.SUB)
+            self.subscriber.setsockopt(zmq.SUBSCRIBE, b"")
+            self.subscriber.connect(self.publish_address)
+
+        request_data = struct.pack("I", len(ranges))
+        for watch_address, watch_size in ranges:
+            request_data += struct.pack("II", watch_address, watch_size)
+
+        reply_data, request_id = self._request(RequestType.SetMemoryWatches, request_data)
+        if reply_data is None:
+            return False
+        self.watches = list(ranges)
+        self.watch_request_id = request_id
+        return True
+
+    def wait_for_watch_update(self, timeout_ms=None):
+        """
+        Waits for the watched memory of the next frame. Returns the frame number and the
+        contents of each watched range, or None on timeout.
+        Frames are skipped while the script falls behind.
+        """
+        if self.subscriber is None:
+            raise RuntimeError("wait_for_watch_update called before watch_memory")
+
+        while self.subscriber.poll(timeout_ms):
+            raw_update = self.subscriber.recv()
+            update_version, update_id, update_type, update_data_size = struct.unpack("IIII", raw_update[:4*4])
+            # Skip the updates of watches which have since been replaced
+            if (update_type != RequestType.MemoryWatchUpdate or
+                update_id != self.watch_request_id or
+                update_data_size != len(raw_update[4*4:])):
+                continue
+
+            frame, = struct.unpack("I", raw_update[4*4:4*5])
+            contents = []
+            offset = 4*5
+            for _, watch_size in self.watches:
+                contents.append(raw_update[offset:offset + watch_size])
+                offset += watch_size
+            return frame, contents
+        return None
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
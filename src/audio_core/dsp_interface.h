@@ -70,6 +70,18 @@ public:
     /// Sets the dsp class that we trigger interrupts for
     virtual void SetServiceToInterrupt(std::weak_ptr<Service::DSP::DSP_DSP> dsp) = 0;
 
+    /// Copy of the state of the DSP other than its memory, held by save states
+    class State {
+    public:
+        virtual ~State() = default;
+    };
+
+    /// Captures the state of the DSP other than its memory, once the frame being rendered is done
+    virtual std::unique_ptr<State> CaptureState() = 0;
+
+    /// Restores a state captured from this DSP, the DSP memory is restored separately
+    virtual void RestoreState(const State& state) = 0;
+
     /// Select the sink to use based on sink id.
     void SetSink(const std::string& sink_id, const std::string& audio_device);
     /// Get the current sink
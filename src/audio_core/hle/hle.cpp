@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <future>
 #include "audio_core/audio_types.h"
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/hle.h"
@@ -12,7 +13,9 @@
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
 #include "core/core_timing.h"
+#include "core/settings.h"
 
 using InterruptType = Service::DSP::DSP_DSP::InterruptType;
 using Service::DSP::DSP_DSP;
@@ -21,6 +24,12 @@ namespace AudioCore {
 
 static constexpr u64 audio_frame_ticks = 1310252ull; ///< Units: ARM11 cycles
 
+/// Renders audio frames ahead of time, one at a time
+static Common::ThreadPool& GetRenderPool() {
+    static Common::ThreadPool pool(1, "AudioRender");
+    return pool;
+}
+
 struct DspHle::Impl final {
 public:
     explicit Impl(DspHle& parent);
@@ -36,6 +45,9 @@ public:
 
     void SetServiceToInterrupt(std::weak_ptr<DSP_DSP> dsp);
 
+    std::unique_ptr<DspInterface::State> CaptureState();
+    void RestoreState(const DspInterface::State& state);
+
 private:
     void ResetPipes();
     void WriteU16(DspPipe pipe_number, u16 value);
@@ -46,6 +58,9 @@ private:
     HLE::SharedMemory& WriteRegion();
 
     StereoFrame16 GenerateCurrentFrame();
+    void PrepareFrameAhead();
+    void RenderFrameAhead();
+    StereoFrame16 PublishFrameAhead();
     bool Tick();
     void AudioTickCallback(s64 cycles_late);
 
@@ -62,6 +77,30 @@ private:
     }};
     HLE::Mixers mixers;
 
+    /// Results of the frame rendered ahead, which are published at the next audio frame
+    struct RenderedFrame {
+        std::array<HLE::SourceStatus::Status, HLE::num_sources> source_statuses;
+        HLE::DspStatus dsp_status;
+        HLE::IntermediateMixSamples intermediate_mix_samples;
+        StereoFrame16 output;
+    } rendered_frame;
+    std::future<void> frame_render;
+
+    /// State of the DSP captured for save states, other than its memory
+    struct SavedState final : DspInterface::State {
+        explicit SavedState(const Impl& impl)
+            : dsp_state(impl.dsp_state), pipe_data(impl.pipe_data), sources(impl.sources),
+              mixers(impl.mixers), rendered_frame(impl.rendered_frame),
+              frame_rendered_ahead(impl.frame_render.valid()) {}
+
+        DspState dsp_state;
+        std::array<std::vector<u8>, num_dsp_pipe> pipe_data;
+        std::array<HLE::Source, HLE::num_sources> sources;
+        HLE::Mixers mixers;
+        RenderedFrame rendered_frame;
+        bool frame_rendered_ahead;
+    };
+
     DspHle& parent;
     CoreTiming::EventType* tick_event;
 
@@ -79,6 +118,9 @@ DspHle::Impl::Impl(DspHle& parent_) : parent(parent_) {
 }
 
 DspHle::Impl::~Impl() {
+    if (frame_render.valid()) {
+        frame_render.wait();
+    }
     CoreTiming::UnscheduleEvent(tick_event, 0);
 }
 
@@ -274,6 +316,15 @@ HLE::SharedMemory& DspHle::Impl::WriteRegion() {
     return CurrentRegionIndex() != 0 ? dsp_memory.region_0 : dsp_memory.region_1;
 }
 
+/// Writes the output frame to the shared memory region
+static void WriteFinalSamples(HLE::SharedMemory& write, const StereoFrame16& output_frame) {
+    for (std::size_t samplei = 0; samplei < output_frame.size(); samplei++) {
+        for (std::size_t channeli = 0; channeli < output_frame[0].size(); channeli++) {
+            write.final_samples.pcm16[samplei][channeli] = s16_le(output_frame[samplei][channeli]);
+        }
+    }
+}
+
 StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
     HLE::SharedMemory& read = ReadRegion();
     HLE::SharedMemory& write = WriteRegion();
@@ -284,9 +335,7 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
     for (std::size_t i = 0; i < HLE::num_sources; i++) {
         write.source_statuses.status[i] =
             sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
-        for (std::size_t mix = 0; mix < 3; mix++) {
-            sources[i].MixInto(intermediate_mixes[mix], mix);
-        }
+        sources[i].MixInto(intermediate_mixes);
     }
 
     // Generate final mix
@@ -295,28 +344,109 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
 
     StereoFrame16 output_frame = mixers.GetOutput();
 
-    // Write current output frame to the shared memory region
-    for (std::size_t samplei = 0; samplei < output_frame.size(); samplei++) {
-        for (std::size_t channeli = 0; channeli < output_frame[0].size(); channeli++) {
-            write.final_samples.pcm16[samplei][channeli] = s16_le(output_frame[samplei][channeli]);
-        }
-    }
+    WriteFinalSamples(write, output_frame);
 
     return output_frame;
 }
 
-bool DspHle::Impl::Tick() {
-    StereoFrame16 current_frame = {};
+void DspHle::Impl::PrepareFrameAhead() {
+    HLE::SharedMemory& read = ReadRegion();
+
+    for (std::size_t i = 0; i < HLE::num_sources; i++) {
+        sources[i].PrepareTick(read.source_configurations.config[i],
+                               read.adpcm_coefficients.coeff[i]);
+    }
+    mixers.PrepareTick(read.dsp_configuration, read.intermediate_mix_samples);
+}
+
+void DspHle::Impl::RenderFrameAhead() {
+    std::array<QuadFrame32, 3> intermediate_mixes = {};
+
+    for (std::size_t i = 0; i < HLE::num_sources; i++) {
+        rendered_frame.source_statuses[i] = sources[i].RenderTick();
+        sources[i].MixInto(intermediate_mixes);
+    }
 
+    rendered_frame.dsp_status =
+        mixers.RenderTick(rendered_frame.intermediate_mix_samples, intermediate_mixes);
+    rendered_frame.output = mixers.GetOutput();
+}
+
+StereoFrame16 DspHle::Impl::PublishFrameAhead() {
+    HLE::SharedMemory& write = WriteRegion();
+
+    for (std::size_t i = 0; i < HLE::num_sources; i++) {
+        write.source_statuses.status[i] = rendered_frame.source_statuses[i];
+    }
+    write.dsp_status = rendered_frame.dsp_status;
+    if (mixers.IsAuxEnabled(1)) {
+        write.intermediate_mix_samples.mix1 = rendered_frame.intermediate_mix_samples.mix1;
+    }
+    if (mixers.IsAuxEnabled(2)) {
+        write.intermediate_mix_samples.mix2 = rendered_frame.intermediate_mix_samples.mix2;
+    }
+
+    WriteFinalSamples(write, rendered_frame.output);
+
+    return rendered_frame.output;
+}
+
+bool DspHle::Impl::Tick() {
     // TODO: Check dsp::DSP semaphore (which indicates emulated application has finished writing to
     // shared memory region)
-    current_frame = GenerateCurrentFrame();
+
+    // With render ahead enabled, each frame is rendered on a worker thread during the previous
+    // audio frame and published in place of the current one. Everything it reads is captured when
+    // it is prepared, so the results only differ from rendering in place by being one frame late.
+    // When the setting changes, the pipeline fills or drains while still publishing exactly one
+    // frame per tick.
+    StereoFrame16 current_frame = {};
+    if (frame_render.valid()) {
+        frame_render.get();
+        current_frame = PublishFrameAhead();
+    } else {
+        current_frame = GenerateCurrentFrame();
+    }
 
     parent.OutputFrame(current_frame);
 
+    if (Settings::values.enable_audio_render_ahead) {
+        PrepareFrameAhead();
+        frame_render = GetRenderPool().Submit([this] { RenderFrameAhead(); });
+    }
+
     return true;
 }
 
+std::unique_ptr<DspInterface::State> DspHle::Impl::CaptureState() {
+    // The frame rendered ahead is part of the state, wait for the worker to be done with it
+    if (frame_render.valid()) {
+        frame_render.wait();
+    }
+    return std::make_unique<SavedState>(*this);
+}
+
+void DspHle::Impl::RestoreState(const DspInterface::State& state) {
+    const auto& saved = static_cast<const SavedState&>(state);
+    if (frame_render.valid()) {
+        frame_render.wait();
+    }
+
+    dsp_state = saved.dsp_state;
+    pipe_data = saved.pipe_data;
+    sources = saved.sources;
+    mixers = saved.mixers;
+    rendered_frame = saved.rendered_frame;
+
+    // The frame rendered ahead is published at the next tick, as if it had just been rendered
+    frame_render = {};
+    if (saved.frame_rendered_ahead) {
+        std::promise<void> rendered;
+        rendered.set_value();
+        frame_render = rendered.get_future();
+    }
+}
+
 void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
     if (Tick()) {
         // TODO(merry): Signal all the other interrupts as appropriate.
@@ -358,4 +488,12 @@ void DspHle::SetServiceToInterrupt(std::weak_ptr<DSP_DSP> dsp) {
     impl->SetServiceToInterrupt(std::move(dsp));
 }
 
+std::unique_ptr<DspInterface::State> DspHle::CaptureState() {
+    return impl->CaptureState();
+}
+
+void DspHle::RestoreState(const State& state) {
+    impl->RestoreState(state);
+}
+
 } // namespace AudioCore
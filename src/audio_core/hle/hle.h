@@ -30,6 +30,9 @@ public:
 
     void SetServiceToInterrupt(std::weak_ptr<Service::DSP::DSP_DSP> dsp) override;
 
+    std::unique_ptr<State> CaptureState() override;
+    void RestoreState(const State& state) override;
+
 private:
     struct Impl;
     friend struct Impl;
@@ -2,9 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <algorithm>
 #include <cstddef>
 #include "audio_core/hle/mixers.h"
+#include "audio_core/hle/mixing.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 
@@ -19,9 +19,17 @@ void Mixers::Reset() {
 DspStatus Mixers::Tick(DspConfiguration& config, const IntermediateMixSamples& read_samples,
                        IntermediateMixSamples& write_samples,
                        const std::array<QuadFrame32, 3>& input) {
-    ParseConfig(config);
+    PrepareTick(config, read_samples);
+    return RenderTick(write_samples, input);
+}
 
+void Mixers::PrepareTick(DspConfiguration& config, const IntermediateMixSamples& read_samples) {
+    ParseConfig(config);
     AuxReturn(read_samples);
+}
+
+DspStatus Mixers::RenderTick(IntermediateMixSamples& write_samples,
+                             const std::array<QuadFrame32, 3>& input) {
     AuxSend(write_samples, input);
 
     MixCurrentFrame();
@@ -29,6 +37,17 @@ DspStatus Mixers::Tick(DspConfiguration& config, const IntermediateMixSamples& r
     return GetCurrentStatus();
 }
 
+bool Mixers::IsAuxEnabled(std::size_t intermediate_mix_id) const {
+    switch (intermediate_mix_id) {
+    case 1:
+        return state.mixer1_enabled;
+    case 2:
+        return state.mixer2_enabled;
+    default:
+        return false;
+    }
+}
+
 void Mixers::ParseConfig(DspConfiguration& config) {
     if (!config.dirty_raw) {
         return;
@@ -85,32 +104,12 @@ void Mixers::ParseConfig(DspConfiguration& config) {
     config.dirty_raw = 0;
 }
 
-static s16 ClampToS16(s32 value) {
-    return static_cast<s16>(std::clamp(value, -32768, 32767));
-}
-
-static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
-                                           const std::array<s16, 2>& b) {
-    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
-            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
-}
-
 void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& samples) {
     // TODO(merry): Limiter. (Currently we're performing final mixing assuming a disabled limiter.)
 
     switch (state.output_format) {
     case OutputFormat::Mono:
-        std::transform(
-            current_frame.begin(), current_frame.end(), samples.begin(), current_frame.begin(),
-            [gain](const std::array<s16, 2>& accumulator,
-                   const std::array<s32, 4>& sample) -> std::array<s16, 2> {
-                // Downmix to mono
-                s16 mono = ClampToS16(static_cast<s32>(
-                    (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) /
-                    2));
-                // Mix into current frame
-                return AddAndClampToS16(accumulator, {mono, mono});
-            });
+        DownmixIntoMono(gain, samples, current_frame);
         return;
 
     case OutputFormat::Surround:
@@ -118,16 +117,7 @@ void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& sample
         // fallthrough
 
     case OutputFormat::Stereo:
-        std::transform(
-            current_frame.begin(), current_frame.end(), samples.begin(), current_frame.begin(),
-            [gain](const std::array<s16, 2>& accumulator,
-                   const std::array<s32, 4>& sample) -> std::array<s16, 2> {
-                // Downmix to stereo
-                s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
-                s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
-                // Mix into current frame
-                return AddAndClampToS16(accumulator, {left, right});
-            });
+        DownmixIntoStereo(gain, samples, current_frame);
         return;
     }
 
@@ -139,21 +129,11 @@ void Mixers::AuxReturn(const IntermediateMixSamples& read_samples) {
     // QuadFrame32.
 
     if (state.mixer1_enabled) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                state.intermediate_mix_buffer[1][sample][channel] =
-                    read_samples.mix1.pcm32[channel][sample];
-            }
-        }
+        ChannelsToQuadFrame(read_samples.mix1.pcm32, state.intermediate_mix_buffer[1]);
     }
 
     if (state.mixer2_enabled) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                state.intermediate_mix_buffer[2][sample][channel] =
-                    read_samples.mix2.pcm32[channel][sample];
-            }
-        }
+        ChannelsToQuadFrame(read_samples.mix2.pcm32, state.intermediate_mix_buffer[2]);
     }
 }
 
@@ -165,21 +145,13 @@ void Mixers::AuxSend(IntermediateMixSamples& write_samples,
     state.intermediate_mix_buffer[0] = input[0];
 
     if (state.mixer1_enabled) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                write_samples.mix1.pcm32[channel][sample] = input[1][sample][channel];
-            }
-        }
+        QuadFrameToChannels(input[1], write_samples.mix1.pcm32);
     } else {
         state.intermediate_mix_buffer[1] = input[1];
     }
 
     if (state.mixer2_enabled) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                write_samples.mix2.pcm32[channel][sample] = input[2][sample][channel];
-            }
-        }
+        QuadFrameToChannels(input[2], write_samples.mix2.pcm32);
     } else {
         state.intermediate_mix_buffer[2] = input[2];
     }
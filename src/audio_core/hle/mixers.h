@@ -22,6 +22,22 @@ public:
     DspStatus Tick(DspConfiguration& config, const IntermediateMixSamples& read_samples,
                    IntermediateMixSamples& write_samples, const std::array<QuadFrame32, 3>& input);
 
+    /**
+     * The first half of Tick, which must run when the audio frame is due: it reads the
+     * configuration and the intermediate mixes returned by the ARM11.
+     */
+    void PrepareTick(DspConfiguration& config, const IntermediateMixSamples& read_samples);
+
+    /**
+     * The second half of Tick, which only touches the state of the mixers and its arguments and
+     * may run on another thread.
+     */
+    DspStatus RenderTick(IntermediateMixSamples& write_samples,
+                         const std::array<QuadFrame32, 3>& input);
+
+    /// Whether the given intermediate mix is sent to the ARM11 by RenderTick.
+    bool IsAuxEnabled(std::size_t intermediate_mix_id) const;
+
     StereoFrame16 GetOutput() const {
         return current_frame;
     }
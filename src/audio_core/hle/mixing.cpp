@@ -0,0 +1,118 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstddef>
+#include "audio_core/hle/mixing.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace AudioCore {
+namespace HLE {
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+void MixStereoIntoQuad(const StereoFrame16& source, const SourceGains& gains,
+                       std::array<QuadFrame32, 3>& dest) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse2) {
+        MixStereoIntoQuadSSE2(source, gains, dest);
+        return;
+    }
+#endif
+
+    for (std::size_t mix = 0; mix < dest.size(); mix++) {
+        const std::array<float, 4>& gain = gains[mix];
+        for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+            // Conversion from stereo (source) to quadraphonic (dest) occurs here.
+            dest[mix][samplei][0] += static_cast<s32>(gain[0] * source[samplei][0]);
+            dest[mix][samplei][1] += static_cast<s32>(gain[1] * source[samplei][1]);
+            dest[mix][samplei][2] += static_cast<s32>(gain[2] * source[samplei][0]);
+            dest[mix][samplei][3] += static_cast<s32>(gain[3] * source[samplei][1]);
+        }
+    }
+}
+
+void DownmixIntoStereo(float gain, const QuadFrame32& source, StereoFrame16& dest) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse2) {
+        DownmixIntoStereoSSE2(gain, source, dest);
+        return;
+    }
+#endif
+
+    std::transform(
+        dest.begin(), dest.end(), source.begin(), dest.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            // Downmix to stereo
+            s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+            s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+            // Mix into current frame
+            return AddAndClampToS16(accumulator, {left, right});
+        });
+}
+
+void DownmixIntoMono(float gain, const QuadFrame32& source, StereoFrame16& dest) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse2) {
+        DownmixIntoMonoSSE2(gain, source, dest);
+        return;
+    }
+#endif
+
+    std::transform(
+        dest.begin(), dest.end(), source.begin(), dest.begin(),
+        [gain](const std::array<s16, 2>& accumulator,
+               const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+            // Downmix to mono
+            s16 mono = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+            // Mix into current frame
+            return AddAndClampToS16(accumulator, {mono, mono});
+        });
+}
+
+void ChannelsToQuadFrame(const QuadChannels32& source, QuadFrame32& dest) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse2) {
+        ChannelsToQuadFrameSSE2(source, dest);
+        return;
+    }
+#endif
+
+    for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            dest[sample][channel] = source[channel][sample];
+        }
+    }
+}
+
+void QuadFrameToChannels(const QuadFrame32& source, QuadChannels32& dest) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse2) {
+        QuadFrameToChannelsSSE2(source, dest);
+        return;
+    }
+#endif
+
+    for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            dest[channel][sample] = source[sample][channel];
+        }
+    }
+}
+
+} // namespace HLE
+} // namespace AudioCore
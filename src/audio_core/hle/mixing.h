@@ -0,0 +1,52 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "audio_core/audio_types.h"
+#include "audio_core/hle/shared_memory.h"
+
+namespace AudioCore {
+namespace HLE {
+
+/// Gains applied to each channel of a source, for each of the three intermediate mixes
+using SourceGains = std::array<std::array<float, 4>, 3>;
+
+/// Channels of an intermediate mix as laid out in shared memory, the transpose of a QuadFrame32
+using QuadChannels32 = s32_le[4][samples_per_frame];
+
+/**
+ * Applies the gains of each intermediate mix to a stereo frame and accumulates it into the
+ * intermediate mixes. The left channel feeds channels 0 and 2 and the right one 1 and 3.
+ */
+void MixStereoIntoQuad(const StereoFrame16& source, const SourceGains& gains,
+                       std::array<QuadFrame32, 3>& dest);
+
+/// Downmixes a quadraphonic frame to stereo with a gain, and accumulates it into dest with
+/// saturation.
+void DownmixIntoStereo(float gain, const QuadFrame32& source, StereoFrame16& dest);
+
+/// Downmixes a quadraphonic frame to mono with a gain, and accumulates it into both channels of
+/// dest with saturation.
+void DownmixIntoMono(float gain, const QuadFrame32& source, StereoFrame16& dest);
+
+/// Copies an intermediate mix from its shared memory layout.
+void ChannelsToQuadFrame(const QuadChannels32& source, QuadFrame32& dest);
+
+/// Copies an intermediate mix to its shared memory layout.
+void QuadFrameToChannels(const QuadFrame32& source, QuadChannels32& dest);
+
+#ifdef ARCHITECTURE_x86_64
+// SSE2 versions of the above, all of which produce the same results as the scalar versions
+void MixStereoIntoQuadSSE2(const StereoFrame16& source, const SourceGains& gains,
+                           std::array<QuadFrame32, 3>& dest);
+void DownmixIntoStereoSSE2(float gain, const QuadFrame32& source, StereoFrame16& dest);
+void DownmixIntoMonoSSE2(float gain, const QuadFrame32& source, StereoFrame16& dest);
+void ChannelsToQuadFrameSSE2(const QuadChannels32& source, QuadFrame32& dest);
+void QuadFrameToChannelsSSE2(const QuadFrame32& source, QuadChannels32& dest);
+#endif
+
+} // namespace HLE
+} // namespace AudioCore
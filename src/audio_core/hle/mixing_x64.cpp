@@ -0,0 +1,136 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include <emmintrin.h>
+#include "audio_core/hle/mixing.h"
+
+// SSE2 is part of x86-64, so unlike the other vectorized kernels these need no target attribute.
+// Floating point operations are done in the same order as in the scalar code, so that the
+// results are identical.
+
+namespace AudioCore {
+namespace HLE {
+
+static __m128i Load(const void* source) {
+    return _mm_loadu_si128(static_cast<const __m128i*>(source));
+}
+
+static void Store(void* dest, __m128i value) {
+    _mm_storeu_si128(static_cast<__m128i*>(dest), value);
+}
+
+/// Transposes a 4x4 matrix of 32-bit values held in 4 rows.
+static void Transpose4(__m128i& row0, __m128i& row1, __m128i& row2, __m128i& row3) {
+    const __m128i t0 = _mm_unpacklo_epi32(row0, row1);
+    const __m128i t1 = _mm_unpacklo_epi32(row2, row3);
+    const __m128i t2 = _mm_unpackhi_epi32(row0, row1);
+    const __m128i t3 = _mm_unpackhi_epi32(row2, row3);
+    row0 = _mm_unpacklo_epi64(t0, t1);
+    row1 = _mm_unpackhi_epi64(t0, t1);
+    row2 = _mm_unpacklo_epi64(t2, t3);
+    row3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/// Loads a quadraphonic sample and applies the gain to each of its channels.
+static __m128 LoadWithGain(__m128 gain, const std::array<s32, 4>& sample) {
+    return _mm_mul_ps(gain, _mm_cvtepi32_ps(Load(sample.data())));
+}
+
+/// Adds 8 samples, clamped to 16 bits, to dest with saturation.
+static void AccumulateClamped(std::array<s16, 2>* dest, __m128i low, __m128i high) {
+    Store(dest, _mm_adds_epi16(Load(dest), _mm_packs_epi32(low, high)));
+}
+
+void MixStereoIntoQuadSSE2(const StereoFrame16& source, const SourceGains& gains,
+                           std::array<QuadFrame32, 3>& dest) {
+    const __m128 mix_gains[3] = {_mm_loadu_ps(gains[0].data()), _mm_loadu_ps(gains[1].data()),
+                                 _mm_loadu_ps(gains[2].data())};
+
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 2) {
+        // Two stereo samples, sign extended to 32 bits
+        const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&source[samplei]));
+        const __m128i pair32 = _mm_srai_epi32(_mm_unpacklo_epi16(pair, pair), 16);
+        // Each of them converted to quadraphonic as left, right, left, right
+        const __m128 first = _mm_cvtepi32_ps(_mm_shuffle_epi32(pair32, _MM_SHUFFLE(1, 0, 1, 0)));
+        const __m128 second = _mm_cvtepi32_ps(_mm_shuffle_epi32(pair32, _MM_SHUFFLE(3, 2, 3, 2)));
+
+        for (std::size_t mix = 0; mix < dest.size(); mix++) {
+            s32* out_first = dest[mix][samplei].data();
+            s32* out_second = dest[mix][samplei + 1].data();
+            Store(out_first, _mm_add_epi32(Load(out_first),
+                                           _mm_cvttps_epi32(_mm_mul_ps(mix_gains[mix], first))));
+            Store(out_second, _mm_add_epi32(Load(out_second), _mm_cvttps_epi32(_mm_mul_ps(
+                                                                  mix_gains[mix], second))));
+        }
+    }
+}
+
+void DownmixIntoStereoSSE2(float gain, const QuadFrame32& source, StereoFrame16& dest) {
+    const __m128 gain_vector = _mm_set1_ps(gain);
+
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const __m128 s0 = LoadWithGain(gain_vector, source[samplei]);
+        const __m128 s1 = LoadWithGain(gain_vector, source[samplei + 1]);
+        const __m128 s2 = LoadWithGain(gain_vector, source[samplei + 2]);
+        const __m128 s3 = LoadWithGain(gain_vector, source[samplei + 3]);
+
+        // Channels 0 and 1 of two samples added to their channels 2 and 3
+        const __m128 low = _mm_add_ps(_mm_movelh_ps(s0, s1), _mm_movehl_ps(s1, s0));
+        const __m128 high = _mm_add_ps(_mm_movelh_ps(s2, s3), _mm_movehl_ps(s3, s2));
+        AccumulateClamped(&dest[samplei], _mm_cvttps_epi32(low), _mm_cvttps_epi32(high));
+    }
+}
+
+void DownmixIntoMonoSSE2(float gain, const QuadFrame32& source, StereoFrame16& dest) {
+    const __m128 gain_vector = _mm_set1_ps(gain);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128 c0 = LoadWithGain(gain_vector, source[samplei]);
+        __m128 c1 = LoadWithGain(gain_vector, source[samplei + 1]);
+        __m128 c2 = LoadWithGain(gain_vector, source[samplei + 2]);
+        __m128 c3 = LoadWithGain(gain_vector, source[samplei + 3]);
+        // Each channel of the four samples
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        // Halving is exact, so multiplying by 0.5 is the same as dividing by 2
+        const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(c0, c1), c2), c3);
+        const __m128i mono = _mm_cvttps_epi32(_mm_mul_ps(sum, half));
+        const __m128i mono16 = _mm_packs_epi32(mono, mono);
+        const __m128i stereo = _mm_unpacklo_epi16(mono16, mono16);
+        Store(&dest[samplei], _mm_adds_epi16(Load(&dest[samplei]), stereo));
+    }
+}
+
+void ChannelsToQuadFrameSSE2(const QuadChannels32& source, QuadFrame32& dest) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128i row0 = Load(&source[0][samplei]);
+        __m128i row1 = Load(&source[1][samplei]);
+        __m128i row2 = Load(&source[2][samplei]);
+        __m128i row3 = Load(&source[3][samplei]);
+        Transpose4(row0, row1, row2, row3);
+        Store(dest[samplei].data(), row0);
+        Store(dest[samplei + 1].data(), row1);
+        Store(dest[samplei + 2].data(), row2);
+        Store(dest[samplei + 3].data(), row3);
+    }
+}
+
+void QuadFrameToChannelsSSE2(const QuadFrame32& source, QuadChannels32& dest) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128i row0 = Load(source[samplei].data());
+        __m128i row1 = Load(source[samplei + 1].data());
+        __m128i row2 = Load(source[samplei + 2].data());
+        __m128i row3 = Load(source[samplei + 3].data());
+        Transpose4(row0, row1, row2, row3);
+        Store(&dest[0][samplei], row0);
+        Store(&dest[1][samplei], row1);
+        Store(&dest[2][samplei], row2);
+        Store(&dest[3][samplei], row3);
+    }
+}
+
+} // namespace HLE
+} // namespace AudioCore
@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
+#include "audio_core/hle/mixing.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
@@ -19,30 +21,42 @@ SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
                                   const s16_le (&adpcm_coeffs)[16]) {
     ParseConfig(config, adpcm_coeffs);
 
+    return RenderTick();
+}
+
+void Source::PrepareTick(SourceConfiguration::Configuration& config,
+                         const s16_le (&adpcm_coeffs)[16]) {
+    ParseConfig(config, adpcm_coeffs);
+
+    if (state.enabled) {
+        SnapshotBuffers();
+    }
+    prepared = true;
+}
+
+SourceStatus::Status Source::RenderTick() {
     if (state.enabled) {
         GenerateFrame();
     }
 
+    buffer_snapshots.clear();
+    prepared = false;
+
     return GetCurrentStatus();
 }
 
-void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
+void Source::MixInto(std::array<QuadFrame32, 3>& dest) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
-    }
+    MixStereoIntoQuad(current_frame, state.gain, dest);
 }
 
 void Source::Reset() {
     current_frame.fill({});
     state = {};
+    buffer_snapshots.clear();
+    prepared = false;
 }
 
 void Source::ParseConfig(SourceConfiguration::Configuration& config,
@@ -230,6 +244,10 @@ void Source::GenerateFrame() {
     current_frame.fill({});
 
     if (state.current_buffer.empty() && !DequeueBuffer()) {
+        if (!state.input_queue.empty()) {
+            // The buffer due wasn't copied by PrepareTick, this frame underruns
+            return;
+        }
         state.enabled = false;
         state.buffer_update = true;
         state.current_buffer_id = 0;
@@ -277,6 +295,16 @@ bool Source::DequeueBuffer() {
         return false;
 
     Buffer buf = state.input_queue.top();
+
+    // Guest memory may only be read on the emulation thread. When the frame is rendered ahead,
+    // a buffer SnapshotBuffers didn't copy is left queued and played from the next frame on.
+    const std::optional<const u8*> buffer_memory = GetBufferMemory(buf);
+    if (!buffer_memory) {
+        LOG_DEBUG(Audio_DSP, "source_id={} buffer_id={}: Buffer not copied, underrunning",
+                  source_id, buf.buffer_id);
+        return false;
+    }
+    const u8* const memory = *buffer_memory;
     state.input_queue.pop();
 
     if (buf.adpcm_dirty) {
@@ -284,7 +312,6 @@ bool Source::DequeueBuffer() {
         state.adpcm_state.yn2 = buf.adpcm_yn[1];
     }
 
-    const u8* const memory = Memory::GetPhysicalPointer(buf.physical_address);
     if (memory) {
         const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
         switch (buf.format) {
@@ -327,6 +354,84 @@ bool Source::DequeueBuffer() {
     return true;
 }
 
+/// Number of bytes read from guest memory to decode a buffer
+static std::size_t GetBufferSize(SourceConfiguration::Configuration::Format format,
+                                 SourceConfiguration::Configuration::MonoOrStereo mono_or_stereo,
+                                 u32 length) {
+    using Format = SourceConfiguration::Configuration::Format;
+    using MonoOrStereo = SourceConfiguration::Configuration::MonoOrStereo;
+
+    const std::size_t num_channels = mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
+    switch (format) {
+    case Format::PCM8:
+        return length * num_channels;
+    case Format::PCM16:
+        return length * num_channels * sizeof(s16);
+    case Format::ADPCM:
+        // Frames of 8 bytes holding 14 samples each
+        return (length + 13) / 14 * 8;
+    default:
+        return 0;
+    }
+}
+
+void Source::SnapshotBuffers() {
+    buffer_snapshots.clear();
+
+    // An upper bound on the number of samples the frame consumes, counting those remaining in the
+    // interpolation history and the one it looks ahead
+    const double frame_samples =
+        std::ceil(samples_per_frame * static_cast<double>(state.rate_multiplier));
+    const u64 needed = (state.interp_state.fposition >> 24) +
+                       static_cast<u64>(std::min(frame_samples, 1e12)) + 4;
+
+    // Walk the queue in the order GenerateFrame dequeues from it until there are enough samples.
+    // A looping buffer is requeued first again, so nothing after it is played this frame.
+    auto queue = state.input_queue;
+    u64 available = state.current_buffer.size();
+    while (available < needed && !queue.empty()) {
+        const Buffer buf = queue.top();
+        queue.pop();
+
+        const std::size_t size = GetBufferSize(buf.format, buf.mono_or_stereo, buf.length);
+        const u8* const memory = Memory::GetPhysicalPointer(buf.physical_address);
+        if (memory) {
+            available += buf.length;
+            buffer_snapshots.push_back({buf.physical_address, {memory, memory + size}, true});
+        } else {
+            // Still recorded, so that rendering drops the buffer as it would have without
+            // rendering ahead
+            buffer_snapshots.push_back({buf.physical_address, {}, false});
+        }
+
+        if (buf.is_looping) {
+            break;
+        }
+    }
+}
+
+std::optional<const u8*> Source::GetBufferMemory(const Buffer& buf) const {
+    const std::size_t size = GetBufferSize(buf.format, buf.mono_or_stereo, buf.length);
+    for (const BufferSnapshot& snapshot : buffer_snapshots) {
+        if (snapshot.physical_address != buf.physical_address) {
+            continue;
+        }
+        if (!snapshot.is_valid) {
+            return nullptr;
+        }
+        if (snapshot.data.size() >= size) {
+            return snapshot.data.data();
+        }
+    }
+
+    // A buffer the walk in SnapshotBuffers didn't expect to be played. It can't be read here, as
+    // the frame may be rendering on another thread.
+    if (prepared) {
+        return std::nullopt;
+    }
+    return Memory::GetPhysicalPointer(buf.physical_address);
+}
+
 SourceStatus::Status Source::GetCurrentStatus() {
     SourceStatus::Status ret;
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <optional>
 #include <vector>
 #include <queue>
 #include "audio_core/audio_types.h"
@@ -47,15 +48,27 @@ public:
                               const s16_le (&adpcm_coeffs)[16]);
 
     /**
-     * Mix this source's output into dest, using the gains for the `intermediate_mix_id`-th
-     * intermediate mixer.
-     * @param dest The QuadFrame32 to mix into.
-     * @param intermediate_mix_id The id of the intermediate mix whose gains we are using.
+     * The first half of Tick, for rendering the frame on another thread. This must run when the
+     * audio frame is due: besides reading the configuration, it copies the guest memory of the
+     * buffers the frame may play, so that the result doesn't depend on when it is rendered.
      */
-    void MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const;
+    void PrepareTick(SourceConfiguration::Configuration& config,
+                     const s16_le (&adpcm_coeffs)[16]);
+
+    /**
+     * The second half of Tick, which may run on another thread after PrepareTick.
+     * @return The current status of this Source.
+     */
+    SourceStatus::Status RenderTick();
+
+    /**
+     * Mix this source's output into each of the intermediate mixes, using their gains.
+     * @param dest The QuadFrame32s to mix into, one per intermediate mix.
+     */
+    void MixInto(std::array<QuadFrame32, 3>& dest) const;
 
 private:
-    const std::size_t source_id;
+    std::size_t source_id;
     StereoFrame16 current_frame;
 
     using Format = SourceConfiguration::Configuration::Format;
@@ -132,6 +145,20 @@ private:
 
     } state;
 
+    /// Guest memory of a buffer, copied by PrepareTick
+    struct BufferSnapshot {
+        PAddr physical_address;
+        std::vector<u8> data;
+        /// Whether the address was valid, the buffer is dropped otherwise
+        bool is_valid;
+    };
+
+    /// Buffers the frame being rendered may dequeue, empty unless it was prepared by PrepareTick
+    std::vector<BufferSnapshot> buffer_snapshots;
+    /// Whether the frame being rendered was prepared by PrepareTick, in which case guest memory is
+    /// only read from buffer_snapshots
+    bool prepared = false;
+
     // Internal functions
 
     /// INTERNAL: Update our internal state based on the current config.
@@ -141,6 +168,12 @@ private:
     /// INTERNAL: Dequeues a buffer and does preprocessing on it (decoding, resampling). Puts it
     /// into current_buffer.
     bool DequeueBuffer();
+    /// INTERNAL: Copies the guest memory of the buffers GenerateFrame may dequeue into
+    /// buffer_snapshots.
+    void SnapshotBuffers();
+    /// INTERNAL: Gets the contents of a buffer, nullptr if its address is invalid. When the frame
+    /// was prepared by PrepareTick, they come from buffer_snapshots, std::nullopt if not copied.
+    std::optional<const u8*> GetBufferMemory(const Buffer& buf) const;
     /// INTERNAL: Generates a SourceStatus::Status based on our internal state.
     SourceStatus::Status GetCurrentStatus();
 };
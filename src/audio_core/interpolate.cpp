@@ -6,6 +6,10 @@
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
 namespace AudioCore {
 namespace AudioInterp {
 
@@ -15,63 +19,107 @@ constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
+/// The two samples around each step are gathered first, and then passed to kernel all at once
+/// with the fractional positions between them.
+template <typename Kernel>
 static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-                            std::size_t& outputi, Function fn) {
+                            std::size_t& outputi, Kernel kernel) {
     ASSERT(rate > 0);
 
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    // Positions are counted from the two historical samples, which precede the input.
+    const std::size_t num_samples = input.size() + 2;
+    const auto sample_at = [&](std::size_t i) -> std::array<s16, 2> {
+        if (i < 2)
+            return i == 0 ? state.xn2 : state.xn1;
+        return input[i - 2];
+    };
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
-    u64 fposition = state.fposition;
+    const u64 fposition = state.fposition;
+
+    // A step needs the sample after the two it interpolates between to be available.
+    const u64 end_position = (num_samples - 2) * scale_factor;
+    std::size_t count = 0;
+    if (fposition < end_position) {
+        count = output.size() - outputi;
+        if (step_size != 0) {
+            const u64 num_steps = (end_position - fposition + step_size - 1) / step_size;
+            count = static_cast<std::size_t>(std::min<u64>(count, num_steps));
+        }
+    }
+
+    std::array<std::array<s16, 2>, samples_per_frame> x0;
+    std::array<std::array<s16, 2>, samples_per_frame> x1;
+    std::array<u32, samples_per_frame> fractions;
+    for (std::size_t i = 0; i < count; i++) {
+        const u64 position = fposition + i * step_size;
+        const std::size_t inputi = static_cast<std::size_t>(position / scale_factor);
+        x0[i] = sample_at(inputi);
+        x1[i] = sample_at(inputi + 1);
+        fractions[i] = static_cast<u32>(position & scale_mask);
+    }
+    kernel(x0.data(), x1.data(), fractions.data(), count, &output[outputi]);
+    outputi += count;
+
+    const u64 next_position = fposition + count * step_size;
     std::size_t inputi = 0;
+    if (outputi < output.size()) {
+        // Ran out of input
+        inputi = num_samples - 2;
+    } else if (count != 0) {
+        // The position of the last step
+        inputi = static_cast<std::size_t>((next_position - step_size) / scale_factor);
+    }
 
-    while (outputi < output.size()) {
-        inputi = static_cast<std::size_t>(fposition / scale_factor);
+    const std::array<s16, 2> xn2 = sample_at(inputi);
+    const std::array<s16, 2> xn1 = sample_at(inputi + 1);
+    state.xn2 = xn2;
+    state.xn1 = xn1;
+    state.fposition = next_position - inputi * scale_factor;
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
-            break;
-        }
+    input.erase(input.begin(), std::next(input.begin(), inputi));
+}
 
-        u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+static void NoneKernel(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1,
+                       const u32* fractions, std::size_t count, std::array<s16, 2>* output) {
+    std::copy_n(x0, count, output);
+}
 
-        fposition += step_size;
+static void LinearKernel(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1,
+                         const u32* fractions, std::size_t count, std::array<s16, 2>* output) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse2) {
+        LinearSSE2(x0, x1, fractions, count, output);
+        return;
     }
+#endif
+
+    for (std::size_t i = 0; i < count; i++) {
+        const u64 fraction = fractions[i];
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
-    state.fposition = fposition - inputi * scale_factor;
+        // This is a saturated subtraction. (Verified by black-box fuzzing.)
+        s64 delta0 = std::clamp<s64>(x1[i][0] - x0[i][0], -32768, 32767);
+        s64 delta1 = std::clamp<s64>(x1[i][1] - x0[i][1], -32768, 32767);
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+        output[i] = {
+            static_cast<s16>(x0[i][0] + fraction * delta0 / scale_factor),
+            static_cast<s16>(x0[i][1] + fraction * delta1 / scale_factor),
+        };
+    }
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    StepOverSamples(state, input, rate, output, outputi, NoneKernel);
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
-                    });
+    StepOverSamples(state, input, rate, output, outputi, LinearKernel);
 }
 
 } // namespace AudioInterp
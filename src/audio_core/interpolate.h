@@ -47,5 +47,15 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi);
 
+#ifdef ARCHITECTURE_x86_64
+/**
+ * Vectorized linear interpolation between pairs of samples, with the same results as the scalar
+ * interpolation.
+ * @param fractions Position of each output between x0 and x1, with 24 fractional bits
+ */
+void LinearSSE2(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1, const u32* fractions,
+                std::size_t count, std::array<s16, 2>* output);
+#endif
+
 } // namespace AudioInterp
 } // namespace AudioCore
@@ -0,0 +1,71 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <emmintrin.h>
+#include "audio_core/interpolate.h"
+
+namespace AudioCore {
+namespace AudioInterp {
+
+static __m128i Load(const void* source) {
+    return _mm_loadu_si128(static_cast<const __m128i*>(source));
+}
+
+/// Widens the products of two vectors of 16-bit lanes to 32 bits.
+static void Multiply(__m128i a, __m128i b, __m128i& low, __m128i& high) {
+    const __m128i product_low = _mm_mullo_epi16(a, b);
+    const __m128i product_high = _mm_mulhi_epi16(a, b);
+    low = _mm_unpacklo_epi16(product_low, product_high);
+    high = _mm_unpackhi_epi16(product_low, product_high);
+}
+
+/// Spreads the low 16 bits of 4 lanes to both channels of 4 stereo samples.
+static __m128i SpreadToChannels(__m128i values) {
+    const __m128i packed = _mm_packs_epi32(values, values);
+    return _mm_unpacklo_epi16(packed, packed);
+}
+
+void LinearSSE2(const std::array<s16, 2>* x0, const std::array<s16, 2>* x1, const u32* fractions,
+                std::size_t count, std::array<s16, 2>* output) {
+    // fraction * delta needs 40 bits, so the fraction is split into two 12-bit halves whose
+    // products fit in 32 bits. Rounding the low product down first doesn't change the result:
+    // floor((high * 2^12 + low) / 2^24) == floor((high + floor(low / 2^12)) / 2^12)
+    const __m128i low_mask = _mm_set1_epi32(0xFFF);
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i first = Load(&x0[i]);
+        // Saturated subtraction, as in the scalar version
+        const __m128i delta = _mm_subs_epi16(Load(&x1[i]), first);
+
+        const __m128i fraction = Load(&fractions[i]);
+        const __m128i fraction_high = SpreadToChannels(_mm_srli_epi32(fraction, 12));
+        const __m128i fraction_low = SpreadToChannels(_mm_and_si128(fraction, low_mask));
+
+        __m128i high_low, high_high, low_low, low_high;
+        Multiply(delta, fraction_high, high_low, high_high);
+        Multiply(delta, fraction_low, low_low, low_high);
+        const __m128i step_low =
+            _mm_srai_epi32(_mm_add_epi32(high_low, _mm_srai_epi32(low_low, 12)), 12);
+        const __m128i step_high =
+            _mm_srai_epi32(_mm_add_epi32(high_high, _mm_srai_epi32(low_high, 12)), 12);
+
+        // The steps are within 16 bits, and the sum wraps around as the scalar version's does
+        const __m128i result = _mm_add_epi16(first, _mm_packs_epi32(step_low, step_high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), result);
+    }
+
+    for (; i < count; i++) {
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const s32 delta =
+                std::clamp(static_cast<s32>(x1[i][channel]) - x0[i][channel], -32768, 32767);
+            const s64 step = (static_cast<s64>(fractions[i]) * delta) >> 24;
+            output[i][channel] = static_cast<s16>(x0[i][channel] + step);
+        }
+    }
+}
+
+} // namespace AudioInterp
+} // namespace AudioCore
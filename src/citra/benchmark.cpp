@@ -0,0 +1,151 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include <fmt/format.h>
+#include "citra/benchmark.h"
+#include "citra/emu_window/emu_window_sdl2.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/core.h"
+#include "core/perf_stats.h"
+
+namespace {
+
+using DoubleMs = std::chrono::duration<double, std::milli>;
+
+/// Accumulated ticks of each MicroProfile timer
+std::vector<u64> GetTimerTicks() {
+    std::vector<u64> ticks;
+#if MICROPROFILE_ENABLED
+    std::lock_guard<std::recursive_mutex> lock(MicroProfileGetMutex());
+    const MicroProfile& profile = *MicroProfileGet();
+    for (u32 i = 0; i < profile.nTotalTimers; ++i) {
+        ticks.push_back(profile.AccumTimers[i].nTicks);
+    }
+#endif
+    return ticks;
+}
+
+std::string EscapeJson(const std::string& str) {
+    std::string escaped;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+/// Nearest-rank percentile of sorted, which must not be empty
+double Percentile(const std::vector<double>& sorted, double percent) {
+    const auto rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * sorted.size()));
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+/// Writes the time spent in each MicroProfile timer since start_ticks, grouped by name
+void WriteTimers(std::string& out, const std::vector<u64>& start_ticks) {
+#if MICROPROFILE_ENABLED
+    std::lock_guard<std::recursive_mutex> lock(MicroProfileGetMutex());
+    const MicroProfile& profile = *MicroProfileGet();
+    const double ms_per_tick = 1000.0 / MicroProfileTicksPerSecondCpu();
+    bool first = true;
+    for (u32 i = 0; i < profile.nTotalTimers; ++i) {
+        const u64 start = i < start_ticks.size() ? start_ticks[i] : 0;
+        const u64 ticks = profile.AccumTimers[i].nTicks - start;
+        if (ticks == 0)
+            continue;
+        const auto& timer = profile.TimerInfo[i];
+        out += fmt::format("{}\n    \"{}/{}\": {:.3f}", first ? "" : ",",
+                           EscapeJson(profile.GroupInfo[timer.nGroupIndex].pName),
+                           EscapeJson(timer.pName), ticks * ms_per_tick);
+        first = false;
+    }
+    if (!first)
+        out += "\n  ";
+#endif
+}
+
+} // Anonymous namespace
+
+bool RunBenchmark(Core::System& system, const EmuWindow_SDL2& emu_window, u32 num_frames,
+                  const std::string& output_path) {
+    LOG_INFO(Frontend, "Running benchmark for {} frames", num_frames);
+
+#if MICROPROFILE_ENABLED
+    // Accumulate the timers over the whole run instead of the profiler's display interval
+    MicroProfileSetEnableAllGroups(true);
+    MicroProfileSetAggregateFrames(0);
+#endif
+    const std::vector<u64> start_ticks = GetTimerTicks();
+
+    system.GetAndResetPerfStats();
+    system.perf_stats.StartRecordingFrames();
+    const auto start = std::chrono::steady_clock::now();
+
+    while (system.perf_stats.GetNumRecordedFrames() < num_frames) {
+        if (!emu_window.IsOpen()) {
+            LOG_ERROR(Frontend, "Benchmark interrupted by closing the window");
+            return false;
+        }
+        const Core::System::ResultStatus result = system.RunLoop();
+        if (result != Core::System::ResultStatus::Success) {
+            LOG_ERROR(Frontend, "Benchmark stopped by an emulation error: {}",
+                      system.GetStatusDetails());
+            return false;
+        }
+    }
+
+    const DoubleMs wall_time = std::chrono::steady_clock::now() - start;
+    const Core::PerfStats::Results results = system.GetAndResetPerfStats();
+    std::vector<double> frametimes;
+    for (const auto& frametime : system.perf_stats.GetRecordedFrames()) {
+        frametimes.push_back(DoubleMs(frametime).count());
+    }
+    // RunLoop may end a frame or two past the requested count
+    frametimes.resize(num_frames);
+
+    std::vector<double> sorted = frametimes;
+    std::sort(sorted.begin(), sorted.end());
+    const double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+    std::string json = fmt::format("{{\n  \"frames\": {},\n  \"wall_time_ms\": {:.3f},\n",
+                                   num_frames, wall_time.count());
+    json += fmt::format("  \"emulation_speed\": {:.4f},\n  \"game_fps\": {:.3f},\n",
+                        results.emulation_speed, results.game_fps);
+    json += fmt::format(
+        "  \"frametime_ms\": {{\"mean\": {:.3f}, \"min\": {:.3f}, \"max\": {:.3f}, "
+        "\"p50\": {:.3f}, \"p90\": {:.3f}, \"p99\": {:.3f}}},\n",
+        mean, sorted.front(), sorted.back(), Percentile(sorted, 50), Percentile(sorted, 90),
+        Percentile(sorted, 99));
+    json += "  \"frametimes_ms\": [";
+    for (std::size_t i = 0; i < frametimes.size(); ++i) {
+        json += fmt::format("{}{:.3f}", i == 0 ? "" : ", ", frametimes[i]);
+    }
+    json += "],\n  \"microprofile_ms\": {";
+    WriteTimers(json, start_ticks);
+    json += "}\n}\n";
+
+    if (output_path.empty()) {
+        std::cout << json << std::flush;
+        return true;
+    }
+    FileUtil::IOFile file(output_path, "w");
+    if (!file.IsOpen() || file.WriteString(json) != json.size()) {
+        LOG_ERROR(Frontend, "Failed to write the benchmark results to {}", output_path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+}
+
+class EmuWindow_SDL2;
+
+/**
+ * Runs the loaded title for a number of system frames (LCD VBlanks), then writes the performance
+ * results as JSON: the walltime of each frame with its percentiles, the emulation speed and the
+ * time spent in each MicroProfile timer. The frame limiter and vsync should be disabled beforehand.
+ * @param output_path File to write the results to, or empty to write them to the standard output
+ * @return false if the emulation or writing the results failed
+ */
+bool RunBenchmark(Core::System& system, const EmuWindow_SDL2& emu_window, u32 num_frames,
+                  const std::string& output_path);
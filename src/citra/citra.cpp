@@ -23,6 +23,7 @@
 #include <shellapi.h>
 #endif
 
+#include "citra/benchmark.h"
 #include "citra/config.h"
 #include "citra/emu_window/emu_window_sdl2.h"
 #include "common/common_paths.h"
@@ -61,6 +62,11 @@ static void PrintHelp(const char* argv0) {
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
+                 "-b, --benchmark=FRAMES  Run FRAMES frames without a visible window, frame"
+                 " limiting or vsync, print the performance results as JSON and exit. With"
+                 " use_hw_renderer = 0, no window nor GL context is created, so it runs on"
+                 " machines without a GPU\n"
+                 "--benchmark-output=FILE  Write the benchmark results to FILE instead\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
 }
@@ -154,6 +160,8 @@ int main(int argc, char** argv) {
 
     bool use_multiplayer = false;
     bool fullscreen = false;
+    u32 benchmark_frames = 0;
+    std::string benchmark_output;
     std::string nickname{};
     std::string password{};
     std::string address{};
@@ -166,13 +174,15 @@ int main(int argc, char** argv) {
         {"movie-record", required_argument, 0, 'r'},
         {"movie-play", required_argument, 0, 'p'},
         {"fullscreen", no_argument, 0, 'f'},
+        {"benchmark", required_argument, 0, 'b'},
+        {"benchmark-output", required_argument, 0, 'o'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "g:i:m:r:p:fb:hv", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
             case 'g':
@@ -239,6 +249,19 @@ int main(int argc, char** argv) {
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
                 break;
+            case 'b':
+                errno = 0;
+                benchmark_frames = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || benchmark_frames == 0)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--benchmark");
+                    exit(1);
+                }
+                break;
+            case 'o':
+                benchmark_output = optarg;
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -283,12 +306,21 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    EmuWindow_SDL2::Mode window_mode = EmuWindow_SDL2::Mode::Visible;
+    if (benchmark_frames != 0) {
+        Settings::values.use_frame_limit = false;
+        Settings::values.use_vsync = false;
+        // The software renderer doesn't need a graphics context when nothing is presented
+        Settings::values.use_null_renderer = !Settings::values.use_hw_renderer;
+        window_mode = Settings::values.use_null_renderer ? EmuWindow_SDL2::Mode::Headless
+                                                         : EmuWindow_SDL2::Mode::Hidden;
+    }
     Settings::Apply();
 
     // Register frontend applets
     Frontend::RegisterDefaultApplets();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen)};
+    auto emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen, window_mode)};
 
     Core::System& system{Core::System::GetInstance()};
 
@@ -347,12 +379,18 @@ int main(int argc, char** argv) {
         Core::Movie::GetInstance().StartRecording(movie_record);
     }
 
-    while (emu_window->IsOpen()) {
-        system.RunLoop();
+    int exit_code = 0;
+    if (benchmark_frames != 0) {
+        if (!RunBenchmark(system, *emu_window, benchmark_frames, benchmark_output))
+            exit_code = -1;
+    } else {
+        while (emu_window->IsOpen()) {
+            system.RunLoop();
+        }
     }
 
     Core::Movie::GetInstance().Shutdown();
 
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return exit_code;
 }
@@ -110,6 +110,14 @@ shaders_accurate_gs =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to store shaders on disk and compile them ahead of time when a title is started again
+# 0: Off, 1 (default): On
+use_disk_shader_cache =
+
+# Whether to emulate the GPU on a separate thread, running in parallel with the CPU (experimental)
+# 0 (default): Off, 1: On
+use_asynchronous_gpu =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -177,6 +185,11 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# Whether to render each audio frame on a separate thread during the previous one.
+# This takes work off the emulation thread, at the cost of one frame (about 5ms) of audio latency.
+# 0 (default): No, 1: Yes
+enable_audio_render_ahead =
+
 # Which audio device to use.
 # auto (default): Auto-select
 output_device =
@@ -109,9 +109,11 @@ void EmuWindow_SDL2::Fullscreen() {
     SDL_MaximizeWindow(render_window);
 }
 
-EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
-    // Initialize the window
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
+EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen, Mode mode) {
+    // Initialize the window. Headless, SDL only handles the input and the quit events.
+    const u32 subsystems = mode == Mode::Headless ? SDL_INIT_JOYSTICK
+                                                  : SDL_INIT_VIDEO | SDL_INIT_JOYSTICK;
+    if (SDL_Init(subsystems) < 0) {
         LOG_CRITICAL(Frontend, "Failed to initialize SDL2! Exiting...");
         exit(1);
     }
@@ -121,6 +123,16 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
 
     SDL_SetMainReady();
 
+    LOG_INFO(Frontend, "Citra Version: {} | {}-{}", Common::g_build_fullname, Common::g_scm_branch,
+             Common::g_scm_desc);
+    Settings::LogSettings();
+
+    if (mode == Mode::Headless) {
+        UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                       Core::kScreenTopHeight + Core::kScreenBottomHeight);
+        return;
+    }
+
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
@@ -132,19 +144,23 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
 
     std::string window_title = fmt::format("Citra {} | {}-{}", Common::g_build_fullname,
                                            Common::g_scm_branch, Common::g_scm_desc);
+    u32 window_flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
+    if (mode == Mode::Hidden) {
+        window_flags |= SDL_WINDOW_HIDDEN;
+    }
     render_window =
         SDL_CreateWindow(window_title.c_str(),
                          SDL_WINDOWPOS_UNDEFINED, // x position
                          SDL_WINDOWPOS_UNDEFINED, // y position
                          Core::kScreenTopWidth, Core::kScreenTopHeight + Core::kScreenBottomHeight,
-                         SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+                         window_flags);
 
     if (render_window == nullptr) {
         LOG_CRITICAL(Frontend, "Failed to create SDL2 window: {}", SDL_GetError());
         exit(1);
     }
 
-    if (fullscreen) {
+    if (fullscreen && mode == Mode::Visible) {
         Fullscreen();
     }
 
@@ -164,9 +180,6 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
     OnMinimalClientAreaChangeRequest(GetActiveConfig().min_client_area_size);
     SDL_PumpEvents();
     SDL_GL_SetSwapInterval(Settings::values.use_vsync);
-    LOG_INFO(Frontend, "Citra Version: {} | {}-{}", Common::g_build_fullname, Common::g_scm_branch,
-             Common::g_scm_desc);
-    Settings::LogSettings();
 
     DoneCurrent();
 }
@@ -174,12 +187,16 @@ EmuWindow_SDL2::EmuWindow_SDL2(bool fullscreen) {
 EmuWindow_SDL2::~EmuWindow_SDL2() {
     Network::Shutdown();
     InputCommon::Shutdown();
-    SDL_GL_DeleteContext(gl_context);
+    if (gl_context != nullptr) {
+        SDL_GL_DeleteContext(gl_context);
+    }
     SDL_Quit();
 }
 
 void EmuWindow_SDL2::SwapBuffers() {
-    SDL_GL_SwapWindow(render_window);
+    if (render_window != nullptr) {
+        SDL_GL_SwapWindow(render_window);
+    }
 }
 
 void EmuWindow_SDL2::PollEvents() {
@@ -238,15 +255,21 @@ void EmuWindow_SDL2::PollEvents() {
 }
 
 void EmuWindow_SDL2::MakeCurrent() {
-    SDL_GL_MakeCurrent(render_window, gl_context);
+    if (gl_context != nullptr) {
+        SDL_GL_MakeCurrent(render_window, gl_context);
+    }
 }
 
 void EmuWindow_SDL2::DoneCurrent() {
-    SDL_GL_MakeCurrent(render_window, nullptr);
+    if (gl_context != nullptr) {
+        SDL_GL_MakeCurrent(render_window, nullptr);
+    }
 }
 
 void EmuWindow_SDL2::OnMinimalClientAreaChangeRequest(
     const std::pair<unsigned, unsigned>& minimal_size) {
 
-    SDL_SetWindowMinimumSize(render_window, minimal_size.first, minimal_size.second);
+    if (render_window != nullptr) {
+        SDL_SetWindowMinimumSize(render_window, minimal_size.first, minimal_size.second);
+    }
 }
@@ -12,7 +12,14 @@ struct SDL_Window;
 
 class EmuWindow_SDL2 : public EmuWindow {
 public:
-    explicit EmuWindow_SDL2(bool fullscreen);
+    enum class Mode {
+        Visible,  ///< A window on screen, with a GL context
+        Hidden,   ///< A hidden window, with a GL context for rendering without a visible output
+        Headless, ///< No window nor GL context, for the null renderer
+    };
+
+    /// Creates the window and its GL context, unless it's headless
+    explicit EmuWindow_SDL2(bool fullscreen, Mode mode = Mode::Visible);
     ~EmuWindow_SDL2();
 
     /// Swap buffers to display the next frame
@@ -65,10 +72,10 @@ private:
     /// Is the window still open?
     bool is_open = true;
 
-    /// Internal SDL2 render window
-    SDL_Window* render_window;
+    /// Internal SDL2 render window, null when headless
+    SDL_Window* render_window = nullptr;
 
     using SDL_GLContext = void*;
     /// The OpenGL context associated with the window
-    SDL_GLContext gl_context;
+    SDL_GLContext gl_context = nullptr;
 };
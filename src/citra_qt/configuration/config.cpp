@@ -107,6 +107,7 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_gs = ReadSetting("shaders_accurate_gs", true).toBool();
     Settings::values.shaders_accurate_mul = ReadSetting("shaders_accurate_mul", false).toBool();
     Settings::values.use_shader_jit = ReadSetting("use_shader_jit", true).toBool();
+    Settings::values.use_disk_shader_cache = ReadSetting("use_disk_shader_cache", true).toBool();
     Settings::values.resolution_factor =
         static_cast<u16>(ReadSetting("resolution_factor", 1).toInt());
     Settings::values.use_vsync = ReadSetting("use_vsync", false).toBool();
@@ -139,6 +140,8 @@ void Config::ReadValues() {
     Settings::values.sink_id = ReadSetting("output_engine", "auto").toString().toStdString();
     Settings::values.enable_audio_stretching =
         ReadSetting("enable_audio_stretching", true).toBool();
+    Settings::values.enable_audio_render_ahead =
+        ReadSetting("enable_audio_render_ahead", false).toBool();
     Settings::values.audio_device_id =
         ReadSetting("output_device", "auto").toString().toStdString();
     Settings::values.volume = ReadSetting("volume", 1).toFloat();
@@ -368,6 +371,7 @@ void Config::SaveValues() {
     WriteSetting("shaders_accurate_gs", Settings::values.shaders_accurate_gs, true);
     WriteSetting("shaders_accurate_mul", Settings::values.shaders_accurate_mul, false);
     WriteSetting("use_shader_jit", Settings::values.use_shader_jit, true);
+    WriteSetting("use_disk_shader_cache", Settings::values.use_disk_shader_cache, true);
     WriteSetting("resolution_factor", Settings::values.resolution_factor, 1);
     WriteSetting("use_vsync", Settings::values.use_vsync, false);
     WriteSetting("use_frame_limit", Settings::values.use_frame_limit, true);
@@ -398,6 +402,7 @@ void Config::SaveValues() {
     qt_config->beginGroup("Audio");
     WriteSetting("output_engine", QString::fromStdString(Settings::values.sink_id), "auto");
     WriteSetting("enable_audio_stretching", Settings::values.enable_audio_stretching, true);
+    WriteSetting("enable_audio_render_ahead", Settings::values.enable_audio_render_ahead, false);
     WriteSetting("output_device", QString::fromStdString(Settings::values.audio_device_id), "auto");
     WriteSetting("volume", Settings::values.volume, 1.0f);
     qt_config->endGroup();
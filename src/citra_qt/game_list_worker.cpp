@@ -2,10 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <future>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 #include "citra_qt/compatibility_list.h"
@@ -15,6 +18,7 @@
 #include "citra_qt/ui_settings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/thread_pool.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
@@ -24,6 +28,63 @@ bool HasSupportedFileExtension(const std::string& file_name) {
     const QFileInfo file = QFileInfo(QString::fromStdString(file_name));
     return GameList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
 }
+
+bool HasUpdate(u64 program_id) {
+    return program_id >= 0x0004000000000000 && program_id <= 0x00040000FFFFFFFF;
+}
+
+/**
+ * Returns the modification time of the content of the update title of a game, or 0 if there's
+ * none, which tells whether the SMDH of a cached game is still the one of its update.
+ */
+s64 GetUpdateModified(u64 program_id) {
+    if (!HasUpdate(program_id))
+        return 0;
+
+    const QFileInfo content(QString::fromStdString(
+        Service::AM::GetTitlePath(Service::FS::MediaType::SDMC, program_id + 0x0000000E00000000) +
+        "content/"));
+    return content.exists() ? content.lastModified().toMSecsSinceEpoch() : 0;
+}
+
+/// Parses the metadata of a game file. Returns nothing if it can't be loaded.
+std::optional<GameListCacheEntry> LoadEntry(const std::string& path, u64 size, s64 modified) {
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(path);
+    if (!loader)
+        return {};
+
+    GameListCacheEntry entry;
+    entry.size = size;
+    entry.modified = modified;
+    loader->ReadProgramId(entry.program_id);
+    loader->ReadExtdataId(entry.extdata_id);
+    entry.file_type = static_cast<u32>(loader->GetFileType());
+    entry.update_modified = GetUpdateModified(entry.program_id);
+
+    entry.smdh = [&entry, &loader]() -> std::vector<u8> {
+        std::vector<u8> original_smdh;
+        loader->ReadIcon(original_smdh);
+
+        if (!HasUpdate(entry.program_id))
+            return original_smdh;
+
+        std::string update_path = Service::AM::GetTitleContentPath(
+            Service::FS::MediaType::SDMC, entry.program_id + 0x0000000E00000000);
+
+        if (!FileUtil::Exists(update_path))
+            return original_smdh;
+
+        std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path);
+
+        if (!update_loader)
+            return original_smdh;
+
+        std::vector<u8> update_smdh;
+        update_loader->ReadIcon(update_smdh);
+        return update_smdh;
+    }();
+    return entry;
+}
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(QList<UISettings::GameDir>& game_dirs,
@@ -44,63 +105,17 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
 
         bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader)
-                return true;
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh = [program_id, &loader]() -> std::vector<u8> {
-                std::vector<u8> original_smdh;
-                loader->ReadIcon(original_smdh);
-
-                if (program_id < 0x0004000000000000 || program_id > 0x00040000FFFFFFFF)
-                    return original_smdh;
-
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id + 0x0000000E00000000);
-
-                if (!FileUtil::Exists(update_path))
-                    return original_smdh;
-
-                std::unique_ptr<Loader::AppLoader> update_loader = Loader::GetLoader(update_path);
-
-                if (!update_loader)
-                    return original_smdh;
-
-                std::vector<u8> update_smdh;
-                update_loader->ReadIcon(update_smdh);
-                return update_smdh;
-            }();
-
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
-                // Skip this invalid entry
-                return true;
+            const QFileInfo file(QString::fromStdString(physical_name));
+            const u64 size = file.size();
+            const s64 modified = file.lastModified().toMSecsSinceEpoch();
+
+            const auto entry = cache.Find(physical_name, size, modified);
+            if (entry && entry->update_modified == GetUpdateModified(entry->program_id)) {
+                cache.Keep(physical_name);
+                AddEntryToGameList(physical_name, *entry, parent_dir);
+            } else {
+                uncached_files.push_back({physical_name, size, modified, parent_dir});
             }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility("99");
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
-
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
             AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir);
@@ -112,8 +127,66 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::AddUncachedFilesToGameList() {
+    if (uncached_files.empty())
+        return;
+
+    // The entries are added from this thread as they are ready, in the order the files were found.
+    // The keys of encrypted files are derived without changing the AES key slots, so that files
+    // can be loaded at the same time.
+    Common::ThreadPool pool(Common::ThreadPool::GetDefaultNumThreads(), "GameListWorker");
+    std::vector<std::optional<GameListCacheEntry>> entries(uncached_files.size());
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(uncached_files.size());
+    for (std::size_t i = 0; i < uncached_files.size(); ++i) {
+        tasks.push_back(pool.Submit([this, i, &entries] {
+            if (stop_processing)
+                return;
+            const UncachedFile& file = uncached_files[i];
+            entries[i] = LoadEntry(file.path, file.size, file.modified);
+        }));
+    }
+
+    for (std::size_t i = 0; i < uncached_files.size(); ++i) {
+        tasks[i].wait();
+        if (stop_processing || !entries[i])
+            continue;
+        const UncachedFile& file = uncached_files[i];
+        AddEntryToGameList(file.path, *entries[i], file.parent_dir);
+        cache.Add(file.path, std::move(*entries[i]));
+    }
+}
+
+void GameListWorker::AddEntryToGameList(const std::string& path, const GameListCacheEntry& entry,
+                                        GameListDir* parent_dir) {
+    if (!Loader::IsValidSMDH(entry.smdh) && UISettings::values.game_list_hide_no_icon) {
+        // Skip this invalid entry
+        return;
+    }
+
+    auto it = FindMatchingCompatibilityEntry(compatibility_list, entry.program_id);
+
+    // The game list uses this as compatibility number for untested games
+    QString compatibility("99");
+    if (it != compatibility_list.end())
+        compatibility = it->second.first;
+
+    const auto file_type = static_cast<Loader::FileType>(entry.file_type);
+    emit EntryReady(
+        {
+            new GameListItemPath(QString::fromStdString(path), entry.smdh, entry.program_id,
+                                 entry.extdata_id),
+            new GameListItemCompat(compatibility),
+            new GameListItemRegion(entry.smdh),
+            new GameListItem(QString::fromStdString(Loader::GetFileTypeString(file_type))),
+            new GameListItemSize(entry.size),
+        },
+        parent_dir);
+}
+
 void GameListWorker::run() {
     stop_processing = false;
+    cache.Load();
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == "INSTALLED") {
             QString path =
@@ -141,6 +214,14 @@ void GameListWorker::run() {
                                     game_list_dir);
         }
     };
+
+    // The cached games are all listed by now, and only the new or changed files are parsed
+    if (!stop_processing) {
+        AddUncachedFilesToGameList();
+    }
+    if (!stop_processing) {
+        cache.Save();
+    }
     emit Finished(watch_list);
 }
 
@@ -9,12 +9,14 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QString>
 #include "citra_qt/compatibility_list.h"
 #include "common/common_types.h"
+#include "core/game_list_cache.h"
 
 class QStandardItem;
 
@@ -52,10 +54,30 @@ signals:
     void Finished(QStringList watch_list);
 
 private:
+    /// A game file whose metadata isn't cached
+    struct UncachedFile {
+        std::string path;
+        u64 size;
+        s64 modified;
+        GameListDir* parent_dir;
+    };
+
+    /**
+     * Adds the cached games of a directory to the game list right away, and collects the other
+     * game files in uncached_files.
+     */
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                  GameListDir* parent_dir);
 
+    /// Parses the uncached game files on a thread pool, and adds them as they are ready
+    void AddUncachedFilesToGameList();
+
+    void AddEntryToGameList(const std::string& path, const GameListCacheEntry& entry,
+                            GameListDir* parent_dir);
+
     QStringList watch_list;
+    GameListCache cache;
+    std::vector<UncachedFile> uncached_files;
     const CompatibilityList& compatibility_list;
     QList<UISettings::GameDir>& game_dirs;
     std::atomic_bool stop_processing;
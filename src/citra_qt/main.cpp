@@ -359,6 +359,10 @@ void GMainWindow::InitializeHotkeys() {
                                    Qt::ApplicationShortcut);
     hotkey_registry.RegisterHotkey("Main Window", "Advance Frame", QKeySequence(Qt::Key_Backslash),
                                    Qt::ApplicationShortcut);
+    hotkey_registry.RegisterHotkey("Main Window", "Quick Save", QKeySequence(Qt::Key_F6),
+                                   Qt::ApplicationShortcut);
+    hotkey_registry.RegisterHotkey("Main Window", "Quick Load", QKeySequence(Qt::Key_F7),
+                                   Qt::ApplicationShortcut);
     hotkey_registry.LoadHotkeys();
 
     connect(hotkey_registry.GetHotkey("Main Window", "Load File", this), &QShortcut::activated,
@@ -420,6 +424,19 @@ void GMainWindow::InitializeHotkeys() {
             &QShortcut::activated, ui.action_Enable_Frame_Advancing, &QAction::trigger);
     connect(hotkey_registry.GetHotkey("Main Window", "Advance Frame", this), &QShortcut::activated,
             ui.action_Advance_Frame, &QAction::trigger);
+    // Handled by the emulation thread between two runs of the CPU, once it is running
+    connect(hotkey_registry.GetHotkey("Main Window", "Quick Save", this), &QShortcut::activated,
+            this, [&] {
+                if (emulation_running) {
+                    Core::System::GetInstance().RequestQuickSave();
+                }
+            });
+    connect(hotkey_registry.GetHotkey("Main Window", "Quick Load", this), &QShortcut::activated,
+            this, [&] {
+                if (emulation_running) {
+                    Core::System::GetInstance().RequestQuickLoad();
+                }
+            });
 }
 
 void GMainWindow::ShowUpdaterWidgets() {
@@ -36,6 +36,7 @@
 #define SDMC_DIR "sdmc"
 #define NAND_DIR "nand"
 #define SYSDATA_DIR "sysdata"
+#define SHADER_DIR "shaders"
 #define LOG_DIR "log"
 
 // Filenames
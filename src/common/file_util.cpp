@@ -708,6 +708,7 @@ const std::string& GetUserPath(UserPath path, const std::string& new_path) {
         paths.emplace(UserPath::SDMCDir, user_path + SDMC_DIR DIR_SEP);
         paths.emplace(UserPath::NANDDir, user_path + NAND_DIR DIR_SEP);
         paths.emplace(UserPath::SysDataDir, user_path + SYSDATA_DIR DIR_SEP);
+        paths.emplace(UserPath::ShaderDir, user_path + SHADER_DIR DIR_SEP);
         // TODO: Put the logs in a better location for each OS
         paths.emplace(UserPath::LogDir, user_path + LOG_DIR DIR_SEP);
     }
@@ -731,6 +732,7 @@ const std::string& GetUserPath(UserPath path, const std::string& new_path) {
             paths[UserPath::CacheDir] = user_path + CACHE_DIR DIR_SEP;
             paths[UserPath::SDMCDir] = user_path + SDMC_DIR DIR_SEP;
             paths[UserPath::NANDDir] = user_path + NAND_DIR DIR_SEP;
+            paths[UserPath::ShaderDir] = user_path + SHADER_DIR DIR_SEP;
             break;
         }
     }
@@ -27,6 +27,7 @@ enum class UserPath {
     NANDDir,
     RootDir,
     SDMCDir,
+    ShaderDir,
     SysDataDir,
     UserDir,
 };
@@ -4,16 +4,18 @@
 
 #pragma once
 
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <string>
 #include "common/common_types.h"
-
-// defined in Version.cpp
-extern const char* scm_rev_git_str;
+#include "common/file_util.h"
+#include "common/hash.h"
 
 // On disk format:
 // header{
 // u32 'DCAC';
-// u32 version;  // svn_rev
+// u32 version;  // supplied by the user of the cache
 // u16 sizeof(key_type);
 // u16 sizeof(value_type);
 //}
@@ -22,6 +24,8 @@ extern const char* scm_rev_git_str;
 // u32 value_size;
 // key_type   key;
 // value_type[value_size]   value;
+// u32 entry_number;
+// u64 checksum; // hash of key and value
 //}
 
 template <typename K, typename V>
@@ -38,6 +42,9 @@ public:
 // Not tuned for extreme performance but should be reasonably fast.
 // Does not support keys or values larger than 2GB, which should be reasonable.
 // Keys must have non-zero length; values can have zero length.
+//
+// A file written with a different version (or different key/value sizes) is discarded as a whole.
+// Reading stops at the first truncated or corrupted entry, and any further appends overwrite it.
 
 // K and V are some POD type
 // K : the key type
@@ -46,12 +53,13 @@ template <typename K, typename V>
 class LinearDiskCache {
 public:
     // return number of read entries
-    u32 OpenAndRead(const char* filename, LinearDiskCacheReader<K, V>& reader) {
+    u32 OpenAndRead(const std::string& filename, u32 version, LinearDiskCacheReader<K, V>& reader) {
         using std::ios_base;
 
         // close any currently opened file
         Close();
         m_num_entries = 0;
+        m_header.version = version;
 
         // try opening for reading/writing
         OpenFStream(m_file, filename, ios_base::in | ios_base::out | ios_base::binary);
@@ -66,25 +74,27 @@ public:
             // good header, read some key/value pairs
             K key;
 
-            V* value = nullptr;
+            std::unique_ptr<V[]> value;
             u32 value_size;
             u32 entry_number;
+            u64 checksum;
 
             std::fstream::pos_type last_pos = m_file.tellg();
 
             while (Read(&value_size)) {
-                std::streamoff next_extent =
-                    (last_pos - start_pos) + sizeof(value_size) + value_size;
+                std::streamoff next_extent = (last_pos - start_pos) + sizeof(value_size) +
+                                             sizeof(K) + value_size * sizeof(V) +
+                                             sizeof(entry_number) + sizeof(checksum);
                 if (next_extent > file_size)
                     break;
 
-                delete[] value;
-                value = new V[value_size];
+                value = std::make_unique<V[]>(value_size);
 
                 // read key/value and pass to reader
-                if (Read(&key) && Read(value, value_size) && Read(&entry_number) &&
-                    entry_number == m_num_entries + 1) {
-                    reader.Read(key, value, value_size);
+                if (Read(&key) && Read(value.get(), value_size) && Read(&entry_number) &&
+                    Read(&checksum) && entry_number == m_num_entries + 1 &&
+                    checksum == ComputeChecksum(key, value.get(), value_size)) {
+                    reader.Read(key, value.get(), value_size);
                 } else {
                     break;
                 }
@@ -92,17 +102,16 @@ public:
                 m_num_entries++;
                 last_pos = m_file.tellg();
             }
-            m_file.seekp(last_pos);
             m_file.clear();
+            m_file.seekp(last_pos);
 
-            delete[] value;
             return m_num_entries;
         }
 
         // failed to open file for reading or bad header
         // close and recreate file
         Close();
-        m_file.open(filename, ios_base::out | ios_base::trunc | ios_base::binary);
+        OpenFStream(m_file, filename, ios_base::out | ios_base::trunc | ios_base::binary);
         WriteHeader();
         return 0;
     }
@@ -118,18 +127,29 @@ public:
         m_file.clear();
     }
 
+    bool IsOpen() const {
+        return m_file.is_open();
+    }
+
     // Appends a key-value pair to the store.
     void Append(const K& key, const V* value, u32 value_size) {
         // TODO: Should do a check that we don't already have "key"? (I think each caller does that
         // already.)
+        const u64 checksum = ComputeChecksum(key, value, value_size);
         Write(&value_size);
         Write(&key);
         Write(value, value_size);
         m_num_entries++;
         Write(&m_num_entries);
+        Write(&checksum);
     }
 
 private:
+    static u64 ComputeChecksum(const K& key, const V* value, u32 value_size) {
+        return Common::ComputeHash64(&key, sizeof(K)) ^
+               Common::ComputeHash64(value, value_size * sizeof(V));
+    }
+
     void WriteHeader() {
         Write(&m_header);
     }
@@ -138,30 +158,28 @@ private:
         char file_header[sizeof(Header)];
 
         return (Read(file_header, sizeof(Header)) &&
-                !memcmp((const char*)&m_header, file_header, sizeof(Header)));
+                !std::memcmp(&m_header, file_header, sizeof(Header)));
     }
 
     template <typename D>
     bool Write(const D* data, u32 count = 1) {
-        return m_file.write((const char*)data, count * sizeof(D)).good();
+        return m_file.write(reinterpret_cast<const char*>(data), count * sizeof(D)).good();
     }
 
     template <typename D>
-    bool Read(const D* data, u32 count = 1) {
-        return m_file.read((char*)data, count * sizeof(D)).good();
+    bool Read(D* data, u32 count = 1) {
+        return m_file.read(reinterpret_cast<char*>(data), count * sizeof(D)).good();
     }
 
     struct Header {
-        Header() : id(*(u32*)"DCAC"), key_t_size(sizeof(K)), value_t_size(sizeof(V)) {
-            memcpy(ver, scm_rev_git_str, 40);
-        }
-
-        const u32 id;
-        const u16 key_t_size, value_t_size;
-        char ver[40];
-
+        u32 id = 'D' | ('C' << 8) | ('A' << 16) | ('C' << 24);
+        u32 version = 0;
+        u16 key_t_size = sizeof(K);
+        u16 value_t_size = sizeof(V);
     } m_header;
 
+    static_assert(sizeof(Header) == 12, "Header has padding");
+
     std::fstream m_file;
-    u32 m_num_entries;
+    u32 m_num_entries = 0;
 };
@@ -0,0 +1,105 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(std::size_t num_threads, std::string name) : name(std::move(name)) {
+    threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task) {
+    std::packaged_task<void()> packaged_task(std::move(task));
+    std::future<void> future = packaged_task.get_future();
+    if (threads.empty()) {
+        // Without workers the task is run immediately, so that callers don't have to special case
+        packaged_task();
+        return future;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(packaged_task));
+    }
+    cv.notify_one();
+    return future;
+}
+
+void ThreadPool::ParallelFor(
+    std::size_t count, std::size_t min_chunk_size,
+    const std::function<void(std::size_t, std::size_t, std::size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+
+    min_chunk_size = std::max<std::size_t>(min_chunk_size, 1);
+    const std::size_t max_chunks = (count + min_chunk_size - 1) / min_chunk_size;
+    const std::size_t num_chunks = std::min(GetMaxChunks(), max_chunks);
+    const std::size_t chunk_size = (count + num_chunks - 1) / num_chunks;
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_chunks - 1);
+    for (std::size_t chunk = 1; chunk < num_chunks; ++chunk) {
+        const std::size_t begin = chunk * chunk_size;
+        const std::size_t end = std::min(begin + chunk_size, count);
+        if (begin >= end) {
+            break;
+        }
+        futures.push_back(Submit([&func, begin, end, chunk] { func(begin, end, chunk); }));
+    }
+
+    func(0, std::min(chunk_size, count), 0);
+
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+std::size_t ThreadPool::GetDefaultNumThreads() {
+    // Leave one core to the thread submitting the work
+    const unsigned int num_cores = std::thread::hardware_concurrency();
+    return num_cores > 1 ? num_cores - 1 : 0;
+}
+
+ThreadPool& ThreadPool::GetShared() {
+    static ThreadPool pool(GetDefaultNumThreads(), "Worker");
+    return pool;
+}
+
+void ThreadPool::WorkerLoop() {
+    SetCurrentThreadName(name.c_str());
+
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stop || !tasks.empty(); });
+            if (stop && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+} // namespace Common
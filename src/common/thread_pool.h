@@ -0,0 +1,83 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/**
+ * A fixed-size pool of worker threads executing tasks in submission order.
+ *
+ * Tasks must not block waiting for other tasks of the same pool, and ParallelFor must not be called
+ * from inside a task, as this could exhaust the workers and deadlock.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_threads Number of worker threads to spawn
+     * @param name Name given to the worker threads, for debugging purposes
+     */
+    explicit ThreadPool(std::size_t num_threads, std::string name = "ThreadPool");
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Returns the number of worker threads of the pool
+    std::size_t GetNumThreads() const {
+        return threads.size();
+    }
+
+    /**
+     * Returns the maximum number of chunks ParallelFor splits its work into, i.e. the number of
+     * workers plus the calling thread. Useful to size per-chunk scratch state.
+     */
+    std::size_t GetMaxChunks() const {
+        return threads.size() + 1;
+    }
+
+    /// Queues a task for execution on one of the workers
+    std::future<void> Submit(std::function<void()> task);
+
+    /**
+     * Splits [0, count) in at most GetMaxChunks() contiguous chunks and runs
+     * func(begin, end, chunk_index) for each of them, with the calling thread taking part in the
+     * work. Returns once all the chunks have been processed.
+     * @param min_chunk_size Chunks are never made smaller than this, except for the last one
+     */
+    void ParallelFor(std::size_t count, std::size_t min_chunk_size,
+                     const std::function<void(std::size_t, std::size_t, std::size_t)>& func);
+
+    /// Returns the default number of workers to use for data-parallel work on this machine
+    static std::size_t GetDefaultNumThreads();
+
+    /**
+     * Returns the pool shared by the data-parallel work of the emulated hardware, so that the
+     * subsystems using it don't each spawn a worker per core. It has GetDefaultNumThreads()
+     * workers, and is created on first use.
+     */
+    static ThreadPool& GetShared();
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> threads;
+    std::queue<std::packaged_task<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop = false;
+    std::string name;
+};
+
+} // namespace Common
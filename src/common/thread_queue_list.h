@@ -5,157 +5,195 @@
 #pragma once
 
 #include <array>
-#include <deque>
-#include <boost/range/algorithm_ext/erase.hpp>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/common_types.h"
 
 namespace Common {
 
 template <class T, unsigned int N>
-struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+class ThreadQueueList;
+
+/**
+ * Links of an element of a ThreadQueueList. Elements inherit this, so that queueing them never
+ * allocates. An element can be in at most one queue at a time.
+ */
+template <class T>
+class ThreadQueueListNode {
+private:
+    template <class, unsigned int>
+    friend class ThreadQueueList;
+
+    T* prev_in_queue = nullptr;
+    T* next_in_queue = nullptr;
+    unsigned int queued_priority = 0;
+    bool queued = false;
+};
 
+/**
+ * A queue of elements for each of N priority levels, where lower levels come first. A bitmap of
+ * the non-empty levels finds the first element, so every operation except clear is O(1).
+ */
+template <class T, unsigned int N>
+class ThreadQueueList {
+    static_assert(N <= 64, "The priority levels must fit in the bitmap");
+
+public:
     typedef unsigned int Priority;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static const Priority NUM_QUEUES = N;
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    ThreadQueueList() = default;
+    ThreadQueueList(const ThreadQueueList&) = delete;
+    ThreadQueueList& operator=(const ThreadQueueList&) = delete;
 
     // Only for debugging, returns priority level.
-    Priority contains(const T& uid) {
-        for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
-            }
-        }
-
-        return -1;
+    Priority contains(const T* element) const {
+        const Node* node = element;
+        return node->queued ? node->queued_priority : -1;
     }
 
-    T get_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+    T* get_first() const {
+        if (nonempty == 0)
+            return nullptr;
+        return queues[LeastSignificantSetBit(nonempty)].head;
     }
 
-    T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+    T* pop_first() {
+        T* element = get_first();
+        if (element != nullptr)
+            unlink(element);
+        return element;
     }
 
-    T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
+    /// Pops the first element with a priority strictly better (lower) than the given one.
+    T* pop_first_better(Priority priority) {
+        const u64 better = priority < 64 ? nonempty & ((u64(1) << priority) - 1) : nonempty;
+        if (better == 0)
+            return nullptr;
 
-        return T();
+        T* element = queues[LeastSignificantSetBit(better)].head;
+        unlink(element);
+        return element;
     }
 
-    void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+    void push_front(Priority priority, T* element) {
+        Queue& queue = link(priority, element);
+        Node* node = element;
+        node->next_in_queue = queue.head;
+        if (queue.head != nullptr) {
+            static_cast<Node*>(queue.head)->prev_in_queue = element;
+        } else {
+            queue.tail = element;
+        }
+        queue.head = element;
     }
 
-    void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+    void push_back(Priority priority, T* element) {
+        Queue& queue = link(priority, element);
+        Node* node = element;
+        node->prev_in_queue = queue.tail;
+        if (queue.tail != nullptr) {
+            static_cast<Node*>(queue.tail)->next_in_queue = element;
+        } else {
+            queue.head = element;
+        }
+        queue.tail = element;
     }
 
-    void move(const T& thread_id, Priority old_priority, Priority new_priority) {
-        remove(old_priority, thread_id);
-        prepare(new_priority);
-        push_back(new_priority, thread_id);
+    void move(T* element, Priority old_priority, Priority new_priority) {
+        remove(old_priority, element);
+        push_back(new_priority, element);
     }
 
-    void remove(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        boost::remove_erase(cur->data, thread_id);
+    /// Removes an element from the queue of the given priority, if it's in it.
+    void remove(Priority priority, T* element) {
+        const Node* node = element;
+        if (node->queued && node->queued_priority == priority)
+            unlink(element);
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        Queue& queue = queues[priority];
+        if (queue.head != queue.tail) {
+            T* element = queue.head;
+            unlink(element);
+            push_back(priority, element);
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        while (nonempty != 0)
+            pop_first();
     }
 
     bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
+        return queues[priority].head == nullptr;
     }
 
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+    /// Calls func(priority, element) for each element, in the order in which they are popped.
+    template <typename Func>
+    void for_each(Func&& func) const {
+        for (Priority priority = 0; priority < NUM_QUEUES; ++priority) {
+            for (T* element = queues[priority].head; element != nullptr;
+                 element = static_cast<const Node*>(element)->next_in_queue) {
+                func(priority, element);
+            }
+        }
     }
 
 private:
+    using Node = ThreadQueueListNode<T>;
+
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T* head = nullptr;
+        T* tail = nullptr;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    Queue& link(Priority priority, T* element) {
+        Node* node = element;
+        // An element is in one list at a time, so pushing a queued one is a bug of the caller.
+        // Without the assert, the element is moved rather than left to corrupt its links.
+        DEBUG_ASSERT_MSG(!node->queued, "Element is already queued");
+        if (node->queued) {
+            unlink(element);
+        }
+        node->queued = true;
+        node->queued_priority = priority;
+        node->prev_in_queue = nullptr;
+        node->next_in_queue = nullptr;
+        nonempty |= u64(1) << priority;
+        return queues[priority];
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
+    void unlink(T* element) {
+        Node* node = element;
+        Queue& queue = queues[node->queued_priority];
 
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
+        if (node->prev_in_queue != nullptr) {
+            static_cast<Node*>(node->prev_in_queue)->next_in_queue = node->next_in_queue;
+        } else {
+            queue.head = node->next_in_queue;
+        }
+        if (node->next_in_queue != nullptr) {
+            static_cast<Node*>(node->next_in_queue)->prev_in_queue = node->prev_in_queue;
+        } else {
+            queue.tail = node->prev_in_queue;
         }
 
-        cur->next_nonempty = first;
-        first = cur;
+        if (queue.head == nullptr)
+            nonempty &= ~(u64(1) << node->queued_priority);
+
+        node->queued = false;
+        node->prev_in_queue = nullptr;
+        node->next_in_queue = nullptr;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
+    // Bit i is set when the queue of priority level i isn't empty.
+    u64 nonempty = 0;
+    // The priority level queues, as doubly linked lists through the elements.
+    std::array<Queue, NUM_QUEUES> queues{};
 };
 
 } // namespace Common
@@ -50,6 +50,9 @@ public:
         write_ptr = new_ptr;
         if (NeedSize)
             size++;
+        // PopWait checks for elements under cv_mutex, taking it here makes sure that the reader is
+        // either already waiting, or sees the new element before it waits
+        std::lock_guard<std::mutex> lock(cv_mutex);
         cv.notify_one();
     }
 
@@ -141,7 +144,7 @@ public:
     template <typename Arg>
     void Push(Arg&& t) {
         std::lock_guard<std::mutex> lock(write_lock);
-        spsc_queue.Push(t);
+        spsc_queue.Push(std::forward<Arg>(t));
     }
 
     void Pop() {
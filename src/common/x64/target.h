@@ -0,0 +1,16 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Kernels that are selected at runtime from the CPU caps are marked with these, so that they are
+// compiled for their instruction set regardless of the flags used for the rest of the code. MSVC
+// accepts the intrinsics of every instruction set without them.
+#ifdef _MSC_VER
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
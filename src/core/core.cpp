@@ -29,6 +29,7 @@
 #ifdef ENABLE_SCRIPTING
 #include "core/rpc/rpc_server.h"
 #endif
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "network/network.h"
 #include "video_core/video_core.h"
@@ -80,6 +81,18 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     HW::Update();
     Reschedule();
 
+    // Save states are captured and restored between two runs of the CPU
+    if (quick_save_requested.exchange(false)) {
+        quick_save = SaveState::Capture(quick_save.get());
+        LOG_INFO(Core, "Quick saved");
+    } else if (quick_load_requested.exchange(false)) {
+        if (quick_save == nullptr) {
+            LOG_WARNING(Core, "Nothing to quick load, no quick save was made in this session");
+        } else if (quick_save->Restore() == SaveState::RestoreResult::Success) {
+            LOG_INFO(Core, "Quick loaded");
+        }
+    }
+
     if (reset_requested.exchange(false)) {
         Reset();
     } else if (shutdown_requested.exchange(false)) {
@@ -231,6 +244,12 @@ const Service::FS::ArchiveManager& System::ArchiveManager() const {
     return *archive_manager;
 }
 
+void System::WaitForFileReads() {
+    if (archive_manager != nullptr) {
+        archive_manager->WaitForIOThread();
+    }
+}
+
 Kernel::KernelSystem& System::Kernel() {
     return *kernel;
 }
@@ -239,6 +258,12 @@ const Kernel::KernelSystem& System::Kernel() const {
     return *kernel;
 }
 
+void System::SetCoresForTests(std::unique_ptr<ARM_Interface> cpu,
+                              std::unique_ptr<AudioCore::DspInterface> dsp) {
+    cpu_core = std::move(cpu);
+    dsp_core = std::move(dsp);
+}
+
 void System::RegisterSoftwareKeyboard(std::shared_ptr<Frontend::SoftwareKeyboard> swkbd) {
     registered_swkbd = std::move(swkbd);
 }
@@ -254,9 +279,9 @@ void System::Shutdown() {
                          perf_results.frametime * 1000.0);
 
     // Shutdown emulation session
+    quick_save.reset();
     GDBStub::Shutdown();
     VideoCore::Shutdown();
-    kernel.reset();
     HW::Shutdown();
     telemetry_session.reset();
 #ifdef ENABLE_SCRIPTING
@@ -265,6 +290,8 @@ void System::Shutdown() {
     service_manager.reset();
     dsp_core.reset();
     cpu_core.reset();
+    // The kernel goes last, as the services and applets return their kernel objects to it
+    kernel.reset();
     CoreTiming::Shutdown();
     app_loader.reset();
 
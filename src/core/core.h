@@ -41,6 +41,8 @@ class KernelSystem;
 
 namespace Core {
 
+class SaveState;
+
 class System {
 public:
     /**
@@ -105,6 +107,16 @@ public:
         shutdown_requested = true;
     }
 
+    /// Request a quick save of the system, which is kept in memory until the session ends
+    void RequestQuickSave() {
+        quick_save_requested = true;
+    }
+
+    /// Request the system to be restored to the last quick save
+    void RequestQuickLoad() {
+        quick_load_requested = true;
+    }
+
     /**
      * Load an executable application.
      * @param emu_window Reference to the host-system window used for video output and keyboard
@@ -170,12 +182,26 @@ public:
     /// Gets a const reference to the archive manager
     const Service::FS::ArchiveManager& ArchiveManager() const;
 
+    /// Waits for the file reads running on the FS I/O thread, which write guest memory, to be done
+    void WaitForFileReads();
+
+#ifdef ENABLE_SCRIPTING
+    /// Gets a pointer to the RPC server, which is null while the system is shut down
+    RPC::RPCServer* RPCServer() const {
+        return rpc_server.get();
+    }
+#endif
+
     /// Gets a reference to the kernel
     Kernel::KernelSystem& Kernel();
 
     /// Gets a const reference to the kernel
     const Kernel::KernelSystem& Kernel() const;
 
+    /// Replaces the CPU and DSP cores, for the tests running code without loading an application
+    void SetCoresForTests(std::unique_ptr<ARM_Interface> cpu,
+                          std::unique_ptr<AudioCore::DspInterface> dsp);
+
     PerfStats perf_stats;
     FrameLimiter frame_limiter;
 
@@ -258,6 +284,11 @@ private:
 
     std::atomic<bool> reset_requested;
     std::atomic<bool> shutdown_requested;
+    std::atomic<bool> quick_save_requested;
+    std::atomic<bool> quick_load_requested;
+
+    /// Last quick save of the session
+    std::unique_ptr<SaveState> quick_save;
 };
 
 inline ARM_Interface& CPU() {
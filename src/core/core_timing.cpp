@@ -6,12 +6,14 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <iterator>
 #include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "common/thread.h"
 #include "common/threadsafe_queue.h"
@@ -22,9 +24,18 @@ static s64 global_timer;
 static s64 slice_length;
 static s64 downcount;
 
+/// Events of a type with the same userdata which are in the queue and haven't been cancelled
+struct PendingEvents {
+    /// Events of other generations have been cancelled
+    u64 generation;
+    u32 count;
+};
+
 struct EventType {
     TimedCallback callback;
     const std::string* name;
+    /// Pending events by userdata, updated through the const pointers handed out to the callers
+    mutable std::unordered_map<u64, PendingEvents> pending;
 };
 
 struct Event {
@@ -32,6 +43,7 @@ struct Event {
     u64 fifo_order;
     u64 userdata;
     const EventType* type;
+    u64 generation;
 };
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
@@ -51,8 +63,13 @@ static std::unordered_map<std::string, EventType> event_types;
 // We don't use std::priority_queue because we need to be able to serialize, unserialize and
 // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
 // by the standard adaptor class.
+// Unscheduling an event doesn't remove it from the queue, which would require rebuilding the heap,
+// but bumps the generation of its type and userdata so that it is dropped when it is popped. The
+// queue is compacted when it holds more cancelled events than pending ones.
 static std::vector<Event> event_queue;
 static u64 event_fifo_id;
+static u64 cancel_generation;
+static std::size_t num_cancelled_events;
 // the queue for storing the events from other threads threadsafe until they will be added
 // to the event_queue by the emu thread
 static Common::MPSCQueue<Event, false> ts_queue;
@@ -102,6 +119,8 @@ void Init() {
     is_global_timer_sane = true;
 
     event_fifo_id = 0;
+    cancel_generation = 0;
+    num_cancelled_events = 0;
     ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
@@ -131,6 +150,61 @@ u64 GetIdleTicks() {
 
 void ClearPendingEvents() {
     event_queue.clear();
+    num_cancelled_events = 0;
+    for (auto& pair : event_types) {
+        pair.second.pending.clear();
+    }
+}
+
+static bool IsCancelled(const Event& event) {
+    const auto it = event.type->pending.find(event.userdata);
+    return it == event.type->pending.end() || it->second.generation != event.generation;
+}
+
+static void PushEvent(Event event) {
+    auto& pending = event.type->pending;
+    auto it = pending.find(event.userdata);
+    if (it == pending.end()) {
+        // Any cancelled event with this userdata has an older generation
+        it = pending.emplace(event.userdata, PendingEvents{cancel_generation, 0}).first;
+    }
+    ++it->second.count;
+    event.generation = it->second.generation;
+
+    event_queue.emplace_back(std::move(event));
+    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+}
+
+static Event PopEvent() {
+    Event event = std::move(event_queue.front());
+    std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    event_queue.pop_back();
+    return event;
+}
+
+/// Removes an event which left the queue from the pending events, returns false if it was
+/// cancelled
+static bool RetireEvent(const Event& event) {
+    if (IsCancelled(event)) {
+        --num_cancelled_events;
+        return false;
+    }
+
+    const auto it = event.type->pending.find(event.userdata);
+    if (--it->second.count == 0)
+        event.type->pending.erase(it);
+    return true;
+}
+
+/// Drops the cancelled events from the queue once they make up most of it
+static void CompactQueue() {
+    if (num_cancelled_events <= event_queue.size() / 2)
+        return;
+
+    event_queue.erase(std::remove_if(event_queue.begin(), event_queue.end(), IsCancelled),
+                      event_queue.end());
+    std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    num_cancelled_events = 0;
 }
 
 void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
@@ -141,35 +215,35 @@ void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 user
     if (!is_global_timer_sane)
         ForceExceptionCheck(cycles_into_future);
 
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    PushEvent(Event{timeout, event_fifo_id++, userdata, event_type, 0});
 }
 
 void ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
-    ts_queue.Push(Event{global_timer + cycles_into_future, 0, userdata, event_type});
+    ts_queue.Push(Event{global_timer + cycles_into_future, 0, userdata, event_type, 0});
 }
 
 void UnscheduleEvent(const EventType* event_type, u64 userdata) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    });
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-    }
+    const auto it = event_type->pending.find(userdata);
+    if (it == event_type->pending.end())
+        return;
+
+    // Events scheduled from now on get a newer generation
+    ++cancel_generation;
+    num_cancelled_events += it->second.count;
+    event_type->pending.erase(it);
+    CompactQueue();
 }
 
 void RemoveEvent(const EventType* event_type) {
-    auto itr = std::remove_if(event_queue.begin(), event_queue.end(),
-                              [&](const Event& e) { return e.type == event_type; });
+    if (event_type->pending.empty())
+        return;
 
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    ++cancel_generation;
+    for (const auto& pair : event_type->pending) {
+        num_cancelled_events += pair.second.count;
     }
+    event_type->pending.clear();
+    CompactQueue();
 }
 
 void RemoveNormalAndThreadsafeEvent(const EventType* event_type) {
@@ -188,8 +262,7 @@ void ForceExceptionCheck(s64 cycles) {
 void MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        PushEvent(std::move(ev));
     }
 }
 
@@ -203,14 +276,19 @@ void Advance() {
     is_global_timer_sane = true;
 
     while (!event_queue.empty() && event_queue.front().time <= global_timer) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
-        evt.type->callback(evt.userdata, global_timer - evt.time);
+        Event evt = PopEvent();
+        if (RetireEvent(evt)) {
+            evt.type->callback(evt.userdata, global_timer - evt.time);
+        }
     }
 
     is_global_timer_sane = false;
 
+    // Cancelled events must not shorten the next slice
+    while (!event_queue.empty() && IsCancelled(event_queue.front())) {
+        RetireEvent(PopEvent());
+    }
+
     // Still events left (scheduled in the future)
     if (!event_queue.empty()) {
         slice_length = static_cast<int>(
@@ -233,4 +311,54 @@ s64 GetDowncount() {
     return downcount;
 }
 
+void DoState(PointerWrap& p) {
+    MoveEvents();
+
+    p.Do(global_timer);
+    p.Do(slice_length);
+    p.Do(downcount);
+    p.Do(idled_cycles);
+    p.Do(event_fifo_id);
+    p.Do(is_global_timer_sane);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        ClearPendingEvents();
+
+        u32 num_events = 0;
+        p.Do(num_events);
+        for (u32 i = 0; i < num_events; ++i) {
+            Event event{};
+            std::string name;
+            p.Do(event.time);
+            p.Do(event.fifo_order);
+            p.Do(event.userdata);
+            p.Do(name);
+
+            const auto it = event_types.find(name);
+            if (it != event_types.end()) {
+                event.type = &it->second;
+            } else {
+                LOG_ERROR(Core_Timing, "Unknown event type \"{}\" in save state", name);
+                event.type = ev_lost;
+            }
+            PushEvent(std::move(event));
+        }
+    } else {
+        // Cancelled events are left out
+        std::vector<Event> events;
+        std::copy_if(event_queue.begin(), event_queue.end(), std::back_inserter(events),
+                     [](const Event& event) { return !IsCancelled(event); });
+
+        u32 num_events = static_cast<u32>(events.size());
+        p.Do(num_events);
+        for (Event& event : events) {
+            std::string name = *event.type->name;
+            p.Do(event.time);
+            p.Do(event.fifo_order);
+            p.Do(event.userdata);
+            p.Do(name);
+        }
+    }
+}
+
 } // namespace CoreTiming
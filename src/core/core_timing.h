@@ -24,6 +24,8 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 
+class PointerWrap;
+
 // The timing we get from the assembly is 268,111,855.956 Hz
 // It is possible that this number isn't just an integer because the compiler could have
 // optimized the multiplication by a multiply-by-constant division.
@@ -189,4 +191,10 @@ std::chrono::microseconds GetGlobalTimeUs();
 
 s64 GetDowncount();
 
+/**
+ * Saves or loads the timer and the pending events, including those scheduled from other threads.
+ * Events are stored with the name of their type, which must be registered when loading.
+ */
+void DoState(PointerWrap& p);
+
 } // namespace CoreTiming
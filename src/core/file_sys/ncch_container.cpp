@@ -183,13 +183,16 @@ Loader::ResultStatus NCCHContainer::Load() {
                     }
                 }
 
-                SetKeyY(KeySlotID::NCCHSecure1, key_y_primary);
-                if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure1)) {
+                // Derived without setting the KeyY of the slots, as games are also loaded by the
+                // game list while another one runs
+                const auto primary = DeriveNormalKey(KeySlotID::NCCHSecure1, key_y_primary);
+                if (!primary) {
                     LOG_ERROR(Service_FS, "Secure1 KeyX missing");
                     failed_to_decrypt = true;
                 }
-                primary_key = GetNormalKey(KeySlotID::NCCHSecure1);
+                primary_key = primary.value_or(AESKey{});
 
+                std::optional<AESKey> secondary;
                 switch (ncch_header.secondary_key_slot) {
                 case 0:
                     LOG_DEBUG(Service_FS, "Secure1 crypto");
@@ -197,30 +200,30 @@ Loader::ResultStatus NCCHContainer::Load() {
                     break;
                 case 1:
                     LOG_DEBUG(Service_FS, "Secure2 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure2, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure2)) {
+                    secondary = DeriveNormalKey(KeySlotID::NCCHSecure2, key_y_secondary);
+                    if (!secondary) {
                         LOG_ERROR(Service_FS, "Secure2 KeyX missing");
                         failed_to_decrypt = true;
                     }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure2);
+                    secondary_key = secondary.value_or(AESKey{});
                     break;
                 case 10:
                     LOG_DEBUG(Service_FS, "Secure3 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure3, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure3)) {
+                    secondary = DeriveNormalKey(KeySlotID::NCCHSecure3, key_y_secondary);
+                    if (!secondary) {
                         LOG_ERROR(Service_FS, "Secure3 KeyX missing");
                         failed_to_decrypt = true;
                     }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure3);
+                    secondary_key = secondary.value_or(AESKey{});
                     break;
                 case 11:
                     LOG_DEBUG(Service_FS, "Secure4 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure4, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure4)) {
+                    secondary = DeriveNormalKey(KeySlotID::NCCHSecure4, key_y_secondary);
+                    if (!secondary) {
                         LOG_ERROR(Service_FS, "Secure4 KeyX missing");
                         failed_to_decrypt = true;
                     }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure4);
+                    secondary_key = secondary.value_or(AESKey{});
                     break;
                 }
             }
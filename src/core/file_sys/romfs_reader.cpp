@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "core/file_sys/romfs_reader.h"
@@ -6,12 +7,45 @@
 namespace FileSys {
 
 std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
+    if (length == 0 || offset >= data_size)
         return 0; // Crypto++ does not like zero size buffer
+    length = std::min(length, data_size - offset);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const bool is_sequential = offset == next_sequential_offset;
+
+    std::size_t read_length = 0;
+    if (length > MaxCachedReadSize) {
+        read_length = ReadUncached(offset, length, buffer);
+    } else {
+        const std::size_t last_index = (offset + length - 1) / CacheBlockSize;
+        while (read_length < length) {
+            const std::size_t position = offset + read_length;
+            const std::size_t index = position / CacheBlockSize;
+            // Load the rest of the read at once, and more if the game is streaming a file
+            std::size_t num_blocks = last_index - index + 1;
+            if (is_sequential)
+                num_blocks = std::max(num_blocks, ReadAheadBlocks);
+
+            const CacheBlock* block = GetBlock(index, num_blocks);
+            const std::size_t block_offset = position % CacheBlockSize;
+            if (block == nullptr || block_offset >= block->data.size())
+                break;
+            const std::size_t copy_length =
+                std::min(length - read_length, block->data.size() - block_offset);
+            std::memcpy(buffer + read_length, block->data.data() + block_offset, copy_length);
+            read_length += copy_length;
+        }
+    }
+
+    next_sequential_offset = offset + read_length;
+    return read_length;
+}
+
+std::size_t RomFSReader::ReadUncached(std::size_t offset, std::size_t length, u8* buffer) {
     file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length = std::min(length, data_size - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
+    const std::size_t read_length = file.ReadBytes(buffer, length);
+    if (is_encrypted && read_length != 0) {
         CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
         d.Seek(crypto_offset + offset);
         d.ProcessData(buffer, buffer, read_length);
@@ -19,4 +53,42 @@ std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* bu
     return read_length;
 }
 
+const RomFSReader::CacheBlock* RomFSReader::GetBlock(std::size_t index, std::size_t num_blocks) {
+    auto cached = cache_map.find(index);
+    if (cached != cache_map.end()) {
+        cache.splice(cache.begin(), cache, cached->second);
+        return &*cached->second;
+    }
+
+    // Stop before the end of the data, the first cached block and the blocks the cache can't hold
+    const std::size_t num_data_blocks = (data_size + CacheBlockSize - 1) / CacheBlockSize;
+    num_blocks = std::min({num_blocks, num_data_blocks - index, CacheCapacity});
+    for (std::size_t i = 1; i < num_blocks; ++i) {
+        if (cache_map.count(index + i) != 0) {
+            num_blocks = i;
+            break;
+        }
+    }
+
+    const std::size_t offset = index * CacheBlockSize;
+    std::vector<u8> data(std::min(num_blocks * CacheBlockSize, data_size - offset));
+    data.resize(ReadUncached(offset, data.size(), data.data()));
+    if (data.empty())
+        return nullptr;
+
+    // Insert the blocks backwards, so that the requested one ends up the most recently used
+    const std::size_t num_read_blocks = (data.size() + CacheBlockSize - 1) / CacheBlockSize;
+    for (std::size_t i = num_read_blocks; i-- > 0;) {
+        const auto begin = data.begin() + i * CacheBlockSize;
+        const auto end = data.begin() + std::min((i + 1) * CacheBlockSize, data.size());
+        cache.push_front({index + i, std::vector<u8>(begin, end)});
+        cache_map[index + i] = cache.begin();
+    }
+    while (cache.size() > CacheCapacity) {
+        cache_map.erase(cache.back().index);
+        cache.pop_back();
+    }
+    return &cache.front();
+}
+
 } // namespace FileSys
@@ -1,11 +1,20 @@
 #pragma once
 
 #include <array>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
 namespace FileSys {
 
+/**
+ * Reads the RomFS of a title from its file, decrypting it when needed. Small reads go through an
+ * LRU cache of decrypted blocks, and sequential ones read ahead, so that the games streaming their
+ * assets in small chunks don't seek, read and decrypt the same blocks over and over.
+ */
 class RomFSReader {
 public:
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
@@ -24,7 +33,31 @@ public:
 
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer);
 
+    /// Size of the cached blocks, which are aligned to it
+    static constexpr std::size_t CacheBlockSize = 0x1000;
+    /// Maximum number of blocks kept in the cache
+    static constexpr std::size_t CacheCapacity = 256;
+    /// Number of blocks loaded at once when a read continues the previous one
+    static constexpr std::size_t ReadAheadBlocks = 32;
+    /// Reads larger than this bypass the cache, to not evict the blocks of the small ones
+    static constexpr std::size_t MaxCachedReadSize = 0x10000;
+
 private:
+    struct CacheBlock {
+        std::size_t index;
+        /// Decrypted contents, shorter than CacheBlockSize for the last block
+        std::vector<u8> data;
+    };
+
+    /// Reads and decrypts data from the file, without going through the cache
+    std::size_t ReadUncached(std::size_t offset, std::size_t length, u8* buffer);
+
+    /**
+     * Returns the cached block at index, loading it along with the uncached blocks following it
+     * @param num_blocks Number of blocks to load if it isn't cached, including this one
+     */
+    const CacheBlock* GetBlock(std::size_t index, std::size_t num_blocks);
+
     bool is_encrypted;
     FileUtil::IOFile file;
     std::array<u8, 16> key;
@@ -32,6 +65,13 @@ private:
     std::size_t file_offset;
     std::size_t crypto_offset;
     std::size_t data_size;
+
+    std::mutex mutex;
+    /// Cached blocks, from the most to the least recently used
+    std::list<CacheBlock> cache;
+    std::unordered_map<std::size_t, std::list<CacheBlock>::iterator> cache_map;
+    /// Offset following the previous read, where a sequential read starts
+    std::size_t next_sequential_offset = 0;
 };
 
 } // namespace FileSys
@@ -0,0 +1,196 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <utility>
+#include "common/file_util.h"
+#include "common/linear_disk_cache.h"
+#include "common/logging/log.h"
+#include "core/game_list_cache.h"
+
+namespace {
+
+constexpr u32 CacheVersion = 2;
+
+std::string GetCachePath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "game_list.bin";
+}
+
+/// Serializes an entry, along with its path. The path identifies the entry, so the keys of the
+/// LinearDiskCache are unused.
+class EntryWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        const auto* bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(const std::string& value) {
+        Write(static_cast<u32>(value.size()));
+        data.insert(data.end(), value.begin(), value.end());
+    }
+
+    void Write(const std::vector<u8>& value) {
+        Write(static_cast<u32>(value.size()));
+        data.insert(data.end(), value.begin(), value.end());
+    }
+
+    std::vector<u8> data;
+};
+
+/// Deserializes an entry. Reading past the end fails all the following reads.
+class EntryReader {
+public:
+    EntryReader(const u8* data, u32 size) : data(data), size(size) {}
+
+    template <typename T>
+    bool Read(T& value) {
+        if (size - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string& value) {
+        u32 length;
+        if (!Read(length) || size - offset < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return true;
+    }
+
+    bool Read(std::vector<u8>& value) {
+        u32 length;
+        if (!Read(length) || size - offset < length) {
+            return false;
+        }
+        value.assign(data + offset, data + offset + length);
+        offset += length;
+        return true;
+    }
+
+private:
+    const u8* data;
+    u32 size;
+    u32 offset = 0;
+};
+
+void WriteEntry(EntryWriter& writer, const std::string& path, const GameListCacheEntry& entry) {
+    writer.Write(path);
+    writer.Write(entry.size);
+    writer.Write(entry.modified);
+    writer.Write(entry.update_modified);
+    writer.Write(entry.program_id);
+    writer.Write(entry.extdata_id);
+    writer.Write(entry.file_type);
+    writer.Write(entry.smdh);
+}
+
+bool ReadEntry(EntryReader& reader, std::string& path, GameListCacheEntry& entry) {
+    return reader.Read(path) && reader.Read(entry.size) && reader.Read(entry.modified) &&
+           reader.Read(entry.update_modified) && reader.Read(entry.program_id) &&
+           reader.Read(entry.extdata_id) && reader.Read(entry.file_type) &&
+           reader.Read(entry.smdh);
+}
+
+class Reader : public LinearDiskCacheReader<u8, u8> {
+public:
+    explicit Reader(std::unordered_map<std::string, GameListCacheEntry>& entries)
+        : entries(entries) {}
+
+    void Read(const u8& key, const u8* value, u32 value_size) override {
+        EntryReader reader(value, value_size);
+        std::string path;
+        GameListCacheEntry entry;
+        if (ReadEntry(reader, path, entry)) {
+            entries[std::move(path)] = std::move(entry);
+        }
+    }
+
+private:
+    std::unordered_map<std::string, GameListCacheEntry>& entries;
+};
+
+/// Used to create an empty cache file
+class NullReader : public LinearDiskCacheReader<u8, u8> {
+public:
+    void Read(const u8& key, const u8* value, u32 value_size) override {}
+};
+
+} // Anonymous namespace
+
+void GameListCache::Load() {
+    entries.clear();
+    found.clear();
+    changed = false;
+
+    const std::string path = GetCachePath();
+    if (!FileUtil::Exists(path)) {
+        return;
+    }
+
+    LinearDiskCache<u8, u8> cache;
+    Reader reader(entries);
+    cache.OpenAndRead(path, CacheVersion, reader);
+    LOG_INFO(Frontend, "Loaded {} game list entries from {}", entries.size(), path);
+}
+
+std::optional<GameListCacheEntry> GameListCache::Find(const std::string& path, u64 size,
+                                                      s64 modified) const {
+    const auto entry = entries.find(path);
+    if (entry == entries.end() || entry->second.size != size ||
+        entry->second.modified != modified) {
+        return {};
+    }
+    return entry->second;
+}
+
+void GameListCache::Keep(const std::string& path) {
+    found.insert(path);
+}
+
+void GameListCache::Add(const std::string& path, GameListCacheEntry entry) {
+    entries[path] = std::move(entry);
+    found.insert(path);
+    changed = true;
+}
+
+void GameListCache::Save() {
+    // The entries which weren't found are those of files which were removed
+    if (!changed && found.size() == entries.size()) {
+        return;
+    }
+
+    if (!FileUtil::CreateFullPath(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir))) {
+        LOG_ERROR(Frontend, "Failed to create the cache directory");
+        return;
+    }
+
+    // The cache is rewritten as a whole, rather than appended to, so that it doesn't grow
+    const std::string path = GetCachePath();
+    FileUtil::Delete(path);
+    LinearDiskCache<u8, u8> cache;
+    NullReader reader;
+    cache.OpenAndRead(path, CacheVersion, reader);
+    if (!cache.IsOpen()) {
+        LOG_ERROR(Frontend, "Failed to write the game list cache to {}", path);
+        return;
+    }
+
+    for (const auto& [entry_path, entry] : entries) {
+        if (found.count(entry_path) == 0) {
+            continue;
+        }
+        EntryWriter writer;
+        WriteEntry(writer, entry_path, entry);
+        cache.Append(0, writer.data.data(), static_cast<u32>(writer.data.size()));
+    }
+    cache.Close();
+    LOG_INFO(Frontend, "Saved {} game list entries to {}", found.size(), path);
+}
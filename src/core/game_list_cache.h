@@ -0,0 +1,53 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+
+/// Metadata of a game file, as shown in the game list
+struct GameListCacheEntry {
+    u64 size = 0;     ///< Size of the file
+    s64 modified = 0; ///< Modification time of the file, in ms since the epoch
+    /// Modification time of the content of the update title, in ms since the epoch, or 0 if the
+    /// game has no update
+    s64 update_modified = 0;
+    u64 program_id = 0;
+    u64 extdata_id = 0;
+    u32 file_type = 0;    ///< The Loader::FileType of the file
+    std::vector<u8> smdh; ///< The SMDH of the update if there's one, otherwise of the game
+};
+
+/**
+ * On-disk cache of the metadata of the game files found by the game list, so that the files which
+ * didn't change aren't parsed again at every launch. The entries are keyed by path, and are valid
+ * as long as the file keeps its size and modification time. Only used by the game list worker.
+ */
+class GameListCache {
+public:
+    /// Loads the entries saved by the last scan
+    void Load();
+
+    /// Returns the entry of a file if it's cached and unchanged
+    std::optional<GameListCacheEntry> Find(const std::string& path, u64 size, s64 modified) const;
+
+    /// Marks the cached entry of a file as found by this scan
+    void Keep(const std::string& path);
+
+    /// Adds the entry of a file found by this scan, replacing the cached one
+    void Add(const std::string& path, GameListCacheEntry entry);
+
+    /// Saves the entries found by this scan, if they differ from the ones loaded
+    void Save();
+
+private:
+    std::unordered_map<std::string, GameListCacheEntry> entries;
+    std::unordered_set<std::string> found; ///< The paths found by this scan
+    bool changed = false;                  ///< Whether entries were added by this scan
+};
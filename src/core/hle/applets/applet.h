@@ -66,8 +66,7 @@ protected:
      */
     virtual ResultCode StartImpl(const Service::APT::AppletStartupParameter& parameter) = 0;
 
-    Service::APT::AppletId id;                    ///< Id of this Applet
-    std::shared_ptr<std::vector<u8>> heap_memory; ///< Heap memory for this Applet
+    Service::APT::AppletId id; ///< Id of this Applet
 
     /// Whether this applet is currently running instead of the host application or not.
     bool is_running = false;
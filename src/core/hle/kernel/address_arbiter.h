@@ -14,6 +14,10 @@
 // applications use them as an underlying mechanism to implement thread-safe barriers, events, and
 // semaphores.
 
+namespace Core {
+struct KernelState;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Kernel namespace
 
@@ -66,6 +70,7 @@ private:
     std::vector<SharedPtr<Thread>> waiting_threads;
 
     friend class KernelSystem;
+    friend struct Core::KernelState;
 };
 
 } // namespace Kernel
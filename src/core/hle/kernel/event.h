@@ -8,6 +8,10 @@
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/wait_object.h"
 
+namespace Core {
+struct KernelState;
+}
+
 namespace Kernel {
 
 class Event final : public WaitObject {
@@ -49,6 +53,7 @@ private:
     std::string name; ///< Name of event (optional)
 
     friend class KernelSystem;
+    friend struct Core::KernelState;
 };
 
 } // namespace Kernel
@@ -83,6 +83,15 @@ SharedPtr<Object> HandleTable::GetGeneric(Handle handle) const {
     return objects[GetSlot(handle)];
 }
 
+std::vector<std::pair<Handle, SharedPtr<Object>>> HandleTable::GetHandles() const {
+    std::vector<std::pair<Handle, SharedPtr<Object>>> handles;
+    for (u16 slot = 0; slot < MAX_COUNT; ++slot) {
+        if (objects[slot] != nullptr)
+            handles.emplace_back(generations[slot] | (slot << 15), objects[slot]);
+    }
+    return handles;
+}
+
 void HandleTable::Clear() {
     for (u16 i = 0; i < MAX_COUNT; ++i) {
         generations[i] = i + 1;
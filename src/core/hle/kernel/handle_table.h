@@ -6,6 +6,8 @@
 
 #include <array>
 #include <cstddef>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/result.h"
@@ -85,6 +87,9 @@ public:
         return DynamicObjectCast<T>(GetGeneric(handle));
     }
 
+    /// Returns the valid handles of this table, with the objects they point to.
+    std::vector<std::pair<Handle, SharedPtr<Object>>> GetHandles() const;
+
     /// Closes all handles held in this table.
     void Clear();
 
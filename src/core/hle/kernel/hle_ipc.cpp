@@ -6,12 +6,14 @@
 #include <vector>
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/logging/log.h"
 #include "core/core.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/memory.h"
 
 namespace Kernel {
 
@@ -251,4 +253,19 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     Memory::WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+ResultVal<std::vector<std::pair<u8*, u32>>> MappedBuffer::GetBackingBlocks(
+    std::size_t offset, std::size_t size) const {
+    ASSERT(perms & IPC::W);
+    ASSERT(offset + size <= this->size);
+    const VAddr start = address + static_cast<VAddr>(offset);
+    auto blocks = process->vm_manager.GetBackingBlocksForRange(start, static_cast<u32>(size));
+    if (blocks.Failed()) {
+        LOG_ERROR(Kernel, "MappedBuffer at 0x{:08X} isn't backed by memory", address);
+        return blocks.Code();
+    }
+    Memory::RasterizerFlushVirtualRegion(start, static_cast<u32>(size),
+                                         Memory::FlushMode::FlushAndInvalidate);
+    return blocks;
+}
+
 } // namespace Kernel
@@ -9,6 +9,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 #include "common/common_types.h"
@@ -16,6 +17,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/result.h"
 
 namespace Service {
 class ServiceFrameworkBase;
@@ -100,10 +102,23 @@ public:
     // interface for service
     void Read(void* dest_buffer, std::size_t offset, std::size_t size);
     void Write(const void* src_buffer, std::size_t offset, std::size_t size);
+    /**
+     * Gets the host memory backing a range of the buffer, as blocks of contiguous memory in order,
+     * for services which write to it without an intermediate copy. Fails if the range isn't
+     * backed by memory. The rasterizer cache is flushed and invalidated for the range beforehand.
+     * The caller invalidates it again once the range is written, as the GPU may cache the range
+     * in the meantime.
+     */
+    ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocks(std::size_t offset,
+                                                                 std::size_t size) const;
     std::size_t GetSize() const {
         return size;
     }
 
+    VAddr GetAddress() const {
+        return address;
+    }
+
     // interface for ipc helper
     u32 GenerateDescriptor() const {
         return IPC::MappedBufferDesc(size, perms);
@@ -178,17 +178,15 @@ public:
                                                std::string name = "Unknown");
 
     /**
-     * Creates a shared memory object from a block of memory managed by an HLE applet.
-     * @param heap_block Heap block of the HLE applet.
-     * @param offset The offset into the heap block that the SharedMemory will map.
+     * Creates a shared memory object for an HLE applet, allocated in the SYSTEM memory region.
+     * @param offset The offset into the heap of the applet that the SharedMemory will map.
      * @param size Size of the memory block. Must be page-aligned.
      * @param permissions Permission restrictions applied to the process which created the block.
      * @param other_permissions Permission restrictions applied to other processes mapping the
      * block.
      * @param name Optional object name, used for debugging purposes.
      */
-    SharedPtr<SharedMemory> CreateSharedMemoryForApplet(std::shared_ptr<std::vector<u8>> heap_block,
-                                                        u32 offset, u32 size,
+    SharedPtr<SharedMemory> CreateSharedMemoryForApplet(u32 offset, u32 size,
                                                         MemoryPermission permissions,
                                                         MemoryPermission other_permissions,
                                                         std::string name = "Unknown Applet");
@@ -198,6 +196,9 @@ public:
     /// Retrieves a process from the current list of processes.
     SharedPtr<Process> GetProcessById(u32 process_id) const;
 
+    /// Returns all the processes of the current session.
+    const std::vector<SharedPtr<Process>>& GetProcessList() const;
+
     SharedPtr<Process> GetCurrentProcess() const;
     void SetCurrentProcess(SharedPtr<Process> process);
 
@@ -216,6 +217,11 @@ public:
 
     std::array<MemoryRegionInfo, 3> memory_regions;
 
+    /// Shared memory blocks created over memory their owner process had already mapped. They use
+    /// the memory of the process, which must then stay where it is. Blocks remove themselves when
+    /// destroyed.
+    std::vector<SharedMemory*> heap_shared_memory;
+
     /// Adds a port to the named port table
     void AddNamedPort(std::string name, SharedPtr<ClientPort> port);
 
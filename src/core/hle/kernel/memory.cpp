@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <utility>
@@ -50,14 +51,7 @@ void KernelSystem::MemoryInit(u32 mem_type) {
     // the sizes specified in the memory_region_sizes table.
     VAddr base = 0;
     for (int i = 0; i < 3; ++i) {
-        memory_regions[i].base = base;
-        memory_regions[i].size = memory_region_sizes[mem_type][i];
-        memory_regions[i].used = 0;
-        memory_regions[i].linear_heap_memory = std::make_shared<std::vector<u8>>();
-        // Reserve enough space for this region of FCRAM.
-        // We do not want this block of memory to be relocated when allocating from it.
-        memory_regions[i].linear_heap_memory->reserve(memory_regions[i].size);
-
+        memory_regions[i].Reset(base, memory_region_sizes[mem_type][i]);
         base += memory_regions[i].size;
     }
 
@@ -76,6 +70,91 @@ void KernelSystem::MemoryInit(u32 mem_type) {
     shared_page_handler = std::make_unique<SharedPage::Handler>();
 }
 
+void MemoryRegionInfo::Reset(u32 base, u32 size) {
+    this->base = base;
+    this->size = size;
+    used = 0;
+    linear_heap_size = 0;
+    free_blocks.clear();
+    free_blocks.insert(IntervalSet::interval_type::right_open(base, base + size));
+}
+
+MemoryRegionInfo::IntervalSet MemoryRegionInfo::HeapAllocate(u32 size) {
+    IntervalSet result;
+
+    // Prefer the highest block that fits the whole allocation, so that the memory is contiguous
+    if (const auto offset = HeapAllocateContiguous(size)) {
+        result.insert(IntervalSet::interval_type::right_open(*offset, *offset + size));
+    } else {
+        // Otherwise gather smaller blocks, from the highest down
+        u32 remaining = size;
+        for (auto iter = free_blocks.rbegin(); iter != free_blocks.rend() && remaining != 0;
+             ++iter) {
+            const u32 block_end = boost::icl::last_next(*iter);
+            const u32 allocated = std::min(remaining, block_end - boost::icl::first(*iter));
+            result.insert(IntervalSet::interval_type::right_open(block_end - allocated, block_end));
+            remaining -= allocated;
+        }
+        if (remaining != 0) {
+            return {};
+        }
+        free_blocks -= result;
+    }
+
+    for (const auto& interval : result) {
+        std::memset(Memory::GetFCRAMPointer(boost::icl::first(interval)), 0,
+                    boost::icl::length(interval));
+    }
+    return result;
+}
+
+std::optional<u32> MemoryRegionInfo::HeapAllocateContiguous(u32 size) {
+    for (auto iter = free_blocks.rbegin(); iter != free_blocks.rend(); ++iter) {
+        const u32 block_end = boost::icl::last_next(*iter);
+        if (block_end - boost::icl::first(*iter) >= size) {
+            const u32 offset = block_end - size;
+            free_blocks -= IntervalSet::interval_type::right_open(offset, block_end);
+            return offset;
+        }
+    }
+    return {};
+}
+
+bool MemoryRegionInfo::LinearAllocate(u32 offset, u32 size) {
+    const auto interval = IntervalSet::interval_type::right_open(offset, offset + size);
+    if (!boost::icl::contains(free_blocks, interval)) {
+        return false;
+    }
+
+    free_blocks -= interval;
+    linear_heap_size = std::max(linear_heap_size, offset + size - base);
+    std::memset(Memory::GetFCRAMPointer(offset), 0, size);
+    return true;
+}
+
+std::optional<u32> MemoryRegionInfo::LinearAllocate(u32 size) {
+    const u32 offset = base + linear_heap_size;
+    if (!LinearAllocate(offset, size)) {
+        return {};
+    }
+    return offset;
+}
+
+void MemoryRegionInfo::Free(u32 offset, u32 size) {
+    if (size == 0) {
+        return;
+    }
+
+    free_blocks += IntervalSet::interval_type::right_open(offset, offset + size);
+
+    // If the end of the linear heap was freed, it ends at the last block still allocated in it
+    const u32 linear_heap_end = base + linear_heap_size;
+    if (linear_heap_size != 0 && offset < linear_heap_end && offset + size >= linear_heap_end) {
+        const auto free_block = free_blocks.find(linear_heap_end - 1);
+        linear_heap_size = boost::icl::first(*free_block) - base;
+    }
+}
+
 MemoryRegionInfo* KernelSystem::GetMemoryRegion(MemoryRegion region) {
     switch (region) {
     case MemoryRegion::APPLICATION:
@@ -4,8 +4,8 @@
 
 #pragma once
 
-#include <memory>
-#include <vector>
+#include <optional>
+#include <boost/icl/interval_set.hpp>
 #include "common/common_types.h"
 
 namespace Kernel {
@@ -13,12 +13,56 @@ namespace Kernel {
 struct AddressMapping;
 class VMManager;
 
+/**
+ * A region of FCRAM which the kernel allocates memory from. The linear heap grows from the start of
+ * the region, as its virtual addresses map 1:1 to FCRAM, and the regular heap is taken from the
+ * end, where it may be split into several blocks. Offsets are from the start of FCRAM, whose host
+ * memory never moves, so allocating never updates any mappings.
+ */
 struct MemoryRegionInfo {
     u32 base; // Not an address, but offset from start of FCRAM
     u32 size;
     u32 used;
 
-    std::shared_ptr<std::vector<u8>> linear_heap_memory;
+    /// Size of the part of the region covered by the linear heap, including any freed holes
+    u32 linear_heap_size;
+
+    using IntervalSet = boost::icl::interval_set<u32>;
+    /// Free FCRAM offsets in this region
+    IntervalSet free_blocks;
+
+    /// Makes the whole region free
+    void Reset(u32 base, u32 size);
+
+    /**
+     * Allocates memory for the regular heap, from the highest free offsets down. The memory may be
+     * split into several blocks.
+     * @returns the allocated FCRAM offsets, or an empty set if there isn't enough free memory
+     */
+    IntervalSet HeapAllocate(u32 size);
+
+    /**
+     * Allocates memory for the regular heap in one block, the highest free one which fits it. The
+     * memory isn't cleared.
+     * @returns the offset of the memory, or nothing if no free block is large enough
+     */
+    std::optional<u32> HeapAllocateContiguous(u32 size);
+
+    /**
+     * Allocates the memory at the specified offset, which must be free, growing the linear heap if
+     * it ends past it.
+     * @returns whether the memory was free
+     */
+    bool LinearAllocate(u32 offset, u32 size);
+
+    /**
+     * Allocates memory at the end of the linear heap, growing it.
+     * @returns the offset of the memory, or nothing if the memory past the heap isn't free
+     */
+    std::optional<u32> LinearAllocate(u32 size);
+
+    /// Frees memory, shrinking the linear heap if it was at its end
+    void Free(u32 offset, u32 size);
 };
 
 void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
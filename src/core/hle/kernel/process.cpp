@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
+#include <vector>
 #include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
@@ -11,6 +13,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/shared_memory.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
@@ -174,33 +177,41 @@ ResultVal<VAddr> Process::HeapAllocate(VAddr target, u32 size, VMAPermission per
         return ERR_INVALID_ADDRESS;
     }
 
-    if (heap_memory == nullptr) {
-        // Initialize heap
-        heap_memory = std::make_shared<std::vector<u8>>();
-        heap_start = heap_end = target;
+    if (size == 0) {
+        return MakeResult<VAddr>(target);
     }
 
-    // If necessary, expand backing vector to cover new heap extents.
-    if (target < heap_start) {
-        heap_memory->insert(begin(*heap_memory), heap_start - target, 0);
-        heap_start = target;
-        vm_manager.RefreshMemoryBlockMappings(heap_memory.get());
+    // Check the range is free before taking memory from the region
+    auto vma = vm_manager.FindVMA(target);
+    if (vma->second.type != VMAType::Free || vma->second.base + vma->second.size < target + size) {
+        return ERR_INVALID_ADDRESS_STATE;
     }
-    if (target + size > heap_end) {
-        heap_memory->insert(end(*heap_memory), (target + size) - heap_end, 0);
-        heap_end = target + size;
-        vm_manager.RefreshMemoryBlockMappings(heap_memory.get());
+
+    auto allocated_fcram = memory_region->HeapAllocate(size);
+    if (allocated_fcram.empty()) {
+        return ERR_OUT_OF_MEMORY;
     }
-    ASSERT(heap_end - heap_start == heap_memory->size());
 
-    CASCADE_RESULT(auto vma, vm_manager.MapMemoryBlock(target, heap_memory, target - heap_start,
-                                                       size, MemoryState::Private));
-    vm_manager.Reprotect(vma, perms);
+    // Map the blocks of FCRAM one after another. The memory is already in place, so growing the
+    // heap never copies it.
+    VAddr interval_target = target;
+    for (const auto& interval : allocated_fcram) {
+        const u32 interval_size = boost::icl::length(interval);
+        u8* backing_memory = Memory::GetFCRAMPointer(boost::icl::first(interval));
+        auto interval_vma =
+            vm_manager
+                .MapBackingMemory(interval_target, backing_memory, interval_size,
+                                  MemoryState::Private)
+                .Unwrap();
+        vm_manager.Reprotect(interval_vma, perms);
+        interval_target += interval_size;
+    }
 
+    holding_memory += allocated_fcram;
     heap_used += size;
     memory_region->used += size;
 
-    return MakeResult<VAddr>(heap_end - size);
+    return MakeResult<VAddr>(target);
 }
 
 ResultCode Process::HeapFree(VAddr target, u32 size) {
@@ -213,20 +224,122 @@ ResultCode Process::HeapFree(VAddr target, u32 size) {
         return RESULT_SUCCESS;
     }
 
+    // Free the FCRAM held by the process in the range. Shared memory mapped into the heap belongs
+    // to its owner, and is only unmapped.
+    MemoryRegionInfo::IntervalSet freed_fcram;
+    const VAddr target_end = target + size;
+    for (auto vma = vm_manager.FindVMA(target);
+         vma != vm_manager.vma_map.end() && vma->second.base < target_end; ++vma) {
+        if (vma->second.type != VMAType::BackingMemory) {
+            continue;
+        }
+        const VAddr start = std::max(target, vma->second.base);
+        const VAddr end = std::min(target_end, vma->second.base + vma->second.size);
+        const auto fcram_offset =
+            Memory::GetFCRAMOffset(vma->second.backing_memory + (start - vma->second.base));
+        if (fcram_offset) {
+            freed_fcram.insert(MemoryRegionInfo::IntervalSet::interval_type::right_open(
+                *fcram_offset, *fcram_offset + (end - start)));
+        }
+    }
+    freed_fcram &= holding_memory;
+
     ResultCode result = vm_manager.UnmapRange(target, size);
     if (result.IsError())
         return result;
 
+    for (const auto& interval : freed_fcram) {
+        memory_region->Free(boost::icl::first(interval), boost::icl::length(interval));
+    }
+    holding_memory -= freed_fcram;
+
     heap_used -= size;
     memory_region->used -= size;
 
     return RESULT_SUCCESS;
 }
 
-ResultVal<VAddr> Process::LinearAllocate(VAddr target, u32 size, VMAPermission perms) {
-    auto& linheap_memory = memory_region->linear_heap_memory;
+ResultCode Process::MakeHeapContiguous(VAddr target, u32 size) {
+    struct HeapPart {
+        VAddr address;
+        u32 size;
+        u32 fcram_offset;
+        VMAPermission permissions;
+        MemoryState meminfo_state;
+    };
+
+    std::vector<HeapPart> parts;
+    MemoryRegionInfo::IntervalSet moved_fcram;
+    const VAddr target_end = target + size;
+    for (VAddr address = target; address != target_end;) {
+        const auto vma = vm_manager.FindVMA(address);
+        if (vma == vm_manager.vma_map.end() || vma->second.type != VMAType::BackingMemory) {
+            return ERR_INVALID_ADDRESS_STATE;
+        }
+        const VirtualMemoryArea& area = vma->second;
+        const VAddr end = std::min(target_end, area.base + area.size);
+        const auto fcram_offset =
+            Memory::GetFCRAMOffset(area.backing_memory + (address - area.base));
+        if (!fcram_offset) {
+            return ERR_INVALID_ADDRESS_STATE;
+        }
+        const auto interval = MemoryRegionInfo::IntervalSet::interval_type::right_open(
+            *fcram_offset, *fcram_offset + (end - address));
+        if (!boost::icl::contains(holding_memory, interval)) {
+            return ERR_INVALID_ADDRESS_STATE;
+        }
+        parts.push_back({address, end - address, *fcram_offset, area.permissions,
+                         area.meminfo_state});
+        moved_fcram += interval;
+        address = end;
+    }
+
+    // Shared memory blocks created before over part of the range point to its memory, and so do
+    // their mappings in other processes
+    for (const SharedMemory* shared_memory : kernel.heap_shared_memory) {
+        for (const auto& [block, block_size] : shared_memory->backing_blocks) {
+            const auto block_offset = Memory::GetFCRAMOffset(block);
+            if (block_offset &&
+                boost::icl::intersects(moved_fcram,
+                                       MemoryRegionInfo::IntervalSet::interval_type::right_open(
+                                           *block_offset, *block_offset + block_size))) {
+                return ERR_INVALID_ADDRESS_STATE;
+            }
+        }
+    }
 
-    VAddr heap_end = GetLinearHeapBase() + (u32)linheap_memory->size();
+    const auto offset = memory_region->HeapAllocateContiguous(size);
+    if (!offset) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    u8* memory = Memory::GetFCRAMPointer(*offset);
+    for (const HeapPart& part : parts) {
+        Memory::RasterizerFlushAndInvalidateRegion(Memory::FCRAM_PADDR + part.fcram_offset,
+                                                   part.size);
+        std::memcpy(memory + (part.address - target), Memory::GetFCRAMPointer(part.fcram_offset),
+                    part.size);
+    }
+
+    vm_manager.UnmapRange(target, size);
+    for (const HeapPart& part : parts) {
+        auto vma = vm_manager
+                       .MapBackingMemory(part.address, memory + (part.address - target),
+                                         part.size, part.meminfo_state)
+                       .Unwrap();
+        vm_manager.Reprotect(vma, part.permissions);
+    }
+
+    for (const auto& interval : moved_fcram) {
+        memory_region->Free(boost::icl::first(interval), boost::icl::length(interval));
+    }
+    holding_memory -= moved_fcram;
+    holding_memory +=
+        MemoryRegionInfo::IntervalSet::interval_type::right_open(*offset, *offset + size);
+    return RESULT_SUCCESS;
+}
+
+ResultVal<VAddr> Process::LinearAllocate(VAddr target, u32 size, VMAPermission perms) {
+    VAddr heap_end = GetLinearHeapBase() + memory_region->linear_heap_size;
     // Games and homebrew only ever seem to pass 0 here (which lets the kernel decide the address),
     // but explicit addresses are also accepted and respected.
     if (target == 0) {
@@ -242,18 +355,24 @@ ResultVal<VAddr> Process::LinearAllocate(VAddr target, u32 size, VMAPermission p
     // Expansion of the linear heap is only allowed if you do an allocation immediately at its
     // end. It's possible to free gaps in the middle of the heap and then reallocate them later,
     // but expansions are only allowed at the end.
-    if (target == heap_end) {
-        linheap_memory->insert(linheap_memory->end(), size, 0);
-        vm_manager.RefreshMemoryBlockMappings(linheap_memory.get());
+    // The linear heap maps 1:1 to FCRAM, so the memory must be free at exactly this offset.
+    u32 offset = target - GetLinearHeapAreaAddress();
+    if (!memory_region->LinearAllocate(offset, size)) {
+        return ERR_OUT_OF_MEMORY;
     }
 
     // TODO(yuriks): As is, this lets processes map memory allocated by other processes from the
     // same region. It is unknown if or how the 3DS kernel checks against this.
-    std::size_t offset = target - GetLinearHeapBase();
-    CASCADE_RESULT(auto vma, vm_manager.MapMemoryBlock(target, linheap_memory, offset, size,
-                                                       MemoryState::Continuous));
-    vm_manager.Reprotect(vma, perms);
+    auto vma = vm_manager.MapBackingMemory(target, Memory::GetFCRAMPointer(offset), size,
+                                           MemoryState::Continuous);
+    if (vma.Failed()) {
+        memory_region->Free(offset, size);
+        return vma.Code();
+    }
+    vm_manager.Reprotect(vma.Unwrap(), perms);
 
+    holding_linear_memory +=
+        MemoryRegionInfo::IntervalSet::interval_type::right_open(offset, offset + size);
     linear_heap_used += size;
     memory_region->used += size;
 
@@ -261,8 +380,6 @@ ResultVal<VAddr> Process::LinearAllocate(VAddr target, u32 size, VMAPermission p
 }
 
 ResultCode Process::LinearFree(VAddr target, u32 size) {
-    auto& linheap_memory = memory_region->linear_heap_memory;
-
     if (target < GetLinearHeapBase() || target + size > GetLinearHeapLimit() ||
         target + size < target) {
 
@@ -273,7 +390,7 @@ ResultCode Process::LinearFree(VAddr target, u32 size) {
         return RESULT_SUCCESS;
     }
 
-    VAddr heap_end = GetLinearHeapBase() + (u32)linheap_memory->size();
+    VAddr heap_end = GetLinearHeapBase() + memory_region->linear_heap_size;
     if (target + size > heap_end) {
         return ERR_INVALID_ADDRESS_STATE;
     }
@@ -285,24 +402,42 @@ ResultCode Process::LinearFree(VAddr target, u32 size) {
     linear_heap_used -= size;
     memory_region->used -= size;
 
-    if (target + size == heap_end) {
-        // End of linear heap has been freed, so check what's the last allocated block in it and
-        // reduce the size.
-        auto vma = vm_manager.FindVMA(target);
-        ASSERT(vma != vm_manager.vma_map.end());
-        ASSERT(vma->second.type == VMAType::Free);
-        VAddr new_end = vma->second.base;
-        if (new_end >= GetLinearHeapBase()) {
-            linheap_memory->resize(new_end - GetLinearHeapBase());
-        }
-    }
+    // This shrinks the linear heap if its end was freed
+    const u32 offset = target - GetLinearHeapAreaAddress();
+    memory_region->Free(offset, size);
+    holding_linear_memory -=
+        MemoryRegionInfo::IntervalSet::interval_type::right_open(offset, offset + size);
 
     return RESULT_SUCCESS;
 }
 
 Kernel::Process::Process(KernelSystem& kernel)
     : Object(kernel), handle_table(kernel), kernel(kernel) {}
-Kernel::Process::~Process() {}
+Kernel::Process::~Process() {
+    if (memory_region == nullptr)
+        return;
+
+    // Return the FCRAM still held by the regular and linear heaps to the region
+    for (const auto& interval : holding_memory) {
+        memory_region->Free(boost::icl::first(interval), boost::icl::length(interval));
+    }
+    for (const auto& interval : holding_linear_memory) {
+        memory_region->Free(boost::icl::first(interval), boost::icl::length(interval));
+        memory_region->used -= boost::icl::length(interval);
+    }
+    memory_region->used -= heap_used + misc_memory_used;
+
+    // The TLS pages of the threads are allocated from the BASE region
+    MemoryRegionInfo* tls_region = kernel.GetMemoryRegion(MemoryRegion::BASE);
+    for (std::size_t page = 0; page < tls_slots.size(); ++page) {
+        const auto vma = vm_manager.FindVMA(Memory::TLS_AREA_VADDR +
+                                            static_cast<VAddr>(page) * Memory::PAGE_SIZE);
+        const auto offset = Memory::GetFCRAMOffset(vma->second.backing_memory);
+        ASSERT(offset);
+        tls_region->Free(*offset, Memory::PAGE_SIZE);
+        tls_region->used -= Memory::PAGE_SIZE;
+    }
+}
 
 SharedPtr<Process> KernelSystem::GetProcessById(u32 process_id) const {
     auto itr = std::find_if(
@@ -314,4 +449,8 @@ SharedPtr<Process> KernelSystem::GetProcessById(u32 process_id) const {
 
     return *itr;
 }
+
+const std::vector<SharedPtr<Process>>& KernelSystem::GetProcessList() const {
+    return process_list;
+}
 } // namespace Kernel
@@ -14,6 +14,7 @@
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/vm_manager.h"
 
@@ -165,13 +166,11 @@ public:
 
     VMManager vm_manager;
 
-    // Memory used to back the allocations in the regular heap. A single vector is used to cover
-    // the entire virtual address space extents that bound the allocations, including any holes.
-    // This makes deallocation and reallocation of holes fast and keeps process memory contiguous
-    // in the emulator address space, allowing Memory::GetPointer to be reasonably safe.
-    std::shared_ptr<std::vector<u8>> heap_memory;
-    // The left/right bounds of the address space covered by heap_memory.
-    VAddr heap_start = 0, heap_end = 0;
+    // FCRAM offsets of the memory allocated for the regular heap of the process. Only this memory
+    // is returned to the region when heap memory is freed.
+    MemoryRegionInfo::IntervalSet holding_memory;
+    // FCRAM offsets of the memory allocated for the linear heap of the process
+    MemoryRegionInfo::IntervalSet holding_linear_memory;
 
     u32 heap_used = 0, linear_heap_used = 0, misc_memory_used = 0;
 
@@ -191,6 +190,15 @@ public:
     ResultVal<VAddr> HeapAllocate(VAddr target, u32 size, VMAPermission perms);
     ResultCode HeapFree(VAddr target, u32 size);
 
+    /**
+     * Moves the regular heap memory mapped in a range to one block of FCRAM, keeping its contents,
+     * mappings and permissions. Used for the memory of shared memory blocks, which the HLE services
+     * access through a single pointer.
+     * @returns an error if the range isn't all regular heap memory of this process, or if shared
+     * memory blocks created before use part of it
+     */
+    ResultCode MakeHeapContiguous(VAddr target, u32 size);
+
     ResultVal<VAddr> LinearAllocate(VAddr target, u32 size, VMAPermission perms);
     ResultCode LinearFree(VAddr target, u32 size);
 
@@ -2,7 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
+#include "common/alignment.h"
+#include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/memory.h"
@@ -11,8 +14,17 @@
 
 namespace Kernel {
 
-SharedMemory::SharedMemory(KernelSystem& kernel) : Object(kernel) {}
-SharedMemory::~SharedMemory() {}
+SharedMemory::SharedMemory(KernelSystem& kernel) : Object(kernel), kernel(kernel) {}
+SharedMemory::~SharedMemory() {
+    if (holding_region != nullptr) {
+        holding_region->Free(holding_offset, holding_size);
+        holding_region->used -= holding_size;
+    }
+    auto& heap_shared_memory = kernel.heap_shared_memory;
+    heap_shared_memory.erase(
+        std::remove(heap_shared_memory.begin(), heap_shared_memory.end(), this),
+        heap_shared_memory.end());
+}
 
 SharedPtr<SharedMemory> KernelSystem::CreateSharedMemory(Process* owner_process, u32 size,
                                                          MemoryPermission permissions,
@@ -31,44 +43,40 @@ SharedPtr<SharedMemory> KernelSystem::CreateSharedMemory(Process* owner_process,
         // We need to allocate a block from the Linear Heap ourselves.
         // We'll manually allocate some memory from the linear heap in the specified region.
         MemoryRegionInfo* memory_region = GetMemoryRegion(region);
-        auto& linheap_memory = memory_region->linear_heap_memory;
+        auto offset = memory_region->LinearAllocate(size);
 
-        ASSERT_MSG(linheap_memory->size() + size <= memory_region->size,
-                   "Not enough space in region to allocate shared memory!");
+        ASSERT_MSG(offset, "Not enough space in region to allocate shared memory!");
 
-        shared_memory->backing_block = linheap_memory;
-        shared_memory->backing_block_offset = linheap_memory->size();
-        // Allocate some memory from the end of the linear heap for this region.
-        linheap_memory->insert(linheap_memory->end(), size, 0);
+        shared_memory->backing_blocks = {{Memory::GetFCRAMPointer(*offset), size}};
+        shared_memory->holding_region = memory_region;
+        shared_memory->holding_offset = *offset;
+        shared_memory->holding_size = size;
         memory_region->used += size;
 
-        shared_memory->linear_heap_phys_address =
-            Memory::FCRAM_PADDR + memory_region->base +
-            static_cast<PAddr>(shared_memory->backing_block_offset);
+        shared_memory->linear_heap_phys_address = Memory::FCRAM_PADDR + *offset;
 
         // Increase the amount of used linear heap memory for the owner process.
         if (shared_memory->owner_process != nullptr) {
             shared_memory->owner_process->linear_heap_used += size;
         }
-
-        // Refresh the address mappings for the current process.
-        if (current_process != nullptr) {
-            current_process->vm_manager.RefreshMemoryBlockMappings(linheap_memory.get());
-        }
     } else {
         auto& vm_manager = shared_memory->owner_process->vm_manager;
         // The memory is already available and mapped in the owner process.
-        auto vma = vm_manager.FindVMA(address);
-        ASSERT_MSG(vma != vm_manager.vma_map.end(), "Invalid memory address");
-        ASSERT_MSG(vma->second.backing_block, "Backing block doesn't exist for address");
-
-        // The returned VMA might be a bigger one encompassing the desired address.
-        auto vma_offset = address - vma->first;
-        ASSERT_MSG(vma_offset + size <= vma->second.size,
-                   "Shared memory exceeds bounds of mapped block");
-
-        shared_memory->backing_block = vma->second.backing_block;
-        shared_memory->backing_block_offset = vma->second.offset + vma_offset;
+        auto backing_blocks = vm_manager.GetBackingBlocksForRange(address, size);
+        ASSERT_MSG(backing_blocks.Succeeded(), "Invalid memory address");
+        if (backing_blocks->size() > 1) {
+            // The heap is allocated in parts, which are rarely next to each other in FCRAM. The HLE
+            // services access shared memory through a single pointer, so its memory is moved to
+            // one block.
+            if (owner_process->MakeHeapContiguous(address, size).IsSuccess()) {
+                backing_blocks = vm_manager.GetBackingBlocksForRange(address, size);
+            } else {
+                LOG_WARNING(Kernel, "Shared memory {} at 0x{:08X} isn't contiguous in FCRAM",
+                            shared_memory->name, address);
+            }
+        }
+        shared_memory->backing_blocks = std::move(backing_blocks).Unwrap();
+        heap_shared_memory.push_back(shared_memory.get());
     }
 
     shared_memory->base_address = address;
@@ -76,17 +84,26 @@ SharedPtr<SharedMemory> KernelSystem::CreateSharedMemory(Process* owner_process,
 }
 
 SharedPtr<SharedMemory> KernelSystem::CreateSharedMemoryForApplet(
-    std::shared_ptr<std::vector<u8>> heap_block, u32 offset, u32 size, MemoryPermission permissions,
-    MemoryPermission other_permissions, std::string name) {
+    u32 offset, u32 size, MemoryPermission permissions, MemoryPermission other_permissions,
+    std::string name) {
     SharedPtr<SharedMemory> shared_memory(new SharedMemory(*this));
 
+    // Allocate memory in the SYSTEM region of FCRAM, where the applets run on the console
+    MemoryRegionInfo* memory_region = GetMemoryRegion(MemoryRegion::SYSTEM);
+    const u32 allocated_size = Common::AlignUp(size, Memory::PAGE_SIZE);
+    auto backing_offset = memory_region->LinearAllocate(allocated_size);
+    ASSERT_MSG(backing_offset, "Not enough space in region to allocate applet memory!");
+    memory_region->used += allocated_size;
+    shared_memory->holding_region = memory_region;
+    shared_memory->holding_offset = *backing_offset;
+    shared_memory->holding_size = allocated_size;
+
     shared_memory->owner_process = nullptr;
     shared_memory->name = std::move(name);
     shared_memory->size = size;
     shared_memory->permissions = permissions;
     shared_memory->other_permissions = other_permissions;
-    shared_memory->backing_block = heap_block;
-    shared_memory->backing_block_offset = offset;
+    shared_memory->backing_blocks = {{Memory::GetFCRAMPointer(*backing_offset), size}};
     shared_memory->base_address = Memory::HEAP_VADDR + offset;
 
     return shared_memory;
@@ -151,15 +168,21 @@ ResultCode SharedMemory::Map(Process* target_process, VAddr address, MemoryPermi
         target_address = *maybe_vaddr;
     }
 
-    // Map the memory block into the target process
-    auto result = target_process->vm_manager.MapMemoryBlock(
-        target_address, backing_block, backing_block_offset, size, MemoryState::Shared);
-    if (result.Failed()) {
-        LOG_ERROR(
-            Kernel,
-            "cannot map id={}, target_address=0x{:08X} name={}, error mapping to virtual memory",
-            GetObjectId(), target_address, name);
-        return result.Code();
+    // Map the memory blocks into the target process
+    VAddr interval_target = target_address;
+    for (const auto& [backing_memory, block_size] : backing_blocks) {
+        auto result = target_process->vm_manager.MapBackingMemory(interval_target, backing_memory,
+                                                                  block_size, MemoryState::Shared);
+        if (result.Failed()) {
+            LOG_ERROR(Kernel,
+                      "cannot map id={}, target_address=0x{:08X} name={}, error mapping to "
+                      "virtual memory",
+                      GetObjectId(), target_address, name);
+            target_process->vm_manager.UnmapRange(target_address,
+                                                  interval_target - target_address);
+            return result.Code();
+        }
+        interval_target += block_size;
     }
 
     return target_process->vm_manager.ReprotectRange(target_address, size,
@@ -179,7 +202,13 @@ VMAPermission SharedMemory::ConvertPermissions(MemoryPermission permission) {
 };
 
 u8* SharedMemory::GetPointer(u32 offset) {
-    return backing_block->data() + backing_block_offset + offset;
+    // The callers access the whole block from the pointer, which would run into unrelated memory
+    // past the first part of a discontinuous block
+    ASSERT_MSG(backing_blocks.size() == 1, "GetPointer on discontinuous SharedMemory name={}",
+               name);
+    ASSERT_MSG(offset < backing_blocks[0].second,
+               "Offset 0x{:X} is outside of SharedMemory name={}", offset, name);
+    return backing_blocks[0].first + offset;
 }
 
 } // namespace Kernel
@@ -5,6 +5,8 @@
 #pragma once
 
 #include <string>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/process.h"
@@ -64,10 +66,14 @@ public:
     /// Physical address of the shared memory block in the linear heap if no address was specified
     /// during creation.
     PAddr linear_heap_phys_address;
-    /// Backing memory for this shared memory block.
-    std::shared_ptr<std::vector<u8>> backing_block;
-    /// Offset into the backing block for this shared memory.
-    std::size_t backing_block_offset;
+    /// Host memory backing this shared memory block, as blocks of contiguous memory in order.
+    std::vector<std::pair<u8*, u32>> backing_blocks;
+    /// Region of the FCRAM the kernel allocated for this block, which is returned to it when the
+    /// block is destroyed. Null if the block is memory the owner process had already mapped.
+    MemoryRegionInfo* holding_region = nullptr;
+    /// FCRAM offset and size of the memory allocated for this block.
+    u32 holding_offset = 0;
+    u32 holding_size = 0;
     /// Size of the memory block. Page-aligned.
     u32 size;
     /// Permission restrictions applied to the process which created the block.
@@ -82,6 +88,7 @@ private:
     ~SharedMemory() override;
 
     friend class KernelSystem;
+    KernelSystem& kernel;
 };
 
 } // namespace Kernel
@@ -17,6 +17,10 @@
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
+namespace Core {
+struct KernelState;
+}
+
 namespace Kernel {
 
 class Mutex;
@@ -123,7 +127,7 @@ private:
 
     u32 next_thread_id = 1;
     SharedPtr<Thread> current_thread;
-    Common::ThreadQueueList<Thread*, ThreadPrioLowest + 1> ready_queue;
+    Common::ThreadQueueList<Thread, ThreadPrioLowest + 1> ready_queue;
     std::unordered_map<u64, Thread*> wakeup_callback_table;
 
     /// Event type for the thread wake up event
@@ -134,9 +138,10 @@ private:
 
     friend class Thread;
     friend class KernelSystem;
+    friend struct Core::KernelState;
 };
 
-class Thread final : public WaitObject {
+class Thread final : public WaitObject, public Common::ThreadQueueListNode<Thread> {
 public:
     std::string GetName() const override {
         return name;
@@ -9,6 +9,10 @@
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/wait_object.h"
 
+namespace Core {
+struct KernelState;
+}
+
 namespace Kernel {
 
 class TimerManager {
@@ -96,6 +100,7 @@ private:
     TimerManager& timer_manager;
 
     friend class KernelSystem;
+    friend struct Core::KernelState;
 };
 
 } // namespace Kernel
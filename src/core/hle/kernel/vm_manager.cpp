@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <iterator>
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
@@ -247,15 +248,44 @@ ResultCode VMManager::ReprotectRange(VAddr target, u32 size, VMAPermission new_p
     return RESULT_SUCCESS;
 }
 
-void VMManager::RefreshMemoryBlockMappings(const std::vector<u8>* block) {
-    // If this ever proves to have a noticeable performance impact, allow users of the function to
-    // specify a specific range of addresses to limit the scan to.
-    for (const auto& p : vma_map) {
-        const VirtualMemoryArea& vma = p.second;
-        if (block == vma.backing_block.get()) {
-            UpdatePageTableForVMA(vma);
+ResultVal<std::vector<std::pair<u8*, u32>>> VMManager::GetBackingBlocksForRange(
+    VAddr address, u32 size) const {
+    std::vector<std::pair<u8*, u32>> backing_blocks;
+    const VAddr end = address + size;
+    VAddr interval_target = address;
+    while (interval_target != end) {
+        const auto vma = FindVMA(interval_target);
+        if (vma == vma_map.end()) {
+            return ERR_INVALID_ADDRESS;
+        }
+
+        const VirtualMemoryArea& area = vma->second;
+        const u32 offset = interval_target - area.base;
+        u8* backing_memory;
+        switch (area.type) {
+        case VMAType::AllocatedMemoryBlock:
+            backing_memory = area.backing_block->data() + area.offset + offset;
+            break;
+        case VMAType::BackingMemory:
+            backing_memory = area.backing_memory + offset;
+            break;
+        default:
+            LOG_ERROR(Kernel, "Range 0x{:08X}+0x{:X} isn't backed by memory at 0x{:08X}", address,
+                      size, interval_target);
+            return ERR_INVALID_ADDRESS_STATE;
+        }
+
+        const u32 interval_size = std::min(end, area.base + area.size) - interval_target;
+        if (!backing_blocks.empty() &&
+            backing_blocks.back().first + backing_blocks.back().second == backing_memory) {
+            backing_blocks.back().second += interval_size;
+        } else {
+            backing_blocks.emplace_back(backing_memory, interval_size);
         }
+        interval_target += interval_size;
     }
+
+    return MakeResult(std::move(backing_blocks));
 }
 
 void VMManager::LogLayout(Log::Level log_level) const {
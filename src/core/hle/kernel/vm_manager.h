@@ -6,6 +6,7 @@
 
 #include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/result.h"
@@ -205,10 +206,12 @@ public:
     ResultCode ReprotectRange(VAddr target, u32 size, VMAPermission new_perms);
 
     /**
-     * Scans all VMAs and updates the page table range of any that use the given vector as backing
-     * memory. This should be called after any operation that causes reallocation of the vector.
+     * Gets the host memory backing a range of addresses, as blocks of contiguous memory in
+     * address order.
+     * @returns the blocks, or an error if any of the range is free or not backed by memory
      */
-    void RefreshMemoryBlockMappings(const std::vector<u8>* block);
+    ResultVal<std::vector<std::pair<u8*, u32>>> GetBackingBlocksForRange(VAddr address,
+                                                                      u32 size) const;
 
     /// Dumps the address space layout to the log, for debugging
     void LogLayout(Log::Level log_level) const;
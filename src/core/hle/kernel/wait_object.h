@@ -9,6 +9,10 @@
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 
+namespace Core {
+struct KernelState;
+}
+
 namespace Kernel {
 
 class Thread;
@@ -55,6 +59,8 @@ public:
 private:
     /// Threads waiting for this object to become available
     std::vector<SharedPtr<Thread>> waiting_threads;
+
+    friend struct Core::KernelState;
 };
 
 // Specialization of DynamicObjectCast for WaitObjects
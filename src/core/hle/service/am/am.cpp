@@ -3,15 +3,20 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cinttypes>
 #include <cstddef>
 #include <cstring>
+#include <thread>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/threadsafe_queue.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
@@ -76,13 +81,115 @@ struct TicketInfo {
 
 static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong");
 
-class CIAFile::DecryptionState {
+/**
+ * Decryption and hashing of each content, and the thread writing the contents to their files. The
+ * thread calling Write decrypts and hashes a chunk while the writer thread writes the previous
+ * ones. The chunks cycle between the two threads through a fixed set of buffers, bounding how far
+ * decryption gets ahead of the writes.
+ */
+class CIAFile::ContentState {
 public:
-    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    static constexpr std::size_t BufferSize = 0x100000;
+    static constexpr std::size_t NumBuffers = 4;
+
+    struct Buffer {
+        std::vector<u8> data;
+        std::size_t size = 0;
+        u16 content_index = 0;
+        bool last = false; ///< Whether this completes the content, whose file is then closed
+    };
+
+    ~ContentState() {
+        Finish();
+    }
+
+    /// Starts the writer thread, which writes each content to the file at its path
+    void Start(std::vector<std::string> paths) {
+        for (Buffer& buffer : buffers) {
+            buffer.data.resize(BufferSize);
+            free_buffers.Push(&buffer);
+        }
+        files.resize(paths.size());
+        written.resize(paths.size());
+        this->paths = std::move(paths);
+        thread = std::thread(&ContentState::WriteLoop, this);
+    }
+
+    /// Waits for a buffer the writer thread is done with
+    Buffer& GetBuffer() {
+        return *free_buffers.PopWait();
+    }
+
+    /// Queues a buffer returned by GetBuffer to be written
+    void Queue(Buffer& buffer) {
+        queued_buffers.Push(&buffer);
+    }
+
+    /// Returns whether a content file failed to open or to be written
+    bool HasFailed() const {
+        return failed;
+    }
+
+    /**
+     * Waits for the queued buffers to be written, and stops the writer thread
+     * @returns false if a content file failed to open or to be written
+     */
+    bool Finish() {
+        if (thread.joinable()) {
+            queued_buffers.Push(nullptr);
+            thread.join();
+        }
+        return !failed;
+    }
+
+    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> decryption;
+    std::vector<CryptoPP::SHA256> hash;
+
+private:
+    void WriteLoop() {
+        while (Buffer* buffer = queued_buffers.PopWait()) {
+            if (!failed) {
+                Write(*buffer);
+            }
+            free_buffers.Push(buffer);
+        }
+        for (FileUtil::IOFile& file : files) {
+            file.Close();
+        }
+    }
+
+    void Write(const Buffer& buffer) {
+        const u16 index = buffer.content_index;
+        // Kept open until the content is complete, as a CIA is written in many small chunks
+        FileUtil::IOFile& file = files[index];
+        if (!file.IsOpen()) {
+            file = FileUtil::IOFile(paths[index], written[index] ? "ab" : "wb");
+        }
+        if (!file.IsOpen() || file.WriteBytes(buffer.data.data(), buffer.size) != buffer.size) {
+            LOG_ERROR(Service_AM, "Failed to write content {} to {}", index, paths[index]);
+            failed = true;
+            return;
+        }
+        written[index] += buffer.size;
+        if (buffer.last) {
+            file.Close();
+        }
+    }
+
+    std::array<Buffer, NumBuffers> buffers;
+    Common::SPSCQueue<Buffer*> free_buffers;
+    Common::SPSCQueue<Buffer*> queued_buffers;
+    std::thread thread;
+    std::atomic<bool> failed{false};
+
+    // Only used by the writer thread
+    std::vector<std::string> paths;
+    std::vector<FileUtil::IOFile> files;
+    std::vector<u64> written;
 };
 
 CIAFile::CIAFile(Service::FS::MediaType media_type)
-    : media_type(media_type), decryption_state(std::make_unique<DecryptionState>()) {}
+    : media_type(media_type), content_state(std::make_unique<ContentState>()) {}
 
 CIAFile::~CIAFile() {
     Close();
@@ -131,16 +238,25 @@ ResultCode CIAFile::WriteTitleMetadata() {
 
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
+    content_state->hash.resize(content_count);
 
     if (auto title_key = container.GetTicket().GetTitleKey()) {
-        decryption_state->content.resize(content_count);
+        content_state->decryption.resize(content_count);
         for (std::size_t i = 0; i < content_count; ++i) {
             auto ctr = tmd.GetContentCTRByIndex(i);
-            decryption_state->content[i].SetKeyWithIV(title_key->data(), title_key->size(),
+            content_state->decryption[i].SetKeyWithIV(title_key->data(), title_key->size(),
                                                       ctr.data());
         }
     }
 
+    // Since the incoming TMD has already been written, we can use GetTitleContentPath to get the
+    // content paths to write to.
+    std::vector<std::string> content_paths(content_count);
+    for (u16 i = 0; i < content_count; i++) {
+        content_paths[i] = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
+    }
+    content_state->Start(std::move(content_paths));
+
     install_state = CIAInstallState::TMDLoaded;
 
     return RESULT_SUCCESS;
@@ -150,8 +266,13 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
     // Data is not being buffered, so we have to keep track of how much of each <ID>.app
     // has been written since we might get a written buffer which contains multiple .app
     // contents or only part of a larger .app's contents.
+    // The writes run on the writer thread, so their failures are reported by the next write
+    if (content_state->HasFailed())
+        return FileSys::ERROR_INSUFFICIENT_SPACE;
+
     u64 offset_max = offset + length;
-    for (int i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
+    const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
+    for (u16 i = 0; i < tmd.GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(i)) {
             // The size, minimum unwritten offset, and maximum unwritten offset of this content
             u64 size = container.GetContentSize(i);
@@ -165,31 +286,46 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // Figure out how much of this content ID we have just recieved/can write out
             u64 available_to_write = std::min(offset_max, range_max) - range_min;
+            if (available_to_write == 0)
+                continue;
 
-            // Since the incoming TMD has already been written, we can use GetTitleContentPath
-            // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            FileUtil::IOFile file(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
-                                  content_written[i] ? "ab" : "wb");
-
-            if (!file.IsOpen())
-                return FileSys::ERROR_INSUFFICIENT_SPACE;
-
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-
-            if (tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
-                FileSys::TMDContentTypeFlag::Encrypted) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+            // Decrypt straight from the written buffer into the buffers of the writer thread
+            const u8* content_data = buffer + (range_min - offset);
+            const bool encrypted =
+                tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted;
+            for (u64 done = 0; done < available_to_write;) {
+                ContentState::Buffer& chunk = content_state->GetBuffer();
+                chunk.size = static_cast<std::size_t>(
+                    std::min<u64>(available_to_write - done, ContentState::BufferSize));
+                if (encrypted) {
+                    content_state->decryption[i].ProcessData(chunk.data.data(),
+                                                             content_data + done, chunk.size);
+                } else {
+                    std::memcpy(chunk.data.data(), content_data + done, chunk.size);
+                }
+                content_state->hash[i].Update(chunk.data.data(), chunk.size);
+                done += chunk.size;
+                chunk.content_index = i;
+                chunk.last = content_written[i] + done == size;
+                content_state->Queue(chunk);
             }
 
-            file.WriteBytes(temp.data(), temp.size());
-
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
             content_written[i] += available_to_write;
             LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", available_to_write, i,
                       content_written[i]);
+
+            if (content_written[i] == size) {
+                std::array<u8, CryptoPP::SHA256::DIGESTSIZE> hash;
+                content_state->hash[i].Final(hash.data());
+                if (hash != tmd.GetContentHashByIndex(i)) {
+                    LOG_ERROR(Service_AM, "Content {} doesn't match the hash in the TMD", i);
+                    content_corrupted = true;
+                    return ResultCode(ErrCodes::InvalidCIAHeader, ErrorModule::AM,
+                                      ErrorSummary::InvalidArgument, ErrorLevel::Permanent);
+                }
+            }
         }
     }
 
@@ -276,7 +412,7 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
-    bool complete = true;
+    bool complete = content_state->Finish() && !content_corrupted;
     for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
             complete = false;
@@ -286,7 +422,7 @@ bool CIAFile::Close() const {
     if (!complete) {
         LOG_ERROR(Service_AM, "CIAFile closed prematurely, aborting install...");
         FileUtil::DeleteDir(GetTitlePath(media_type, container.GetTitleMetadata().GetTitleID()));
-        return true;
+        return false;
     }
 
     // Clean up older content data if we installed newer content on top
@@ -325,6 +461,62 @@ bool CIAFile::Close() const {
 
 void CIAFile::Flush() const {}
 
+/**
+ * Reads a file sequentially on a separate thread, so that reading the next chunk of a CIA overlaps
+ * with decrypting the current one, while CIAFile writes the previous ones. Chunks cycle between the
+ * two threads through a fixed set of buffers, bounding how far the reader gets ahead.
+ */
+class ReadAheadFile {
+public:
+    static constexpr std::size_t ChunkSize = 0x100000;
+    static constexpr std::size_t NumChunks = 4;
+
+    struct Chunk {
+        std::vector<u8> data;
+        std::size_t size = 0;
+    };
+
+    explicit ReadAheadFile(FileUtil::IOFile& file) : file(file) {
+        for (Chunk& chunk : chunks) {
+            chunk.data.resize(ChunkSize);
+            free_chunks.Push(&chunk);
+        }
+        thread = std::thread(&ReadAheadFile::ReadLoop, this);
+    }
+
+    ~ReadAheadFile() {
+        // Stops the reader once it is done with the free chunks queued before
+        free_chunks.Push(nullptr);
+        thread.join();
+    }
+
+    /// Waits for the next chunk of the file, whose size is 0 at the end of the file or on errors
+    const Chunk& Next() {
+        return *read_chunks.PopWait();
+    }
+
+    /// Hands back the chunk returned by Next, to be filled again
+    void Release(const Chunk& chunk) {
+        free_chunks.Push(const_cast<Chunk*>(&chunk));
+    }
+
+private:
+    void ReadLoop() {
+        while (Chunk* chunk = free_chunks.PopWait()) {
+            chunk->size = file.ReadBytes(chunk->data.data(), chunk->data.size());
+            read_chunks.Push(chunk);
+            if (chunk->size == 0)
+                break;
+        }
+    }
+
+    FileUtil::IOFile& file;
+    std::array<Chunk, NumChunks> chunks;
+    Common::SPSCQueue<Chunk*> free_chunks;
+    Common::SPSCQueue<Chunk*> read_chunks;
+    std::thread thread;
+};
+
 InstallStatus InstallCIA(const std::string& path,
                          std::function<ProgressCallback>&& update_callback) {
     LOG_INFO(Service_AM, "Installing {}...", path);
@@ -354,15 +546,23 @@ InstallStatus InstallCIA(const std::string& path,
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
 
-        std::array<u8, 0x10000> buffer;
+        const std::size_t file_size = file.GetSize();
+        ReadAheadFile read_ahead(file);
         std::size_t total_bytes_read = 0;
-        while (total_bytes_read != file.GetSize()) {
-            std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
+        while (total_bytes_read != file_size) {
+            const ReadAheadFile::Chunk& chunk = read_ahead.Next();
+            if (chunk.size == 0) {
+                LOG_ERROR(Service_AM, "Failed to read {} past offset {:x}", path,
+                          total_bytes_read);
+                return InstallStatus::ErrorAborted;
+            }
+            const std::size_t bytes_read = chunk.size;
             auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            static_cast<u8*>(buffer.data()));
+                                            chunk.data.data());
+            read_ahead.Release(chunk);
 
             if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
+                update_callback(total_bytes_read, file_size);
             if (result.Failed()) {
                 LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
                           result.Code().raw);
@@ -370,7 +570,10 @@ InstallStatus InstallCIA(const std::string& path,
             }
             total_bytes_read += bytes_read;
         }
-        installFile.Close();
+        if (!installFile.Close()) {
+            LOG_ERROR(Service_AM, "CIA file {} is incomplete", path);
+            return InstallStatus::ErrorAborted;
+        }
 
         LOG_INFO(Service_AM, "Installed {} successfully.", path);
         return InstallStatus::Success;
@@ -1112,11 +1315,13 @@ public:
         : file(std::move(file)), file_offset(offset), file_size(size) {}
 
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override {
+        file->WaitForPendingRead();
         return file->backend->Read(offset + file_offset, length, buffer);
     }
 
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override {
+        file->WaitForPendingRead();
         return file->backend->Write(offset + file_offset, length, flush, buffer);
     }
 
@@ -84,16 +84,18 @@ private:
     CIAInstallState install_state = CIAInstallState::InstallStarted;
 
     // How much has been written total, CIAContainer for the installing CIA, buffer of all data
-    // prior to content data, how much of each content index has been written, and where the CIA
-    // is being installed to
+    // prior to content data, how much of each content index has been written, whether a content
+    // didn't match its hash, and where the CIA is being installed to
     u64 written = 0;
     FileSys::CIAContainer container;
     std::vector<u8> data;
     std::vector<u64> content_written;
+    bool content_corrupted = false;
     Service::FS::MediaType media_type;
 
-    class DecryptionState;
-    std::unique_ptr<DecryptionState> decryption_state;
+    // Decryption and hashing of each content, and the thread writing them to their files
+    class ContentState;
+    std::unique_ptr<ContentState> content_state;
 };
 
 /**
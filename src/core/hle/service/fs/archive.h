@@ -10,6 +10,7 @@
 #include <vector>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
+#include "common/thread_pool.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/directory.h"
@@ -228,9 +229,23 @@ public:
     /// Registers a new NCCH file with the SelfNCCH archive factory
     void RegisterSelfNCCH(Loader::AppLoader& app_loader);
 
+    /// Returns the thread on which the files read from their backends
+    Common::ThreadPool& GetIOThread() {
+        return io_thread;
+    }
+
+    /// Waits for the tasks submitted to the I/O thread so far to be done
+    void WaitForIOThread() {
+        // The thread runs the tasks in submission order, the last one is done after the others
+        io_thread.Submit([] {}).wait();
+    }
+
 private:
     Core::System& system;
 
+    /// A single thread, so that the reads of a backend never run concurrently
+    Common::ThreadPool io_thread{1, "FS I/O"};
+
     /**
      * Registers an Archive type, instances of which can later be opened using its IdCode.
      * @param factory File system backend interface to the archive
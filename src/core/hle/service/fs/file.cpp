@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <memory>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
@@ -11,7 +13,9 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/file.h"
+#include "core/memory.h"
 
 namespace Service::FS {
 
@@ -33,6 +37,10 @@ File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend
     RegisterHandlers(functions);
 }
 
+File::~File() {
+    WaitForPendingRead();
+}
+
 void File::Read(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0802, 3, 2);
     u64 offset = rp.Pop<u64>();
@@ -40,6 +48,8 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     auto& buffer = rp.PopMappedBuffer();
     LOG_TRACE(Service_FS, "Read {}: offset=0x{:x} length=0x{:08X}", GetName(), offset, length);
 
+    WaitForPendingRead();
+
     const FileSessionSlot* file = GetSessionData(ctx.Session());
 
     if (file->subfile && length > file->size) {
@@ -56,27 +66,72 @@ void File::Read(Kernel::HLERequestContext& ctx) {
                   offset, length, backend->GetSize());
     }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
+    if (length > buffer.GetSize()) {
+        LOG_ERROR(Service_FS, "Reading 0x{:08X} bytes into a buffer of 0x{:08X} bytes", length,
+                  buffer.GetSize());
+        length = static_cast<u32>(buffer.GetSize());
+    }
 
-    std::vector<u8> data(length);
-    ResultVal<std::size_t> read = backend->Read(offset, data.size(), data.data());
-    if (read.Failed()) {
-        rb.Push(read.Code());
+    // The read runs on the I/O thread while the client thread waits for the emulated delay, and
+    // goes straight into the guest memory. The thread is woken once both are done.
+    auto blocks = buffer.GetBackingBlocks(0, length);
+    if (blocks.Failed()) {
+        IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
+        rb.Push(blocks.Code());
         rb.Push<u32>(0);
-    } else {
-        buffer.Write(data.data(), 0, *read);
-        rb.Push(RESULT_SUCCESS);
-        rb.Push<u32>(static_cast<u32>(*read));
+        rb.PushMappedBuffer(buffer);
+        return;
     }
-    rb.PushMappedBuffer(buffer);
+
+    auto read = std::make_shared<ResultVal<std::size_t>>();
+    pending_read = system.ArchiveManager()
+                       .GetIOThread()
+                       .Submit([backend = backend.get(), offset,
+                                blocks = std::move(blocks).Unwrap(), read] {
+                           std::size_t total = 0;
+                           for (const auto& [block, block_size] : blocks) {
+                               auto block_read = backend->Read(offset + total, block_size, block);
+                               if (block_read.Failed()) {
+                                   *read = block_read.Code();
+                                   return;
+                               }
+                               total += *block_read;
+                               if (*block_read != block_size)
+                                   break;
+                           }
+                           *read = MakeResult<std::size_t>(total);
+                       })
+                       .share();
 
     std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
-    ctx.SleepClientThread(system.Kernel().GetThreadManager().GetCurrentThread(), "file::read",
-                          read_timeout_ns,
-                          [](Kernel::SharedPtr<Kernel::Thread> thread,
-                             Kernel::HLERequestContext& ctx, Kernel::ThreadWakeupReason reason) {
-                              // Nothing to do here
-                          });
+    ctx.SleepClientThread(
+        system.Kernel().GetThreadManager().GetCurrentThread(), "file::read", read_timeout_ns,
+        [pending_read = pending_read, read, buffer,
+         length](Kernel::SharedPtr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                 Kernel::ThreadWakeupReason reason) {
+            // Only blocks when the host is slower than the emulated delay
+            pending_read.wait();
+
+            // Surfaces the GPU cached from the buffer during the delay are stale now
+            Memory::RasterizerFlushVirtualRegion(buffer.GetAddress(), length,
+                                                 Memory::FlushMode::Invalidate);
+
+            IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+            if (read->Failed()) {
+                rb.Push(read->Code());
+                rb.Push<u32>(0);
+            } else {
+                rb.Push(RESULT_SUCCESS);
+                rb.Push<u32>(static_cast<u32>(**read));
+            }
+            rb.PushMappedBuffer(buffer);
+        });
+}
+
+void File::WaitForPendingRead() {
+    if (pending_read.valid()) {
+        pending_read.wait();
+    }
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
@@ -88,6 +143,8 @@ void File::Write(Kernel::HLERequestContext& ctx) {
     LOG_TRACE(Service_FS, "Write {}: offset=0x{:x} length={}, flush=0x{:x}", GetName(), offset,
               length, flush);
 
+    WaitForPendingRead();
+
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
 
     const FileSessionSlot* file = GetSessionData(ctx.Session());
@@ -138,6 +195,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
     }
 
     file->size = size;
+    WaitForPendingRead();
     backend->SetSize(size);
     rb.Push(RESULT_SUCCESS);
 }
@@ -150,6 +208,7 @@ void File::Close(Kernel::HLERequestContext& ctx) {
         LOG_WARNING(Service_FS, "Closing File backend but {} clients still connected",
                     connected_sessions.size());
 
+    WaitForPendingRead();
     backend->Close();
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
@@ -168,6 +227,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    WaitForPendingRead();
     backend->Flush();
     rb.Push(RESULT_SUCCESS);
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <future>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/service/service.h"
@@ -27,7 +28,7 @@ class File final : public ServiceFramework<File, FileSessionSlot> {
 public:
     File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
          const FileSys::Path& path);
-    ~File() = default;
+    ~File();
 
     std::string GetName() const {
         return "Path: " + path.DebugStr();
@@ -47,6 +48,9 @@ public:
     // OpenSubFile.
     std::size_t GetSessionFileSize(Kernel::SharedPtr<Kernel::ServerSession> session);
 
+    /// Waits for the read running on the I/O thread, before the backend is used for anything else
+    void WaitForPendingRead();
+
 private:
     void Read(Kernel::HLERequestContext& ctx);
     void Write(Kernel::HLERequestContext& ctx);
@@ -60,6 +64,9 @@ private:
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
     Core::System& system;
+
+    /// Read of the backend running on the I/O thread, if any
+    std::shared_future<void> pending_read;
 };
 
 } // namespace Service::FS
@@ -113,6 +113,9 @@ const std::array<ServiceModuleInfo, 40> service_module_map{
      {"PS", 0x00040130'00003102, nullptr},
      {"SPI", 0x00040130'00002302, nullptr}}};
 
+/// Number of requests handled by the HLE services, only changed from the CPU thread
+static u64 num_handled_requests = 0;
+
 /**
  * Creates a function string for logging, complete with the name (or header code, depending
  * on what's passed in) the port name, and all the cmd_buff arguments.
@@ -197,6 +200,7 @@ void ServiceFrameworkBase::HandleSyncRequest(SharedPtr<ServerSession> server_ses
     context.PopulateFromIncomingCommandBuffer(cmd_buf, *current_process);
 
     LOG_TRACE(Service, "{}", MakeFunctionString(info->name, GetServiceName().c_str(), cmd_buf));
+    ++num_handled_requests;
     handler_invoker(this, info->handler_callback, context);
 
     ASSERT(thread->status == Kernel::ThreadStatus::Running ||
@@ -240,4 +244,8 @@ void Init(Core::System& core) {
     LOG_DEBUG(Service, "initialized OK");
 }
 
+u64 GetNumHandledRequests() {
+    return num_handled_requests;
+}
+
 } // namespace Service
@@ -186,6 +186,12 @@ private:
 /// Initialize ServiceManager
 void Init(Core::System& system);
 
+/**
+ * Returns the number of requests the HLE services handled since the emulator started. The state of
+ * the services may have changed when it did.
+ */
+u64 GetNumHandledRequests();
+
 struct ServiceModuleInfo {
     std::string name;
     u64 title_id;
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <cryptopp/aes.h>
@@ -72,13 +73,21 @@ struct KeySlot {
     }
 
     void GenerateNormalKey() {
-        if (x && y) {
-            normal = Lrot128(Add128(Xor128(Lrot128(*x, 2), *y), generator_constant), 87);
+        if (y) {
+            normal = DeriveNormalKey(*y);
         } else {
             normal = {};
         }
     }
 
+    /// The normal key the slot would have with the given KeyY
+    std::optional<AESKey> DeriveNormalKey(const AESKey& key_y) const {
+        if (!x) {
+            return {};
+        }
+        return Lrot128(Add128(Xor128(Lrot128(*x, 2), key_y), generator_constant), 87);
+    }
+
     void Clear() {
         x.reset();
         y.reset();
@@ -88,6 +97,9 @@ struct KeySlot {
 
 std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
 std::array<std::optional<AESKey>, 6> common_key_y_slots;
+// Guards the key slots, as games are loaded on the game list worker while the emulation runs.
+// Recursive, as InitKeys loads the keys of the native firmware through NCCHArchive.
+std::recursive_mutex key_slots_mutex;
 
 enum class FirmwareType : u32 {
     ARM9 = 0,  // uses NDMA
@@ -441,6 +453,7 @@ void LoadPresetKeys() {
 } // namespace
 
 void InitKeys() {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
     static bool initialized = false;
     if (initialized)
         return;
@@ -452,27 +465,41 @@ void InitKeys() {
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
     key_slots.at(slot_id).SetKeyX(key);
 }
 
 void SetKeyY(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
     key_slots.at(slot_id).SetKeyY(key);
 }
 
 void SetNormalKey(std::size_t slot_id, const AESKey& key) {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
     key_slots.at(slot_id).SetNormalKey(key);
 }
 
 bool IsNormalKeyAvailable(std::size_t slot_id) {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
     return key_slots.at(slot_id).normal.has_value();
 }
 
 AESKey GetNormalKey(std::size_t slot_id) {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
     return key_slots.at(slot_id).normal.value_or(AESKey{});
 }
 
-void SelectCommonKeyIndex(u8 index) {
-    key_slots[KeySlotID::TicketCommonKey].SetKeyY(common_key_y_slots.at(index));
+std::optional<AESKey> DeriveNormalKey(std::size_t slot_id, const AESKey& key_y) {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
+    return key_slots.at(slot_id).DeriveNormalKey(key_y);
+}
+
+std::optional<AESKey> GetCommonKey(u8 index) {
+    std::lock_guard<std::recursive_mutex> lock(key_slots_mutex);
+    if (index >= common_key_y_slots.size() || !common_key_y_slots[index]) {
+        return {};
+    }
+    return key_slots[KeySlotID::TicketCommonKey].DeriveNormalKey(*common_key_y_slots[index]);
 }
 
 } // namespace AES
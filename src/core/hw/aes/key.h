@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <optional>
 #include "common/common_types.h"
 
 namespace HW {
@@ -48,7 +49,18 @@ void SetNormalKey(std::size_t slot_id, const AESKey& key);
 bool IsNormalKeyAvailable(std::size_t slot_id);
 AESKey GetNormalKey(std::size_t slot_id);
 
-void SelectCommonKeyIndex(u8 index);
+/**
+ * Derives the normal key a slot would have with the given KeyY, without changing the slot, so
+ * that files can be decrypted from several threads at once.
+ * @return The normal key, or std::nullopt if the KeyX of the slot is missing
+ */
+std::optional<AESKey> DeriveNormalKey(std::size_t slot_id, const AESKey& key_y);
+
+/**
+ * Derives the normal key decrypting the title keys of tickets, from the common KeyY at index.
+ * @return The normal key, or std::nullopt if the keys are missing
+ */
+std::optional<AESKey> GetCommonKey(u8 index);
 
 } // namespace AES
 } // namespace HW
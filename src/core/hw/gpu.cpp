@@ -2,26 +2,28 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <cstring>
 #include <numeric>
 #include <type_traits>
 #include "common/alignment.h"
-#include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
-#include "common/vector_math.h"
+#include "core/core.h"
 #include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
+#include "core/hw/gpu_transfer.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
+#ifdef ENABLE_SCRIPTING
+#include "core/rpc/rpc_server.h"
+#endif
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
-#include "video_core/utils.h"
 #include "video_core/video_core.h"
 
 namespace GPU {
@@ -32,6 +34,12 @@ Regs g_regs;
 const u64 frame_ticks = static_cast<u64>(BASE_CLOCK_RATE_ARM11 / SCREEN_REFRESH_RATE);
 /// Event id for CoreTiming
 static CoreTiming::EventType* vblank_event;
+/// Event ids for CoreTiming, completing the work of the GPU thread on the CPU thread
+static CoreTiming::EventType* memory_fill_event;
+static CoreTiming::EventType* display_transfer_event;
+static CoreTiming::EventType* command_list_event;
+static CoreTiming::EventType* interrupt_event;
+static CoreTiming::EventType* mark_region_cached_event;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -47,29 +55,6 @@ inline void Read(T& var, const u32 raw_addr) {
     var = g_regs[addr / 4];
 }
 
-static Math::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
-
-    case Regs::PixelFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
-
-    case Regs::PixelFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
-    case Regs::PixelFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
-    case Regs::PixelFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
-
-    default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", static_cast<u32>(input_format));
-        return {0, 0, 0, 0};
-    }
-}
-
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
 
@@ -103,27 +88,7 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     Memory::RasterizerInvalidateRegion(config.GetStartAddress(),
                                        config.GetEndAddress() - config.GetStartAddress());
 
-    if (config.fill_24bit) {
-        // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
-    } else if (config.fill_32bit) {
-        // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
-    } else {
-        // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
-    }
+    SoftwareMemoryFill(config, start, end);
 }
 
 static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
@@ -193,113 +158,7 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Math::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                Math::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                Math::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Math::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Math::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
-
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB565:
-                Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB5A1:
-                Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGBA4:
-                Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
-
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
-        }
-    }
+    SoftwareDisplayTransfer(config, src_pointer, dst_pointer);
 }
 
 static void TextureCopy(const Regs::DisplayTransferConfig& config) {
@@ -360,28 +219,67 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
                                                       : Memory::RasterizerInvalidateRegion;
     FlushInvalidate_fn(config.GetPhysicalOutputAddress(), static_cast<u32>(contiguous_output_size));
 
-    u32 remaining_input = input_width;
-    u32 remaining_output = output_width;
-    while (remaining_size > 0) {
-        u32 copy_size = std::min({remaining_input, remaining_output, remaining_size});
+    SoftwareTextureCopy(config, src_pointer, dst_pointer);
+}
 
-        std::memcpy(dst_pointer, src_pointer, copy_size);
-        src_pointer += copy_size;
-        dst_pointer += copy_size;
+/**
+ * Runs callback on the CPU thread, which owns the registers and the interrupts: right away when
+ * called from it, or through a CoreTiming event when called from the GPU thread.
+ */
+static void RunOnCPUThread(CoreTiming::EventType* event_type, void (*callback)(u64, s64),
+                           u64 userdata) {
+    if (VideoCore::g_gpu_thread != nullptr && VideoCore::g_gpu_thread->IsCurrentThread()) {
+        CoreTiming::ScheduleEventThreadsafe(0, event_type, userdata);
+    } else {
+        callback(userdata, 0);
+    }
+}
 
-        remaining_input -= copy_size;
-        remaining_output -= copy_size;
-        remaining_size -= copy_size;
+static void SignalInterruptCallback(u64 interrupt_id, s64 cycles_late) {
+    Service::GSP::SignalInterrupt(static_cast<Service::GSP::InterruptId>(interrupt_id));
+}
 
-        if (remaining_input == 0) {
-            remaining_input = input_width;
-            src_pointer += input_gap;
-        }
-        if (remaining_output == 0) {
-            remaining_output = output_width;
-            dst_pointer += output_gap;
-        }
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id) {
+    RunOnCPUThread(interrupt_event, SignalInterruptCallback, static_cast<u64>(interrupt_id));
+}
+
+/// Userdata of the page table update: bits 0-31 hold the address, bits 32-62 the size and bit 63
+/// whether the region is now cached
+static void MarkRegionCachedCallback(u64 userdata, s64 cycles_late) {
+    Memory::RasterizerMarkRegionCached(static_cast<PAddr>(userdata),
+                                       static_cast<u32>((userdata >> 32) & 0x7FFFFFFF),
+                                       (userdata >> 63) != 0);
+}
+
+void MarkRegionCached(PAddr start, u32 size, bool cached) {
+    ASSERT(size <= 0x7FFFFFFF);
+    RunOnCPUThread(mark_region_cached_event, MarkRegionCachedCallback,
+                   static_cast<u64>(start) | (static_cast<u64>(size) << 32) |
+                       (static_cast<u64>(cached) << 63));
+}
+
+/// Userdata of the memory fill completion: bit 0 selects the filler, bit 1 signals the interrupt
+static void MemoryFillCompleted(u64 userdata, s64 cycles_late) {
+    const bool is_second_filler = (userdata & 1) != 0;
+    if ((userdata & 2) != 0) {
+        Service::GSP::SignalInterrupt(!is_second_filler ? Service::GSP::InterruptId::PSC0
+                                                        : Service::GSP::InterruptId::PSC1);
     }
+
+    // Reset "trigger" flag and set the "finish" flag
+    // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
+    auto& config = g_regs.memory_fill_config[is_second_filler];
+    config.trigger.Assign(0);
+    config.finished.Assign(1);
+}
+
+static void DisplayTransferCompleted(u64 userdata, s64 cycles_late) {
+    g_regs.display_transfer_config.trigger = 0;
+    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
+}
+
+static void CommandListCompleted(u64 userdata, s64 cycles_late) {
+    g_regs.command_processor_config.trigger = 0;
 }
 
 template <typename T>
@@ -403,63 +301,58 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX_WORKAROUND(memory_fill_config[0].trigger, 0x00004 + 0x3):
     case GPU_REG_INDEX_WORKAROUND(memory_fill_config[1].trigger, 0x00008 + 0x3): {
         const bool is_second_filler = (index != GPU_REG_INDEX(memory_fill_config[0].trigger));
-        auto& config = g_regs.memory_fill_config[is_second_filler];
+        const auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
-                }
-            }
-
-            // Reset "trigger" flag and set the "finish" flag
-            // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
-            config.trigger.Assign(0);
-            config.finished.Assign(1);
+            // The GPU thread works on a copy of the registers, which may be rewritten meanwhile
+            VideoCore::RunAsync([config, is_second_filler] {
+                MemoryFill(config);
+                LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}",
+                          config.GetStartAddress(), config.GetEndAddress());
+
+                // It seems that it won't signal interrupt if "address_start" is zero.
+                // TODO: hwtest this
+                const bool signal_interrupt = config.GetStartAddress() != 0;
+                RunOnCPUThread(memory_fill_event, MemoryFillCompleted,
+                               (is_second_filler ? 1 : 0) | (signal_interrupt ? 2 : 0));
+            });
         }
         break;
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
         const auto& config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
+            VideoCore::RunAsync([config] {
+                MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+
+                if (Pica::g_debug_context)
+                    Pica::g_debug_context->OnEvent(
+                        Pica::DebugContext::Event::IncomingDisplayTransfer, nullptr);
+
+                if (config.is_texture_copy) {
+                    TextureCopy(config);
+                    LOG_TRACE(HW_GPU,
+                              "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
+                              "{:#010X}({}+{}), flags {:#010X}",
+                              config.texture_copy.size, config.GetPhysicalInputAddress(),
+                              config.texture_copy.input_width * 16,
+                              config.texture_copy.input_gap * 16, config.GetPhysicalOutputAddress(),
+                              config.texture_copy.output_width * 16,
+                              config.texture_copy.output_gap * 16, config.flags);
+                } else {
+                    DisplayTransfer(config);
+                    LOG_TRACE(HW_GPU,
+                              "DisplayTransfer: {:#010X}({}x{})-> "
+                              "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
+                              config.GetPhysicalInputAddress(), config.input_width.Value(),
+                              config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                              config.output_width.Value(), config.output_height.Value(),
+                              static_cast<u32>(config.output_format.Value()), config.flags);
+                }
 
-            if (Pica::g_debug_context)
-                Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
-                                               nullptr);
-
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU,
-                          "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
-                          "{:#010X}({}+{}), flags {:#010X}",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
-            } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU,
-                          "DisplayTransfer: {:#010X}({}x{})-> "
-                          "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          static_cast<u32>(config.output_format.Value()), config.flags);
-            }
-
-            g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
+                RunOnCPUThread(display_transfer_event, DisplayTransferCompleted, 0);
+            });
         }
         break;
     }
@@ -468,8 +361,6 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
-
             u32* buffer = (u32*)Memory::GetPhysicalPointer(config.GetPhysicalAddress());
 
             if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
@@ -477,9 +368,11 @@ inline void Write(u32 addr, const T data) {
                                                                 config.GetPhysicalAddress());
             }
 
-            Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
-
-            g_regs.command_processor_config.trigger = 0;
+            VideoCore::RunAsync([buffer, size = config.size] {
+                MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+                Pica::CommandProcessor::ProcessCommandList(buffer, size);
+                RunOnCPUThread(command_list_event, CommandListCompleted, 0);
+            });
         }
         break;
     }
@@ -511,7 +404,10 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
-    VideoCore::g_renderer->SwapBuffers();
+    // Window events are handled by the thread which created the window
+    VideoCore::g_renderer->GetRenderWindow().PollEvents();
+    // Presenting the frame waits for the GPU thread, so it's at most one frame behind the CPU
+    VideoCore::RunSync([] { VideoCore::g_renderer->SwapBuffers(); });
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -521,6 +417,13 @@ static void VBlankCallback(u64 userdata, s64 cycles_late) {
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC0);
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC1);
 
+#ifdef ENABLE_SCRIPTING
+    // Send the watched memory of the frame to the scripts
+    if (RPC::RPCServer* rpc_server = Core::System::GetInstance().RPCServer()) {
+        rpc_server->PublishMemoryWatches();
+    }
+#endif
+
     // Reschedule recurrent event
     CoreTiming::ScheduleEvent(frame_ticks - cycles_late, vblank_event);
 }
@@ -556,6 +459,14 @@ void Init() {
     framebuffer_sub.active_fb = 0;
 
     vblank_event = CoreTiming::RegisterEvent("GPU::VBlankCallback", VBlankCallback);
+    memory_fill_event = CoreTiming::RegisterEvent("GPU::MemoryFillCompleted", MemoryFillCompleted);
+    display_transfer_event =
+        CoreTiming::RegisterEvent("GPU::DisplayTransferCompleted", DisplayTransferCompleted);
+    command_list_event =
+        CoreTiming::RegisterEvent("GPU::CommandListCompleted", CommandListCompleted);
+    interrupt_event = CoreTiming::RegisterEvent("GPU::SignalInterrupt", SignalInterruptCallback);
+    mark_region_cached_event =
+        CoreTiming::RegisterEvent("GPU::MarkRegionCached", MarkRegionCachedCallback);
     CoreTiming::ScheduleEvent(frame_ticks, vblank_event);
 
     LOG_DEBUG(HW_GPU, "initialized OK");
@@ -11,6 +11,12 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 
+namespace Service {
+namespace GSP {
+enum class InterruptId : u8;
+}
+} // namespace Service
+
 namespace GPU {
 
 constexpr float SCREEN_REFRESH_RATE = 60;
@@ -325,6 +331,18 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Signals a GPU interrupt to the application. When called from the GPU thread, the interrupt is
+ * signalled on the CPU thread as soon as possible.
+ */
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id);
+
+/**
+ * Marks a region as cached by the rasterizer in the page table, from the GPU thread. The page
+ * table belongs to the CPU thread, which updates it before it completes the work queued after.
+ */
+void MarkRegionCached(PAddr start, u32 size, bool cached);
+
 /// Initialize hardware
 void Init();
 
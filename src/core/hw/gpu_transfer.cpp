@@ -0,0 +1,292 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+#include "common/alignment.h"
+#include "common/color.h"
+#include "common/logging/log.h"
+#include "core/hw/gpu_transfer.h"
+#include "video_core/utils.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace GPU {
+
+void SoftwareMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end) {
+    // The value repeated over a block whose size is a multiple of all the value sizes, which is
+    // copied over the range
+    std::array<u8, 3 * 4 * 64> pattern;
+    std::size_t size = end - start;
+    if (config.fill_24bit) {
+        for (std::size_t i = 0; i < pattern.size(); i += 3) {
+            pattern[i] = config.value_24bit_r;
+            pattern[i + 1] = config.value_24bit_g;
+            pattern[i + 2] = config.value_24bit_b;
+        }
+        size = (size + 2) / 3 * 3;
+    } else if (config.fill_32bit) {
+        const u32 value = config.value_32bit;
+        for (std::size_t i = 0; i < pattern.size(); i += sizeof(u32)) {
+            std::memcpy(&pattern[i], &value, sizeof(u32));
+        }
+        size = size / sizeof(u32) * sizeof(u32);
+    } else {
+        const u16 value = config.value_16bit.Value();
+        for (std::size_t i = 0; i < pattern.size(); i += sizeof(u16)) {
+            std::memcpy(&pattern[i], &value, sizeof(u16));
+        }
+        size = (size + 1) / sizeof(u16) * sizeof(u16);
+    }
+
+    for (std::size_t offset = 0; offset < size; offset += pattern.size()) {
+        std::memcpy(start + offset, pattern.data(), std::min(pattern.size(), size - offset));
+    }
+}
+
+namespace {
+
+/// Offset of a pixel in a tiled image, whose rows of tiles are width pixels wide
+u32 GetTiledOffset(u32 x, u32 y, u32 width, u32 bytes_per_pixel) {
+    return VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + (y & ~7) * width * bytes_per_pixel;
+}
+
+// Horizontally adjacent pixels of a tiled image are only contiguous by pairs, starting at even
+// coordinates, so rows are copied between the layouts a pair at a time.
+
+/// Copies the first count pixels of row y of a tiled image to a linear row
+void ReadTiledRow(const u8* image, u32 y, u32 width, u32 count, u32 bytes_per_pixel, u8* dest) {
+    u32 x = 0;
+    for (; x + 2 <= count; x += 2) {
+        std::memcpy(dest + x * bytes_per_pixel,
+                    image + GetTiledOffset(x, y, width, bytes_per_pixel), 2 * bytes_per_pixel);
+    }
+    if (x < count) {
+        std::memcpy(dest + x * bytes_per_pixel,
+                    image + GetTiledOffset(x, y, width, bytes_per_pixel), bytes_per_pixel);
+    }
+}
+
+/// Copies a linear row of count pixels to the row y of a tiled image
+void WriteTiledRow(u8* image, u32 y, u32 width, u32 count, u32 bytes_per_pixel,
+                   const u8* source) {
+    u32 x = 0;
+    for (; x + 2 <= count; x += 2) {
+        std::memcpy(image + GetTiledOffset(x, y, width, bytes_per_pixel),
+                    source + x * bytes_per_pixel, 2 * bytes_per_pixel);
+    }
+    if (x < count) {
+        std::memcpy(image + GetTiledOffset(x, y, width, bytes_per_pixel),
+                    source + x * bytes_per_pixel, bytes_per_pixel);
+    }
+}
+
+void DecodePixels(Regs::PixelFormat format, const u8* source, std::size_t count,
+                  Math::Vec4<u8>* dest) {
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse4_1)
+        i = DecodePixelsSSE41(format, source, count, dest);
+#endif
+
+    const auto decode_with = [&](auto decode, std::size_t bytes_per_pixel) {
+        for (; i < count; ++i) {
+            dest[i] = decode(source + i * bytes_per_pixel);
+        }
+    };
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        decode_with(Color::DecodeRGBA8, 4);
+        break;
+    case Regs::PixelFormat::RGB8:
+        decode_with(Color::DecodeRGB8, 3);
+        break;
+    case Regs::PixelFormat::RGB565:
+        decode_with(Color::DecodeRGB565, 2);
+        break;
+    case Regs::PixelFormat::RGB5A1:
+        decode_with(Color::DecodeRGB5A1, 2);
+        break;
+    case Regs::PixelFormat::RGBA4:
+        decode_with(Color::DecodeRGBA4, 2);
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", static_cast<u32>(format));
+        std::fill(dest, dest + count, Math::Vec4<u8>{0, 0, 0, 0});
+        break;
+    }
+}
+
+void DownscalePixels(const Math::Vec4<u8>* row, const Math::Vec4<u8>* second_row,
+                     std::size_t count, Math::Vec4<u8>* dest) {
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse4_1)
+        i = DownscalePixelsSSE41(row, second_row, count, dest);
+#endif
+
+    for (; i < count; ++i) {
+        const auto sum = row[2 * i] + row[2 * i + 1];
+        if (second_row != nullptr) {
+            dest[i] = ((sum + (second_row[2 * i] + second_row[2 * i + 1])) / 4).Cast<u8>();
+        } else {
+            dest[i] = (sum / 2).Cast<u8>();
+        }
+    }
+}
+
+} // Anonymous namespace
+
+void EncodePixels(Regs::PixelFormat format, const Math::Vec4<u8>* source, std::size_t count,
+                  u8* dest) {
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse4_1)
+        i = EncodePixelsSSE41(format, source, count, dest);
+#endif
+
+    const auto encode_with = [&](auto encode, std::size_t bytes_per_pixel) {
+        for (; i < count; ++i) {
+            encode(source[i], dest + i * bytes_per_pixel);
+        }
+    };
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        encode_with(Color::EncodeRGBA8, 4);
+        break;
+    case Regs::PixelFormat::RGB8:
+        encode_with(Color::EncodeRGB8, 3);
+        break;
+    case Regs::PixelFormat::RGB565:
+        encode_with(Color::EncodeRGB565, 2);
+        break;
+    case Regs::PixelFormat::RGB5A1:
+        encode_with(Color::EncodeRGB5A1, 2);
+        break;
+    case Regs::PixelFormat::RGBA4:
+        encode_with(Color::EncodeRGBA4, 2);
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}", static_cast<u32>(format));
+        break;
+    }
+}
+
+void SoftwareDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    // Number of pixels read from each input row
+    const u32 input_count = output_width << horizontal_scale;
+
+    const Regs::PixelFormat input_format = config.input_format;
+    const Regs::PixelFormat output_format = config.output_format;
+    const u32 src_bytes_per_pixel = Regs::BytesPerPixel(input_format);
+    const u32 dst_bytes_per_pixel = Regs::BytesPerPixel(output_format);
+
+    // Swizzling converts between the layouts, otherwise both images have the same one
+    const bool input_tiled = !config.input_linear;
+    const bool output_tiled = config.dont_swizzle ? input_tiled : !input_tiled;
+    // Decoding and encoding a pixel in the same format gives back the same bytes
+    const bool copy_pixels = input_format == output_format && config.scaling == config.NoScale;
+
+    std::vector<u8> input_rows(input_tiled ? 2 * input_count * src_bytes_per_pixel : 0);
+    std::vector<u8> output_row(output_tiled ? output_width * dst_bytes_per_pixel : 0);
+    std::vector<Math::Vec4<u8>> decoded(copy_pixels ? 0 : 2 * input_count);
+    std::vector<Math::Vec4<u8>> downscaled(horizontal_scale ? output_width : 0);
+
+    for (u32 y = 0; y < output_height; ++y) {
+        const u32 input_y = y << vertical_scale;
+        // Flip the rows of the output after calculating the input position, to account for the
+        // scaling options
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+        u8* const output = output_tiled
+                               ? output_row.data()
+                               : dst + output_y * output_width * dst_bytes_per_pixel;
+
+        if (copy_pixels) {
+            if (input_tiled) {
+                ReadTiledRow(src, input_y, config.input_width, input_count, src_bytes_per_pixel,
+                             output);
+            } else {
+                std::memcpy(output, src + input_y * config.input_width * src_bytes_per_pixel,
+                            input_count * src_bytes_per_pixel);
+            }
+        } else {
+            // The second input row is only read when scaling vertically, which requires tiled
+            // input
+            const u32 num_input_rows = vertical_scale ? 2 : 1;
+            for (u32 i = 0; i < num_input_rows; ++i) {
+                const u8* input_row;
+                if (input_tiled) {
+                    u8* const row = input_rows.data() + i * input_count * src_bytes_per_pixel;
+                    ReadTiledRow(src, input_y + i, config.input_width, input_count,
+                                 src_bytes_per_pixel, row);
+                    input_row = row;
+                } else {
+                    input_row = src + input_y * config.input_width * src_bytes_per_pixel;
+                }
+                DecodePixels(input_format, input_row, input_count,
+                             decoded.data() + i * input_count);
+            }
+
+            const Math::Vec4<u8>* colors = decoded.data();
+            if (horizontal_scale) {
+                DownscalePixels(decoded.data(),
+                                vertical_scale ? decoded.data() + input_count : nullptr,
+                                output_width, downscaled.data());
+                colors = downscaled.data();
+            }
+            EncodePixels(output_format, colors, output_width, output);
+        }
+
+        if (output_tiled) {
+            WriteTiledRow(dst, output_y, output_width, output_width, dst_bytes_per_pixel, output);
+        }
+    }
+}
+
+void SoftwareTextureCopy(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst) {
+    u32 remaining_size = Common::AlignDown(config.texture_copy.size, 16);
+
+    u32 input_gap = config.texture_copy.input_gap * 16;
+    u32 output_gap = config.texture_copy.output_gap * 16;
+
+    // Zero gap means contiguous input/output even if width = 0. To avoid infinite loop below, width
+    // is assigned with the total size if gap = 0.
+    u32 input_width = input_gap == 0 ? remaining_size : config.texture_copy.input_width * 16;
+    u32 output_width = output_gap == 0 ? remaining_size : config.texture_copy.output_width * 16;
+
+    u32 remaining_input = input_width;
+    u32 remaining_output = output_width;
+    while (remaining_size > 0) {
+        u32 copy_size = std::min({remaining_input, remaining_output, remaining_size});
+
+        std::memcpy(dst, src, copy_size);
+        src += copy_size;
+        dst += copy_size;
+
+        remaining_input -= copy_size;
+        remaining_output -= copy_size;
+        remaining_size -= copy_size;
+
+        if (remaining_input == 0) {
+            remaining_input = input_width;
+            src += input_gap;
+        }
+        if (remaining_output == 0) {
+            remaining_output = output_width;
+            dst += output_gap;
+        }
+    }
+}
+
+} // namespace GPU
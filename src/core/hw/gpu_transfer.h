@@ -0,0 +1,70 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "core/hw/gpu.h"
+
+namespace GPU {
+
+/**
+ * Software implementation of the memory fill engine, used when the rasterizer doesn't accelerate
+ * the fill.
+ * @param start Pointer to the start of the filled range
+ * @param end Pointer to the end of the filled range. As on the hardware, 16-bit and 24-bit fills
+ *            write whole values, up to 2 bytes past it.
+ */
+void SoftwareMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end);
+
+/**
+ * Software implementation of the display transfer engine, used when the rasterizer doesn't
+ * accelerate the transfer. The images are converted a row at a time, with vectorized kernels for
+ * the pixel formats and the downscaling.
+ * @param config Transfer configuration, with non-zero dimensions and a supported scaling mode,
+ *               which is only available on tiled input
+ */
+void SoftwareDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst);
+
+/**
+ * Software implementation of the texture copy mode of the display transfer engine.
+ * @param config Transfer configuration, with a non-zero size and non-zero widths
+ */
+void SoftwareTextureCopy(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst);
+
+/**
+ * Encodes a row of RGBA8 pixels to the given format, using the vectorized kernels when the CPU
+ * supports them.
+ */
+void EncodePixels(Regs::PixelFormat format, const Math::Vec4<u8>* source, std::size_t count,
+                  u8* dest);
+
+#ifdef ARCHITECTURE_x86_64
+/**
+ * Vectorized decoding of a row of pixels to RGBA8, requires SSE4.1.
+ * @returns the number of pixels decoded, the remaining ones are left to the caller
+ */
+std::size_t DecodePixelsSSE41(Regs::PixelFormat format, const u8* source, std::size_t count,
+                              Math::Vec4<u8>* dest);
+
+/**
+ * Vectorized encoding of a row of RGBA8 pixels, requires SSE4.1.
+ * @returns the number of pixels encoded, the remaining ones are left to the caller
+ */
+std::size_t EncodePixelsSSE41(Regs::PixelFormat format, const Math::Vec4<u8>* source,
+                              std::size_t count, u8* dest);
+
+/**
+ * Vectorized downscaling of a row of RGBA8 pixels, requires SSE4.1. Averages the pairs of
+ * horizontally adjacent pixels of row, and of second_row when it isn't null, rounding down.
+ * @param count Number of pixels to output
+ * @returns the number of pixels output, the remaining ones are left to the caller
+ */
+std::size_t DownscalePixelsSSE41(const Math::Vec4<u8>* row, const Math::Vec4<u8>* second_row,
+                                 std::size_t count, Math::Vec4<u8>* dest);
+#endif
+
+} // namespace GPU
@@ -0,0 +1,266 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <immintrin.h>
+#include "common/common_types.h"
+#include "common/x64/target.h"
+#include "core/hw/gpu_transfer.h"
+
+namespace GPU {
+
+TARGET_SSE41 static __m128i Load(const void* source) {
+    return _mm_loadu_si128(static_cast<const __m128i*>(source));
+}
+
+TARGET_SSE41 static void Store(void* dest, __m128i value) {
+    _mm_storeu_si128(static_cast<__m128i*>(dest), value);
+}
+
+// The decoders output RGBA8 pixels, as the bytes of Math::Vec4<u8>, and return the number of
+// pixels they decoded, without reading past the end of the source.
+
+/// Decoders for formats with 8-bit channels, which only need their bytes to be rearranged
+TARGET_SSE41 static std::size_t DecodeRGBA8(const u8* source, std::size_t count, u8* dest) {
+    const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        Store(dest + i * 4, _mm_shuffle_epi8(Load(source + i * 4), shuffle));
+    }
+    return i;
+}
+
+TARGET_SSE41 static std::size_t DecodeRGB8(const u8* source, std::size_t count, u8* dest) {
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    std::size_t i = 0;
+    // 16 bytes are loaded for every 4 pixels
+    for (; i + 6 <= count; i += 4) {
+        Store(dest + i * 4, _mm_or_si128(_mm_shuffle_epi8(Load(source + i * 3), shuffle), alpha));
+    }
+    return i;
+}
+
+/// Decoders for the 16-bit packed formats, working on the channels of 8 pixels in 16-bit lanes
+TARGET_SSE41 static __m128i Convert5To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+TARGET_SSE41 static __m128i Convert6To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+}
+
+TARGET_SSE41 static __m128i Convert4To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 4), value);
+}
+
+/// Interleaves 8-bit channels held in 16-bit lanes into 8 RGBA8 pixels
+TARGET_SSE41 static void StorePacked(u8* dest, __m128i r, __m128i g, __m128i b, __m128i a) {
+    const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+    Store(dest, _mm_unpacklo_epi16(rg, ba));
+    Store(dest + 16, _mm_unpackhi_epi16(rg, ba));
+}
+
+TARGET_SSE41 static std::size_t DecodeRGB565(const u8* source, std::size_t count, u8* dest) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    const __m128i alpha = _mm_set1_epi16(0xFF);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = Load(source + i * 2);
+        const __m128i r = Convert5To8(_mm_srli_epi16(pixels, 11));
+        const __m128i g = Convert6To8(_mm_and_si128(_mm_srli_epi16(pixels, 5), mask6));
+        const __m128i b = Convert5To8(_mm_and_si128(pixels, mask5));
+        StorePacked(dest + i * 4, r, g, b, alpha);
+    }
+    return i;
+}
+
+TARGET_SSE41 static std::size_t DecodeRGB5A1(const u8* source, std::size_t count, u8* dest) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask1 = _mm_set1_epi16(0x1);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = Load(source + i * 2);
+        const __m128i r = Convert5To8(_mm_srli_epi16(pixels, 11));
+        const __m128i g = Convert5To8(_mm_and_si128(_mm_srli_epi16(pixels, 6), mask5));
+        const __m128i b = Convert5To8(_mm_and_si128(_mm_srli_epi16(pixels, 1), mask5));
+        const __m128i a = _mm_mullo_epi16(_mm_and_si128(pixels, mask1), _mm_set1_epi16(0xFF));
+        StorePacked(dest + i * 4, r, g, b, a);
+    }
+    return i;
+}
+
+TARGET_SSE41 static std::size_t DecodeRGBA4(const u8* source, std::size_t count, u8* dest) {
+    const __m128i mask4 = _mm_set1_epi16(0xF);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = Load(source + i * 2);
+        const __m128i r = Convert4To8(_mm_srli_epi16(pixels, 12));
+        const __m128i g = Convert4To8(_mm_and_si128(_mm_srli_epi16(pixels, 8), mask4));
+        const __m128i b = Convert4To8(_mm_and_si128(_mm_srli_epi16(pixels, 4), mask4));
+        const __m128i a = Convert4To8(_mm_and_si128(pixels, mask4));
+        StorePacked(dest + i * 4, r, g, b, a);
+    }
+    return i;
+}
+
+std::size_t DecodePixelsSSE41(Regs::PixelFormat format, const u8* source, std::size_t count,
+                              Math::Vec4<u8>* dest) {
+    u8* const dest_bytes = reinterpret_cast<u8*>(dest);
+
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        return DecodeRGBA8(source, count, dest_bytes);
+    case Regs::PixelFormat::RGB8:
+        return DecodeRGB8(source, count, dest_bytes);
+    case Regs::PixelFormat::RGB565:
+        return DecodeRGB565(source, count, dest_bytes);
+    case Regs::PixelFormat::RGB5A1:
+        return DecodeRGB5A1(source, count, dest_bytes);
+    case Regs::PixelFormat::RGBA4:
+        return DecodeRGBA4(source, count, dest_bytes);
+    default:
+        return 0;
+    }
+}
+
+// The encoders take RGBA8 pixels, as the bytes of Math::Vec4<u8>, and return the number of pixels
+// they encoded, without writing past the end of the destination.
+
+TARGET_SSE41 static std::size_t EncodeRGBA8(const u8* source, std::size_t count, u8* dest) {
+    const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        Store(dest + i * 4, _mm_shuffle_epi8(Load(source + i * 4), shuffle));
+    }
+    return i;
+}
+
+TARGET_SSE41 static std::size_t EncodeRGB8(const u8* source, std::size_t count, u8* dest) {
+    const __m128i shuffle =
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_shuffle_epi8(Load(source + i * 4), shuffle);
+        // Only the 12 bytes of the 4 pixels are written
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i * 3), pixels);
+        const u32 last_bytes = _mm_extract_epi32(pixels, 2);
+        std::memcpy(dest + i * 3 + 8, &last_bytes, sizeof(last_bytes));
+    }
+    return i;
+}
+
+/**
+ * Encoders for the 16-bit packed formats, computing the value of each pixel in the 32-bit lane
+ * holding its RGBA8 channels, from the lowest to the highest byte, before packing 8 of them
+ */
+template <typename Pack>
+TARGET_SSE41 static std::size_t EncodePacked(const u8* source, std::size_t count, u8* dest,
+                                             Pack pack) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i low = pack(Load(source + i * 4));
+        const __m128i high = pack(Load(source + i * 4 + 16));
+        Store(dest + i * 2, _mm_packus_epi32(low, high));
+    }
+    return i;
+}
+
+/// Returns (pixels >> shift) & mask in each 32-bit lane, with a positive shift to the right
+template <int shift>
+TARGET_SSE41 static __m128i ShiftAndMask(__m128i pixels, u32 mask) {
+    if constexpr (shift >= 0) {
+        return _mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32(mask));
+    } else {
+        return _mm_and_si128(_mm_slli_epi32(pixels, -shift), _mm_set1_epi32(mask));
+    }
+}
+
+TARGET_SSE41 static __m128i PackRGB565(__m128i pixels) {
+    // (r >> 3) << 11 | (g >> 2) << 5 | b >> 3
+    return _mm_or_si128(_mm_or_si128(ShiftAndMask<-8>(pixels, 0xF800),
+                                     ShiftAndMask<5>(pixels, 0x07E0)),
+                        ShiftAndMask<19>(pixels, 0x001F));
+}
+
+TARGET_SSE41 static __m128i PackRGB5A1(__m128i pixels) {
+    // (r >> 3) << 11 | (g >> 3) << 6 | (b >> 3) << 1 | a >> 7
+    return _mm_or_si128(_mm_or_si128(ShiftAndMask<-8>(pixels, 0xF800),
+                                     ShiftAndMask<5>(pixels, 0x07C0)),
+                        _mm_or_si128(ShiftAndMask<18>(pixels, 0x003E),
+                                     _mm_srli_epi32(pixels, 31)));
+}
+
+TARGET_SSE41 static __m128i PackRGBA4(__m128i pixels) {
+    // (r >> 4) << 12 | (g >> 4) << 8 | (b >> 4) << 4 | a >> 4
+    return _mm_or_si128(_mm_or_si128(ShiftAndMask<-8>(pixels, 0xF000),
+                                     ShiftAndMask<4>(pixels, 0x0F00)),
+                        _mm_or_si128(ShiftAndMask<16>(pixels, 0x00F0),
+                                     _mm_srli_epi32(pixels, 28)));
+}
+
+std::size_t EncodePixelsSSE41(Regs::PixelFormat format, const Math::Vec4<u8>* source,
+                              std::size_t count, u8* dest) {
+    const u8* const source_bytes = reinterpret_cast<const u8*>(source);
+
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        return EncodeRGBA8(source_bytes, count, dest);
+    case Regs::PixelFormat::RGB8:
+        return EncodeRGB8(source_bytes, count, dest);
+    case Regs::PixelFormat::RGB565:
+        return EncodePacked(source_bytes, count, dest, PackRGB565);
+    case Regs::PixelFormat::RGB5A1:
+        return EncodePacked(source_bytes, count, dest, PackRGB5A1);
+    case Regs::PixelFormat::RGBA4:
+        return EncodePacked(source_bytes, count, dest, PackRGBA4);
+    default:
+        return 0;
+    }
+}
+
+/// Splits 8 pixels into the pixels at even and odd positions
+TARGET_SSE41 static void Deinterleave(const u8* source, __m128i& even, __m128i& odd) {
+    const __m128 low = _mm_castsi128_ps(Load(source));
+    const __m128 high = _mm_castsi128_ps(Load(source + 16));
+    even = _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+    odd = _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+std::size_t DownscalePixelsSSE41(const Math::Vec4<u8>* row, const Math::Vec4<u8>* second_row,
+                                 std::size_t count, Math::Vec4<u8>* dest) {
+    const u8* const row_bytes = reinterpret_cast<const u8*>(row);
+    const u8* const second_row_bytes = reinterpret_cast<const u8*>(second_row);
+    u8* const dest_bytes = reinterpret_cast<u8*>(dest);
+    const __m128i zero = _mm_setzero_si128();
+
+    // The channels are summed in 16-bit lanes, so that the averages round down like the scalar
+    // code instead of rounding up like _mm_avg_epu8
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i even, odd;
+        Deinterleave(row_bytes + i * 8, even, odd);
+        __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(even, zero), _mm_unpacklo_epi8(odd, zero));
+        __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(even, zero), _mm_unpackhi_epi8(odd, zero));
+
+        if (second_row != nullptr) {
+            Deinterleave(second_row_bytes + i * 8, even, odd);
+            low = _mm_add_epi16(low, _mm_add_epi16(_mm_unpacklo_epi8(even, zero),
+                                                   _mm_unpacklo_epi8(odd, zero)));
+            high = _mm_add_epi16(high, _mm_add_epi16(_mm_unpackhi_epi8(even, zero),
+                                                     _mm_unpackhi_epi8(odd, zero)));
+            low = _mm_srli_epi16(low, 2);
+            high = _mm_srli_epi16(high, 2);
+        } else {
+            low = _mm_srli_epi16(low, 1);
+            high = _mm_srli_epi16(high, 1);
+        }
+        Store(dest_bytes + i * 4, _mm_packus_epi16(low, high));
+    }
+    return i;
+}
+
+} // namespace GPU
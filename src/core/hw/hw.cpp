@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hw/aes/key.h"
@@ -99,4 +100,9 @@ void Shutdown() {
     LCD::Shutdown();
     LOG_DEBUG(HW, "shutdown OK");
 }
+
+void DoState(PointerWrap& p) {
+    p.DoVoid(&GPU::g_regs, sizeof(GPU::g_regs));
+    p.DoVoid(&LCD::g_regs, sizeof(LCD::g_regs));
+}
 } // namespace HW
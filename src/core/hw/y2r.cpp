@@ -5,15 +5,23 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <vector>
+#include "common/alignment.h"
 #include "common/assert.h"
-#include "common/color.h"
 #include "common/common_types.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hle/service/y2r_u.h"
+#include "core/hw/gpu_transfer.h"
 #include "core/hw/y2r.h"
 #include "core/memory.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
 namespace HW {
 namespace Y2R {
 
@@ -23,10 +31,28 @@ static const std::size_t MAX_TILES = 1024 / 8;
 static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
+/// Images with fewer pixels than this are converted on the calling thread
+constexpr std::size_t MIN_PARALLEL_PIXELS = 256 * 256;
+/// Minimum number of strips converted by each worker of a parallel conversion
+constexpr std::size_t MIN_STRIPS_PER_WORKER = 4;
+
+/**
+ * Converts an image strip from the source YUV format into RGBA8 pixels, writing each one directly
+ * to its position in the rotated strip.
+ * @param dest_index Position of each pixel in dest, in row-major order, or null to write them in
+ *                   that order
+ */
 static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
-                            const u8* input_V, ImageTile output[], unsigned int width,
-                            unsigned int height, const CoefficientSet& coefficients) {
+                            const u8* input_V, unsigned int width, unsigned int height,
+                            const CoefficientSet& coefficients, u8 alpha, const u16* dest_index,
+                            Math::Vec4<u8>* dest) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().sse4_1) {
+        ConvertStripSSE41(input_format, input_Y, input_U, input_V, width, height, coefficients,
+                          alpha, dest_index, dest);
+        return;
+    }
+#endif
 
     for (unsigned int y = 0; y < height; ++y) {
         for (unsigned int x = 0; x < width; ++x) {
@@ -66,12 +92,11 @@ static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u
             g = (g >> 3) + c[6] + rounding_offset;
             b = (b >> 3) + c[7] + rounding_offset;
 
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+            const unsigned int i = y * width + x;
+            dest[dest_index != nullptr ? dest_index[i] : i] = {
+                static_cast<u8>(std::clamp(r >> 5, 0, 0xFF)),
+                static_cast<u8>(std::clamp(g >> 5, 0, 0xFF)),
+                static_cast<u8>(std::clamp(b >> 5, 0, 0xFF)), alpha};
         }
     }
 }
@@ -99,42 +124,23 @@ static void ReceiveData(u8* output, ConversionBuffer& buf, std::size_t amount_of
     }
 }
 
-/// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
-/// transfer.
-static void SendData(const u32* input, ConversionBuffer& buf, int amount_of_data,
-                     OutputFormat output_format, u8 alpha) {
+/// Simulates an outgoing CDMA transfer of pixels already converted to the output format.
+static void SendData(const u8* input, ConversionBuffer& buf, std::size_t amount_of_data,
+                     std::size_t bytes_per_pixel) {
 
     u8* output = Memory::GetPointer(buf.address);
 
-    while (amount_of_data > 0) {
-        u8* unit_end = output + buf.transfer_unit;
-        while (output < unit_end) {
-            u32 color = *input++;
-            Math::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            switch (output_format) {
-            case OutputFormat::RGBA8:
-                Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-                break;
-            case OutputFormat::RGB8:
-                Color::EncodeRGB8(col_vec, output);
-                output += 3;
-                break;
-            case OutputFormat::RGB5A1:
-                Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-                break;
-            case OutputFormat::RGB565:
-                Color::EncodeRGB565(col_vec, output);
-                output += 2;
-                break;
-            }
+    // The hardware writes whole pixels, so transfer units which aren't a multiple of the pixel
+    // size are rounded up to one
+    const std::size_t unit_size = Common::AlignUp<std::size_t>(buf.transfer_unit, bytes_per_pixel);
 
-            amount_of_data -= 1;
-        }
+    while (amount_of_data > 0) {
+        const std::size_t copy_size = std::min(unit_size, amount_of_data);
+        std::memcpy(output, input, copy_size);
+        input += copy_size;
+        amount_of_data -= copy_size;
 
-        output += buf.gap;
+        output += unit_size + buf.gap;
         buf.address += buf.transfer_unit + buf.gap;
         buf.image_size -= buf.transfer_unit;
     }
@@ -209,6 +215,186 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
     }
 }
 
+/**
+ * Computes the position of each pixel of a strip in the converted output, accounting for the
+ * rotation and the block alignment. This runs the per-tile rotations on the pixel indices rather
+ * than on the pixels, so that it only needs to be done once per conversion.
+ * With 8x8 blocks, the tiles of a partial strip are still written whole, so the positions may go
+ * up to 8 rows, while only the first row_height rows are output.
+ * @returns the positions in row-major order, or an empty vector if the pixels stay in that order
+ */
+static std::vector<u16> GetStripLayout(const ConversionConfiguration& cvt,
+                                       unsigned int row_height) {
+    const unsigned int width = cvt.input_line_width;
+    // Tiles per row
+    const std::size_t num_tiles = width / 8;
+
+    // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
+    // requiring two different code paths.
+    const u8* tile_remap = nullptr;
+    switch (cvt.block_alignment) {
+    case BlockAlignment::Linear:
+        tile_remap = linear_lut;
+        break;
+    case BlockAlignment::Block8x8:
+        tile_remap = morton_lut;
+        break;
+    }
+
+    // Index of the source pixel at each position of the output. The rows of the tiles past the
+    // end of a partial strip hold no pixel.
+    constexpr u32 NO_PIXEL = 0xFFFFFFFF;
+    const unsigned int output_height =
+        cvt.block_alignment == BlockAlignment::Block8x8 ? 8 : row_height;
+    std::vector<u32> source_index(width * output_height, NO_PIXEL);
+    u32* output_buffer = source_index.data();
+    ImageTile tile;
+    tile.fill(NO_PIXEL);
+    ImageTile tmp_tile;
+
+    for (std::size_t i = 0; i < num_tiles; ++i) {
+        // For 180 and 270 degree rotations we also invert the order of tiles in the strip, since
+        // the rotates are done individually on each tile.
+        const bool reverse_tiles = cvt.rotation == Rotation::Clockwise_180 ||
+                                   cvt.rotation == Rotation::Clockwise_270;
+        const std::size_t source_tile = reverse_tiles ? num_tiles - i - 1 : i;
+        for (unsigned int y = 0; y < row_height; ++y) {
+            for (unsigned int x = 0; x < 8; ++x) {
+                tile[y * 8 + x] = static_cast<u32>(y * width + source_tile * 8 + x);
+            }
+        }
+
+        int image_strip_width = 0;
+        int output_stride = 0;
+
+        // The rotations only write the positions of the row_height rows
+        tmp_tile.fill(NO_PIXEL);
+        switch (cvt.rotation) {
+        case Rotation::None:
+            RotateTile0(tile, tmp_tile, row_height, tile_remap);
+            image_strip_width = width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_90:
+            RotateTile90(tile, tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        case Rotation::Clockwise_180:
+            RotateTile180(tile, tmp_tile, row_height, tile_remap);
+            image_strip_width = width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_270:
+            RotateTile270(tile, tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        }
+
+        switch (cvt.block_alignment) {
+        case BlockAlignment::Linear:
+            WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
+            output_buffer += output_stride;
+            break;
+        case BlockAlignment::Block8x8:
+            WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+            output_buffer += TILE_SIZE;
+            break;
+        }
+    }
+
+    bool is_identity = true;
+    std::vector<u16> dest_index(std::size_t{width} * row_height);
+    for (std::size_t i = 0; i < source_index.size(); ++i) {
+        if (source_index[i] == NO_PIXEL) {
+            is_identity = false;
+            continue;
+        }
+        dest_index[source_index[i]] = static_cast<u16>(i);
+        is_identity = is_identity && source_index[i] == i;
+    }
+    if (is_identity) {
+        dest_index.clear();
+    }
+    return dest_index;
+}
+
+static GPU::Regs::PixelFormat GetPixelFormat(OutputFormat output_format) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        return GPU::Regs::PixelFormat::RGBA8;
+    case OutputFormat::RGB8:
+        return GPU::Regs::PixelFormat::RGB8;
+    case OutputFormat::RGB5A1:
+        return GPU::Regs::PixelFormat::RGB5A1;
+    case OutputFormat::RGB565:
+        return GPU::Regs::PixelFormat::RGB565;
+    }
+    UNREACHABLE();
+}
+
+void ConvertImage(const ConversionConfiguration& cvt, const u8* input_Y, const u8* input_U,
+                  const u8* input_V, u8* output) {
+    const unsigned int width = cvt.input_line_width;
+    const std::size_t num_strips = (cvt.input_lines + 7) / 8;
+    const unsigned int last_strip_height = cvt.input_lines - (num_strips - 1) * 8;
+
+    const GPU::Regs::PixelFormat output_format = GetPixelFormat(cvt.output_format);
+    const std::size_t bytes_per_pixel = GPU::Regs::BytesPerPixel(output_format);
+
+    // Distance between the strips in each of the planes
+    std::size_t strip_size_Y = 8 * width;
+    std::size_t strip_size_UV = 0;
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+        strip_size_UV = 8 * width / 2;
+        break;
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16:
+        strip_size_UV = 8 * width / 4;
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        strip_size_Y = 8 * width * 2;
+        break;
+    }
+
+    const std::vector<u16> strip_layout = GetStripLayout(cvt, 8);
+    const std::vector<u16> last_strip_layout =
+        last_strip_height == 8 ? strip_layout : GetStripLayout(cvt, last_strip_height);
+
+    const auto convert_strips = [&](std::size_t begin, std::size_t end, std::size_t) {
+        // Intermediate storage for the converted and rotated strip, before its final encoding
+        std::vector<Math::Vec4<u8>> pixels(8 * width);
+        for (std::size_t strip = begin; strip < end; ++strip) {
+            const bool is_last = strip == num_strips - 1;
+            const unsigned int row_height = is_last ? last_strip_height : 8;
+            const std::vector<u16>& layout = is_last ? last_strip_layout : strip_layout;
+            // The output of a partial strip of 8x8 blocks has positions which hold no pixel,
+            // clear them rather than leaving the pixels of the previous strip
+            if (row_height != 8 && cvt.block_alignment == BlockAlignment::Block8x8) {
+                std::fill(pixels.begin(), pixels.end(), Math::Vec4<u8>{});
+            }
+
+            const u8* strip_U = strip_size_UV != 0 ? input_U + strip * strip_size_UV : nullptr;
+            const u8* strip_V = strip_size_UV != 0 ? input_V + strip * strip_size_UV : nullptr;
+            ConvertYUVToRGB(cvt.input_format, input_Y + strip * strip_size_Y, strip_U, strip_V,
+                            width, row_height, cvt.coefficients, static_cast<u8>(cvt.alpha),
+                            layout.empty() ? nullptr : layout.data(), pixels.data());
+            GPU::EncodePixels(output_format, pixels.data(), width * row_height,
+                              output + strip * 8 * width * bytes_per_pixel);
+        }
+    };
+
+    if (std::size_t{width} * cvt.input_lines < MIN_PARALLEL_PIXELS) {
+        convert_strips(0, num_strips, 0);
+    } else {
+        Common::ThreadPool::GetShared().ParallelFor(num_strips, MIN_STRIPS_PER_WORKER,
+                                                    convert_strips);
+    }
+}
+
 /**
  * Performs a Y2R colorspace conversion.
  *
@@ -245,13 +431,16 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
  * In this implementation, to avoid the combinatorial explosion of parameter combinations, common
  * intermediate formats are used and where possible tables or parameters are used instead of
  * diverging code paths to keep the amount of branches in check. Some steps are also merged to
- * increase efficiency.
+ * increase efficiency: the YUV to RGB conversion writes each pixel directly to its rotated
+ * position, which is computed once per conversion, and the rotated strip is then encoded to the
+ * output format in one go. Since the strips are independent, large images are converted on
+ * several threads.
  *
  * Output for all valid settings combinations matches hardware, however output in some edge-cases
  * differs:
  *
- * - `Block8x8` alignment with non-mod8 height produces different garbage patterns on the last
- *   strip, especially when combined with rotation.
+ * - `Block8x8` alignment with non-mod8 height produces garbage on the last strip, where this
+ *   implementation outputs zeros instead.
  * - Hardware, when using `Linear` alignment with a non-even height and 90 or 270 degree rotation
  *   produces misaligned output on the last strip. This implmentation produces output with the
  *   correct "expected" alignment.
@@ -266,114 +455,60 @@ void PerformConversion(ConversionConfiguration& cvt) {
     std::size_t num_tiles = cvt.input_line_width / 8;
     ASSERT(num_tiles <= MAX_TILES);
 
-    // Buffer used as a CDMA source/target.
-    std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
-    // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
-    std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
-    ImageTile tmp_tile;
+    const std::size_t num_pixels = std::size_t{cvt.input_line_width} * cvt.input_lines;
+    const std::size_t bytes_per_pixel =
+        GPU::Regs::BytesPerPixel(GetPixelFormat(cvt.output_format));
 
-    // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
-    // requiring two different code paths.
-    const u8* tile_remap = nullptr;
-    switch (cvt.block_alignment) {
-    case BlockAlignment::Linear:
-        tile_remap = linear_lut;
-        break;
-    case BlockAlignment::Block8x8:
-        tile_remap = morton_lut;
-        break;
-    }
+    // Buffers used as CDMA targets for the whole image, and as the CDMA source of the converted
+    // image.
+    std::unique_ptr<u8[]> input_Y(new u8[num_pixels * 2]);
+    std::unique_ptr<u8[]> input_U(new u8[num_pixels / 2]);
+    std::unique_ptr<u8[]> input_V(new u8[num_pixels / 2]);
+    std::unique_ptr<u8[]> output(new u8[num_pixels * bytes_per_pixel]);
 
+    // All the strips are received before converting them, to convert them in parallel. The
+    // transfers still happen a strip at a time, as their units restart at each strip.
     for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
         unsigned int row_height = std::min(cvt.input_lines - y, 8u);
 
         // Total size in pixels of incoming data required for this strip.
         const std::size_t row_data_size = row_height * cvt.input_line_width;
-
-        u8* input_Y = data_buffer.get();
-        u8* input_U = input_Y + 8 * cvt.input_line_width;
-        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+        const std::size_t row_offset = y * cvt.input_line_width;
 
         switch (cvt.input_format) {
         case InputFormat::YUV422_Indiv8:
-            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 2);
+            ReceiveData<1>(&input_Y[row_offset], cvt.src_Y, row_data_size);
+            ReceiveData<1>(&input_U[row_offset / 2], cvt.src_U, row_data_size / 2);
+            ReceiveData<1>(&input_V[row_offset / 2], cvt.src_V, row_data_size / 2);
             break;
         case InputFormat::YUV420_Indiv8:
-            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 4);
+            ReceiveData<1>(&input_Y[row_offset], cvt.src_Y, row_data_size);
+            ReceiveData<1>(&input_U[row_offset / 4], cvt.src_U, row_data_size / 4);
+            ReceiveData<1>(&input_V[row_offset / 4], cvt.src_V, row_data_size / 4);
             break;
         case InputFormat::YUV422_Indiv16:
-            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 2);
+            ReceiveData<2>(&input_Y[row_offset], cvt.src_Y, row_data_size);
+            ReceiveData<2>(&input_U[row_offset / 2], cvt.src_U, row_data_size / 2);
+            ReceiveData<2>(&input_V[row_offset / 2], cvt.src_V, row_data_size / 2);
             break;
         case InputFormat::YUV420_Indiv16:
-            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 4);
+            ReceiveData<2>(&input_Y[row_offset], cvt.src_Y, row_data_size);
+            ReceiveData<2>(&input_U[row_offset / 4], cvt.src_U, row_data_size / 4);
+            ReceiveData<2>(&input_V[row_offset / 4], cvt.src_V, row_data_size / 4);
             break;
         case InputFormat::YUYV422_Interleaved:
-            input_U = nullptr;
-            input_V = nullptr;
-            ReceiveData<1>(input_Y, cvt.src_YUYV, row_data_size * 2);
+            ReceiveData<1>(&input_Y[row_offset * 2], cvt.src_YUYV, row_data_size * 2);
             break;
         }
+    }
 
-        // Note(yuriks): If additional optimization is required, input_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.get(),
-                        cvt.input_line_width, row_height, cvt.coefficients);
-
-        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (std::size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            }
-
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
-            }
-        }
+    ConvertImage(cvt, input_Y.get(), input_U.get(), input_V.get(), output.get());
 
-        // Note(yuriks): If additional optimization is required, output_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        SendData(reinterpret_cast<u32*>(data_buffer.get()), cvt.dst, (int)row_data_size,
-                 cvt.output_format, (u8)cvt.alpha);
+    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+        unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+        const std::size_t row_data_size = row_height * cvt.input_line_width;
+        SendData(&output[y * cvt.input_line_width * bytes_per_pixel], cvt.dst,
+                 row_data_size * bytes_per_pixel, bytes_per_pixel);
     }
 }
 } // namespace Y2R
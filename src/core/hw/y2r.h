@@ -4,14 +4,38 @@
 
 #pragma once
 
-namespace Service {
-namespace Y2R {
-struct ConversionConfiguration;
-}
-} // namespace Service
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "core/hle/service/y2r_u.h"
 
 namespace HW {
 namespace Y2R {
 void PerformConversion(Service::Y2R::ConversionConfiguration& cvt);
-}
+
+/**
+ * Converts a whole image, as received from the CDMA source buffers, in strips of 8 lines. Large
+ * images are split across worker threads.
+ * @param input_Y Luma plane, or the interleaved YUYV stream, with the 16-bit formats already
+ *                reduced to 8 bits
+ * @param input_U Chroma planes, unused for YUYV input
+ * @param output Receives the converted strips one after the other, in the order they are sent to
+ *               the CDMA destination buffer. Must hold input_line_width * input_lines pixels.
+ */
+void ConvertImage(const Service::Y2R::ConversionConfiguration& cvt, const u8* input_Y,
+                  const u8* input_U, const u8* input_V, u8* output);
+
+#ifdef ARCHITECTURE_x86_64
+/**
+ * Vectorized conversion of a strip to RGBA8 with the configured alpha, requires SSE4.1.
+ * @param width Width of the strip, a multiple of 8
+ * @param dest_index Position of each pixel of the strip in dest, in row-major order, or null to
+ *                   write them in that order
+ */
+void ConvertStripSSE41(Service::Y2R::InputFormat input_format, const u8* input_Y,
+                       const u8* input_U, const u8* input_V, unsigned width, unsigned height,
+                       const Service::Y2R::CoefficientSet& coefficients, u8 alpha,
+                       const u16* dest_index, Math::Vec4<u8>* dest);
+#endif
+
+} // namespace Y2R
 } // namespace HW
@@ -0,0 +1,167 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <immintrin.h>
+#include "common/common_types.h"
+#include "common/x64/target.h"
+#include "core/hw/y2r.h"
+
+namespace HW {
+namespace Y2R {
+
+using namespace Service::Y2R;
+
+TARGET_SSE41 static __m128i Load16(const u8* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+TARGET_SSE41 static __m128i Load8(const u8* source) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+}
+
+TARGET_SSE41 static __m128i Load4(const u8* source) {
+    s32 value;
+    std::memcpy(&value, source, sizeof(value));
+    return _mm_cvtsi32_si128(value);
+}
+
+/// Coefficients broadcast to all the lanes
+struct Coefficients {
+    __m128i c0, c1, c2, c3, c4;
+    __m128i offset_r, offset_g, offset_b;
+};
+
+/**
+ * Converts 4 pixels from YUV to RGB, in 32-bit lanes, with the same fixed point arithmetic as the
+ * scalar conversion. The results are left unclamped.
+ */
+TARGET_SSE41 static void ConvertToRGB(const Coefficients& c, __m128i Y, __m128i U, __m128i V,
+                                      __m128i& r, __m128i& g, __m128i& b) {
+    const __m128i cY = _mm_mullo_epi32(c.c0, Y);
+    r = _mm_add_epi32(cY, _mm_mullo_epi32(c.c1, V));
+    g = _mm_sub_epi32(_mm_sub_epi32(cY, _mm_mullo_epi32(c.c2, V)), _mm_mullo_epi32(c.c3, U));
+    b = _mm_add_epi32(cY, _mm_mullo_epi32(c.c4, U));
+
+    r = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(r, 3), c.offset_r), 5);
+    g = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(g, 3), c.offset_g), 5);
+    b = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(b, 3), c.offset_b), 5);
+}
+
+/**
+ * Converts 8 pixels, whose components are in the low 8 bytes of each input, to RGBA8.
+ * @param low Receives the first 4 pixels
+ * @param high Receives the last 4 pixels
+ */
+TARGET_SSE41 static void ConvertToRGBA(const Coefficients& c, __m128i alpha, __m128i Y, __m128i U,
+                                       __m128i V, __m128i& low, __m128i& high) {
+    __m128i r_low, g_low, b_low, r_high, g_high, b_high;
+    ConvertToRGB(c, _mm_cvtepu8_epi32(Y), _mm_cvtepu8_epi32(U), _mm_cvtepu8_epi32(V), r_low,
+                 g_low, b_low);
+    ConvertToRGB(c, _mm_cvtepu8_epi32(_mm_srli_si128(Y, 4)),
+                 _mm_cvtepu8_epi32(_mm_srli_si128(U, 4)), _mm_cvtepu8_epi32(_mm_srli_si128(V, 4)),
+                 r_high, g_high, b_high);
+
+    // Saturating to 16 bits and then to 8 bits clamps the components to [0, 255]
+    const __m128i rb = _mm_packus_epi16(_mm_packs_epi32(r_low, r_high),
+                                        _mm_packs_epi32(b_low, b_high));
+    const __m128i ga = _mm_packus_epi16(_mm_packs_epi32(g_low, g_high), alpha);
+    const __m128i rg = _mm_unpacklo_epi8(rb, ga);
+    const __m128i ba = _mm_unpackhi_epi8(rb, ga);
+    low = _mm_unpacklo_epi16(rg, ba);
+    high = _mm_unpackhi_epi16(rg, ba);
+}
+
+TARGET_SSE41 static void StorePixels(Math::Vec4<u8>* dest, const u16* dest_index, __m128i low,
+                                     __m128i high) {
+    if (dest_index == nullptr) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), high);
+        return;
+    }
+
+    const auto scatter = [&](int i, s32 pixel) {
+        std::memcpy(&dest[dest_index[i]], &pixel, sizeof(pixel));
+    };
+    scatter(0, _mm_cvtsi128_si32(low));
+    scatter(1, _mm_extract_epi32(low, 1));
+    scatter(2, _mm_extract_epi32(low, 2));
+    scatter(3, _mm_extract_epi32(low, 3));
+    scatter(4, _mm_cvtsi128_si32(high));
+    scatter(5, _mm_extract_epi32(high, 1));
+    scatter(6, _mm_extract_epi32(high, 2));
+    scatter(7, _mm_extract_epi32(high, 3));
+}
+
+TARGET_SSE41 void ConvertStripSSE41(InputFormat input_format, const u8* input_Y,
+                                    const u8* input_U, const u8* input_V, unsigned width,
+                                    unsigned height, const CoefficientSet& coefficients, u8 alpha,
+                                    const u16* dest_index, Math::Vec4<u8>* dest) {
+    const Coefficients c{
+        _mm_set1_epi32(coefficients[0]),        _mm_set1_epi32(coefficients[1]),
+        _mm_set1_epi32(coefficients[2]),        _mm_set1_epi32(coefficients[3]),
+        _mm_set1_epi32(coefficients[4]),        _mm_set1_epi32(coefficients[5] + 0x18),
+        _mm_set1_epi32(coefficients[6] + 0x18), _mm_set1_epi32(coefficients[7] + 0x18),
+    };
+    const __m128i alpha_vector = _mm_set1_epi16(alpha);
+
+    // Each chroma sample is shared by 2 horizontally adjacent pixels
+    const __m128i duplicate_chroma =
+        _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i yuyv_Y =
+        _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i yuyv_U =
+        _mm_setr_epi8(1, 1, 5, 5, 9, 9, 13, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i yuyv_V =
+        _mm_setr_epi8(3, 3, 7, 7, 11, 11, 15, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    for (unsigned y = 0; y < height; ++y) {
+        const u8* row_Y = nullptr;
+        const u8* row_U = nullptr;
+        const u8* row_V = nullptr;
+        switch (input_format) {
+        case InputFormat::YUV422_Indiv8:
+        case InputFormat::YUV422_Indiv16:
+            row_Y = input_Y + y * width;
+            row_U = input_U + y * width / 2;
+            row_V = input_V + y * width / 2;
+            break;
+        case InputFormat::YUV420_Indiv8:
+        case InputFormat::YUV420_Indiv16:
+            row_Y = input_Y + y * width;
+            row_U = input_U + (y / 2) * width / 2;
+            row_V = input_V + (y / 2) * width / 2;
+            break;
+        case InputFormat::YUYV422_Interleaved:
+            row_Y = input_Y + y * width * 2;
+            break;
+        }
+
+        for (unsigned x = 0; x < width; x += 8) {
+            __m128i Y, U, V;
+            if (input_format == InputFormat::YUYV422_Interleaved) {
+                const __m128i yuyv = Load16(row_Y + x * 2);
+                Y = _mm_shuffle_epi8(yuyv, yuyv_Y);
+                U = _mm_shuffle_epi8(yuyv, yuyv_U);
+                V = _mm_shuffle_epi8(yuyv, yuyv_V);
+            } else {
+                Y = Load8(row_Y + x);
+                U = _mm_shuffle_epi8(Load4(row_U + x / 2), duplicate_chroma);
+                V = _mm_shuffle_epi8(Load4(row_V + x / 2), duplicate_chroma);
+            }
+
+            __m128i low, high;
+            ConvertToRGBA(c, alpha_vector, Y, U, V, low, high);
+            const unsigned i = y * width + x;
+            if (dest_index == nullptr) {
+                StorePixels(dest + i, nullptr, low, high);
+            } else {
+                StorePixels(dest, dest_index + i, low, high);
+            }
+        }
+    }
+}
+
+} // namespace Y2R
+} // namespace HW
@@ -14,6 +14,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
+#include "core/hw/gpu.h"
 #include "core/memory.h"
 #include "core/memory_setup.h"
 #include "video_core/renderer_base.h"
@@ -23,6 +24,9 @@ namespace Memory {
 
 static std::array<u8, Memory::VRAM_SIZE> vram;
 static std::array<u8, Memory::N3DS_EXTRA_RAM_SIZE> n3ds_extra_ram;
+// The host only commits the pages of FCRAM that are used, as it does for the other static arrays.
+// The kernel clears the memory it allocates.
+static std::array<u8, Memory::FCRAM_N3DS_SIZE> fcram;
 
 static PageTable* current_page_table = nullptr;
 
@@ -266,63 +270,38 @@ std::string ReadCString(VAddr vaddr, std::size_t max_length) {
 }
 
 u8* GetPhysicalPointer(PAddr address) {
-    struct MemoryArea {
-        PAddr paddr_base;
-        u32 size;
-    };
-
-    static constexpr MemoryArea memory_areas[] = {
-        {VRAM_PADDR, VRAM_SIZE},
-        {IO_AREA_PADDR, IO_AREA_SIZE},
-        {DSP_RAM_PADDR, DSP_RAM_SIZE},
-        {FCRAM_PADDR, FCRAM_N3DS_SIZE},
-        {N3DS_EXTRA_RAM_PADDR, N3DS_EXTRA_RAM_SIZE},
-    };
-
-    const auto area =
-        std::find_if(std::begin(memory_areas), std::end(memory_areas), [&](const auto& area) {
-            return address >= area.paddr_base && address < area.paddr_base + area.size;
-        });
-
-    if (area == std::end(memory_areas)) {
-        LOG_ERROR(HW_Memory, "unknown GetPhysicalPointer @ 0x{:08X}", address);
-        return nullptr;
+    // Each area is a single block of host memory, so this is a few comparisons, most used first
+    if (address - FCRAM_PADDR < FCRAM_N3DS_SIZE) {
+        return fcram.data() + (address - FCRAM_PADDR);
+    }
+    if (address - VRAM_PADDR < VRAM_SIZE) {
+        return vram.data() + (address - VRAM_PADDR);
+    }
+    if (address - DSP_RAM_PADDR < DSP_RAM_SIZE) {
+        return Core::DSP().GetDspMemory().data() + (address - DSP_RAM_PADDR);
+    }
+    if (address - N3DS_EXTRA_RAM_PADDR < N3DS_EXTRA_RAM_SIZE) {
+        return n3ds_extra_ram.data() + (address - N3DS_EXTRA_RAM_PADDR);
     }
 
-    if (area->paddr_base == IO_AREA_PADDR) {
+    if (address - IO_AREA_PADDR < IO_AREA_SIZE) {
         LOG_ERROR(HW_Memory, "MMIO mappings are not supported yet. phys_addr=0x{:08X}", address);
-        return nullptr;
+    } else {
+        LOG_ERROR(HW_Memory, "unknown GetPhysicalPointer @ 0x{:08X}", address);
     }
+    return nullptr;
+}
 
-    u32 offset_into_region = address - area->paddr_base;
+u8* GetFCRAMPointer(u32 offset) {
+    ASSERT(offset <= FCRAM_N3DS_SIZE);
+    return fcram.data() + offset;
+}
 
-    u8* target_pointer = nullptr;
-    switch (area->paddr_base) {
-    case VRAM_PADDR:
-        target_pointer = vram.data() + offset_into_region;
-        break;
-    case DSP_RAM_PADDR:
-        target_pointer = Core::DSP().GetDspMemory().data() + offset_into_region;
-        break;
-    case FCRAM_PADDR:
-        for (const auto& region : Core::System::GetInstance().Kernel().memory_regions) {
-            if (offset_into_region >= region.base &&
-                offset_into_region < region.base + region.size) {
-                target_pointer =
-                    region.linear_heap_memory->data() + offset_into_region - region.base;
-                break;
-            }
-        }
-        ASSERT_MSG(target_pointer != nullptr, "Invalid FCRAM address");
-        break;
-    case N3DS_EXTRA_RAM_PADDR:
-        target_pointer = n3ds_extra_ram.data() + offset_into_region;
-        break;
-    default:
-        UNREACHABLE();
+std::optional<u32> GetFCRAMOffset(const u8* pointer) {
+    if (pointer < fcram.data() || pointer >= fcram.data() + FCRAM_N3DS_SIZE) {
+        return {};
     }
-
-    return target_pointer;
+    return static_cast<u32>(pointer - fcram.data());
 }
 
 void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
@@ -330,6 +309,13 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
         return;
     }
 
+    // The CPU thread reads the page table and changes the mappings concurrently, so it does the
+    // update itself when it's asked from the GPU thread
+    if (VideoCore::g_gpu_thread != nullptr && VideoCore::g_gpu_thread->IsCurrentThread()) {
+        GPU::MarkRegionCached(start, size, cached);
+        return;
+    }
+
     u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
     PAddr paddr = start;
 
@@ -395,7 +381,7 @@ void RasterizerFlushRegion(PAddr start, u32 size) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
+    VideoCore::RunSync([&] { VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size); });
 }
 
 void RasterizerInvalidateRegion(PAddr start, u32 size) {
@@ -403,7 +389,7 @@ void RasterizerInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
+    VideoCore::RunSync([&] { VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size); });
 }
 
 void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
@@ -413,7 +399,8 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
-    VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
+    VideoCore::RunSync(
+        [&] { VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size); });
 }
 
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
@@ -453,9 +440,11 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         }
     };
 
-    CheckRegion(LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END);
-    CheckRegion(NEW_LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_VADDR_END);
-    CheckRegion(VRAM_VADDR, VRAM_VADDR_END);
+    VideoCore::RunSync([&] {
+        CheckRegion(LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END);
+        CheckRegion(NEW_LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_VADDR_END);
+        CheckRegion(VRAM_VADDR, VRAM_VADDR_END);
+    });
 }
 
 u8 Read8(const VAddr addr) {
@@ -237,7 +237,17 @@ std::optional<VAddr> PhysicalToVirtualAddress(PAddr paddr);
 u8* GetPhysicalPointer(PAddr address);
 
 /**
- * Mark each page touching the region as cached.
+ * Gets a pointer to FCRAM at the specified offset. FCRAM is a single block of host memory, so the
+ * pointers of all its offsets are valid for the whole session.
+ */
+u8* GetFCRAMPointer(u32 offset);
+
+/// Gets the offset from the start of FCRAM of a pointer, or nothing if it doesn't point into FCRAM.
+std::optional<u32> GetFCRAMOffset(const u8* pointer);
+
+/**
+ * Mark each page touching the region as cached. When called from the GPU thread, the pages are
+ * marked later on the CPU thread.
  */
 void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
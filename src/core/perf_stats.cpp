@@ -32,6 +32,9 @@ void PerfStats::EndSystemFrame() {
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
+
+    if (recording_frames)
+        recorded_frames.push_back(previous_frame_length);
 }
 
 void PerfStats::EndGameFrame() {
@@ -73,6 +76,27 @@ double PerfStats::GetLastFrameTimeScale() {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
+void PerfStats::StartRecordingFrames() {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    recording_frames = true;
+    recorded_frames.clear();
+    // The first recorded frame starts now
+    previous_frame_end = Clock::now();
+}
+
+std::size_t PerfStats::GetNumRecordedFrames() {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    return recorded_frames.size();
+}
+
+std::vector<PerfStats::Clock::duration> PerfStats::GetRecordedFrames() {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    return recorded_frames;
+}
+
 void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     if (frame_advancing_enabled) {
         // Frame advancing is enabled: wait on event instead of doing framelimiting
@@ -7,6 +7,7 @@
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
 #include "common/thread.h"
 
@@ -43,6 +44,15 @@ public:
      */
     double GetLastFrameTimeScale();
 
+    /// Starts recording the walltime of each system frame, dropping the frames recorded before
+    void StartRecordingFrames();
+
+    /// Returns the number of system frames recorded since StartRecordingFrames
+    std::size_t GetNumRecordedFrames();
+
+    /// Returns the walltime, including any waits, of the recorded system frames
+    std::vector<Clock::duration> GetRecordedFrames();
+
 private:
     std::mutex object_mutex;
 
@@ -64,6 +74,10 @@ private:
     Clock::time_point frame_begin = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+
+    bool recording_frames = false;
+    /// Total visible duration of each system frame since recording started
+    std::vector<Clock::duration> recorded_frames;
 };
 
 class FrameLimiter {
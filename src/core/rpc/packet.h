@@ -4,8 +4,8 @@
 
 #pragma once
 
-#include <array>
 #include <functional>
+#include <vector>
 #include "common/common_types.h"
 
 namespace RPC {
@@ -14,6 +14,10 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    ReadMemoryBatch,
+    WriteMemoryBatch,
+    SetMemoryWatches,
+    MemoryWatchUpdate,
 };
 
 struct PacketHeader {
@@ -23,15 +27,26 @@ struct PacketHeader {
     u32 packet_size;
 };
 
-constexpr u32 CURRENT_VERSION = 1;
+/// A range of guest memory, as sent in batch and watch requests
+struct MemoryRange {
+    u32 address;
+    u32 size;
+};
+
+constexpr u32 CURRENT_VERSION = 2;
 constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
-constexpr u32 MAX_PACKET_DATA_SIZE = 32;
+constexpr u32 MAX_PACKET_DATA_SIZE = 0x100000;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
+/// Maximum number of ranges in a batch or watch request
+constexpr u32 MAX_BATCH_RANGES = 0x1000;
+/// Maximum total size of the watched ranges, which are copied on the emulation thread every frame
+constexpr u32 MAX_WATCH_SIZE = 0x10000;
 
 class Packet {
 public:
-    Packet(const PacketHeader& header, u8* data, std::function<void(Packet&)> send_reply_callback);
+    Packet(const PacketHeader& header, const u8* data,
+           std::function<void(Packet&)> send_reply_callback);
 
     u32 GetVersion() const {
         return header.version;
@@ -53,12 +68,18 @@ public:
         return header;
     }
 
-    std::array<u8, MAX_PACKET_DATA_SIZE>& GetPacketData() {
+    std::vector<u8>& GetPacketData() {
+        return packet_data;
+    }
+
+    const std::vector<u8>& GetPacketData() const {
         return packet_data;
     }
 
+    /// Sets the size of the packet data, resizing the data to match
     void SetPacketDataSize(u32 size) {
         header.packet_size = size;
+        packet_data.resize(size);
     }
 
     void SendReply() {
@@ -66,11 +87,8 @@ public:
     }
 
 private:
-    void HandleReadMemory(u32 address, u32 data_size);
-    void HandleWriteMemory(u32 address, const u8* data, u32 data_size);
-
     struct PacketHeader header;
-    std::array<u8, MAX_PACKET_DATA_SIZE> packet_data;
+    std::vector<u8> packet_data;
 
     std::function<void(Packet&)> send_reply_callback;
 };
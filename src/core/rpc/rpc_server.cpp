@@ -1,3 +1,4 @@
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
@@ -23,31 +24,154 @@ RPCServer::~RPCServer() {
     LOG_INFO(RPC_Server, "RPC stopped.");
 }
 
+/// Only allow writing to certain memory regions
+static bool IsWritableAddress(u32 address) {
+    return (address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
+           (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
+           (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END);
+}
+
+static void WriteMemory(u32 address, const u8* data, u32 data_size) {
+    if (IsWritableAddress(address)) {
+        // Note: Memory write occurs asynchronously from the state of the emulator
+        Memory::WriteBlock(address, data, data_size);
+        // If the memory happens to be executable code, make sure the changes become visible
+        if (Core::System::GetInstance().IsPoweredOn()) {
+            Core::CPU().InvalidateCacheRange(address, data_size);
+        }
+    }
+}
+
+/**
+ * Parses the ranges of a batch request, which starts with their count. For writes, each range is
+ * followed by its data, which is returned in write_data.
+ * @returns whether the request is well formed and within the size limits
+ */
+static bool ParseMemoryRanges(const std::vector<u8>& packet_data, u32 max_total_size,
+                              std::vector<MemoryRange>& ranges,
+                              std::vector<const u8*>* write_data) {
+    u32 count = 0;
+    std::memcpy(&count, packet_data.data(), sizeof(count));
+    if (count > MAX_BATCH_RANGES) {
+        return false;
+    }
+
+    ranges.resize(count);
+    if (write_data) {
+        write_data->resize(count);
+    }
+
+    std::size_t offset = sizeof(count);
+    u64 total_size = 0;
+    for (u32 i = 0; i < count; ++i) {
+        if (packet_data.size() - offset < sizeof(MemoryRange)) {
+            return false;
+        }
+        std::memcpy(&ranges[i], packet_data.data() + offset, sizeof(MemoryRange));
+        offset += sizeof(MemoryRange);
+
+        total_size += ranges[i].size;
+        if (total_size > max_total_size) {
+            return false;
+        }
+
+        if (write_data) {
+            if (packet_data.size() - offset < ranges[i].size) {
+                return false;
+            }
+            (*write_data)[i] = packet_data.data() + offset;
+            offset += ranges[i].size;
+        }
+    }
+    return offset == packet_data.size();
+}
+
 void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
     if (data_size > MAX_READ_SIZE) {
         return;
     }
 
     // Note: Memory read occurs asynchronously from the state of the emulator
-    Memory::ReadBlock(address, packet.GetPacketData().data(), data_size);
     packet.SetPacketDataSize(data_size);
+    Memory::ReadBlock(address, packet.GetPacketData().data(), data_size);
     packet.SendReply();
 }
 
 void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size) {
-    // Only allow writing to certain memory regions
-    if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
-        (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
-        (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END)) {
-        // Note: Memory write occurs asynchronously from the state of the emulator
-        Memory::WriteBlock(address, data, data_size);
-        // If the memory happens to be executable code, make sure the changes become visible
-        Core::CPU().InvalidateCacheRange(address, data_size);
+    WriteMemory(address, data, data_size);
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::HandleReadMemoryBatch(Packet& packet, const std::vector<MemoryRange>& ranges) {
+    u32 total_size = 0;
+    for (const MemoryRange& range : ranges) {
+        total_size += range.size;
+    }
+
+    // The ranges have been copied out of the request, so its data can be replaced by the reply
+    packet.SetPacketDataSize(total_size);
+    u8* reply = packet.GetPacketData().data();
+    for (const MemoryRange& range : ranges) {
+        // Note: Memory read occurs asynchronously from the state of the emulator
+        Memory::ReadBlock(range.address, reply, range.size);
+        reply += range.size;
+    }
+    packet.SendReply();
+}
+
+void RPCServer::HandleWriteMemoryBatch(Packet& packet, const std::vector<MemoryRange>& ranges,
+                                       const std::vector<const u8*>& data) {
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        WriteMemory(ranges[i].address, data[i], ranges[i].size);
     }
     packet.SetPacketDataSize(0);
     packet.SendReply();
 }
 
+void RPCServer::HandleSetMemoryWatches(Packet& packet, std::vector<MemoryRange> ranges) {
+    u32 total_size = 0;
+    for (const MemoryRange& range : ranges) {
+        total_size += range.size;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        watches = std::move(ranges);
+        watch_request_id = packet.GetId();
+        watch_size = total_size;
+        watch_frame = 0;
+    }
+
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+}
+
+void RPCServer::PublishMemoryWatches() {
+    // Skip the frame rather than wait for a request changing the watches
+    std::unique_lock<std::mutex> lock(watch_mutex, std::try_to_lock);
+    if (!lock || watches.empty() || !server.IsReadyToPublish()) {
+        return;
+    }
+
+    PacketHeader header{CURRENT_VERSION, watch_request_id, PacketType::MemoryWatchUpdate, 0};
+    auto update = std::make_unique<Packet>(header, nullptr, nullptr);
+    update->SetPacketDataSize(sizeof(watch_frame) + watch_size);
+
+    // The update starts with the frame number, followed by the contents of the ranges
+    u8* data = update->GetPacketData().data();
+    std::memcpy(data, &watch_frame, sizeof(watch_frame));
+    data += sizeof(watch_frame);
+    for (const MemoryRange& range : watches) {
+        Memory::ReadBlock(range.address, data, range.size);
+        data += range.size;
+    }
+    ++watch_frame;
+    lock.unlock();
+
+    server.Publish(std::move(update));
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
@@ -57,6 +181,13 @@ bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
                 return true;
             }
             break;
+        case PacketType::ReadMemoryBatch:
+        case PacketType::WriteMemoryBatch:
+        case PacketType::SetMemoryWatches:
+            if (packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
         default:
             break;
         }
@@ -68,24 +199,46 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
-        u32 address = 0;
-        u32 data_size = 0;
-        std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
-        std::memcpy(&data_size, request_packet->GetPacketData().data() + sizeof(address),
-                    sizeof(data_size));
+        const std::vector<u8>& packet_data = request_packet->GetPacketData();
+        std::vector<MemoryRange> ranges;
+        std::vector<const u8*> write_data;
 
         switch (request_packet->GetPacketType()) {
         case PacketType::ReadMemory:
-            if (data_size > 0 && data_size <= MAX_READ_SIZE) {
-                HandleReadMemory(*request_packet, address, data_size);
+        case PacketType::WriteMemory: {
+            // The single requests use the address/data_size wire format
+            u32 address = 0;
+            u32 data_size = 0;
+            std::memcpy(&address, packet_data.data(), sizeof(address));
+            std::memcpy(&data_size, packet_data.data() + sizeof(address), sizeof(data_size));
+
+            if (request_packet->GetPacketType() == PacketType::ReadMemory) {
+                if (data_size > 0 && data_size <= MAX_READ_SIZE) {
+                    HandleReadMemory(*request_packet, address, data_size);
+                    success = true;
+                }
+            } else if (data_size > 0 && data_size <= packet_data.size() - (sizeof(u32) * 2)) {
+                const u8* data = packet_data.data() + (sizeof(u32) * 2);
+                HandleWriteMemory(*request_packet, address, data, data_size);
                 success = true;
             }
             break;
-        case PacketType::WriteMemory:
-            if (data_size > 0 && data_size <= MAX_PACKET_DATA_SIZE - (sizeof(u32) * 2)) {
-                const u8* data = request_packet->GetPacketData().data() + (sizeof(u32) * 2);
-                HandleWriteMemory(*request_packet, address, data, data_size);
+        }
+        case PacketType::ReadMemoryBatch:
+            if (ParseMemoryRanges(packet_data, MAX_READ_SIZE, ranges, nullptr)) {
+                HandleReadMemoryBatch(*request_packet, ranges);
+                success = true;
+            }
+            break;
+        case PacketType::WriteMemoryBatch:
+            if (ParseMemoryRanges(packet_data, MAX_PACKET_DATA_SIZE, ranges, &write_data)) {
+                HandleWriteMemoryBatch(*request_packet, ranges, write_data);
+                success = true;
+            }
+            break;
+        case PacketType::SetMemoryWatches:
+            if (ParseMemoryRanges(packet_data, MAX_WATCH_SIZE, ranges, nullptr)) {
+                HandleSetMemoryWatches(*request_packet, std::move(ranges));
                 success = true;
             }
             break;
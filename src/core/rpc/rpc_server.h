@@ -8,6 +8,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include "common/threadsafe_queue.h"
 #include "core/rpc/server.h"
 
@@ -20,11 +21,21 @@ public:
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
+    /**
+     * Publishes the watched memory ranges to the subscribers. Called from the emulation thread once
+     * per frame; this never waits for the RPC threads, and skips the frame instead.
+     */
+    void PublishMemoryWatches();
+
 private:
     void Start();
     void Stop();
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size);
+    void HandleReadMemoryBatch(Packet& packet, const std::vector<MemoryRange>& ranges);
+    void HandleWriteMemoryBatch(Packet& packet, const std::vector<MemoryRange>& ranges,
+                                const std::vector<const u8*>& data);
+    void HandleSetMemoryWatches(Packet& packet, std::vector<MemoryRange> ranges);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
     void HandleRequestsLoop();
@@ -32,6 +43,16 @@ private:
     Server server;
     Common::SPSCQueue<std::unique_ptr<Packet>> request_queue;
     std::thread request_handler_thread;
+
+    std::mutex watch_mutex;
+    /// Memory ranges published every frame, in the order they were requested
+    std::vector<MemoryRange> watches;
+    /// Id of the request which set the watches, sent back in the updates
+    u32 watch_request_id = 0;
+    /// Total size of the watched ranges
+    u32 watch_size = 0;
+    /// Number of frames published since the watches were set
+    u32 watch_frame = 0;
 };
 
 } // namespace RPC
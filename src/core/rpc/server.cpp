@@ -26,13 +26,23 @@ void Server::Stop() {
 
 void Server::NewRequestCallback(std::unique_ptr<RPC::Packet> new_request) {
     if (new_request) {
-        LOG_INFO(RPC_Server, "Received request version={} id={} type={} size={}",
-                 new_request->GetVersion(), new_request->GetId(),
-                 static_cast<u32>(new_request->GetPacketType()), new_request->GetPacketDataSize());
+        LOG_TRACE(RPC_Server, "Received request version={} id={} type={} size={}",
+                  new_request->GetVersion(), new_request->GetId(),
+                  static_cast<u32>(new_request->GetPacketType()), new_request->GetPacketDataSize());
     } else {
         LOG_INFO(RPC_Server, "Received end packet");
     }
     rpc_server.QueueRequest(std::move(new_request));
 }
 
+bool Server::IsReadyToPublish() const {
+    return zmq_server && zmq_server->IsReadyToPublish();
+}
+
+void Server::Publish(std::unique_ptr<RPC::Packet> update) {
+    if (zmq_server) {
+        zmq_server->Publish(std::move(update));
+    }
+}
+
 }; // namespace RPC
@@ -19,6 +19,11 @@ public:
     void Stop();
     void NewRequestCallback(std::unique_ptr<RPC::Packet> new_request);
 
+    /// Returns whether a published update would be sent, rather than dropped for a slow subscriber
+    bool IsReadyToPublish() const;
+    /// Queues an update for sending to the subscribers, without waiting for it to be sent
+    void Publish(std::unique_ptr<RPC::Packet> update);
+
 private:
     RPCServer& rpc_server;
     std::unique_ptr<ZMQServer> zmq_server;
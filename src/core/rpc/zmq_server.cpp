@@ -1,3 +1,4 @@
+#include <cstring>
 #include "common/common_types.h"
 #include "core/core.h"
 #include "core/rpc/packet.h"
@@ -5,22 +6,44 @@
 
 namespace RPC {
 
+/// Number of published updates which may wait to be sent before further ones are dropped
+constexpr u32 MAX_PENDING_UPDATES = 4;
+
+/// Sends the header and data of a packet as a single message
+static void SendPacket(zmq::socket_t& socket, const Packet& packet) {
+    zmq::message_t message(MIN_PACKET_SIZE + packet.GetPacketDataSize());
+    u8* buffer = static_cast<u8*>(message.data());
+    std::memcpy(buffer, &packet.GetHeader(), sizeof(PacketHeader));
+    std::memcpy(buffer + MIN_PACKET_SIZE, packet.GetPacketData().data(),
+                packet.GetPacketDataSize());
+    socket.send(message);
+}
+
 ZMQServer::ZMQServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback)
     : zmq_context(std::move(std::make_unique<zmq::context_t>(1))),
       zmq_socket(std::move(std::make_unique<zmq::socket_t>(*zmq_context, ZMQ_REP))),
+      zmq_publisher(std::make_unique<zmq::socket_t>(*zmq_context, ZMQ_PUB)),
       new_request_callback(std::move(new_request_callback)) {
     // Use a random high port
     // TODO: Make configurable or increment port number on failure
     zmq_socket->bind("tcp://127.0.0.1:45987");
     LOG_INFO(RPC_Server, "ZeroMQ listening on port 45987");
+    // Don't let updates queued for a slow subscriber hold up stopping the server
+    zmq_publisher->setsockopt(ZMQ_LINGER, 0);
+    zmq_publisher->bind("tcp://127.0.0.1:45988");
+    LOG_INFO(RPC_Server, "ZeroMQ publishing on port 45988");
 
     worker_thread = std::thread(&ZMQServer::WorkerLoop, this);
+    publisher_thread = std::thread(&ZMQServer::PublisherLoop, this);
 }
 
 ZMQServer::~ZMQServer() {
     // Triggering the zmq_context destructor will cancel
     // any blocking calls to zmq_socket->recv()
     running = false;
+    // The context waits for the publisher socket to be closed, so stop its thread first
+    publish_queue.Push(nullptr);
+    publisher_thread.join();
     zmq_context.reset();
     worker_thread.join();
 
@@ -37,7 +60,7 @@ void ZMQServer::WorkerLoop() {
                     PacketHeader header;
                     std::memcpy(&header, request_buffer, sizeof(header));
                     if ((request.size() - MIN_PACKET_SIZE) == header.packet_size) {
-                        u8* data = request_buffer + MIN_PACKET_SIZE;
+                        const u8* data = request_buffer + MIN_PACKET_SIZE;
                         std::function<void(Packet&)> send_reply_callback =
                             std::bind(&ZMQServer::SendReply, this, std::placeholders::_1);
                         std::unique_ptr<Packet> new_packet =
@@ -58,21 +81,36 @@ void ZMQServer::WorkerLoop() {
     zmq_socket.reset();
 }
 
-void ZMQServer::SendReply(Packet& reply_packet) {
-    if (running) {
-        auto reply_buffer =
-            std::make_unique<u8[]>(MIN_PACKET_SIZE + reply_packet.GetPacketDataSize());
-        auto reply_header = reply_packet.GetHeader();
+void ZMQServer::PublisherLoop() {
+    std::unique_ptr<Packet> update;
+    while ((update = publish_queue.PopWait())) {
+        try {
+            SendPacket(*zmq_publisher, *update);
+        } catch (...) {
+            LOG_WARNING(RPC_Server, "Failed to publish data on ZeroMQ socket");
+        }
+        --pending_updates;
+    }
+    // Destroying the socket must be done by this thread.
+    zmq_publisher.reset();
+}
+
+bool ZMQServer::IsReadyToPublish() const {
+    return running && pending_updates < MAX_PENDING_UPDATES;
+}
 
-        std::memcpy(reply_buffer.get(), &reply_header, sizeof(reply_header));
-        std::memcpy(reply_buffer.get() + (4 * sizeof(u32)), reply_packet.GetPacketData().data(),
-                    reply_packet.GetPacketDataSize());
+void ZMQServer::Publish(std::unique_ptr<Packet> update) {
+    ++pending_updates;
+    publish_queue.Push(std::move(update));
+}
 
-        zmq_socket->send(reply_buffer.get(), MIN_PACKET_SIZE + reply_packet.GetPacketDataSize());
+void ZMQServer::SendReply(Packet& reply_packet) {
+    if (running) {
+        SendPacket(*zmq_socket, reply_packet);
 
-        LOG_INFO(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
-                 reply_packet.GetVersion(), reply_packet.GetId(),
-                 static_cast<u32>(reply_packet.GetPacketType()), reply_packet.GetPacketDataSize());
+        LOG_TRACE(RPC_Server, "Sent reply version({}) id=({}) type=({}) size=({})",
+                  reply_packet.GetVersion(), reply_packet.GetId(),
+                  static_cast<u32>(reply_packet.GetPacketType()), reply_packet.GetPacketDataSize());
     }
 }
 
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <thread>
+#include "common/threadsafe_queue.h"
 #define ZMQ_STATIC
 #include <zmq.hpp>
 
@@ -18,15 +20,28 @@ public:
     explicit ZMQServer(std::function<void(std::unique_ptr<Packet>)> new_request_callback);
     ~ZMQServer();
 
+    /// Returns whether an update would be sent, rather than dropped for a slow subscriber
+    bool IsReadyToPublish() const;
+    /// Queues an update for the publisher thread to send to the subscribers
+    void Publish(std::unique_ptr<Packet> update);
+
 private:
     void WorkerLoop();
+    void PublisherLoop();
     void SendReply(Packet& request);
 
     std::thread worker_thread;
+    std::thread publisher_thread;
     std::atomic_bool running = true;
 
     std::unique_ptr<zmq::context_t> zmq_context;
     std::unique_ptr<zmq::socket_t> zmq_socket;
+    /// Socket the memory watch updates are published on, only used by the publisher thread
+    std::unique_ptr<zmq::socket_t> zmq_publisher;
+
+    Common::MPSCQueue<std::unique_ptr<Packet>> publish_queue;
+    /// Number of updates in publish_queue
+    std::atomic<u32> pending_updates{0};
 
     std::function<void(std::unique_ptr<Packet>)> new_request_callback;
 };
@@ -0,0 +1,524 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_set>
+#include <utility>
+#include <boost/container/flat_set.hpp>
+#include "common/assert.h"
+#include "common/chunk_file.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/arm/arm_interface.h"
+#include "core/arm/skyeye_common/arm_regformat.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/server_port.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/timer.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/hle/service/service.h"
+#include "core/hw/hw.h"
+#include "core/savestate.h"
+#include "video_core/pica.h"
+#include "video_core/regs.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+MICROPROFILE_DEFINE(Core_SaveState, "Core", "Save state", MP_RGB(255, 192, 64));
+
+namespace Core {
+
+/// Returns the number of pages holding size bytes, the last one may be partial
+static std::size_t NumPages(std::size_t size) {
+    return (size + Memory::PAGE_SIZE - 1) / Memory::PAGE_SIZE;
+}
+
+void MemorySnapshot::Capture(const std::vector<MemoryBlock>& blocks,
+                             const MemorySnapshot* previous) {
+    std::vector<std::shared_ptr<const Page>> new_pages;
+    std::vector<std::size_t> new_block_sizes;
+    num_copied_pages = 0;
+
+    std::size_t previous_block_start = 0;
+    for (std::size_t block_index = 0; block_index < blocks.size(); ++block_index) {
+        const MemoryBlock& block = blocks[block_index];
+        new_block_sizes.push_back(block.size);
+
+        // A block may have grown or shrunk since the previous snapshot, share the pages of the
+        // part they have in common
+        std::size_t previous_block_size = 0;
+        if (previous != nullptr && block_index < previous->block_sizes.size())
+            previous_block_size = previous->block_sizes[block_index];
+
+        for (std::size_t offset = 0; offset < block.size; offset += Memory::PAGE_SIZE) {
+            const u8* data = block.data + offset;
+            const std::size_t size = std::min<std::size_t>(Memory::PAGE_SIZE, block.size - offset);
+            if (offset + size <= previous_block_size) {
+                const auto& previous_page =
+                    previous->pages[previous_block_start + offset / Memory::PAGE_SIZE];
+                if (std::memcmp(previous_page->data(), data, size) == 0) {
+                    new_pages.push_back(previous_page);
+                    continue;
+                }
+            }
+
+            // Not value-initialized, the page is overwritten right away
+            std::shared_ptr<Page> page(new Page);
+            std::memcpy(page->data(), data, size);
+            new_pages.push_back(std::move(page));
+            ++num_copied_pages;
+        }
+        previous_block_start += NumPages(previous_block_size);
+    }
+
+    // previous may be this snapshot, so it is only replaced once done
+    pages = std::move(new_pages);
+    block_sizes = std::move(new_block_sizes);
+}
+
+void MemorySnapshot::Restore(const std::vector<MemoryBlock>& blocks) const {
+    ASSERT(blocks.size() == block_sizes.size());
+
+    auto page = pages.begin();
+    for (std::size_t block_index = 0; block_index < blocks.size(); ++block_index) {
+        const MemoryBlock& block = blocks[block_index];
+        ASSERT(block.size == block_sizes[block_index]);
+
+        for (std::size_t offset = 0; offset < block.size; offset += Memory::PAGE_SIZE, ++page) {
+            // Most pages are unchanged when rewinding, reading them is cheaper than writing them
+            u8* data = block.data + offset;
+            const std::size_t size = std::min<std::size_t>(Memory::PAGE_SIZE, block.size - offset);
+            if (std::memcmp((*page)->data(), data, size) != 0)
+                std::memcpy(data, (*page)->data(), size);
+        }
+    }
+}
+
+/**
+ * Returns the blocks of guest memory saved in the states: VRAM, DSP RAM, FCRAM, the New 3DS extra
+ * RAM, and the blocks the kernel and the HLE services allocate outside of them and map in the
+ * processes, such as code, main thread stacks, CROs loaded by ldr:ro and IPC buffers.
+ */
+static std::vector<MemoryBlock> GetMemoryBlocks() {
+    std::vector<MemoryBlock> blocks;
+    blocks.push_back({Memory::GetPhysicalPointer(Memory::VRAM_PADDR), Memory::VRAM_SIZE});
+    blocks.push_back({Memory::GetPhysicalPointer(Memory::DSP_RAM_PADDR), Memory::DSP_RAM_SIZE});
+    // The regular heaps are allocated from the end of the regions, so all of FCRAM is saved
+    blocks.push_back({Memory::GetFCRAMPointer(0), Memory::FCRAM_SIZE});
+    blocks.push_back(
+        {Memory::GetPhysicalPointer(Memory::N3DS_EXTRA_RAM_PADDR), Memory::N3DS_EXTRA_RAM_SIZE});
+
+    // A block may be mapped several times, in one or several processes, it is saved once. The
+    // kernel layout holds the VMAs, so the blocks are the same, in the same order, on restore.
+    std::unordered_set<const std::vector<u8>*> allocated_blocks;
+    for (const auto& process : System::GetInstance().Kernel().GetProcessList()) {
+        for (const auto& [base, vma] : process->vm_manager.vma_map) {
+            if (vma.type == Kernel::VMAType::AllocatedMemoryBlock &&
+                allocated_blocks.insert(vma.backing_block.get()).second) {
+                blocks.push_back({vma.backing_block->data(), vma.backing_block->size()});
+            }
+        }
+    }
+    return blocks;
+}
+
+static void DoThreadContext(PointerWrap& p, ARM_Interface::ThreadContext& context) {
+    const auto do_register = [&p](u32 value, auto set) {
+        p.Do(value);
+        if (p.GetMode() == PointerWrap::MODE_READ)
+            set(value);
+    };
+
+    for (std::size_t i = 0; i < 16; ++i) {
+        do_register(context.GetCpuRegister(i),
+                    [&](u32 value) { context.SetCpuRegister(i, value); });
+    }
+    do_register(context.GetCpsr(), [&](u32 value) { context.SetCpsr(value); });
+    for (std::size_t i = 0; i < 64; ++i) {
+        do_register(context.GetFpuRegister(i),
+                    [&](u32 value) { context.SetFpuRegister(i, value); });
+    }
+    do_register(context.GetFpscr(), [&](u32 value) { context.SetFpscr(value); });
+    do_register(context.GetFpexc(), [&](u32 value) { context.SetFpexc(value); });
+}
+
+/// Saves or loads the state other than guest memory. The thread list must match the state's.
+static void DoState(PointerWrap& p) {
+    auto& thread_manager = System::GetInstance().Kernel().GetThreadManager();
+    for (const auto& thread : thread_manager.GetThreadList()) {
+        DoThreadContext(p, *thread->context);
+    }
+    p.DoMarker("Threads");
+
+    CoreTiming::DoState(p);
+    p.DoMarker("CoreTiming");
+
+    HW::DoState(p);
+    p.DoMarker("HW");
+
+    Pica::DoState(p);
+    p.DoMarker("Pica");
+}
+
+/**
+ * Returns the identity and allocation layout of the kernel, as a list of values: the threads, the
+ * processes with their memory mappings and handles, and the memory regions. A state only applies
+ * while these are unchanged, as its thread contexts, CoreTiming events, kernel state and memory
+ * blocks refer to them.
+ */
+static std::vector<u64> GetKernelLayout() {
+    auto& kernel = System::GetInstance().Kernel();
+    std::vector<u64> layout;
+
+    for (const auto& thread : kernel.GetThreadManager().GetThreadList()) {
+        layout.push_back(thread->GetThreadId());
+        layout.push_back(thread->owner_process->process_id);
+        layout.push_back(thread->GetTLSAddress());
+    }
+
+    for (const auto& process : kernel.GetProcessList()) {
+        layout.push_back(process->process_id);
+        layout.push_back(static_cast<u64>(process->status));
+        layout.push_back(process->heap_used);
+        layout.push_back(process->linear_heap_used);
+        layout.push_back(process->misc_memory_used);
+        for (const auto& [base, vma] : process->vm_manager.vma_map) {
+            layout.push_back(base);
+            layout.push_back(vma.size);
+            layout.push_back(static_cast<u64>(vma.type));
+            layout.push_back(static_cast<u64>(vma.permissions));
+            layout.push_back(static_cast<u64>(vma.meminfo_state));
+            const u8* backing = vma.type == Kernel::VMAType::AllocatedMemoryBlock
+                                    ? vma.backing_block->data()
+                                    : vma.backing_memory;
+            layout.push_back(reinterpret_cast<std::uintptr_t>(backing));
+            layout.push_back(vma.offset);
+            layout.push_back(vma.paddr);
+        }
+        const auto handles = process->handle_table.GetHandles();
+        layout.push_back(handles.size());
+        for (const auto& [handle, object] : handles) {
+            layout.push_back(handle);
+            layout.push_back(object->GetObjectId());
+        }
+    }
+
+    for (const auto& region : kernel.memory_regions) {
+        layout.push_back(region.used);
+        layout.push_back(region.linear_heap_size);
+        layout.push_back(region.free_blocks.iterative_size());
+        for (const auto& interval : region.free_blocks) {
+            layout.push_back(boost::icl::first(interval));
+            layout.push_back(boost::icl::length(interval));
+        }
+    }
+    return layout;
+}
+
+/**
+ * The kernel state which changes while the kernel layout doesn't: the scheduling of the threads,
+ * what they wait on, and the state of the objects they synchronize with. It holds copies of the
+ * kernel values, pointing to the same objects, so it only applies within the session.
+ */
+struct KernelState {
+    struct ThreadState {
+        Kernel::SharedPtr<Kernel::Thread> thread;
+        Kernel::ThreadStatus status;
+        u32 nominal_priority;
+        u32 current_priority;
+        u64 last_running_ticks;
+        boost::container::flat_set<Kernel::SharedPtr<Kernel::Mutex>> held_mutexes;
+        boost::container::flat_set<Kernel::SharedPtr<Kernel::Mutex>> pending_mutexes;
+        std::vector<Kernel::SharedPtr<Kernel::WaitObject>> wait_objects;
+        VAddr wait_address;
+        std::function<Kernel::Thread::WakeupCallback> wakeup_callback;
+    };
+
+    /// State of a kernel object, the members which don't apply to its type are left empty
+    struct ObjectState {
+        Kernel::SharedPtr<Kernel::Object> object;
+        /// Threads waiting on a wait object or on an address arbiter
+        std::vector<Kernel::SharedPtr<Kernel::Thread>> waiting_threads;
+        /// Events and timers
+        bool signaled = false;
+        u64 initial_delay = 0;
+        u64 interval_delay = 0;
+        /// Mutexes
+        int lock_count = 0;
+        u32 priority = 0;
+        Kernel::SharedPtr<Kernel::Thread> holding_thread;
+        /// Semaphores
+        s32 available_count = 0;
+        /// Server sessions
+        std::vector<Kernel::SharedPtr<Kernel::Thread>> pending_requesting_threads;
+        Kernel::SharedPtr<Kernel::Thread> currently_handling;
+        /// Server ports
+        std::vector<Kernel::SharedPtr<Kernel::ServerSession>> pending_sessions;
+    };
+
+    Kernel::SharedPtr<Kernel::Thread> current_thread;
+    /// The ready threads with their priority, in scheduling order
+    std::vector<std::pair<u32, Kernel::Thread*>> ready_threads;
+    std::vector<ThreadState> threads;
+    std::vector<ObjectState> objects;
+
+    static std::unique_ptr<KernelState> Capture();
+
+    /// Restores the state, the kernel layout must be the one it was captured with
+    void Restore() const;
+
+private:
+    static ObjectState CaptureObject(const Kernel::SharedPtr<Kernel::Object>& object);
+    static void RestoreObject(const ObjectState& state);
+};
+
+/// Returns the threads and the objects they and the processes refer to, each once
+static std::vector<Kernel::SharedPtr<Kernel::Object>> GetKernelObjects() {
+    auto& kernel = System::GetInstance().Kernel();
+    std::vector<Kernel::SharedPtr<Kernel::Object>> objects;
+    std::unordered_set<const Kernel::Object*> found;
+    const auto add_object = [&objects, &found](Kernel::SharedPtr<Kernel::Object> object) {
+        if (object != nullptr && found.insert(object.get()).second)
+            objects.push_back(std::move(object));
+    };
+
+    for (const auto& thread : kernel.GetThreadManager().GetThreadList()) {
+        add_object(thread);
+        for (const auto& object : thread->wait_objects)
+            add_object(object);
+        for (const auto& mutex : thread->held_mutexes)
+            add_object(mutex);
+        for (const auto& mutex : thread->pending_mutexes)
+            add_object(mutex);
+    }
+    for (const auto& process : kernel.GetProcessList()) {
+        for (const auto& [handle, object] : process->handle_table.GetHandles())
+            add_object(object);
+    }
+    return objects;
+}
+
+std::unique_ptr<KernelState> KernelState::Capture() {
+    auto& thread_manager = System::GetInstance().Kernel().GetThreadManager();
+    auto state = std::make_unique<KernelState>();
+
+    state->current_thread = thread_manager.current_thread;
+    thread_manager.ready_queue.for_each([&state](u32 priority, Kernel::Thread* thread) {
+        state->ready_threads.emplace_back(priority, thread);
+    });
+    for (const auto& thread : thread_manager.GetThreadList()) {
+        state->threads.push_back({thread, thread->status, thread->nominal_priority,
+                                  thread->current_priority, thread->last_running_ticks,
+                                  thread->held_mutexes, thread->pending_mutexes,
+                                  thread->wait_objects, thread->wait_address,
+                                  thread->wakeup_callback});
+    }
+    for (const auto& object : GetKernelObjects()) {
+        state->objects.push_back(CaptureObject(object));
+    }
+    return state;
+}
+
+KernelState::ObjectState KernelState::CaptureObject(
+    const Kernel::SharedPtr<Kernel::Object>& object) {
+    ObjectState state;
+    state.object = object;
+    if (const auto wait_object = Kernel::DynamicObjectCast<Kernel::WaitObject>(object))
+        state.waiting_threads = wait_object->waiting_threads;
+
+    if (const auto event = Kernel::DynamicObjectCast<Kernel::Event>(object)) {
+        state.signaled = event->signaled;
+    } else if (const auto timer = Kernel::DynamicObjectCast<Kernel::Timer>(object)) {
+        state.signaled = timer->signaled;
+        state.initial_delay = timer->initial_delay;
+        state.interval_delay = timer->interval_delay;
+    } else if (const auto mutex = Kernel::DynamicObjectCast<Kernel::Mutex>(object)) {
+        state.lock_count = mutex->lock_count;
+        state.priority = mutex->priority;
+        state.holding_thread = mutex->holding_thread;
+    } else if (const auto semaphore = Kernel::DynamicObjectCast<Kernel::Semaphore>(object)) {
+        state.available_count = semaphore->available_count;
+    } else if (const auto session = Kernel::DynamicObjectCast<Kernel::ServerSession>(object)) {
+        state.pending_requesting_threads = session->pending_requesting_threads;
+        state.currently_handling = session->currently_handling;
+    } else if (const auto port = Kernel::DynamicObjectCast<Kernel::ServerPort>(object)) {
+        state.pending_sessions = port->pending_sessions;
+    } else if (const auto arbiter = Kernel::DynamicObjectCast<Kernel::AddressArbiter>(object)) {
+        state.waiting_threads = arbiter->waiting_threads;
+    }
+    return state;
+}
+
+void KernelState::RestoreObject(const ObjectState& state) {
+    const auto& object = state.object;
+    if (const auto wait_object = Kernel::DynamicObjectCast<Kernel::WaitObject>(object))
+        wait_object->waiting_threads = state.waiting_threads;
+
+    if (const auto event = Kernel::DynamicObjectCast<Kernel::Event>(object)) {
+        event->signaled = state.signaled;
+    } else if (const auto timer = Kernel::DynamicObjectCast<Kernel::Timer>(object)) {
+        timer->signaled = state.signaled;
+        timer->initial_delay = state.initial_delay;
+        timer->interval_delay = state.interval_delay;
+    } else if (const auto mutex = Kernel::DynamicObjectCast<Kernel::Mutex>(object)) {
+        mutex->lock_count = state.lock_count;
+        mutex->priority = state.priority;
+        mutex->holding_thread = state.holding_thread;
+    } else if (const auto semaphore = Kernel::DynamicObjectCast<Kernel::Semaphore>(object)) {
+        semaphore->available_count = state.available_count;
+    } else if (const auto session = Kernel::DynamicObjectCast<Kernel::ServerSession>(object)) {
+        session->pending_requesting_threads = state.pending_requesting_threads;
+        session->currently_handling = state.currently_handling;
+    } else if (const auto port = Kernel::DynamicObjectCast<Kernel::ServerPort>(object)) {
+        port->pending_sessions = state.pending_sessions;
+    } else if (const auto arbiter = Kernel::DynamicObjectCast<Kernel::AddressArbiter>(object)) {
+        arbiter->waiting_threads = state.waiting_threads;
+    }
+}
+
+void KernelState::Restore() const {
+    auto& kernel = System::GetInstance().Kernel();
+    auto& thread_manager = kernel.GetThreadManager();
+
+    // A thread refers to every object it waits on, so the objects which aren't part of the state
+    // had no waiting threads at capture
+    for (const auto& object : GetKernelObjects()) {
+        if (const auto wait_object = Kernel::DynamicObjectCast<Kernel::WaitObject>(object)) {
+            wait_object->waiting_threads.clear();
+        } else if (const auto arbiter = Kernel::DynamicObjectCast<Kernel::AddressArbiter>(object)) {
+            arbiter->waiting_threads.clear();
+        }
+    }
+
+    thread_manager.ready_queue.clear();
+    for (const ThreadState& state : threads) {
+        Kernel::Thread& thread = *state.thread;
+        thread.status = state.status;
+        thread.nominal_priority = state.nominal_priority;
+        thread.current_priority = state.current_priority;
+        thread.last_running_ticks = state.last_running_ticks;
+        thread.held_mutexes = state.held_mutexes;
+        thread.pending_mutexes = state.pending_mutexes;
+        thread.wait_objects = state.wait_objects;
+        thread.wait_address = state.wait_address;
+        thread.wakeup_callback = state.wakeup_callback;
+    }
+    for (const ObjectState& state : objects) {
+        RestoreObject(state);
+    }
+    for (const auto& [priority, thread] : ready_threads) {
+        thread_manager.ready_queue.push_back(priority, thread);
+    }
+
+    thread_manager.current_thread = current_thread;
+    if (current_thread != nullptr && kernel.GetCurrentProcess() != current_thread->owner_process) {
+        kernel.SetCurrentProcess(current_thread->owner_process);
+        Memory::SetCurrentPageTable(&current_thread->owner_process->vm_manager.page_table);
+    }
+}
+
+SaveState::~SaveState() = default;
+
+std::unique_ptr<SaveState> SaveState::Capture(const SaveState* previous) {
+    MICROPROFILE_SCOPE(Core_SaveState);
+
+    auto& system = System::GetInstance();
+    auto& kernel = system.Kernel();
+
+    // File reads write guest memory from the FS I/O thread, the captured memory holds the reads
+    // already submitted, which the threads waiting for them see as done once restored
+    system.WaitForFileReads();
+
+    // Write back the surfaces of the renderer, this also waits for the GPU thread to be idle
+    Memory::RasterizerFlushRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerFlushRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+
+    // The context of the running thread is only held by the CPU
+    Kernel::Thread* current_thread = kernel.GetThreadManager().GetCurrentThread();
+    if (current_thread != nullptr)
+        system.CPU().SaveContext(current_thread->context);
+
+    std::unique_ptr<SaveState> save_state(new SaveState);
+    save_state->kernel_layout = GetKernelLayout();
+    save_state->num_service_requests = Service::GetNumHandledRequests();
+    save_state->kernel_state = KernelState::Capture();
+    save_state->dsp_state = system.DSP().CaptureState();
+
+    u8* ptr = nullptr;
+    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+    DoState(p);
+    save_state->state.resize(ptr - static_cast<u8*>(nullptr));
+    ptr = save_state->state.data();
+    p.SetMode(PointerWrap::MODE_WRITE);
+    DoState(p);
+
+    save_state->memory.Capture(GetMemoryBlocks(), previous ? &previous->memory : nullptr);
+    return save_state;
+}
+
+SaveState::RestoreResult SaveState::Restore() const {
+    MICROPROFILE_SCOPE(Core_SaveState);
+
+    auto& system = System::GetInstance();
+    auto& kernel = system.Kernel();
+
+    if (GetKernelLayout() != kernel_layout) {
+        LOG_ERROR(Core, "Cannot restore a save state, the kernel changed since it was captured");
+        return RestoreResult::KernelChanged;
+    }
+    // The state of the HLE services isn't saved, it would no longer match the rest of the system
+    if (Service::GetNumHandledRequests() != num_service_requests) {
+        LOG_ERROR(Core, "Cannot restore a save state, the HLE services handled requests since it "
+                        "was captured");
+        return RestoreResult::ServicesChanged;
+    }
+
+    // A file read running now would write guest memory after it is restored
+    system.WaitForFileReads();
+
+    // Drop the surfaces of the renderer without writing them back, once the GPU thread is idle
+    Memory::RasterizerInvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerInvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+
+    // The memory allocated by the processes is the same as at capture, only its contents are
+    // restored
+    memory.Restore(GetMemoryBlocks());
+    kernel_state->Restore();
+    system.DSP().RestoreState(*dsp_state);
+
+    u8* ptr = const_cast<u8*>(state.data());
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    DoState(p);
+    ASSERT(p.error == PointerWrap::ERROR_NONE);
+
+    Kernel::Thread* current_thread = kernel.GetThreadManager().GetCurrentThread();
+    if (current_thread != nullptr) {
+        system.CPU().LoadContext(current_thread->context);
+        system.CPU().SetCP15Register(CP15_THREAD_URO, current_thread->GetTLSAddress());
+    }
+    // The code in guest memory may have changed
+    system.CPU().ClearInstructionCache();
+
+    VideoCore::RunSync([] {
+        for (u32 id = 0; id < Pica::Regs::NUM_REGS; ++id) {
+            VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+        }
+    });
+
+    return RestoreResult::Success;
+}
+
+} // namespace Core
@@ -0,0 +1,113 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "audio_core/dsp_interface.h"
+#include "common/common_types.h"
+#include "core/memory.h"
+
+namespace Core {
+
+/// A block of guest memory captured by a MemorySnapshot, its last page may be partial
+struct MemoryBlock {
+    u8* data;
+    std::size_t size;
+};
+
+/**
+ * Copy of blocks of guest memory, stored as reference-counted pages. A snapshot shares the pages
+ * which didn't change with the snapshot captured before it, so that capturing one only copies the
+ * pages written since, and keeping several of them for rewinding only costs their changed pages.
+ * Changed pages are found by comparing with the previous snapshot, as the CPU JIT writes guest
+ * memory directly and can't report the pages it touches.
+ */
+class MemorySnapshot {
+public:
+    /**
+     * Captures the contents of blocks.
+     * @param previous Snapshot of the same blocks captured before, whose pages are shared when
+     * they didn't change, or null to copy all the pages
+     */
+    void Capture(const std::vector<MemoryBlock>& blocks, const MemorySnapshot* previous);
+
+    /// Writes the captured contents back to blocks, which must have their sizes at capture time
+    void Restore(const std::vector<MemoryBlock>& blocks) const;
+
+    /// Returns the number of pages copied, rather than shared, by the last capture
+    std::size_t GetNumCopiedPages() const {
+        return num_copied_pages;
+    }
+
+private:
+    using Page = std::array<u8, Memory::PAGE_SIZE>;
+
+    /// Pages of all the blocks, one after another
+    std::vector<std::shared_ptr<const Page>> pages;
+    std::vector<std::size_t> block_sizes;
+    std::size_t num_copied_pages = 0;
+};
+
+struct KernelState;
+
+/**
+ * Snapshot of the running system, for quick saves and rewinding within an emulation session.
+ * It holds guest memory, the CPU contexts of the kernel threads, the scheduling of the threads and
+ * the state of the objects they synchronize with, the CoreTiming queue, the GPU and LCD registers,
+ * the PICA state and the state of the HLE DSP.
+ * The kernel state is held as references to the kernel objects, and the state of the HLE services
+ * isn't serialized yet. Instead, a state is only restored while the kernel layout is as it was at
+ * capture: the same threads, the same handles in the processes, pointing to the same objects, and
+ * the same memory allocated and mapped, and no requests handled by the HLE services since.
+ */
+class SaveState {
+public:
+    ~SaveState();
+
+    /**
+     * Captures the state of the system. Must be called from the CPU thread, between two runs of
+     * the CPU.
+     * @param previous State captured before in the same session, sharing its unchanged pages
+     */
+    static std::unique_ptr<SaveState> Capture(const SaveState* previous = nullptr);
+
+    enum class RestoreResult {
+        Success,         ///< The system is as it was at capture
+        KernelChanged,   ///< Not restored, the kernel layout changed since the capture
+        ServicesChanged, ///< Not restored, the HLE services handled requests since the capture
+    };
+
+    /**
+     * Restores the system to this state. Must be called from the CPU thread, between two runs of
+     * the CPU.
+     * @return Success if the state was restored. Otherwise, the reason it can't be restored, the
+     * running system is then left untouched.
+     */
+    RestoreResult Restore() const;
+
+    /// Returns the size of the serialized state, excluding guest memory
+    std::size_t GetStateSize() const {
+        return state.size();
+    }
+
+    const MemorySnapshot& GetMemory() const {
+        return memory;
+    }
+
+private:
+    SaveState() = default;
+
+    std::vector<u8> state;
+    std::vector<u64> kernel_layout;
+    u64 num_service_requests = 0; ///< Requests handled by the HLE services at capture
+    std::unique_ptr<KernelState> kernel_state;
+    std::unique_ptr<AudioCore::DspInterface::State> dsp_state;
+    MemorySnapshot memory;
+};
+
+} // namespace Core
@@ -71,6 +71,9 @@ void LogSettings() {
     LogSetting("Renderer_ShadersAccurateGs", Settings::values.shaders_accurate_gs);
     LogSetting("Renderer_ShadersAccurateMul", Settings::values.shaders_accurate_mul);
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
+    LogSetting("Renderer_UseDiskShaderCache", Settings::values.use_disk_shader_cache);
+    LogSetting("Renderer_UseAsynchronousGpu", Settings::values.use_asynchronous_gpu);
+    LogSetting("Renderer_UseNullRenderer", Settings::values.use_null_renderer);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_UseVsync", Settings::values.use_vsync);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
@@ -81,6 +84,7 @@ void LogSettings() {
     LogSetting("Layout_SwapScreen", Settings::values.swap_screen);
     LogSetting("Audio_OutputEngine", Settings::values.sink_id);
     LogSetting("Audio_EnableAudioStretching", Settings::values.enable_audio_stretching);
+    LogSetting("Audio_EnableAudioRenderAhead", Settings::values.enable_audio_render_ahead);
     LogSetting("Audio_OutputDevice", Settings::values.audio_device_id);
     using namespace Service::CAM;
     LogSetting("Camera_OuterRightName", Settings::values.camera_name[OuterRightCamera]);
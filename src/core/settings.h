@@ -122,6 +122,9 @@ struct Values {
     bool shaders_accurate_gs;
     bool shaders_accurate_mul;
     bool use_shader_jit;
+    bool use_disk_shader_cache;
+    bool use_asynchronous_gpu;
+    bool use_null_renderer;
     u16 resolution_factor;
     bool use_vsync;
     bool use_frame_limit;
@@ -149,6 +152,7 @@ struct Values {
     // Audio
     std::string sink_id;
     bool enable_audio_stretching;
+    bool enable_audio_render_ahead;
     std::string audio_device_id;
     float volume;
 
@@ -8,6 +8,7 @@
 #include <regex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <glad/glad.h>
 
 #ifdef _MSC_VER
@@ -38,6 +39,9 @@ static void PrintHelp(const char* argv0) {
                  "--room-name         The name of the room\n"
                  "--port              The port used for the room\n"
                  "--max_members       The maximum number of players for this room\n"
+                 "--rooms             The number of rooms to host, on consecutive ports\n"
+                 "--threads           The number of threads servicing the rooms, by default one\n"
+                 "                    per core. Only used when hosting more than one room\n"
                  "--password          The password for the room\n"
                  "--preferred-game    The preferred game for this room\n"
                  "--preferred-game-id The preferred game-id for this room\n"
@@ -71,11 +75,15 @@ int main(int argc, char** argv) {
     u64 preferred_game_id = 0;
     u32 port = Network::DefaultRoomPort;
     u32 max_members = 16;
+    u32 num_rooms = 1;
+    u32 num_threads = 0;
 
     static struct option long_options[] = {
         {"room-name", required_argument, 0, 'n'},
         {"port", required_argument, 0, 'p'},
         {"max_members", required_argument, 0, 'm'},
+        {"rooms", required_argument, 0, 'r'},
+        {"threads", required_argument, 0, 'c'},
         {"password", required_argument, 0, 'w'},
         {"preferred-game", required_argument, 0, 'g'},
         {"preferred-game-id", required_argument, 0, 'i'},
@@ -88,7 +96,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "n:p:m:w:g:u:t:a:i:hv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "n:p:m:r:c:w:g:u:t:a:i:hv", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
             case 'n':
@@ -100,6 +108,12 @@ int main(int argc, char** argv) {
             case 'm':
                 max_members = strtoul(optarg, &endarg, 0);
                 break;
+            case 'r':
+                num_rooms = strtoul(optarg, &endarg, 0);
+                break;
+            case 'c':
+                num_threads = strtoul(optarg, &endarg, 0);
+                break;
             case 'w':
                 password.assign(optarg);
                 break;
@@ -153,6 +167,11 @@ int main(int argc, char** argv) {
         PrintHelp(argv[0]);
         return -1;
     }
+    if (num_rooms < 1 || port + num_rooms - 1 > 65535) {
+        std::cout << "rooms needs to be at least 1, and the last port at most 65535!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
     bool announce = true;
     if (username.empty()) {
         announce = false;
@@ -168,19 +187,52 @@ int main(int argc, char** argv) {
     }
     if (announce) {
         std::cout << "Hosting a public room\n\n";
+        if (num_rooms > 1) {
+            std::cout << "Only the first room is announced\n\n";
+        }
         Settings::values.web_api_url = web_api_url;
         Settings::values.citra_username = username;
         Settings::values.citra_token = token;
     }
 
     Network::Init();
+    // The rooms after the first one are private, and serviced by a pool of threads along with it
+    std::unique_ptr<Network::RoomPool> pool;
+    if (num_rooms > 1) {
+        pool = std::make_unique<Network::RoomPool>(num_threads);
+    }
+    std::vector<std::unique_ptr<Network::Room>> other_rooms;
     if (std::shared_ptr<Network::Room> room = Network::GetRoom().lock()) {
         if (!room->Create(room_name, "", port, password, max_members, preferred_game,
-                          preferred_game_id)) {
+                          preferred_game_id, pool.get())) {
             std::cout << "Failed to create room: \n\n";
             return -1;
         }
-        std::cout << "Room is open. Close with Q+Enter...\n\n";
+        for (u32 i = 1; i < num_rooms; ++i) {
+            auto other_room = std::make_unique<Network::Room>();
+            if (!other_room->Create(room_name + " " + std::to_string(i + 1), "", port + i,
+                                    password, max_members, preferred_game, preferred_game_id,
+                                    pool.get())) {
+                std::cout << "Failed to create room on port " << port + i << "\n\n";
+                break;
+            }
+            other_rooms.push_back(std::move(other_room));
+        }
+        const auto destroy_rooms = [&] {
+            for (const auto& other_room : other_rooms) {
+                other_room->Destroy();
+            }
+            other_rooms.clear();
+            room->Destroy();
+            pool.reset();
+        };
+
+        if (other_rooms.empty()) {
+            std::cout << "Room is open. Close with Q+Enter...\n\n";
+        } else {
+            std::cout << other_rooms.size() + 1 << " rooms are open on the ports " << port
+                      << " - " << port + other_rooms.size() << ". Close with Q+Enter...\n\n";
+        }
         auto announce_session = std::make_unique<Core::AnnounceMultiplayerSession>();
         if (announce) {
             announce_session->Start();
@@ -193,7 +245,7 @@ int main(int argc, char** argv) {
                     announce_session->Stop();
                 }
                 announce_session.reset();
-                room->Destroy();
+                destroy_rooms();
                 Network::Shutdown();
                 return 0;
             }
@@ -203,7 +255,7 @@ int main(int argc, char** argv) {
             announce_session->Stop();
         }
         announce_session.reset();
-        room->Destroy();
+        destroy_rooms();
     }
     Network::Shutdown();
     detached_tasks.WaitForAllTasks();
@@ -4,18 +4,35 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <iomanip>
+#include <list>
 #include <mutex>
 #include <random>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room.h"
+#include "network/wakeup_socket.h"
 
 namespace Network {
 
+/// Longest time a room isn't serviced, for the timeouts and pings of its connections
+constexpr u32 ServiceIntervalMs = 50;
+
+struct MacAddressHash {
+    std::size_t operator()(const MacAddress& address) const {
+        u64 value = 0;
+        std::memcpy(&value, address.data(), sizeof(MacAddress));
+        return std::hash<u64>()(value);
+    }
+};
+
 class Room::RoomImpl {
 public:
     // This MAC address is used to generate a 'Nintendo' like Mac address.
@@ -35,21 +52,36 @@ public:
         MacAddress mac_address; ///< The assigned mac address of the member.
         ENetPeer* peer;         ///< The remote peer.
     };
-    using MemberList = std::vector<Member>;
-    MemberList members;              ///< Information about the members of this room
-    mutable std::mutex member_mutex; ///< Mutex for locking the members list
+    using MemberList = std::list<Member>;
+    MemberList members; ///< Information about the members of this room, in the order they joined
+    /// The members by MAC address, for forwarding the frames sent to one member
+    std::unordered_map<MacAddress, MemberList::iterator, MacAddressHash> members_by_mac;
+    /// The members by peer, for finding the sender of a packet
+    std::unordered_map<const ENetPeer*, MemberList::iterator> members_by_peer;
+    mutable std::mutex member_mutex; ///< Mutex for locking the members list and its indices
     /// This should be a std::shared_mutex as soon as C++17 is supported
 
     RoomImpl()
         : random_gen(std::random_device()()), NintendoOUI{0x00, 0x1F, 0x32, 0x00, 0x00, 0x00} {}
 
-    /// Thread that receives and dispatches network packets
+    /// Thread that receives and dispatches network packets, unless a pool services the room
     std::unique_ptr<std::thread> room_thread;
+    /// The threads servicing the room, if it doesn't have its own
+    RoomPool* pool = nullptr;
 
     /// Thread function that will receive and dispatch messages until the room is destroyed.
     void ServerLoop();
     void StartLoop();
 
+    /// Dispatches the messages which were received, without waiting for more
+    void Service();
+
+    /**
+     * Dispatches a received message.
+     * @param event The ENet event that was received.
+     */
+    void HandleEvent(ENetEvent* event);
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the username and assigns the MAC address
@@ -123,7 +155,8 @@ public:
     MacAddress GenerateMacAddress();
 
     /**
-     * Broadcasts this packet to all members except the sender.
+     * Forwards this packet to its destination, or to all members except the sender if it's
+     * broadcast. The received packet itself is sent, and freed by ENet once it's sent.
      * @param event The ENet event containing the data
      */
     void HandleWifiPacket(const ENetEvent* event);
@@ -156,38 +189,54 @@ public:
 void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
         ENetEvent event;
-        if (enet_host_service(server, &event, 50) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
+        if (enet_host_service(server, &event, ServiceIntervalMs) > 0) {
+            HandleEvent(&event);
+            Service();
         }
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::Service() {
+    ENetEvent event;
+    while (enet_host_service(server, &event, 0) > 0) {
+        HandleEvent(&event);
+    }
+    enet_host_flush(server);
+}
+
+void Room::RoomImpl::HandleEvent(ENetEvent* event) {
+    switch (event->type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        switch (event->packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(event);
+            break;
+        case IdSetGameInfo:
+            HandleGameNamePacket(event);
+            break;
+        case IdWifiPacket:
+            HandleWifiPacket(event);
+            break;
+        case IdChatMessage:
+            HandleChatPacket(event);
+            break;
+        }
+        // Packets which were forwarded as they are are freed by ENet once they are sent
+        if (event->packet->referenceCount == 0) {
+            enet_packet_destroy(event->packet);
+        }
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event->peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
@@ -242,7 +291,9 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     {
         std::lock_guard<std::mutex> lock(member_mutex);
-        members.push_back(std::move(member));
+        const auto added = members.insert(members.end(), std::move(member));
+        members_by_mac.emplace(added->mac_address, added);
+        members_by_peer.emplace(added->peer, added);
     }
 
     // Notify everyone that the room information has changed.
@@ -261,8 +312,7 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it is not already taken by anybody else in the room.
     std::lock_guard<std::mutex> lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&address](const auto& member) { return member.mac_address != address; });
+    return members_by_mac.count(address) == 0;
 }
 
 void Room::RoomImpl::SendNameCollision(ENetPeer* client) {
@@ -372,51 +422,36 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // Message type, WifiPacket type, WifiPacket channel and WifiPacket transmitter address
+    constexpr std::size_t DestinationOffset = 3 * sizeof(u8) + sizeof(MacAddress);
+    if (event->packet->dataLength < DestinationOffset + sizeof(MacAddress)) {
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
-
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    std::memcpy(destination_address.data(), event->packet->data + DestinationOffset,
+                sizeof(MacAddress));
 
+    // The frame is relayed on the channel and with the reliability it was sent with, which the
+    // received packet keeps
+    std::lock_guard<std::mutex> lock(member_mutex);
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard<std::mutex> lock(member_mutex);
-        bool sent_packet = false;
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
+                enet_peer_send(member.peer, event->channelID, event->packet);
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
-        std::lock_guard<std::mutex> lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
+        const auto member = members_by_mac.find(destination_address);
+        if (member != members_by_mac.end()) {
+            enet_peer_send(member->second->peer, event->channelID, event->packet);
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -426,22 +461,19 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
     in_packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
     std::string message;
     in_packet >> message;
-    auto CompareNetworkAddress = [event](const Member member) -> bool {
-        return member.peer == event->peer;
-    };
-
     std::lock_guard<std::mutex> lock(member_mutex);
-    const auto sending_member = std::find_if(members.begin(), members.end(), CompareNetworkAddress);
-    if (sending_member == members.end()) {
+    const auto sender = members_by_peer.find(event->peer);
+    if (sender == members_by_peer.end()) {
         return; // Received a chat message from a unknown sender
     }
+    const Member& sending_member = *sender->second;
 
     // Limit the size of chat messages to MaxMessageSize
     message.resize(MaxMessageSize);
 
     Packet out_packet;
     out_packet << static_cast<u8>(IdChatMessage);
-    out_packet << sending_member->nickname;
+    out_packet << sending_member.nickname;
     out_packet << message;
 
     ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
@@ -472,12 +504,9 @@ void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
 
     {
         std::lock_guard<std::mutex> lock(member_mutex);
-        auto member =
-            std::find_if(members.begin(), members.end(), [event](const Member& member) -> bool {
-                return member.peer == event->peer;
-            });
-        if (member != members.end()) {
-            member->game_info = game_info;
+        const auto member = members_by_peer.find(event->peer);
+        if (member != members_by_peer.end()) {
+            member->second->game_info = game_info;
         }
     }
     BroadcastRoomInformation();
@@ -487,10 +516,12 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
     // Remove the client from the members list.
     {
         std::lock_guard<std::mutex> lock(member_mutex);
-        members.erase(
-            std::remove_if(members.begin(), members.end(),
-                           [client](const Member& member) { return member.peer == client; }),
-            members.end());
+        const auto member = members_by_peer.find(client);
+        if (member != members_by_peer.end()) {
+            members_by_mac.erase(member->second->mac_address);
+            members.erase(member->second);
+            members_by_peer.erase(member);
+        }
     }
 
     // Announce the change to all clients.
@@ -519,7 +550,7 @@ Room::~Room() = default;
 
 bool Room::Create(const std::string& name, const std::string& server_address, u16 server_port,
                   const std::string& password, const u32 max_connections,
-                  const std::string& preferred_game, u64 preferred_game_id) {
+                  const std::string& preferred_game, u64 preferred_game_id, RoomPool* pool) {
     ENetAddress address;
     address.host = ENET_HOST_ANY;
     if (!server_address.empty()) {
@@ -541,7 +572,12 @@ bool Room::Create(const std::string& name, const std::string& server_address, u1
     room_impl->password = password;
     room_impl->CreateUniqueID();
 
-    room_impl->StartLoop();
+    if (pool) {
+        room_impl->pool = pool;
+        pool->Add(*room_impl);
+    } else {
+        room_impl->StartLoop();
+    }
     return true;
 }
 
@@ -572,8 +608,14 @@ bool Room::HasPassword() const {
 
 void Room::Destroy() {
     room_impl->state = State::Closed;
-    room_impl->room_thread->join();
-    room_impl->room_thread.reset();
+    if (room_impl->pool) {
+        room_impl->pool->Remove(*room_impl);
+        room_impl->pool = nullptr;
+        room_impl->SendCloseMessage();
+    } else {
+        room_impl->room_thread->join();
+        room_impl->room_thread.reset();
+    }
 
     if (room_impl->server) {
         enet_host_destroy(room_impl->server);
@@ -583,9 +625,145 @@ void Room::Destroy() {
     {
         std::lock_guard<std::mutex> lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->members_by_mac.clear();
+        room_impl->members_by_peer.clear();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
 }
 
+// RoomPool
+class RoomPool::Worker {
+public:
+    Worker() {
+        if (!wakeup_socket.Create()) {
+            LOG_ERROR(Network, "Could not create the wakeup socket, rooms will be slow to start");
+        }
+        thread = std::thread(&Worker::Loop, this);
+    }
+
+    ~Worker() {
+        running = false;
+        wakeup_socket.Signal();
+        thread.join();
+    }
+
+    std::size_t GetNumRooms() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return rooms.size();
+    }
+
+    void Add(Room::RoomImpl& room) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            rooms.push_back(&room);
+        }
+        // Have the thread wait for the socket of the room too
+        wakeup_socket.Signal();
+    }
+
+    bool Remove(Room::RoomImpl& room) {
+        // The rooms are only serviced with the lock held
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = std::find(rooms.begin(), rooms.end(), &room);
+        if (it == rooms.end()) {
+            return false;
+        }
+        rooms.erase(it);
+        return true;
+    }
+
+private:
+    void Loop();
+
+    std::thread thread;
+    std::atomic<bool> running{true};
+    WakeupSocket wakeup_socket;
+
+    mutable std::mutex mutex; ///< Mutex for the rooms, held while they are serviced
+    std::vector<Room::RoomImpl*> rooms;
+};
+
+void RoomPool::Worker::Loop() {
+    using Clock = std::chrono::steady_clock;
+    auto last_full_service = Clock::now();
+    std::vector<pollfd> poll_fds;
+    std::vector<ENetSocket> ready_sockets;
+    while (running) {
+        // Sleep until one of the rooms receives something, without holding the lock
+        poll_fds.clear();
+        const auto add_socket = [&poll_fds](ENetSocket socket) {
+            pollfd poll_fd{};
+            poll_fd.fd = socket;
+            poll_fd.events = POLLIN;
+            poll_fds.push_back(poll_fd);
+        };
+        if (wakeup_socket.IsOpen()) {
+            add_socket(wakeup_socket.GetSocket());
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const Room::RoomImpl* room : rooms) {
+                add_socket(room->server->socket);
+            }
+        }
+        PollSockets(poll_fds, ServiceIntervalMs);
+
+        // Rooms may have been added or removed meanwhile, so they are looked up by socket
+        ready_sockets.clear();
+        for (const pollfd& poll_fd : poll_fds) {
+            if (poll_fd.revents != 0) {
+                ready_sockets.push_back(poll_fd.fd);
+            }
+        }
+        std::sort(ready_sockets.begin(), ready_sockets.end());
+        const auto is_ready = [&ready_sockets](ENetSocket socket) {
+            return std::binary_search(ready_sockets.begin(), ready_sockets.end(), socket);
+        };
+        if (wakeup_socket.IsOpen() && is_ready(wakeup_socket.GetSocket())) {
+            wakeup_socket.Drain();
+        }
+
+        // The rooms which received something are serviced right away, and all of them regularly
+        const auto now = Clock::now();
+        const bool service_all =
+            now - last_full_service >= std::chrono::milliseconds(ServiceIntervalMs);
+        if (service_all) {
+            last_full_service = now;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Room::RoomImpl* room : rooms) {
+            if (service_all || is_ready(room->server->socket)) {
+                room->Service();
+            }
+        }
+    }
+}
+
+RoomPool::RoomPool(std::size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+RoomPool::~RoomPool() = default;
+
+void RoomPool::Add(Room::RoomImpl& room) {
+    const auto worker = std::min_element(
+        workers.begin(), workers.end(),
+        [](const auto& a, const auto& b) { return a->GetNumRooms() < b->GetNumRooms(); });
+    (*worker)->Add(room);
+}
+
+void RoomPool::Remove(Room::RoomImpl& room) {
+    for (const auto& worker : workers) {
+        if (worker->Remove(room)) {
+            return;
+        }
+    }
+}
+
 } // namespace Network
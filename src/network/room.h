@@ -12,7 +12,7 @@
 
 namespace Network {
 
-constexpr u32 network_version = 3; ///< The version of this Room and RoomMember
+constexpr u32 network_version = 4; ///< The version of this Room and RoomMember
 
 constexpr u16 DefaultRoomPort = 24872;
 
@@ -21,7 +21,12 @@ constexpr u32 MaxMessageSize = 500;
 /// Maximum number of concurrent connections allowed to this room.
 static constexpr u32 MaxConcurrentConnections = 254;
 
-constexpr std::size_t NumChannels = 1; // Number of channels used for the connection
+constexpr std::size_t NumChannels = 2; // Number of channels used for the connection
+
+/// Channel of the messages which must arrive, in the order they were sent
+constexpr u8 ReliableChannel = 0;
+/// Channel of the WiFi beacon and data frames, which may be dropped like they are over the air
+constexpr u8 WifiChannel = 1;
 
 struct RoomInformation {
     std::string name;           ///< Name of the server
@@ -60,6 +65,8 @@ enum RoomMessageTypes : u8 {
     IdCloseRoom
 };
 
+class RoomPool;
+
 /// This is what a server [person creating a server] would use.
 class Room final {
 public:
@@ -100,11 +107,14 @@ public:
     /**
      * Creates the socket for this room. Will bind to default address if
      * server is empty string.
+     * @param pool The threads servicing the room, or nullptr to service it on its own thread.
+     * The pool must outlive the room.
      */
     bool Create(const std::string& name, const std::string& server = "",
                 u16 server_port = DefaultRoomPort, const std::string& password = "",
                 const u32 max_connections = MaxConcurrentConnections,
-                const std::string& preferred_game = "", u64 preferred_game_id = 0);
+                const std::string& preferred_game = "", u64 preferred_game_id = 0,
+                RoomPool* pool = nullptr);
 
     /**
      * Destroys the socket
@@ -114,6 +124,36 @@ public:
 private:
     class RoomImpl;
     std::unique_ptr<RoomImpl> room_impl;
+
+    friend class RoomPool;
+};
+
+/**
+ * Services the connections of many rooms on a fixed number of threads, for servers hosting more
+ * rooms than they have cores. Each room is serviced by one of the threads, which sleeps until one
+ * of its rooms receives something.
+ */
+class RoomPool final {
+public:
+    /// Starts the threads, or one for each core if num_threads is 0
+    explicit RoomPool(std::size_t num_threads = 0);
+    ~RoomPool();
+
+    RoomPool(const RoomPool&) = delete;
+    RoomPool& operator=(const RoomPool&) = delete;
+
+private:
+    class Worker;
+
+    friend class Room;
+
+    /// Services the room on the thread servicing the fewest rooms
+    void Add(Room::RoomImpl& room);
+
+    /// Stops servicing the room, once the thread is done with it
+    void Remove(Room::RoomImpl& room);
+
+    std::vector<std::unique_ptr<Worker>> workers;
 };
 
 } // namespace Network
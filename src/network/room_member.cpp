@@ -3,18 +3,21 @@
 // Refer to the license.txt file included.
 
 #include <atomic>
-#include <list>
 #include <mutex>
 #include <set>
 #include <thread>
+#include <vector>
 #include "common/assert.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room_member.h"
+#include "network/wakeup_socket.h"
 
 namespace Network {
 
 constexpr u32 ConnectionTimeoutMs = 5000;
+/// Longest time the loop sleeps without servicing the connection, for its timeouts and pings
+constexpr u32 ServiceIntervalMs = 100;
 
 class RoomMember::RoomMemberImpl {
 public:
@@ -39,8 +42,17 @@ public:
     std::mutex network_mutex; ///< Mutex that controls access to the `client` variable.
     /// Thread that receives and dispatches network packets
     std::unique_ptr<std::thread> loop_thread;
-    std::mutex send_list_mutex;  ///< Mutex that controls access to the `send_list` variable.
-    std::list<Packet> send_list; ///< A list that stores all packets to send the async
+
+    struct OutgoingPacket {
+        Packet packet;
+        u8 channel; ///< The ENet channel to send the packet on
+        u32 flags;  ///< The ENet packet flags
+    };
+    std::mutex send_list_mutex; ///< Mutex that controls access to the `send_list` variable.
+    std::vector<OutgoingPacket> send_list; ///< The packets waiting to be sent by the loop
+
+    /// Wakes the loop up as soon as a packet is queued
+    WakeupSocket wakeup_socket;
 
     template <typename T>
     using CallbackSet = std::set<CallbackHandle<T>>;
@@ -64,10 +76,24 @@ public:
     void StartLoop();
 
     /**
-     * Sends data to the room. It will be send on channel 0 with flag RELIABLE
+     * Handles an event of the connection to the room.
+     * @param event The ENet event that was received.
+     */
+    void HandleEvent(const ENetEvent* event);
+
+    /**
+     * Sends the queued packets to the room, which ENet coalesces into as few datagrams as it can.
+     */
+    void FlushSendList();
+
+    /**
+     * Queues data to send to the room, and wakes up the loop to send it.
      * @param packet The data to send
+     * @param channel The ENet channel to send it on
+     * @param flags The ENet packet flags, by default it must arrive
      */
-    void Send(Packet&& packet);
+    void Send(Packet&& packet, u8 channel = ReliableChannel,
+              u32 flags = ENET_PACKET_FLAG_RELIABLE);
 
     /**
      * Sends a request to the server, asking for permission to join a room with the specified
@@ -129,75 +155,107 @@ bool RoomMember::RoomMemberImpl::IsConnected() const {
 }
 
 void RoomMember::RoomMemberImpl::MemberLoop() {
+    std::vector<pollfd> poll_fds(2);
+    poll_fds[0].fd = client->socket;
+    poll_fds[0].events = POLLIN;
+    poll_fds[1].fd = wakeup_socket.GetSocket();
+    poll_fds[1].events = POLLIN;
+
     // Receive packets while the connection is open
     while (IsConnected()) {
+        // Sleep until the room sends something or a packet is queued, without holding the lock
+        PollSockets(poll_fds, ServiceIntervalMs);
+        if (poll_fds[1].revents != 0) {
+            wakeup_socket.Drain();
+        }
+
         std::lock_guard<std::mutex> lock(network_mutex);
         ENetEvent event;
-        if (enet_host_service(client, &event, 100) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdWifiPacket:
-                    HandleWifiPackets(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                case IdRoomInformation:
-                    HandleRoomInformationPacket(&event);
-                    break;
-                case IdJoinSuccess:
-                    // The join request was successful, we are now in the room.
-                    // If we joined successfully, there must be at least one client in the room: us.
-                    ASSERT_MSG(member_information.size() > 0,
-                               "We have not yet received member information.");
-                    HandleJoinPacket(&event); // Get the MAC Address for the client
-                    SetState(State::Joined);
-                    break;
-                case IdNameCollision:
-                    SetState(State::NameCollision);
-                    break;
-                case IdMacCollision:
-                    SetState(State::MacCollision);
-                    break;
-                case IdVersionMismatch:
-                    SetState(State::WrongVersion);
-                    break;
-                case IdWrongPassword:
-                    SetState(State::WrongPassword);
-                    break;
-                case IdCloseRoom:
-                    SetState(State::LostConnection);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                SetState(State::LostConnection);
-                break;
-            }
-        }
-        {
-            std::lock_guard<std::mutex> lock(send_list_mutex);
-            for (const auto& packet : send_list) {
-                ENetPacket* enetPacket = enet_packet_create(packet.GetData(), packet.GetDataSize(),
-                                                            ENET_PACKET_FLAG_RELIABLE);
-                enet_peer_send(server, 0, enetPacket);
-            }
-            enet_host_flush(client);
-            send_list.clear();
+        while (enet_host_service(client, &event, 0) > 0) {
+            HandleEvent(&event);
         }
+        FlushSendList();
     }
     Disconnect();
 };
 
+void RoomMember::RoomMemberImpl::HandleEvent(const ENetEvent* event) {
+    switch (event->type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        switch (event->packet->data[0]) {
+        case IdWifiPacket:
+            HandleWifiPackets(event);
+            break;
+        case IdChatMessage:
+            HandleChatPacket(event);
+            break;
+        case IdRoomInformation:
+            HandleRoomInformationPacket(event);
+            break;
+        case IdJoinSuccess:
+            // The join request was successful, we are now in the room.
+            // If we joined successfully, there must be at least one client in the room: us.
+            ASSERT_MSG(member_information.size() > 0,
+                       "We have not yet received member information.");
+            HandleJoinPacket(event); // Get the MAC Address for the client
+            SetState(State::Joined);
+            break;
+        case IdNameCollision:
+            SetState(State::NameCollision);
+            break;
+        case IdMacCollision:
+            SetState(State::MacCollision);
+            break;
+        case IdVersionMismatch:
+            SetState(State::WrongVersion);
+            break;
+        case IdWrongPassword:
+            SetState(State::WrongPassword);
+            break;
+        case IdCloseRoom:
+            SetState(State::LostConnection);
+            break;
+        }
+        enet_packet_destroy(event->packet);
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        SetState(State::LostConnection);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
+void RoomMember::RoomMemberImpl::FlushSendList() {
+    std::vector<OutgoingPacket> packets;
+    {
+        std::lock_guard<std::mutex> lock(send_list_mutex);
+        packets.swap(send_list);
+    }
+    for (const auto& outgoing : packets) {
+        ENetPacket* enet_packet = enet_packet_create(
+            outgoing.packet.GetData(), outgoing.packet.GetDataSize(), outgoing.flags);
+        enet_peer_send(server, outgoing.channel, enet_packet);
+    }
+    enet_host_flush(client);
+}
+
 void RoomMember::RoomMemberImpl::StartLoop() {
     loop_thread = std::make_unique<std::thread>(&RoomMember::RoomMemberImpl::MemberLoop, this);
 }
 
-void RoomMember::RoomMemberImpl::Send(Packet&& packet) {
-    std::lock_guard<std::mutex> lock(send_list_mutex);
-    send_list.push_back(std::move(packet));
+void RoomMember::RoomMemberImpl::Send(Packet&& packet, u8 channel, u32 flags) {
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(send_list_mutex);
+        was_empty = send_list.empty();
+        send_list.push_back({std::move(packet), channel, flags});
+    }
+    // The loop empties the list after draining the signals, so one signal is enough until then
+    if (was_empty) {
+        wakeup_socket.Signal();
+    }
 }
 
 void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
@@ -406,6 +464,11 @@ void RoomMember::Join(const std::string& nick, const char* server_addr, u16 serv
         ASSERT_MSG(room_member_impl->client != nullptr, "Could not create client");
     }
 
+    if (!room_member_impl->wakeup_socket.IsOpen() && !room_member_impl->wakeup_socket.Create()) {
+        room_member_impl->SetState(State::Error);
+        return;
+    }
+
     room_member_impl->SetState(State::Joining);
 
     ENetAddress address{};
@@ -444,7 +507,15 @@ void RoomMember::SendWifiPacket(const WifiPacket& wifi_packet) {
     packet << wifi_packet.transmitter_address;
     packet << wifi_packet.destination_address;
     packet << wifi_packet.data;
-    room_member_impl->Send(std::move(packet));
+
+    // Beacons and data frames are lost over the air too, and the games retransmit what they need.
+    // Sending them unreliably keeps a lost datagram from holding back the newer frames.
+    if (wifi_packet.type == WifiPacket::PacketType::Beacon ||
+        wifi_packet.type == WifiPacket::PacketType::Data) {
+        room_member_impl->Send(std::move(packet), WifiChannel, 0);
+    } else {
+        room_member_impl->Send(std::move(packet));
+    }
 }
 
 void RoomMember::SendChatMessage(const std::string& message) {
@@ -494,11 +565,13 @@ void RoomMember::Unbind(CallbackHandle<T> handle) {
 
 void RoomMember::Leave() {
     room_member_impl->SetState(State::Idle);
+    room_member_impl->wakeup_socket.Signal();
     room_member_impl->loop_thread->join();
     room_member_impl->loop_thread.reset();
 
     enet_host_destroy(room_member_impl->client);
     room_member_impl->client = nullptr;
+    room_member_impl->wakeup_socket.Destroy();
 }
 
 template void RoomMember::Unbind(CallbackHandle<WifiPacket>);
@@ -0,0 +1,62 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/common_types.h"
+#include "network/wakeup_socket.h"
+
+namespace Network {
+
+void PollSockets(std::vector<pollfd>& poll_fds, int timeout_ms) {
+#ifdef _WIN32
+    WSAPoll(poll_fds.data(), static_cast<ULONG>(poll_fds.size()), timeout_ms);
+#else
+    poll(poll_fds.data(), static_cast<nfds_t>(poll_fds.size()), timeout_ms);
+#endif
+}
+
+WakeupSocket::~WakeupSocket() {
+    Destroy();
+}
+
+bool WakeupSocket::Create() {
+    socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+    if (socket == ENET_SOCKET_NULL) {
+        return false;
+    }
+
+    ENetAddress loopback{};
+    enet_address_set_host(&loopback, "127.0.0.1");
+    if (enet_socket_bind(socket, &loopback) < 0 || enet_socket_get_address(socket, &address) < 0 ||
+        enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1) < 0) {
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void WakeupSocket::Destroy() {
+    if (socket != ENET_SOCKET_NULL) {
+        enet_socket_destroy(socket);
+        socket = ENET_SOCKET_NULL;
+    }
+}
+
+void WakeupSocket::Signal() {
+    u8 signal = 0;
+    ENetBuffer buffer;
+    buffer.data = &signal;
+    buffer.dataLength = sizeof(signal);
+    enet_socket_send(socket, &address, &buffer, 1);
+}
+
+void WakeupSocket::Drain() {
+    u8 signal;
+    ENetBuffer buffer;
+    buffer.data = &signal;
+    buffer.dataLength = sizeof(signal);
+    while (enet_socket_receive(socket, nullptr, &buffer, 1) > 0) {
+    }
+}
+
+} // namespace Network
@@ -0,0 +1,61 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "enet/enet.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+namespace Network {
+
+/**
+ * Waits until one of the sockets has something to read, or for the timeout. Unlike the fd_set of
+ * enet_socketset_select, poll takes sockets of any value, however many sockets the process has
+ * open.
+ */
+void PollSockets(std::vector<pollfd>& poll_fds, int timeout_ms);
+
+/**
+ * A loopback UDP socket which a thread waiting for its ENet sockets with PollSockets also waits
+ * for, so that other threads can wake it up.
+ */
+class WakeupSocket final {
+public:
+    WakeupSocket() = default;
+    ~WakeupSocket();
+
+    WakeupSocket(const WakeupSocket&) = delete;
+    WakeupSocket& operator=(const WakeupSocket&) = delete;
+
+    /// Creates the socket. Returns whether it succeeded.
+    bool Create();
+
+    void Destroy();
+
+    bool IsOpen() const {
+        return socket != ENET_SOCKET_NULL;
+    }
+
+    ENetSocket GetSocket() const {
+        return socket;
+    }
+
+    /// Wakes up the thread waiting for the socket
+    void Signal();
+
+    /// Consumes the pending signals, once the thread is awake
+    void Drain();
+
+private:
+    ENetSocket socket = ENET_SOCKET_NULL;
+    ENetAddress address{}; ///< The address the socket is bound to
+};
+
+} // namespace Network
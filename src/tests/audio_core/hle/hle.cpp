@@ -0,0 +1,37 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/hle/hle.h"
+#include "core/core_timing.h"
+
+namespace AudioCore {
+
+TEST_CASE("DspHle restores captured states", "[audio_core][hle]") {
+    CoreTiming::Init();
+    {
+        DspHle dsp;
+        const auto off = dsp.CaptureState();
+
+        // Initializing the DSP writes the addresses of the 15 structs to the audio pipe
+        dsp.PipeWrite(DspPipe::Audio, {0, 0, 0, 0});
+        REQUIRE(dsp.GetDspState() == DspState::On);
+        REQUIRE(dsp.GetPipeReadableSize(DspPipe::Audio) == 32);
+        const auto on = dsp.CaptureState();
+        const std::vector<u8> struct_addresses = dsp.PipeRead(DspPipe::Audio, 32);
+        REQUIRE(dsp.GetPipeReadableSize(DspPipe::Audio) == 0);
+
+        dsp.RestoreState(*off);
+        REQUIRE(dsp.GetDspState() == DspState::Off);
+        REQUIRE(dsp.GetPipeReadableSize(DspPipe::Audio) == 0);
+
+        dsp.RestoreState(*on);
+        REQUIRE(dsp.GetDspState() == DspState::On);
+        REQUIRE(dsp.PipeRead(DspPipe::Audio, 32) == struct_addresses);
+    }
+    CoreTiming::Shutdown();
+}
+
+} // namespace AudioCore
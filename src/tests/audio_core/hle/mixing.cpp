@@ -0,0 +1,142 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <catch2/catch.hpp>
+#include "audio_core/hle/mixing.h"
+
+namespace AudioCore {
+namespace HLE {
+
+namespace {
+
+// Reference implementations, as the mixers and sources used to compute a sample at a time
+
+s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a, const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+void ReferenceMixInto(QuadFrame32& dest, const StereoFrame16& current_frame,
+                      const std::array<float, 4>& gains) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
+    }
+}
+
+void ReferenceDownmix(bool mono, float gain, const QuadFrame32& samples,
+                      StereoFrame16& current_frame) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const std::array<s32, 4>& sample = samples[samplei];
+        if (mono) {
+            s16 value = ClampToS16(static_cast<s32>(
+                (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+            current_frame[samplei] = AddAndClampToS16(current_frame[samplei], {value, value});
+        } else {
+            s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+            s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+            current_frame[samplei] = AddAndClampToS16(current_frame[samplei], {left, right});
+        }
+    }
+}
+
+StereoFrame16 RandomStereoFrame(std::mt19937& rng) {
+    StereoFrame16 frame;
+    for (auto& sample : frame) {
+        sample = {static_cast<s16>(rng()), static_cast<s16>(rng())};
+    }
+    return frame;
+}
+
+/// Mixes of a few full scale sources, which can overflow 16 bits when downmixed
+QuadFrame32 RandomQuadFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<s32> distribution(-4 * 32768, 4 * 32767);
+    QuadFrame32 frame;
+    for (auto& sample : frame) {
+        for (s32& channel : sample) {
+            channel = distribution(rng);
+        }
+    }
+    return frame;
+}
+
+/// Gains are usually within [0, 1], but the application may set any value
+float RandomGain(std::mt19937& rng) {
+    return std::uniform_real_distribution<float>(-0.5f, 2.0f)(rng);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MixStereoIntoQuad matches the per-sample mix", "[audio_core][hle]") {
+    std::mt19937 rng(1);
+
+    for (int i = 0; i < 100; ++i) {
+        const StereoFrame16 source = RandomStereoFrame(rng);
+        SourceGains gains;
+        for (auto& mix_gains : gains) {
+            std::generate(mix_gains.begin(), mix_gains.end(), [&] { return RandomGain(rng); });
+        }
+
+        std::array<QuadFrame32, 3> expected = {RandomQuadFrame(rng), RandomQuadFrame(rng),
+                                               RandomQuadFrame(rng)};
+        std::array<QuadFrame32, 3> mixes = expected;
+        for (std::size_t mix = 0; mix < 3; mix++) {
+            ReferenceMixInto(expected[mix], source, gains[mix]);
+        }
+        MixStereoIntoQuad(source, gains, mixes);
+
+        REQUIRE(mixes == expected);
+    }
+}
+
+TEST_CASE("Downmixing matches the per-sample downmix", "[audio_core][hle]") {
+    std::mt19937 rng(2);
+
+    for (bool mono : {false, true}) {
+        for (int i = 0; i < 100; ++i) {
+            const QuadFrame32 source = RandomQuadFrame(rng);
+            const float gain = RandomGain(rng);
+
+            StereoFrame16 expected = RandomStereoFrame(rng);
+            StereoFrame16 frame = expected;
+            ReferenceDownmix(mono, gain, source, expected);
+            if (mono) {
+                DownmixIntoMono(gain, source, frame);
+            } else {
+                DownmixIntoStereo(gain, source, frame);
+            }
+
+            INFO("mono " << mono << ", gain " << gain);
+            REQUIRE(frame == expected);
+        }
+    }
+}
+
+TEST_CASE("Intermediate mixes are transposed to and from shared memory", "[audio_core][hle]") {
+    std::mt19937 rng(3);
+
+    const QuadFrame32 frame = RandomQuadFrame(rng);
+    QuadChannels32 channels;
+    QuadFrameToChannels(frame, channels);
+    for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            REQUIRE(channels[channel][sample] == frame[sample][channel]);
+        }
+    }
+
+    QuadFrame32 result;
+    ChannelsToQuadFrame(channels, result);
+    REQUIRE(result == frame);
+}
+
+} // namespace HLE
+} // namespace AudioCore
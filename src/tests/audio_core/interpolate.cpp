@@ -0,0 +1,138 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <catch2/catch.hpp>
+#include "audio_core/interpolate.h"
+
+namespace AudioCore {
+namespace AudioInterp {
+
+namespace {
+
+constexpr u64 scale_factor = 1 << 24;
+constexpr u64 scale_mask = scale_factor - 1;
+
+// Reference implementation, stepping over the samples one output at a time as the interpolators
+// used to
+
+template <typename Function>
+void ReferenceStepOverSamples(State& state, StereoBuffer16& input, float rate,
+                              StereoFrame16& output, std::size_t& outputi, Function fn) {
+    if (input.empty())
+        return;
+
+    input.insert(input.begin(), {state.xn2, state.xn1});
+
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+    std::size_t inputi = 0;
+
+    while (outputi < output.size()) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+
+        if (inputi + 2 >= input.size()) {
+            inputi = input.size() - 2;
+            break;
+        }
+
+        u64 fraction = fposition & scale_mask;
+        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1]);
+
+        fposition += step_size;
+    }
+
+    state.xn2 = input[inputi];
+    state.xn1 = input[inputi + 1];
+    state.fposition = fposition - inputi * scale_factor;
+
+    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+}
+
+void ReferenceInterpolate(bool linear, State& state, StereoBuffer16& input, float rate,
+                          StereoFrame16& output, std::size_t& outputi) {
+    ReferenceStepOverSamples(
+        state, input, rate, output, outputi,
+        [linear](u64 fraction, const auto& x0, const auto& x1) -> std::array<s16, 2> {
+            if (!linear)
+                return x0;
+
+            s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+            s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+            return {
+                static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+                static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+            };
+        });
+}
+
+/// Mostly full scale noise, with runs of extreme values to cover the saturated differences
+StereoBuffer16 RandomBuffer(std::size_t size, std::mt19937& rng) {
+    StereoBuffer16 buffer(size);
+    for (auto& sample : buffer) {
+        switch (rng() % 4) {
+        case 0:
+            sample = {32767, -32768};
+            break;
+        case 1:
+            sample = {-32768, 32767};
+            break;
+        default:
+            sample = {static_cast<s16>(rng()), static_cast<s16>(rng())};
+            break;
+        }
+    }
+    return buffer;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Interpolation matches stepping over a sample at a time", "[audio_core]") {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> rates(0.05f, 4.0f);
+
+    for (bool linear : {false, true}) {
+        for (int i = 0; i < 200; ++i) {
+            const float rate = rng() % 8 == 0 ? 1.0f : rates(rng);
+            State expected_state;
+            State state;
+            StereoFrame16 expected_frame{};
+            StereoFrame16 frame{};
+            std::size_t expected_position = 0;
+            std::size_t position = 0;
+
+            // Feed buffers of various lengths, like a source dequeueing them, over a few frames
+            for (int buffer = 0; buffer < 20; ++buffer) {
+                StereoBuffer16 expected_input = RandomBuffer(rng() % 300, rng);
+                StereoBuffer16 input = expected_input;
+                while (!input.empty()) {
+                    if (position == frame.size()) {
+                        position = expected_position = 0;
+                    }
+                    const std::size_t input_size = input.size();
+                    ReferenceInterpolate(linear, expected_state, expected_input, rate,
+                                         expected_frame, expected_position);
+                    if (linear) {
+                        Linear(state, input, rate, frame, position);
+                    } else {
+                        None(state, input, rate, frame, position);
+                    }
+
+                    INFO("linear " << linear << ", rate " << rate << ", input " << input_size);
+                    REQUIRE(position == expected_position);
+                    REQUIRE(frame == expected_frame);
+                    REQUIRE(input == expected_input);
+                    REQUIRE(state.xn1 == expected_state.xn1);
+                    REQUIRE(state.xn2 == expected_state.xn2);
+                    REQUIRE(state.fposition == expected_state.fposition);
+                }
+            }
+        }
+    }
+}
+
+} // namespace AudioInterp
+} // namespace AudioCore
@@ -0,0 +1,110 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "common/linear_disk_cache.h"
+#include "tests/test_util.h"
+
+namespace {
+
+using Entry = std::pair<u64, std::vector<u8>>;
+
+constexpr u32 Version = 7;
+constexpr std::size_t HeaderSize = 12;
+constexpr std::size_t ValueSize = 5;
+/// value_size, key, value, entry_number, checksum
+constexpr std::size_t EntrySize = 4 + sizeof(u64) + ValueSize + 4 + 8;
+
+class EntryReader : public LinearDiskCacheReader<u64, u8> {
+public:
+    void Read(const u64& key, const u8* value, u32 value_size) override {
+        entries.emplace_back(key, std::vector<u8>(value, value + value_size));
+    }
+
+    std::vector<Entry> entries;
+};
+
+Entry MakeEntry(u64 key, std::size_t value_size = ValueSize) {
+    std::vector<u8> value(value_size);
+    for (std::size_t i = 0; i < value.size(); ++i)
+        value[i] = static_cast<u8>(key * 3 + i);
+    return {key, value};
+}
+
+/// Opens the cache, and returns the entries read from it
+std::vector<Entry> ReadCache(const std::string& path, u32 version = Version) {
+    LinearDiskCache<u64, u8> cache;
+    EntryReader reader;
+    const u32 num_entries = cache.OpenAndRead(path, version, reader);
+    REQUIRE(num_entries == reader.entries.size());
+    return reader.entries;
+}
+
+void AppendEntries(const std::string& path, const std::vector<Entry>& entries) {
+    LinearDiskCache<u64, u8> cache;
+    EntryReader reader;
+    cache.OpenAndRead(path, Version, reader);
+    for (const Entry& entry : entries) {
+        cache.Append(entry.first, entry.second.data(), static_cast<u32>(entry.second.size()));
+    }
+    cache.Close();
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LinearDiskCache", "[common]") {
+    const Test::TemporaryDirectory test_dir("./test_linear_disk_cache/");
+    const std::string path = test_dir.GetPath() + "cache.bin";
+    const std::vector<Entry> entries{MakeEntry(1), MakeEntry(2), MakeEntry(3)};
+    AppendEntries(path, entries);
+    REQUIRE(FileUtil::GetSize(path) == HeaderSize + entries.size() * EntrySize);
+
+    SECTION("entries are read back in order") {
+        REQUIRE(ReadCache(path) == entries);
+    }
+
+    SECTION("a version mismatch discards the file") {
+        REQUIRE(ReadCache(path, Version + 1).empty());
+        REQUIRE(FileUtil::GetSize(path) == HeaderSize);
+        REQUIRE(ReadCache(path, Version + 1).empty());
+        // The file was rewritten for the new version
+        REQUIRE(ReadCache(path).empty());
+    }
+
+    SECTION("a truncated final entry is dropped") {
+        {
+            FileUtil::IOFile file(path, "r+b");
+            REQUIRE(file.Resize(HeaderSize + entries.size() * EntrySize - 3));
+        }
+        REQUIRE(ReadCache(path) == std::vector<Entry>{entries[0], entries[1]});
+    }
+
+    SECTION("a damaged checksum stops reading at that entry") {
+        {
+            FileUtil::IOFile file(path, "r+b");
+            const std::size_t checksum_offset = HeaderSize + 2 * EntrySize - 8;
+            u8 byte;
+            REQUIRE(file.Seek(checksum_offset, SEEK_SET));
+            REQUIRE(file.ReadBytes(&byte, 1) == 1);
+            byte ^= 0x40;
+            REQUIRE(file.Seek(checksum_offset, SEEK_SET));
+            REQUIRE(file.WriteBytes(&byte, 1) == 1);
+        }
+        REQUIRE(ReadCache(path) == std::vector<Entry>{entries[0]});
+
+        // An append overwrites the damaged entry. This one is longer, and overwrites the start of
+        // the next entry too, whose remains are then ignored.
+        const Entry appended = MakeEntry(4, ValueSize + 2);
+        AppendEntries(path, {appended});
+        REQUIRE(ReadCache(path) == std::vector<Entry>{entries[0], appended});
+        const Entry appended_next = MakeEntry(5);
+        AppendEntries(path, {appended_next});
+        REQUIRE(ReadCache(path) == std::vector<Entry>{entries[0], appended, appended_next});
+    }
+}
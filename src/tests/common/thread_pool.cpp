@@ -0,0 +1,74 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread_pool.h"
+
+namespace Common {
+
+TEST_CASE("ThreadPool::ParallelFor covers every index once", "[common]") {
+    for (std::size_t num_threads : {0, 1, 3}) {
+        ThreadPool pool(num_threads);
+        for (std::size_t count : {0, 1, 7, 1000}) {
+            std::vector<std::atomic<int>> visits(count);
+            std::vector<std::atomic<int>> chunk_uses(pool.GetMaxChunks());
+            pool.ParallelFor(count, 4, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+                REQUIRE(chunk < pool.GetMaxChunks());
+                ++chunk_uses[chunk];
+                for (std::size_t i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+            });
+            for (const auto& visit : visits) {
+                REQUIRE(visit == 1);
+            }
+            for (const auto& uses : chunk_uses) {
+                REQUIRE(uses <= 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("ThreadPool::Submit runs every task", "[common]") {
+    ThreadPool pool(2);
+    std::atomic<int> sum{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 1; i <= 100; ++i) {
+        futures.push_back(pool.Submit([&sum, i] { sum += i; }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+    REQUIRE(sum == 5050);
+}
+
+TEST_CASE("ThreadPool::GetShared runs the work of several threads at once", "[common]") {
+    ThreadPool& pool = ThreadPool::GetShared();
+    REQUIRE(&pool == &ThreadPool::GetShared());
+    REQUIRE(pool.GetNumThreads() == ThreadPool::GetDefaultNumThreads());
+
+    // As the emulation and the GPU threads do
+    constexpr std::size_t Count = 10000;
+    std::vector<std::atomic<int>> visits(Count);
+    const auto visit_all = [&] {
+        for (int run = 0; run < 50; ++run) {
+            pool.ParallelFor(Count, 16, [&](std::size_t begin, std::size_t end, std::size_t) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+            });
+        }
+    };
+    std::thread other_thread(visit_all);
+    visit_all();
+    other_thread.join();
+    for (const auto& visit : visits) {
+        REQUIRE(visit == 100);
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,316 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread_queue_list.h"
+#include "tests/test_util.h"
+
+namespace Common {
+
+namespace {
+
+constexpr unsigned int NumPriorities = 64;
+
+struct FakeThread : ThreadQueueListNode<FakeThread> {
+    u32 id = 0;
+    u32 priority = 0;
+};
+
+/// The deque based queues the scheduler used before, as a reference
+class ReferenceQueueList {
+public:
+    using Priority = unsigned int;
+
+    Priority contains(const FakeThread* thread) const {
+        for (Priority i = 0; i < NumPriorities; ++i) {
+            if (std::find(queues[i].begin(), queues[i].end(), thread) != queues[i].end())
+                return i;
+        }
+        return -1;
+    }
+
+    FakeThread* get_first() const {
+        for (const auto& queue : queues) {
+            if (!queue.empty())
+                return queue.front();
+        }
+        return nullptr;
+    }
+
+    FakeThread* pop_first() {
+        return pop_first_better(NumPriorities);
+    }
+
+    FakeThread* pop_first_better(Priority priority) {
+        for (Priority i = 0; i < priority; ++i) {
+            if (!queues[i].empty()) {
+                FakeThread* thread = queues[i].front();
+                queues[i].pop_front();
+                return thread;
+            }
+        }
+        return nullptr;
+    }
+
+    void push_front(Priority priority, FakeThread* thread) {
+        queues[priority].push_front(thread);
+    }
+
+    void push_back(Priority priority, FakeThread* thread) {
+        queues[priority].push_back(thread);
+    }
+
+    void move(FakeThread* thread, Priority old_priority, Priority new_priority) {
+        remove(old_priority, thread);
+        push_back(new_priority, thread);
+    }
+
+    void remove(Priority priority, FakeThread* thread) {
+        auto& queue = queues[priority];
+        queue.erase(std::remove(queue.begin(), queue.end(), thread), queue.end());
+    }
+
+    bool empty(Priority priority) const {
+        return queues[priority].empty();
+    }
+
+    void rotate(Priority priority) {
+        auto& queue = queues[priority];
+        if (queue.size() > 1) {
+            queue.push_back(queue.front());
+            queue.pop_front();
+        }
+    }
+
+private:
+    std::array<std::deque<FakeThread*>, NumPriorities> queues;
+};
+
+/**
+ * Simulates the scheduling of threads which keep waiting on each other, as with
+ * WaitSynchronizationN and ArbitrateAddress, and returns a hash of the threads that ran.
+ */
+template <typename Queue>
+u64 SimulateScheduling(std::size_t num_threads, std::size_t num_steps, u32 seed) {
+    std::mt19937 rng(seed);
+    std::vector<FakeThread> threads(num_threads);
+    std::vector<FakeThread*> waiting;
+    Queue ready_queue;
+
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        threads[i].id = static_cast<u32>(i);
+        threads[i].priority = 24 + rng() % 40;
+        ready_queue.push_back(threads[i].priority, &threads[i]);
+    }
+    FakeThread* current = ready_queue.pop_first();
+
+    const auto wake = [&](std::size_t index) {
+        FakeThread* thread = waiting[index];
+        waiting[index] = waiting.back();
+        waiting.pop_back();
+        ready_queue.push_back(thread->priority, thread);
+    };
+
+    u64 hash = 0;
+    for (std::size_t step = 0; step < num_steps; ++step) {
+        switch (rng() % 8) {
+        case 0:
+        case 1:
+        case 2: {
+            // The running thread waits for objects, and the next ready thread takes over
+            if (current != nullptr)
+                waiting.push_back(current);
+            current = ready_queue.pop_first();
+            break;
+        }
+        case 3:
+        case 4: {
+            // An object is signalled, waking one of its waiting threads
+            if (!waiting.empty())
+                wake(rng() % waiting.size());
+            break;
+        }
+        case 5: {
+            // An address arbiter wakes several threads at once
+            for (int i = 0; i < 4 && !waiting.empty(); ++i)
+                wake(rng() % waiting.size());
+            break;
+        }
+        case 6: {
+            // A mutex changes the priority of a waiting or ready thread
+            FakeThread& thread = threads[rng() % num_threads];
+            const u32 priority = 24 + rng() % 40;
+            if (ready_queue.contains(&thread) != static_cast<u32>(-1))
+                ready_queue.move(&thread, thread.priority, priority);
+            thread.priority = priority;
+            break;
+        }
+        case 7: {
+            // Time slicing lets threads of the same priority run
+            if (current != nullptr) {
+                ready_queue.push_back(current->priority, current);
+                ready_queue.rotate(current->priority);
+                current = ready_queue.pop_first();
+            }
+            break;
+        }
+        }
+
+        // Reschedule, preempting the running thread if there's a better one
+        if (current != nullptr) {
+            if (FakeThread* next = ready_queue.pop_first_better(current->priority)) {
+                ready_queue.push_front(current->priority, current);
+                current = next;
+            }
+        } else {
+            current = ready_queue.pop_first();
+        }
+
+        hash = hash * 31 + (current != nullptr ? current->id + 1 : 0);
+    }
+
+    // Leave the threads unlinked, as the kernel does when stopping them
+    for (FakeThread& thread : threads)
+        ready_queue.remove(thread.priority, &thread);
+
+    return hash;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ThreadQueueList matches the deque based queues", "[common]") {
+    std::mt19937 rng(1);
+    std::array<FakeThread, 32> threads;
+    for (u32 i = 0; i < threads.size(); ++i)
+        threads[i].id = i;
+
+    ThreadQueueList<FakeThread, NumPriorities> queue;
+    ReferenceQueueList reference;
+    std::array<bool, threads.size()> queued{};
+
+    for (int step = 0; step < 100000; ++step) {
+        FakeThread& thread = threads[rng() % threads.size()];
+        const u32 priority = rng() % NumPriorities;
+        const std::size_t index = thread.id;
+
+        switch (rng() % 7) {
+        case 0:
+            if (!queued[index]) {
+                thread.priority = priority;
+                queue.push_back(priority, &thread);
+                reference.push_back(priority, &thread);
+                queued[index] = true;
+            }
+            break;
+        case 1:
+            if (!queued[index]) {
+                thread.priority = priority;
+                queue.push_front(priority, &thread);
+                reference.push_front(priority, &thread);
+                queued[index] = true;
+            }
+            break;
+        case 2:
+            // Removing from another level, or a thread that isn't queued, does nothing
+            queue.remove(priority, &thread);
+            reference.remove(priority, &thread);
+            if (priority == thread.priority)
+                queued[index] = false;
+            break;
+        case 3:
+            if (queued[index]) {
+                queue.move(&thread, thread.priority, priority);
+                reference.move(&thread, thread.priority, priority);
+                thread.priority = priority;
+            }
+            break;
+        case 4: {
+            FakeThread* first = queue.pop_first();
+            REQUIRE(first == reference.pop_first());
+            if (first != nullptr)
+                queued[first->id] = false;
+            break;
+        }
+        case 5: {
+            FakeThread* first = queue.pop_first_better(priority);
+            REQUIRE(first == reference.pop_first_better(priority));
+            if (first != nullptr)
+                queued[first->id] = false;
+            break;
+        }
+        case 6:
+            queue.rotate(priority);
+            reference.rotate(priority);
+            break;
+        }
+
+        REQUIRE(queue.get_first() == reference.get_first());
+        REQUIRE(queue.contains(&thread) == reference.contains(&thread));
+        REQUIRE(queue.empty(priority) == reference.empty(priority));
+    }
+
+    queue.clear();
+    REQUIRE(queue.get_first() == nullptr);
+}
+
+TEST_CASE("ThreadQueueList::for_each visits the elements in popping order", "[common]") {
+    std::array<FakeThread, 6> threads;
+    ThreadQueueList<FakeThread, NumPriorities> queue;
+    queue.push_back(40, &threads[0]);
+    queue.push_back(10, &threads[1]);
+    queue.push_front(40, &threads[2]);
+    queue.push_back(63, &threads[3]);
+    queue.push_back(10, &threads[4]);
+    queue.push_back(0, &threads[5]);
+
+    std::vector<std::pair<unsigned int, FakeThread*>> visited;
+    queue.for_each([&visited](unsigned int priority, FakeThread* thread) {
+        visited.emplace_back(priority, thread);
+    });
+
+    std::vector<std::pair<unsigned int, FakeThread*>> popped;
+    while (FakeThread* thread = queue.get_first()) {
+        popped.emplace_back(queue.contains(thread), thread);
+        queue.pop_first();
+    }
+    REQUIRE(popped.size() == threads.size());
+    REQUIRE(visited == popped);
+}
+
+TEST_CASE("ThreadQueueList schedules as the deque based queues", "[common]") {
+    for (u32 seed = 0; seed < 10; ++seed) {
+        REQUIRE(SimulateScheduling<ThreadQueueList<FakeThread, NumPriorities>>(40, 10000, seed) ==
+                SimulateScheduling<ReferenceQueueList>(40, 10000, seed));
+    }
+}
+
+TEST_CASE("ThreadQueueList scheduling churn", "[common][.benchmark]") {
+    using Ns = std::chrono::duration<double, std::nano>;
+    constexpr std::size_t NumThreads = 48;
+    constexpr std::size_t NumSteps = 200000;
+    constexpr int NumRuns = 10;
+
+    u64 reference_hash = 0;
+    const double reference_ns = Test::TimePerRun<Ns>(NumRuns, [&] {
+        reference_hash = SimulateScheduling<ReferenceQueueList>(NumThreads, NumSteps, 1);
+    });
+    u64 hash = 0;
+    const double ns = Test::TimePerRun<Ns>(NumRuns, [&] {
+        hash = SimulateScheduling<ThreadQueueList<FakeThread, NumPriorities>>(NumThreads,
+                                                                               NumSteps, 1);
+    });
+    REQUIRE(hash == reference_hash);
+
+    WARN("Deques: " << reference_ns / NumSteps << " ns per step, bitmap: " << ns / NumSteps
+                    << " ns per step");
+}
+
+} // namespace Common
@@ -0,0 +1,32 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <thread>
+#include <catch2/catch.hpp>
+#include "common/threadsafe_queue.h"
+
+namespace Common {
+
+TEST_CASE("SPSCQueue::PopWait wakes up for every push", "[common]") {
+    // Each push lands while the other thread is about to wait, a lost wakeup hangs the test
+    constexpr int NumRoundTrips = 100000;
+    SPSCQueue<int> requests;
+    SPSCQueue<int> replies;
+
+    std::thread echo([&] {
+        int value;
+        while ((value = requests.PopWait()) >= 0) {
+            replies.Push(value);
+        }
+    });
+
+    for (int i = 0; i < NumRoundTrips; ++i) {
+        requests.Push(i);
+        REQUIRE(replies.PopWait() == i);
+    }
+    requests.Push(-1);
+    echo.join();
+}
+
+} // namespace Common
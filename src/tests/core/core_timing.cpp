@@ -6,10 +6,14 @@
 
 #include <array>
 #include <bitset>
+#include <chrono>
 #include <string>
+#include <vector>
+#include "common/chunk_file.h"
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "tests/test_util.h"
 
 // Numbers are chosen randomly to make sure the correct one is given.
 static constexpr std::array<u64, 5> CB_IDS{{42, 144, 93, 1026, UINT64_C(0xFFFF7FFFF7FFFF)}};
@@ -235,3 +239,167 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(0 == reschedules);
     REQUIRE(MAX_SLICE_LENGTH == CoreTiming::GetDowncount());
 }
+
+namespace UnscheduleTest {
+static std::vector<u64> fired;
+
+static void RecordCallback(u64 userdata, s64 cycles_late) {
+    fired.push_back(userdata);
+}
+} // namespace UnscheduleTest
+
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    using namespace UnscheduleTest;
+
+    ScopeInit guard;
+
+    CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", RecordCallback);
+    CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", RecordCallback);
+
+    // Enter slice 0
+    CoreTiming::Advance();
+
+    fired.clear();
+    CoreTiming::ScheduleEvent(100, cb_a, 0);
+    CoreTiming::ScheduleEvent(500, cb_a, 1);
+    CoreTiming::ScheduleEvent(500, cb_b, 2);
+    CoreTiming::ScheduleEvent(500, cb_a, 3);
+    CoreTiming::ScheduleEvent(500, cb_b, 1);
+    CoreTiming::ScheduleEvent(800, cb_a, 1);
+    REQUIRE(100 == CoreTiming::GetDowncount());
+
+    // Only the events of the given type and userdata are cancelled, including the later ones
+    CoreTiming::UnscheduleEvent(cb_a, 1);
+    // An event scheduled after the cancellation isn't affected by it
+    CoreTiming::ScheduleEvent(500, cb_a, 1);
+
+    CoreTiming::AddTicks(CoreTiming::GetDowncount());
+    CoreTiming::Advance();
+    REQUIRE(fired == std::vector<u64>{0});
+    REQUIRE(400 == CoreTiming::GetDowncount());
+
+    // The remaining events with the same time keep the order they were scheduled in
+    CoreTiming::AddTicks(CoreTiming::GetDowncount());
+    CoreTiming::Advance();
+    REQUIRE(fired == std::vector<u64>{0, 2, 3, 1, 1});
+    REQUIRE(MAX_SLICE_LENGTH == CoreTiming::GetDowncount());
+
+    // A cancelled event at the front of the queue doesn't shorten the slice
+    CoreTiming::ScheduleEvent(100, cb_a, 4);
+    CoreTiming::ScheduleEvent(300, cb_b, 5);
+    CoreTiming::AddTicks(CoreTiming::GetDowncount());
+    CoreTiming::UnscheduleEvent(cb_a, 4);
+    CoreTiming::Advance();
+    REQUIRE(200 == CoreTiming::GetDowncount());
+
+    CoreTiming::RemoveEvent(cb_b);
+    CoreTiming::AddTicks(CoreTiming::GetDowncount());
+    CoreTiming::Advance();
+    REQUIRE(fired == std::vector<u64>{0, 2, 3, 1, 1});
+    REQUIRE(MAX_SLICE_LENGTH == CoreTiming::GetDowncount());
+}
+
+namespace BenchmarkTest {
+static CoreTiming::EventType* timer_event;
+static CoreTiming::EventType* timeout_event;
+static CoreTiming::EventType* audio_event;
+
+static void TimerCallback(u64 userdata, s64 cycles_late) {
+    CoreTiming::ScheduleEvent(msToCycles(16) - cycles_late, timer_event, userdata);
+}
+
+static void AudioCallback(u64 userdata, s64 cycles_late) {
+    CoreTiming::ScheduleEvent(usToCycles(5000) - cycles_late, audio_event, userdata);
+}
+
+static void TimeoutCallback(u64 userdata, s64 cycles_late) {}
+} // namespace BenchmarkTest
+
+TEST_CASE("CoreTiming[SaveState]", "[core]") {
+    using namespace UnscheduleTest;
+
+    ScopeInit guard;
+
+    CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", RecordCallback);
+    CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", RecordCallback);
+
+    // Enter slice 0
+    CoreTiming::Advance();
+
+    fired.clear();
+    CoreTiming::ScheduleEvent(300, cb_a, 0);
+    CoreTiming::ScheduleEvent(100, cb_b, 1);
+    CoreTiming::ScheduleEvent(300, cb_b, 2);
+    CoreTiming::ScheduleEvent(200, cb_a, 3);
+    CoreTiming::ScheduleEventThreadsafe(300, cb_a, 4);
+    CoreTiming::UnscheduleEvent(cb_a, 3);
+    const u64 ticks = CoreTiming::GetTicks();
+
+    std::vector<u8> state;
+    u8* ptr = nullptr;
+    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+    CoreTiming::DoState(p);
+    state.resize(ptr - static_cast<u8*>(nullptr));
+    ptr = state.data();
+    p.SetMode(PointerWrap::MODE_WRITE);
+    CoreTiming::DoState(p);
+
+    // Events scheduled after saving are dropped when loading
+    CoreTiming::ScheduleEvent(50, cb_a, 5);
+    CoreTiming::AddTicks(CoreTiming::GetDowncount());
+    CoreTiming::Advance();
+    REQUIRE(fired == std::vector<u64>{5});
+
+    fired.clear();
+    ptr = state.data();
+    p.SetMode(PointerWrap::MODE_READ);
+    CoreTiming::DoState(p);
+    REQUIRE(ptr == state.data() + state.size());
+    REQUIRE(ticks == CoreTiming::GetTicks());
+
+    for (int i = 0; i < 3; ++i) {
+        CoreTiming::AddTicks(CoreTiming::GetDowncount());
+        CoreTiming::Advance();
+    }
+    REQUIRE(fired == std::vector<u64>{1, 0, 2, 4});
+}
+
+TEST_CASE("CoreTiming[Benchmark]", "[core][.benchmark]") {
+    using namespace BenchmarkTest;
+
+    ScopeInit guard;
+
+    timer_event = CoreTiming::RegisterEvent("timer", TimerCallback);
+    timeout_event = CoreTiming::RegisterEvent("timeout", TimeoutCallback);
+    audio_event = CoreTiming::RegisterEvent("audio", AudioCallback);
+
+    CoreTiming::Advance();
+
+    // Periodic timers and audio ticks which reschedule themselves
+    for (u64 i = 0; i < 16; ++i) {
+        CoreTiming::ScheduleEvent(msToCycles(16) + i * 1000, timer_event, i);
+    }
+    CoreTiming::ScheduleEvent(usToCycles(5000), audio_event, 0);
+
+    // Threads waiting with a timeout, which are usually woken up by a signal before it expires
+    constexpr u64 NUM_THREADS = 64;
+    for (u64 thread = 0; thread < NUM_THREADS; ++thread) {
+        CoreTiming::ScheduleEvent(msToCycles(100), timeout_event, thread);
+    }
+
+    using Ns = std::chrono::duration<double, std::nano>;
+    constexpr int NUM_ITERATIONS = 1000000;
+    int i = 0;
+    const double time = Test::TimePerRun<Ns>(NUM_ITERATIONS, [&] {
+        const u64 thread = (i * 17) % NUM_THREADS;
+        CoreTiming::UnscheduleEvent(timeout_event, thread);
+        CoreTiming::ScheduleEvent(msToCycles(100), timeout_event, thread);
+
+        if (i++ % 8 == 0) {
+            CoreTiming::AddTicks(CoreTiming::GetDowncount());
+            CoreTiming::Advance();
+        }
+    });
+
+    WARN("Reschedule of a timeout: " << time << " ns");
+}
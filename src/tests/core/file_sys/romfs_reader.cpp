@@ -0,0 +1,92 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/file_util.h"
+#include "core/file_sys/romfs_reader.h"
+#include "tests/test_util.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr std::size_t FileOffset = 0x200;
+constexpr std::size_t CryptoOffset = 0x1000;
+constexpr std::array<u8, 16> Key{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+constexpr std::array<u8, 16> Ctr{0xF0, 0xE0, 0xD0, 0xC0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+/// Writes data encrypted as a RomFS at FileOffset of a file, and opens a reader for it
+std::unique_ptr<RomFSReader> MakeReader(const std::string& path, const std::vector<u8>& data,
+                                        bool encrypted) {
+    std::vector<u8> contents(FileOffset);
+    contents.insert(contents.end(), data.begin(), data.end());
+    if (encrypted) {
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption e(Key.data(), Key.size(), Ctr.data());
+        e.Seek(CryptoOffset);
+        e.ProcessData(contents.data() + FileOffset, data.data(), data.size());
+    }
+    {
+        FileUtil::IOFile file(path, "wb");
+        REQUIRE(file.WriteBytes(contents.data(), contents.size()) == contents.size());
+    }
+
+    FileUtil::IOFile file(path, "rb");
+    REQUIRE(file.IsOpen());
+    if (encrypted) {
+        return std::make_unique<RomFSReader>(std::move(file), FileOffset, data.size(), Key, Ctr,
+                                             CryptoOffset);
+    }
+    return std::make_unique<RomFSReader>(std::move(file), FileOffset, data.size());
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RomFSReader", "[core][file_sys]") {
+    const Test::TemporaryDirectory test_dir("./test_romfs_reader/");
+    std::mt19937 rng(1);
+    // Neither a multiple of the cache blocks nor of the AES blocks
+    const std::vector<u8> data = Test::RandomBytes(RomFSReader::CacheBlockSize * 300 + 123, rng);
+    const bool encrypted = GENERATE(false, true);
+    const auto reader = MakeReader(test_dir.GetPath() + "romfs.bin", data, encrypted);
+
+    const auto check_read = [&](std::size_t offset, std::size_t length) {
+        std::vector<u8> buffer(length);
+        const std::size_t expected_length =
+            offset < data.size() ? std::min(length, data.size() - offset) : 0;
+        REQUIRE(reader->ReadFile(offset, length, buffer.data()) == expected_length);
+        REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected_length,
+                           data.begin() + std::min(offset, data.size())));
+    };
+
+    SECTION("sequential reads") {
+        for (std::size_t offset = 0; offset < data.size(); offset += 1000) {
+            check_read(offset, 1000);
+        }
+    }
+
+    SECTION("random reads") {
+        std::uniform_int_distribution<std::size_t> offset_dist(0, data.size() - 1);
+        std::uniform_int_distribution<std::size_t> length_dist(1, 3 * RomFSReader::CacheBlockSize);
+        for (int i = 0; i < 2000; ++i) {
+            check_read(offset_dist(rng), length_dist(rng));
+        }
+    }
+
+    SECTION("uncached and out of range reads") {
+        check_read(0, RomFSReader::MaxCachedReadSize + 1);
+        check_read(17, data.size());
+        check_read(data.size() - 10, 100);
+        check_read(data.size(), 100);
+        check_read(5, 0);
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,70 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "core/game_list_cache.h"
+#include "tests/test_util.h"
+
+static void RequireEqual(const GameListCacheEntry& a, const GameListCacheEntry& b) {
+    REQUIRE(a.size == b.size);
+    REQUIRE(a.modified == b.modified);
+    REQUIRE(a.update_modified == b.update_modified);
+    REQUIRE(a.program_id == b.program_id);
+    REQUIRE(a.extdata_id == b.extdata_id);
+    REQUIRE(a.file_type == b.file_type);
+    REQUIRE(a.smdh == b.smdh);
+}
+
+TEST_CASE("GameListCache round trip", "[core]") {
+    const Test::ScopedUserPath cache_dir(FileUtil::UserPath::CacheDir, "./test_game_list_cache/");
+
+    GameListCacheEntry game;
+    game.size = 0x12345678'9A;
+    game.modified = 1539700000000;
+    game.update_modified = -1;
+    game.program_id = 0x00040000'00055D00;
+    game.extdata_id = 0x55D;
+    game.file_type = 3;
+    game.smdh.resize(0x36C0);
+    for (std::size_t i = 0; i < game.smdh.size(); ++i)
+        game.smdh[i] = static_cast<u8>(i * 5);
+
+    // An entry without an SMDH, at a path with non-ASCII characters
+    GameListCacheEntry homebrew;
+    homebrew.size = 1;
+    homebrew.modified = 2;
+    homebrew.file_type = 1;
+    const std::string game_path = "/games/game.3ds";
+    const std::string homebrew_path = u8"/games/ゲーム.3dsx";
+
+    GameListCache cache;
+    cache.Load();
+    REQUIRE(!cache.Find(game_path, game.size, game.modified));
+    cache.Add(game_path, game);
+    cache.Add(homebrew_path, homebrew);
+    cache.Save();
+
+    GameListCache loaded;
+    loaded.Load();
+    const auto loaded_game = loaded.Find(game_path, game.size, game.modified);
+    const auto loaded_homebrew = loaded.Find(homebrew_path, homebrew.size, homebrew.modified);
+    REQUIRE(loaded_game);
+    REQUIRE(loaded_homebrew);
+    RequireEqual(*loaded_game, game);
+    RequireEqual(*loaded_homebrew, homebrew);
+
+    // A file which changed isn't found
+    REQUIRE(!loaded.Find(game_path, game.size + 1, game.modified));
+    REQUIRE(!loaded.Find(game_path, game.size, game.modified + 1));
+
+    // Only the entries kept by a scan are saved again
+    loaded.Keep(game_path);
+    loaded.Save();
+    GameListCache rescanned;
+    rescanned.Load();
+    REQUIRE(rescanned.Find(game_path, game.size, game.modified));
+    REQUIRE(!rescanned.Find(homebrew_path, homebrew.size, homebrew.modified));
+}
@@ -7,6 +7,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/hle_ipc.h"
@@ -178,6 +179,43 @@ TEST_CASE("HLERequestContext::PopulateFromIncomingCommandBuffer", "[core][kernel
         REQUIRE(process->vm_manager.UnmapRange(target_address, buffer->size()) == RESULT_SUCCESS);
     }
 
+    SECTION("gets the memory backing a MappedBuffer") {
+        auto first = std::make_shared<std::vector<u8>>(Memory::PAGE_SIZE);
+        auto second = std::make_shared<std::vector<u8>>(Memory::PAGE_SIZE);
+
+        VAddr target_address = 0x10000000;
+        REQUIRE(process->vm_manager
+                    .MapMemoryBlock(target_address, first, 0, first->size(), MemoryState::Private)
+                    .Succeeded());
+        REQUIRE(process->vm_manager
+                    .MapMemoryBlock(target_address + Memory::PAGE_SIZE, second, 0, second->size(),
+                                    MemoryState::Private)
+                    .Succeeded());
+
+        const u32_le input[]{
+            IPC::MakeHeader(0, 0, 2),
+            IPC::MappedBufferDesc(2 * Memory::PAGE_SIZE, IPC::W),
+            target_address,
+        };
+
+        context.PopulateFromIncomingCommandBuffer(input, *process);
+
+        // The range spans both blocks, which aren't contiguous on the host
+        const std::vector<std::pair<u8*, u32>> expected{
+            {first->data() + 0x800, Memory::PAGE_SIZE - 0x800},
+            {second->data(), 0x800},
+        };
+        CHECK(context.GetMappedBuffer(0).GetBackingBlocks(0x800, Memory::PAGE_SIZE).Unwrap() ==
+              expected);
+
+        REQUIRE(process->vm_manager.UnmapRange(target_address, 2 * Memory::PAGE_SIZE) ==
+                RESULT_SUCCESS);
+
+        // Unmapped memory can't be written to
+        CHECK(context.GetMappedBuffer(0).GetBackingBlocks(0, Memory::PAGE_SIZE).Code() ==
+              ERR_INVALID_ADDRESS_STATE);
+    }
+
     SECTION("translates mixed params") {
         auto buffer_static = std::make_shared<std::vector<u8>>(Memory::PAGE_SIZE);
         std::fill(buffer_static->begin(), buffer_static->end(), 0xCE);
@@ -0,0 +1,261 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/core_timing.h"
+#include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/shared_memory.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+namespace {
+
+using IntervalSet = MemoryRegionInfo::IntervalSet;
+using Interval = IntervalSet::interval_type;
+
+constexpr u32 RegionBase = 0x100000;
+constexpr u32 RegionSize = 0x20000;
+
+/// Returns whether the FCRAM at offset holds only zeros
+bool IsZero(u32 offset, u32 size) {
+    const u8* data = Memory::GetFCRAMPointer(offset);
+    return std::all_of(data, data + size, [](u8 value) { return value == 0; });
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MemoryRegionInfo allocates the heaps from both ends", "[core][kernel]") {
+    MemoryRegionInfo region;
+    region.Reset(RegionBase, RegionSize);
+    // Memory freed by others isn't cleared until it's allocated again
+    std::memset(Memory::GetFCRAMPointer(RegionBase), 0xAB, RegionSize);
+
+    SECTION("the linear heap grows from the start") {
+        REQUIRE(region.LinearAllocate(0x3000) == RegionBase);
+        REQUIRE(region.LinearAllocate(0x1000) == RegionBase + 0x3000);
+        REQUIRE(region.linear_heap_size == 0x4000);
+        REQUIRE(IsZero(RegionBase, 0x4000));
+
+        // Freeing a hole keeps the size, until the end is freed too
+        region.Free(RegionBase + 0x1000, 0x1000);
+        REQUIRE(region.linear_heap_size == 0x4000);
+        region.Free(RegionBase + 0x2000, 0x2000);
+        REQUIRE(region.linear_heap_size == 0x1000);
+
+        // Holes can be allocated again, but not memory which is already allocated
+        REQUIRE_FALSE(region.LinearAllocate(RegionBase, 0x1000));
+        REQUIRE(region.LinearAllocate(RegionBase + 0x2000, 0x1000));
+        REQUIRE(region.linear_heap_size == 0x3000);
+    }
+
+    SECTION("the regular heap is taken from the end") {
+        const IntervalSet first = region.HeapAllocate(0x5000);
+        REQUIRE(first == IntervalSet(Interval::right_open(RegionBase + RegionSize - 0x5000,
+                                                          RegionBase + RegionSize)));
+        REQUIRE(IsZero(RegionBase + RegionSize - 0x5000, 0x5000));
+
+        const IntervalSet second = region.HeapAllocate(0x1000);
+        REQUIRE(second == IntervalSet(Interval::right_open(RegionBase + RegionSize - 0x6000,
+                                                           RegionBase + RegionSize - 0x5000)));
+
+        // The linear heap can't grow into it
+        REQUIRE(region.LinearAllocate(RegionSize - 0x7000) == RegionBase);
+        REQUIRE_FALSE(region.LinearAllocate(0x2000));
+    }
+
+    SECTION("the regular heap may be split when memory is fragmented") {
+        REQUIRE(region.LinearAllocate(RegionSize - 0x4000) == RegionBase);
+        region.Free(RegionBase + 0x1000, 0x1000);
+
+        // The free memory is at 0x1000 and the last 0x4000 bytes
+        REQUIRE(region.HeapAllocate(0x6000).empty());
+        const IntervalSet allocated = region.HeapAllocate(0x5000);
+        IntervalSet expected;
+        expected.insert(Interval::right_open(RegionBase + 0x1000, RegionBase + 0x2000));
+        expected.insert(Interval::right_open(RegionBase + RegionSize - 0x4000,
+                                             RegionBase + RegionSize));
+        REQUIRE(allocated == expected);
+        REQUIRE(region.free_blocks.empty());
+
+        // Freeing gives back the blocks
+        for (const auto& interval : allocated) {
+            region.Free(boost::icl::first(interval), boost::icl::length(interval));
+        }
+        REQUIRE(region.free_blocks == expected);
+    }
+}
+
+TEST_CASE("Process heaps are mapped to FCRAM", "[core][kernel]") {
+    CoreTiming::Init();
+    KernelSystem kernel(0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    process->memory_region = kernel.GetMemoryRegion(MemoryRegion::APPLICATION);
+    MemoryRegionInfo& region = *process->memory_region;
+    const u32 value = 0x12345678;
+
+    SECTION("regular heap") {
+        REQUIRE(process->HeapAllocate(Memory::HEAP_VADDR, 0x2000, VMAPermission::ReadWrite)
+                    .Unwrap() == Memory::HEAP_VADDR);
+        REQUIRE(process->HeapAllocate(Memory::HEAP_VADDR + 0x2000, 0x1000,
+                                      VMAPermission::ReadWrite)
+                    .Succeeded());
+        REQUIRE(process->heap_used == 0x3000);
+        REQUIRE(region.used == 0x3000);
+
+        // Growing the heap upwards takes the memory below
+        Memory::WriteBlock(*process, Memory::HEAP_VADDR + 0x2000, &value, sizeof(value));
+        const u32 region_end = region.base + region.size;
+        u32 read;
+        std::memcpy(&read, Memory::GetFCRAMPointer(region_end - 0x3000), sizeof(read));
+        REQUIRE(read == value);
+
+        // Already mapped memory can't be allocated
+        REQUIRE(process->HeapAllocate(Memory::HEAP_VADDR + 0x1000, 0x1000,
+                                      VMAPermission::ReadWrite)
+                    .Code() == ERR_INVALID_ADDRESS_STATE);
+
+        REQUIRE(process->HeapFree(Memory::HEAP_VADDR, 0x3000).IsSuccess());
+        REQUIRE(region.used == 0);
+        REQUIRE(region.free_blocks ==
+                IntervalSet(Interval::right_open(region.base, region.base + region.size)));
+        REQUIRE_FALSE(Memory::IsValidVirtualAddress(*process, Memory::HEAP_VADDR));
+    }
+
+    SECTION("linear heap") {
+        const VAddr target =
+            process->LinearAllocate(0, 0x2000, VMAPermission::ReadWrite).Unwrap();
+        REQUIRE(target == process->GetLinearHeapBase());
+        REQUIRE(region.linear_heap_size == 0x2000);
+
+        // The linear heap maps 1:1 to FCRAM
+        Memory::WriteBlock(*process, target + 0x1000, &value, sizeof(value));
+        u32 read;
+        std::memcpy(&read, Memory::GetPhysicalPointer(Memory::FCRAM_PADDR + region.base + 0x1000),
+                    sizeof(read));
+        REQUIRE(read == value);
+
+        REQUIRE(process->LinearFree(target, 0x2000).IsSuccess());
+        REQUIRE(region.linear_heap_size == 0);
+    }
+
+    CoreTiming::Shutdown();
+}
+
+TEST_CASE("Applet shared memory is returned to FCRAM", "[core][kernel]") {
+    CoreTiming::Init();
+    KernelSystem kernel(0);
+    MemoryRegionInfo& region = *kernel.GetMemoryRegion(MemoryRegion::SYSTEM);
+    const IntervalSet free_blocks = region.free_blocks;
+    const u32 used = region.used;
+
+    // Launching applets over and over never runs out of memory
+    for (int i = 0; i < 0x100; ++i) {
+        auto shared_memory = kernel.CreateSharedMemoryForApplet(
+            0, 0x100001, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite, "Applet");
+        REQUIRE(region.used == used + 0x101000);
+    }
+    REQUIRE(region.used == used);
+    REQUIRE(region.free_blocks == free_blocks);
+
+    CoreTiming::Shutdown();
+}
+
+TEST_CASE("Shared memory over a heap allocated in parts is contiguous", "[core][kernel]") {
+    CoreTiming::Init();
+    KernelSystem kernel(0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    process->memory_region = kernel.GetMemoryRegion(MemoryRegion::APPLICATION);
+    MemoryRegionInfo& region = *process->memory_region;
+
+    // Growing the heap upwards takes the memory below, the parts aren't contiguous in FCRAM
+    REQUIRE(process->HeapAllocate(Memory::HEAP_VADDR, 0x1000, VMAPermission::ReadWrite)
+                .Succeeded());
+    REQUIRE(process->HeapAllocate(Memory::HEAP_VADDR + 0x1000, 0x2000, VMAPermission::Read)
+                .Succeeded());
+    REQUIRE(process->vm_manager.GetBackingBlocksForRange(Memory::HEAP_VADDR, 0x3000)->size() == 2);
+    std::vector<u8> data(0x3000);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<u8>(i * 7);
+    Memory::WriteBlock(*process, Memory::HEAP_VADDR, data.data(), data.size());
+
+    auto shared_memory = kernel.CreateSharedMemory(
+        process.get(), 0x3000, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite,
+        Memory::HEAP_VADDR, MemoryRegion::APPLICATION, "Shared");
+    REQUIRE(shared_memory->backing_blocks.size() == 1);
+    REQUIRE(std::memcmp(shared_memory->GetPointer(), data.data(), data.size()) == 0);
+
+    // The process sees the same memory as the block, with the same permissions
+    std::vector<u8> read(data.size());
+    Memory::ReadBlock(*process, Memory::HEAP_VADDR, read.data(), read.size());
+    REQUIRE(read == data);
+    shared_memory->GetPointer(0x2000)[0] = 0xAB;
+    u8 value;
+    Memory::ReadBlock(*process, Memory::HEAP_VADDR + 0x2000, &value, sizeof(value));
+    REQUIRE(value == 0xAB);
+    REQUIRE(process->vm_manager.FindVMA(Memory::HEAP_VADDR)->second.permissions ==
+            VMAPermission::ReadWrite);
+    REQUIRE(process->vm_manager.FindVMA(Memory::HEAP_VADDR + 0x1000)->second.permissions ==
+            VMAPermission::Read);
+
+    // The memory it was in went back to the region, and freeing the heap returns the new memory
+    REQUIRE(region.used == 0x3000);
+    shared_memory = nullptr;
+    REQUIRE(process->HeapFree(Memory::HEAP_VADDR, 0x3000).IsSuccess());
+    REQUIRE(region.used == 0);
+    REQUIRE(region.free_blocks ==
+            IntervalSet(Interval::right_open(region.base, region.base + region.size)));
+
+    CoreTiming::Shutdown();
+}
+
+TEST_CASE("Heap memory used by shared memory isn't moved", "[core][kernel]") {
+    CoreTiming::Init();
+    KernelSystem kernel(0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    process->memory_region = kernel.GetMemoryRegion(MemoryRegion::APPLICATION);
+
+    REQUIRE(process->HeapAllocate(Memory::HEAP_VADDR, 0x1000, VMAPermission::ReadWrite)
+                .Succeeded());
+    REQUIRE(process->HeapAllocate(Memory::HEAP_VADDR + 0x1000, 0x2000, VMAPermission::ReadWrite)
+                .Succeeded());
+
+    // A block within one part of the heap doesn't need to move it
+    auto inner = kernel.CreateSharedMemory(
+        process.get(), 0x1000, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite,
+        Memory::HEAP_VADDR + 0x1000, MemoryRegion::APPLICATION, "Inner");
+    REQUIRE(inner->backing_blocks.size() == 1);
+    u8* const inner_memory = inner->GetPointer();
+
+    // A block over both parts would move the memory of the first block, so it stays in parts
+    auto outer = kernel.CreateSharedMemory(
+        process.get(), 0x3000, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite,
+        Memory::HEAP_VADDR, MemoryRegion::APPLICATION, "Outer");
+    REQUIRE(outer->backing_blocks.size() == 2);
+    REQUIRE(inner->GetPointer() == inner_memory);
+    inner_memory[0] = 0xAB;
+    u8 value;
+    Memory::ReadBlock(*process, Memory::HEAP_VADDR + 0x1000, &value, sizeof(value));
+    REQUIRE(value == 0xAB);
+
+    // Once the first block is gone, the memory can move
+    inner = nullptr;
+    outer = nullptr;
+    auto moved = kernel.CreateSharedMemory(
+        process.get(), 0x3000, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite,
+        Memory::HEAP_VADDR, MemoryRegion::APPLICATION, "Moved");
+    REQUIRE(moved->backing_blocks.size() == 1);
+    REQUIRE(moved->GetPointer(0x1000)[0] == 0xAB);
+
+    moved = nullptr;
+    REQUIRE(kernel.heap_shared_memory.empty());
+    CoreTiming::Shutdown();
+}
+
+} // namespace Kernel
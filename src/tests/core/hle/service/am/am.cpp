@@ -0,0 +1,105 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <cryptopp/sha.h>
+#include "common/alignment.h"
+#include "common/file_util.h"
+#include "core/file_sys/cia_common.h"
+#include "core/file_sys/ticket.h"
+#include "core/file_sys/title_metadata.h"
+#include "core/hle/service/am/am.h"
+#include "core/hle/service/fs/archive.h"
+#include "tests/test_util.h"
+
+namespace Service::AM {
+
+constexpr u64 TEST_TITLE_ID = 0x0004000000C1A000;
+constexpr u32 SIGNATURE_HEADER_SIZE = 0x40;
+
+/// Builds an unencrypted CIA of a single content, with its SHA-256 in the TMD
+static std::vector<u8> BuildCIA(const std::vector<u8>& content) {
+    constexpr u32 ticket_size = SIGNATURE_HEADER_SIZE + sizeof(FileSys::Ticket::Body);
+    constexpr u32 tmd_size = SIGNATURE_HEADER_SIZE + sizeof(FileSys::TitleMetadata::Body) +
+                             sizeof(FileSys::TitleMetadata::ContentChunk);
+
+    const u64 ticket_offset = Common::AlignUp<u64>(FileSys::CIA_HEADER_SIZE, 0x40);
+    const u64 tmd_offset = Common::AlignUp<u64>(ticket_offset + ticket_size, 0x40);
+    const u64 content_offset = Common::AlignUp<u64>(tmd_offset + tmd_size, 0x40);
+    std::vector<u8> cia(content_offset + content.size());
+
+    // Header size, section sizes, and the bit of the content being present
+    const u32_le header_size = FileSys::CIA_HEADER_SIZE;
+    const u32_le tik_size = ticket_size;
+    const u32_le tmd_size_le = tmd_size;
+    const u64_le content_size = content.size();
+    std::memcpy(&cia[0x0], &header_size, sizeof(header_size));
+    std::memcpy(&cia[0xC], &tik_size, sizeof(tik_size));
+    std::memcpy(&cia[0x10], &tmd_size_le, sizeof(tmd_size_le));
+    std::memcpy(&cia[0x18], &content_size, sizeof(content_size));
+    cia[0x20] = 0x80;
+
+    const u32_be signature_type = FileSys::EcdsaSha256;
+    std::memcpy(&cia[ticket_offset], &signature_type, sizeof(signature_type));
+    std::memcpy(&cia[tmd_offset], &signature_type, sizeof(signature_type));
+
+    FileSys::TitleMetadata::Body tmd{};
+    tmd.title_id = TEST_TITLE_ID;
+    tmd.content_count = 1;
+    std::memcpy(&cia[tmd_offset + SIGNATURE_HEADER_SIZE], &tmd, sizeof(tmd));
+
+    FileSys::TitleMetadata::ContentChunk chunk{};
+    chunk.size = content.size();
+    CryptoPP::SHA256 hash;
+    hash.Update(content.data(), content.size());
+    hash.Final(chunk.hash.data());
+    std::memcpy(&cia[tmd_offset + SIGNATURE_HEADER_SIZE + sizeof(tmd)], &chunk, sizeof(chunk));
+
+    std::copy(content.begin(), content.end(), cia.begin() + content_offset);
+    return cia;
+}
+
+/// Writes a CIA into a CIAFile in chunks, returns whether all the writes succeeded
+static bool WriteCIA(CIAFile& file, const std::vector<u8>& cia, std::size_t chunk_size) {
+    for (std::size_t offset = 0; offset < cia.size(); offset += chunk_size) {
+        const std::size_t length = std::min(chunk_size, cia.size() - offset);
+        if (file.Write(offset, length, true, cia.data() + offset).Failed())
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("CIAFile verifies the content hashes", "[core][service][am]") {
+    const Test::ScopedUserPath sdmc_dir(FileUtil::UserPath::SDMCDir, "./test_cia/");
+
+    std::vector<u8> content(0x12345);
+    for (std::size_t i = 0; i < content.size(); ++i)
+        content[i] = static_cast<u8>(i * 13);
+    std::vector<u8> cia = BuildCIA(content);
+
+    SECTION("intact content is installed") {
+        CIAFile file(FS::MediaType::SDMC);
+        REQUIRE(WriteCIA(file, cia, 0x4000));
+        REQUIRE(file.Close());
+
+        FileUtil::IOFile installed(GetTitleContentPath(FS::MediaType::SDMC, TEST_TITLE_ID), "rb");
+        REQUIRE(installed.IsOpen());
+        std::vector<u8> installed_content(installed.GetSize());
+        installed.ReadBytes(installed_content.data(), installed_content.size());
+        REQUIRE(installed_content == content);
+    }
+
+    SECTION("tampered content fails the write and aborts the install") {
+        cia[cia.size() - content.size() / 2] ^= 1;
+        CIAFile file(FS::MediaType::SDMC);
+        REQUIRE_FALSE(WriteCIA(file, cia, 0x4000));
+        REQUIRE_FALSE(file.Close());
+    }
+}
+
+} // namespace Service::AM
@@ -0,0 +1,212 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/color.h"
+#include "core/hw/gpu.h"
+#include "core/hw/gpu_transfer.h"
+#include "tests/test_util.h"
+#include "video_core/utils.h"
+
+namespace GPU {
+
+namespace {
+
+using PixelFormat = Regs::PixelFormat;
+using DisplayTransferConfig = Regs::DisplayTransferConfig;
+using Test::RandomBytes;
+
+constexpr PixelFormat PixelFormats[] = {PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB565,
+                                        PixelFormat::RGB5A1, PixelFormat::RGBA4};
+
+// Reference implementations, converting a pixel at a time as the engines used to
+
+Math::Vec4<u8> ReferenceDecodePixel(PixelFormat format, const u8* src_pixel) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(src_pixel);
+    case PixelFormat::RGB8:
+        return Color::DecodeRGB8(src_pixel);
+    case PixelFormat::RGB565:
+        return Color::DecodeRGB565(src_pixel);
+    case PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(src_pixel);
+    case PixelFormat::RGBA4:
+        return Color::DecodeRGBA4(src_pixel);
+    default:
+        return {0, 0, 0, 0};
+    }
+}
+
+void ReferenceDisplayTransfer(const DisplayTransferConfig& config, const u8* src_pointer,
+                              u8* dst_pointer) {
+    int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    u32 output_width = config.output_width >> horizontal_scale;
+    u32 output_height = config.output_height >> vertical_scale;
+
+    for (u32 y = 0; y < output_height; ++y) {
+        for (u32 x = 0; x < output_width; ++x) {
+            u32 input_x = x << horizontal_scale;
+            u32 input_y = y << vertical_scale;
+            u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            u32 dst_bytes_per_pixel = Regs::BytesPerPixel(config.output_format);
+            u32 src_bytes_per_pixel = Regs::BytesPerPixel(config.input_format);
+            u32 src_offset;
+            u32 dst_offset;
+
+            if (config.input_linear) {
+                src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+                if (!config.dont_swizzle) {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 (output_y & ~7) * output_width * dst_bytes_per_pixel;
+                } else {
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                }
+            } else {
+                src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
+                             (input_y & ~7) * config.input_width * src_bytes_per_pixel;
+                if (!config.dont_swizzle) {
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                } else {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 (output_y & ~7) * output_width * dst_bytes_per_pixel;
+                }
+            }
+
+            const u8* src_pixel = src_pointer + src_offset;
+            Math::Vec4<u8> src_color = ReferenceDecodePixel(config.input_format, src_pixel);
+            if (config.scaling == config.ScaleX) {
+                Math::Vec4<u8> pixel =
+                    ReferenceDecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
+                src_color = ((src_color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                Math::Vec4<u8> pixel1 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
+                Math::Vec4<u8> pixel2 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
+                Math::Vec4<u8> pixel3 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
+                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+
+            u8* dst_pixel = dst_pointer + dst_offset;
+            switch (config.output_format) {
+            case PixelFormat::RGBA8:
+                Color::EncodeRGBA8(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB8:
+                Color::EncodeRGB8(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB565:
+                Color::EncodeRGB565(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGB5A1:
+                Color::EncodeRGB5A1(src_color, dst_pixel);
+                break;
+            case PixelFormat::RGBA4:
+                Color::EncodeRGBA4(src_color, dst_pixel);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+void ReferenceMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end) {
+    if (config.fill_24bit) {
+        for (u8* ptr = start; ptr < end; ptr += 3) {
+            ptr[0] = config.value_24bit_r;
+            ptr[1] = config.value_24bit_g;
+            ptr[2] = config.value_24bit_b;
+        }
+    } else if (config.fill_32bit) {
+        u32 value = config.value_32bit;
+        std::size_t len = (end - start) / sizeof(u32);
+        for (std::size_t i = 0; i < len; ++i)
+            std::memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
+    } else {
+        u16 value_16bit = config.value_16bit.Value();
+        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
+            std::memcpy(ptr, &value_16bit, sizeof(u16));
+    }
+}
+
+/// Size of a buffer holding any image of the given dimensions, in any layout
+std::size_t GetBufferSize(u32 width, u32 height) {
+    return ((width + 8) & ~7) * ((height + 8) & ~7) * 4 + 64 * 4;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SoftwareDisplayTransfer matches the per-pixel conversion", "[core][hw][gpu]") {
+    std::mt19937 rng(1);
+
+    for (PixelFormat input_format : PixelFormats) {
+        for (PixelFormat output_format : PixelFormats) {
+            for (int i = 0; i < 40; ++i) {
+                DisplayTransferConfig config{};
+                config.input_format.Assign(input_format);
+                config.output_format.Assign(output_format);
+                config.flip_vertically.Assign(rng() % 2);
+                config.input_linear.Assign(rng() % 2);
+                config.dont_swizzle.Assign(rng() % 2);
+                // Scaling is only implemented on tiled input
+                const u32 scaling = config.input_linear ? 0 : rng() % 3;
+                config.scaling.Assign(static_cast<DisplayTransferConfig::ScalingMode>(scaling));
+                // Mostly whole tiles, and some odd sizes to cover the ends of the rows
+                const bool whole_tiles = rng() % 4 != 0;
+                const u32 width = whole_tiles ? (1 + rng() % 12) * 8 : 1 + rng() % 100;
+                const u32 height = whole_tiles ? (1 + rng() % 6) * 8 : 1 + rng() % 50;
+                config.output_width.Assign(width);
+                config.output_height.Assign(height);
+                config.input_width.Assign(width);
+                config.input_height.Assign(height);
+
+                const std::vector<u8> src = RandomBytes(GetBufferSize(width, height), rng);
+                std::vector<u8> expected = RandomBytes(GetBufferSize(width, height), rng);
+                std::vector<u8> dst = expected;
+                ReferenceDisplayTransfer(config, src.data(), expected.data());
+                SoftwareDisplayTransfer(config, src.data(), dst.data());
+
+                INFO("formats " << static_cast<int>(input_format) << " -> "
+                                << static_cast<int>(output_format) << ", flags " << std::hex
+                                << config.flags << ", size " << std::dec << width << "x"
+                                << height);
+                REQUIRE(dst == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("SoftwareMemoryFill matches the per-value fill", "[core][hw][gpu]") {
+    std::mt19937 rng(2);
+
+    for (int mode = 0; mode < 3; ++mode) {
+        for (int i = 0; i < 50; ++i) {
+            Regs::MemoryFillConfig config{};
+            config.value_32bit = static_cast<u32>(rng());
+            config.fill_24bit.Assign(mode == 1);
+            config.fill_32bit.Assign(mode == 2);
+
+            // Fills of up to a few patterns, with ranges which don't end on a whole value
+            const std::size_t size = 1 + rng() % 3000;
+            std::vector<u8> expected = RandomBytes(size + 8, rng);
+            std::vector<u8> memory = expected;
+            ReferenceMemoryFill(config, expected.data(), expected.data() + size);
+            SoftwareMemoryFill(config, memory.data(), memory.data() + size);
+
+            INFO("mode " << mode << ", size " << size);
+            REQUIRE(memory == expected);
+        }
+    }
+}
+
+} // namespace GPU
@@ -0,0 +1,375 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/color.h"
+#include "core/hle/service/y2r_u.h"
+#include "core/hw/y2r.h"
+#include "tests/test_util.h"
+
+namespace HW::Y2R {
+
+namespace {
+
+using namespace Service::Y2R;
+using Test::RandomBytes;
+
+using ImageTile = std::array<u32, 64>;
+
+// Reference implementation, converting and rotating a pixel at a time as the engine used to
+
+void ReferenceConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
+                              const u8* input_V, ImageTile output[], unsigned int width,
+                              unsigned int height, const CoefficientSet& coefficients) {
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            s32 Y = 0;
+            s32 U = 0;
+            s32 V = 0;
+            switch (input_format) {
+            case InputFormat::YUV422_Indiv8:
+            case InputFormat::YUV422_Indiv16:
+                Y = input_Y[y * width + x];
+                U = input_U[(y * width + x) / 2];
+                V = input_V[(y * width + x) / 2];
+                break;
+            case InputFormat::YUV420_Indiv8:
+            case InputFormat::YUV420_Indiv16:
+                Y = input_Y[y * width + x];
+                U = input_U[((y / 2) * width + x) / 2];
+                V = input_V[((y / 2) * width + x) / 2];
+                break;
+            case InputFormat::YUYV422_Interleaved:
+                Y = input_Y[(y * width + x) * 2];
+                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
+                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
+                break;
+            }
+
+            auto& c = coefficients;
+            s32 cY = c[0] * Y;
+
+            s32 r = cY + c[1] * V;
+            s32 g = cY - c[2] * V - c[3] * U;
+            s32 b = cY + c[4] * U;
+
+            const s32 rounding_offset = 0x18;
+            r = (r >> 3) + c[5] + rounding_offset;
+            g = (g >> 3) + c[6] + rounding_offset;
+            b = (b >> 3) + c[7] + rounding_offset;
+
+            unsigned int tile = x / 8;
+            unsigned int tile_x = x % 8;
+            u32* out = &output[tile][y * 8 + tile_x];
+            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
+                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
+                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+        }
+    }
+}
+
+std::size_t ReferenceEncode(const u32* input, u8* output, std::size_t amount_of_data,
+                            OutputFormat output_format, u8 alpha) {
+    const u8* const start = output;
+    for (std::size_t i = 0; i < amount_of_data; ++i) {
+        u32 color = *input++;
+        Math::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
+
+        switch (output_format) {
+        case OutputFormat::RGBA8:
+            Color::EncodeRGBA8(col_vec, output);
+            output += 4;
+            break;
+        case OutputFormat::RGB8:
+            Color::EncodeRGB8(col_vec, output);
+            output += 3;
+            break;
+        case OutputFormat::RGB5A1:
+            Color::EncodeRGB5A1(col_vec, output);
+            output += 2;
+            break;
+        case OutputFormat::RGB565:
+            Color::EncodeRGB565(col_vec, output);
+            output += 2;
+            break;
+        }
+    }
+    return output - start;
+}
+
+const u8 linear_lut[64] = {
+    // clang-format off
+     0,  1,  2,  3,  4,  5,  6,  7,
+     8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30, 31,
+    32, 33, 34, 35, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55,
+    56, 57, 58, 59, 60, 61, 62, 63,
+    // clang-format on
+};
+
+const u8 morton_lut[64] = {
+    // clang-format off
+     0,  1,  4,  5, 16, 17, 20, 21,
+     2,  3,  6,  7, 18, 19, 22, 23,
+     8,  9, 12, 13, 24, 25, 28, 29,
+    10, 11, 14, 15, 26, 27, 30, 31,
+    32, 33, 36, 37, 48, 49, 52, 53,
+    34, 35, 38, 39, 50, 51, 54, 55,
+    40, 41, 44, 45, 56, 57, 60, 61,
+    42, 43, 46, 47, 58, 59, 62, 63,
+    // clang-format on
+};
+
+void RotateTile0(const ImageTile& input, ImageTile& output, int height, const u8 out_map[64]) {
+    for (int i = 0; i < height * 8; ++i) {
+        output[out_map[i]] = input[i];
+    }
+}
+
+void RotateTile90(const ImageTile& input, ImageTile& output, int height, const u8 out_map[64]) {
+    int out_i = 0;
+    for (int x = 0; x < 8; ++x) {
+        for (int y = height - 1; y >= 0; --y) {
+            output[out_map[out_i++]] = input[y * 8 + x];
+        }
+    }
+}
+
+void RotateTile180(const ImageTile& input, ImageTile& output, int height, const u8 out_map[64]) {
+    int out_i = 0;
+    for (int i = height * 8 - 1; i >= 0; --i) {
+        output[out_map[out_i++]] = input[i];
+    }
+}
+
+void RotateTile270(const ImageTile& input, ImageTile& output, int height, const u8 out_map[64]) {
+    int out_i = 0;
+    for (int x = 8 - 1; x >= 0; --x) {
+        for (int y = 0; y < height; ++y) {
+            output[out_map[out_i++]] = input[y * 8 + x];
+        }
+    }
+}
+
+void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            output[y * line_stride + x] = tile[y * 8 + x];
+        }
+    }
+}
+
+/// Converts an image laid out as HW::Y2R::ConvertImage expects it, a strip at a time
+void ReferenceConvertImage(const ConversionConfiguration& cvt, const u8* input_Y,
+                           const u8* input_U, const u8* input_V, u8* output) {
+    const std::size_t num_tiles = cvt.input_line_width / 8;
+    std::vector<ImageTile> tiles(num_tiles);
+    std::vector<u32> output_buffer(cvt.input_line_width * 8);
+    ImageTile tmp_tile;
+    const u8* tile_remap =
+        cvt.block_alignment == BlockAlignment::Linear ? linear_lut : morton_lut;
+
+    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+        unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+        const std::size_t row_offset = y * cvt.input_line_width;
+
+        const u8* strip_Y = input_Y + row_offset;
+        const u8* strip_U = nullptr;
+        const u8* strip_V = nullptr;
+        switch (cvt.input_format) {
+        case InputFormat::YUV422_Indiv8:
+        case InputFormat::YUV422_Indiv16:
+            strip_U = input_U + row_offset / 2;
+            strip_V = input_V + row_offset / 2;
+            break;
+        case InputFormat::YUV420_Indiv8:
+        case InputFormat::YUV420_Indiv16:
+            strip_U = input_U + row_offset / 4;
+            strip_V = input_V + row_offset / 4;
+            break;
+        case InputFormat::YUYV422_Interleaved:
+            strip_Y = input_Y + row_offset * 2;
+            break;
+        }
+        ReferenceConvertYUVToRGB(cvt.input_format, strip_Y, strip_U, strip_V, tiles.data(),
+                                 cvt.input_line_width, row_height, cvt.coefficients);
+
+        u32* out = output_buffer.data();
+        for (std::size_t i = 0; i < num_tiles; ++i) {
+            int image_strip_width = 0;
+            int output_stride = 0;
+
+            switch (cvt.rotation) {
+            case Rotation::None:
+                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
+                image_strip_width = cvt.input_line_width;
+                output_stride = 8;
+                break;
+            case Rotation::Clockwise_90:
+                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
+                image_strip_width = 8;
+                output_stride = 8 * row_height;
+                break;
+            case Rotation::Clockwise_180:
+                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+                image_strip_width = cvt.input_line_width;
+                output_stride = 8;
+                break;
+            case Rotation::Clockwise_270:
+                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+                image_strip_width = 8;
+                output_stride = 8 * row_height;
+                break;
+            }
+
+            switch (cvt.block_alignment) {
+            case BlockAlignment::Linear:
+                WriteTileToOutput(out, tmp_tile, row_height, image_strip_width);
+                out += output_stride;
+                break;
+            case BlockAlignment::Block8x8:
+                WriteTileToOutput(out, tmp_tile, 8, 8);
+                out += 64;
+                break;
+            }
+        }
+
+        output += ReferenceEncode(output_buffer.data(), output, row_height * cvt.input_line_width,
+                                  cvt.output_format, static_cast<u8>(cvt.alpha));
+    }
+}
+
+std::size_t GetBytesPerPixel(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::RGBA8:
+        return 4;
+    case OutputFormat::RGB8:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+/// Converts a random image with both implementations and checks that they give the same bytes
+void CheckConversion(const ConversionConfiguration& cvt, std::mt19937& rng) {
+    const std::size_t num_pixels = cvt.input_line_width * cvt.input_lines;
+    const std::vector<u8> input_Y = RandomBytes(num_pixels * 2, rng);
+    const std::vector<u8> input_U = RandomBytes(num_pixels / 2, rng);
+    const std::vector<u8> input_V = RandomBytes(num_pixels / 2, rng);
+
+    const std::size_t output_size = num_pixels * GetBytesPerPixel(cvt.output_format);
+    std::vector<u8> expected(output_size);
+    std::vector<u8> output(output_size);
+    ReferenceConvertImage(cvt, input_Y.data(), input_U.data(), input_V.data(), expected.data());
+    ConvertImage(cvt, input_Y.data(), input_U.data(), input_V.data(), output.data());
+
+    INFO("input format " << static_cast<int>(cvt.input_format) << ", output format "
+                         << static_cast<int>(cvt.output_format) << ", rotation "
+                         << static_cast<int>(cvt.rotation) << ", alignment "
+                         << static_cast<int>(cvt.block_alignment) << ", size "
+                         << cvt.input_line_width << "x" << cvt.input_lines);
+    REQUIRE(output == expected);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Y2R ConvertImage matches the per-pixel conversion", "[core][hw][y2r]") {
+    std::mt19937 rng(1);
+
+    for (int input_format = 0; input_format < 5; ++input_format) {
+        for (int output_format = 0; output_format < 4; ++output_format) {
+            for (int rotation = 0; rotation < 4; ++rotation) {
+                for (int alignment = 0; alignment < 2; ++alignment) {
+                    ConversionConfiguration cvt{};
+                    cvt.input_format = static_cast<InputFormat>(input_format);
+                    cvt.output_format = static_cast<OutputFormat>(output_format);
+                    cvt.rotation = static_cast<Rotation>(rotation);
+                    cvt.block_alignment = static_cast<BlockAlignment>(alignment);
+                    cvt.alpha = static_cast<u16>(rng());
+                    // Random coefficients, which also exercise the clamping
+                    for (s16& coefficient : cvt.coefficients) {
+                        coefficient = static_cast<s16>(rng());
+                    }
+
+                    cvt.input_line_width = static_cast<u16>((1 + rng() % 32) * 8);
+                    // Linear output allows a partial last strip
+                    cvt.input_lines = alignment == 0 ? static_cast<u16>(1 + rng() % 40)
+                                                     : static_cast<u16>((1 + rng() % 5) * 8);
+                    CheckConversion(cvt, rng);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Y2R ConvertImage of a partial last strip of 8x8 blocks", "[core][hw][y2r]") {
+    std::mt19937 rng(4);
+
+    ConversionConfiguration cvt{};
+    cvt.input_format = InputFormat::YUV422_Indiv8;
+    cvt.output_format = OutputFormat::RGBA8;
+    cvt.rotation = GENERATE(Rotation::None, Rotation::Clockwise_90, Rotation::Clockwise_180,
+                            Rotation::Clockwise_270);
+    cvt.block_alignment = BlockAlignment::Block8x8;
+    cvt.alpha = 0xFF;
+    REQUIRE(cvt.SetStandardCoefficient(StandardCoefficient::ITU_Rec601).IsSuccess());
+    cvt.input_line_width = 64;
+    cvt.input_lines = static_cast<u16>(16 + GENERATE(range(1, 8)));
+
+    const std::size_t num_pixels = cvt.input_line_width * cvt.input_lines;
+    std::vector<u8> input_Y = RandomBytes(num_pixels, rng);
+    std::vector<u8> input_U = RandomBytes(num_pixels / 2, rng);
+    std::vector<u8> input_V = RandomBytes(num_pixels / 2, rng);
+    std::vector<u8> output(num_pixels * 4);
+    ConvertImage(cvt, input_Y.data(), input_U.data(), input_V.data(), output.data());
+
+    // The reference leaves the pixels of the previous strips where the last strip has none, they
+    // are found by converting again with other previous strips
+    std::vector<u8> expected(output.size());
+    ReferenceConvertImage(cvt, input_Y.data(), input_U.data(), input_V.data(), expected.data());
+    const std::size_t last_strip = 16 * cvt.input_line_width;
+    for (std::size_t i = 0; i < last_strip; ++i) {
+        input_Y[i] = static_cast<u8>(~input_Y[i]);
+        input_U[i / 2] = static_cast<u8>(~input_U[i / 2]);
+    }
+    std::vector<u8> other_expected(output.size());
+    ReferenceConvertImage(cvt, input_Y.data(), input_U.data(), input_V.data(),
+                          other_expected.data());
+
+    REQUIRE(std::equal(output.begin(), output.begin() + last_strip * 4, expected.begin()));
+    std::size_t num_checked = 0;
+    for (std::size_t pixel = last_strip; pixel < num_pixels; ++pixel) {
+        const auto expected_pixel = expected.begin() + pixel * 4;
+        if (std::equal(expected_pixel, expected_pixel + 4, other_expected.begin() + pixel * 4)) {
+            INFO("pixel " << pixel);
+            REQUIRE(std::equal(expected_pixel, expected_pixel + 4, output.begin() + pixel * 4));
+            ++num_checked;
+        }
+    }
+    REQUIRE(num_checked > 0);
+}
+
+TEST_CASE("Y2R ConvertImage splits large images across threads", "[core][hw][y2r]") {
+    std::mt19937 rng(2);
+
+    ConversionConfiguration cvt{};
+    cvt.input_format = InputFormat::YUV420_Indiv8;
+    cvt.output_format = OutputFormat::RGB565;
+    cvt.rotation = GENERATE(Rotation::None, Rotation::Clockwise_90);
+    cvt.block_alignment = BlockAlignment::Linear;
+    cvt.alpha = 0xFF;
+    REQUIRE(cvt.SetStandardCoefficient(StandardCoefficient::ITU_Rec601).IsSuccess());
+    cvt.input_line_width = 1024;
+    cvt.input_lines = 509;
+    CheckConversion(cvt, rng);
+}
+
+} // namespace HW::Y2R
@@ -0,0 +1,278 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "core/rpc/rpc_server.h"
+#include "tests/test_util.h"
+
+namespace RPC {
+
+namespace {
+
+constexpr u32 HeapSize = 0x200000;
+
+/// Maps a buffer as the heap of the current process, which the RPC server reads and writes
+class TestMemory {
+public:
+    TestMemory() : heap(HeapSize) {
+        CoreTiming::Init();
+        // HACK: the memory functions refer to the kernel of the global instance
+        Core::System::GetInstance().kernel = std::make_unique<Kernel::KernelSystem>(0);
+        Kernel::KernelSystem& kernel = *Core::System::GetInstance().kernel;
+        kernel.SetCurrentProcess(kernel.CreateProcess(kernel.CreateCodeSet("", 0)));
+        page_table = &kernel.GetCurrentProcess()->vm_manager.page_table;
+
+        std::iota(heap.begin(), heap.end(), u8(0));
+        Memory::MapMemoryRegion(*page_table, Memory::HEAP_VADDR, HeapSize, heap.data());
+    }
+
+    ~TestMemory() {
+        Memory::UnmapRegion(*page_table, Memory::HEAP_VADDR, HeapSize);
+        Core::System::GetInstance().kernel.reset();
+        CoreTiming::Shutdown();
+    }
+
+    std::vector<u8> heap;
+
+private:
+    Memory::PageTable* page_table;
+};
+
+/// A scripting client, talking to the server over the loopback interface
+class TestClient {
+public:
+    TestClient() : socket(context, ZMQ_REQ) {
+        socket.setsockopt(ZMQ_RCVTIMEO, 5000);
+        socket.connect("tcp://127.0.0.1:45987");
+    }
+
+    std::vector<u8> Request(PacketType type, const std::vector<u8>& data) {
+        const PacketHeader header{CURRENT_VERSION, ++id, type, static_cast<u32>(data.size())};
+        std::vector<u8> request(MIN_PACKET_SIZE + data.size());
+        std::memcpy(request.data(), &header, sizeof(header));
+        std::copy(data.begin(), data.end(), request.begin() + MIN_PACKET_SIZE);
+        socket.send(request.data(), request.size());
+
+        zmq::message_t reply;
+        REQUIRE(socket.recv(&reply, 0));
+        REQUIRE(reply.size() >= MIN_PACKET_SIZE);
+        PacketHeader reply_header;
+        std::memcpy(&reply_header, reply.data(), sizeof(reply_header));
+        REQUIRE(reply_header.id == id);
+        REQUIRE(reply_header.packet_type == type);
+        REQUIRE(reply_header.packet_size == reply.size() - MIN_PACKET_SIZE);
+
+        const u8* reply_data = static_cast<const u8*>(reply.data()) + MIN_PACKET_SIZE;
+        return {reply_data, reply_data + reply_header.packet_size};
+    }
+
+    std::vector<u8> ReadMemory(u32 address, u32 size) {
+        return Request(PacketType::ReadMemory, Pack({address, size}));
+    }
+
+    std::vector<u8> ReadMemoryBatch(const std::vector<MemoryRange>& ranges) {
+        return Request(PacketType::ReadMemoryBatch, PackRanges(ranges));
+    }
+
+    /// Packs words in the little endian wire format
+    static std::vector<u8> Pack(const std::vector<u32>& words) {
+        std::vector<u8> data(words.size() * sizeof(u32));
+        std::memcpy(data.data(), words.data(), data.size());
+        return data;
+    }
+
+    static std::vector<u8> PackRanges(const std::vector<MemoryRange>& ranges) {
+        std::vector<u32> words{static_cast<u32>(ranges.size())};
+        for (const MemoryRange& range : ranges) {
+            words.push_back(range.address);
+            words.push_back(range.size);
+        }
+        return Pack(words);
+    }
+
+private:
+    zmq::context_t context{1};
+    zmq::socket_t socket;
+    u32 id = 0;
+};
+
+std::vector<u8> HeapContents(const TestMemory& memory, u32 address, u32 size) {
+    const auto start = memory.heap.begin() + (address - Memory::HEAP_VADDR);
+    return {start, start + size};
+}
+
+/// Addresses spread over the first half of the heap, as a script watching the state of a game polls
+std::vector<MemoryRange> ScatteredRanges(std::size_t count, u32 size) {
+    std::mt19937 rng(1);
+    std::vector<MemoryRange> ranges(count);
+    for (MemoryRange& range : ranges) {
+        range = {Memory::HEAP_VADDR + static_cast<u32>(rng() % (HeapSize / 2 - size)), size};
+    }
+    return ranges;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RPC batched reads and writes", "[core][rpc]") {
+    TestMemory memory;
+    RPCServer server;
+    TestClient client;
+
+    SECTION("reads") {
+        const std::vector<MemoryRange> ranges = ScatteredRanges(300, 13);
+        std::vector<u8> expected;
+        for (const MemoryRange& range : ranges) {
+            const std::vector<u8> contents = HeapContents(memory, range.address, range.size);
+            expected.insert(expected.end(), contents.begin(), contents.end());
+        }
+        REQUIRE(client.ReadMemoryBatch(ranges) == expected);
+
+        // A single read may now be larger than the old 32 byte limit
+        REQUIRE(client.ReadMemory(Memory::HEAP_VADDR, 0x10000) ==
+                HeapContents(memory, Memory::HEAP_VADDR, 0x10000));
+    }
+
+    SECTION("writes") {
+        std::vector<u8> request = TestClient::Pack({2, Memory::HEAP_VADDR + 0x10, 3});
+        request.insert(request.end(), {0xAA, 0xBB, 0xCC});
+        const std::vector<u8> second = TestClient::Pack({Memory::HEAP_VADDR + 0x100, 1});
+        request.insert(request.end(), second.begin(), second.end());
+        request.push_back(0xDD);
+
+        REQUIRE(client.Request(PacketType::WriteMemoryBatch, request).empty());
+        REQUIRE(HeapContents(memory, Memory::HEAP_VADDR + 0x10, 3) ==
+                std::vector<u8>{0xAA, 0xBB, 0xCC});
+        REQUIRE(memory.heap[0x100] == 0xDD);
+    }
+
+    SECTION("malformed requests get an empty reply") {
+        // More ranges than sent
+        REQUIRE(client.Request(PacketType::ReadMemoryBatch,
+                               TestClient::Pack({2, Memory::HEAP_VADDR, 4}))
+                    .empty());
+        // Larger than a reply may be
+        REQUIRE(client.ReadMemoryBatch({{Memory::HEAP_VADDR, MAX_READ_SIZE},
+                                        {Memory::HEAP_VADDR, 1}})
+                    .empty());
+        // Missing the written data
+        std::vector<u8> request = TestClient::Pack({1, Memory::HEAP_VADDR, 4, 0});
+        request.pop_back();
+        REQUIRE(client.Request(PacketType::WriteMemoryBatch, request).empty());
+        REQUIRE(HeapContents(memory, Memory::HEAP_VADDR, 4) == std::vector<u8>{0, 1, 2, 3});
+    }
+}
+
+TEST_CASE("RPC memory watches are published every frame", "[core][rpc]") {
+    TestMemory memory;
+    RPCServer server;
+    TestClient client;
+
+    zmq::context_t context{1};
+    zmq::socket_t subscriber(context, ZMQ_SUB);
+    subscriber.setsockopt(ZMQ_RCVTIMEO, 10);
+    subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+    subscriber.connect("tcp://127.0.0.1:45988");
+
+    // The first range is a counter which the "game" increments every frame
+    const u32 counter_offset = HeapSize - 4;
+    std::vector<MemoryRange> ranges = ScatteredRanges(100, 4);
+    ranges.insert(ranges.begin(), {Memory::HEAP_VADDR + counter_offset, 4});
+    REQUIRE(client.Request(PacketType::SetMemoryWatches, TestClient::PackRanges(ranges)).empty());
+
+    // Updates published before the subscription reaches the server are dropped, so keep
+    // emulating frames until some arrive
+    std::vector<u32> frames;
+    std::vector<u32> counters;
+    for (u32 i = 0; i < 500 && frames.size() < 3; ++i) {
+        std::memcpy(&memory.heap[counter_offset], &i, sizeof(i));
+        server.PublishMemoryWatches();
+
+        zmq::message_t update;
+        if (!subscriber.recv(&update, 0)) {
+            continue;
+        }
+
+        PacketHeader header;
+        std::memcpy(&header, update.data(), sizeof(header));
+        REQUIRE(header.packet_type == PacketType::MemoryWatchUpdate);
+        REQUIRE(header.packet_size == sizeof(u32) + ranges.size() * 4);
+        REQUIRE(update.size() == MIN_PACKET_SIZE + header.packet_size);
+
+        // The update starts with the frame number, followed by the watched memory
+        const u8* data = static_cast<const u8*>(update.data()) + MIN_PACKET_SIZE;
+        u32 frame;
+        u32 counter;
+        std::memcpy(&frame, data, sizeof(frame));
+        std::memcpy(&counter, data + sizeof(u32), sizeof(counter));
+        frames.push_back(frame);
+        counters.push_back(counter);
+
+        for (std::size_t range = 1; range < ranges.size(); ++range) {
+            const std::vector<u8> expected = HeapContents(memory, ranges[range].address, 4);
+            REQUIRE(std::equal(expected.begin(), expected.end(), data + sizeof(u32) + range * 4));
+        }
+    }
+
+    // Each update holds the memory as it was at the end of its frame. Frames are only skipped
+    // when the subscriber falls behind.
+    REQUIRE(frames.size() == 3);
+    for (std::size_t i = 1; i < frames.size(); ++i) {
+        REQUIRE(frames[i - 1] < frames[i]);
+        REQUIRE(counters[i - 1] < counters[i]);
+        REQUIRE(frames[i] - frames[i - 1] <= counters[i] - counters[i - 1]);
+    }
+}
+
+TEST_CASE("RPC polling over loopback", "[core][rpc][.benchmark]") {
+    using Us = std::chrono::duration<double, std::micro>;
+    using Seconds = std::chrono::duration<double>;
+
+    TestMemory memory;
+    RPCServer server;
+    TestClient client;
+
+    // Latency of polling a few hundred scattered values, as a script does every frame
+    const std::vector<MemoryRange> ranges = ScatteredRanges(256, 4);
+    constexpr int NumPolls = 20;
+
+    const double single_us = Test::TimePerRun<Us>(NumPolls, [&] {
+        for (const MemoryRange& range : ranges) {
+            client.ReadMemory(range.address, range.size);
+        }
+    });
+    const double batch_us = Test::TimePerRun<Us>(NumPolls, [&] { client.ReadMemoryBatch(ranges); });
+
+    WARN("Polling 256 values: " << single_us << " us with single reads, " << batch_us
+                                << " us with a batched read");
+
+    // Throughput of dumping the heap, in reads of the old and the new maximum size
+    constexpr int NumDumps = 4;
+    const double small_seconds = Test::TimePerRun<Seconds>(NumDumps, [&] {
+        for (u32 offset = 0; offset < HeapSize; offset += 32) {
+            client.ReadMemory(Memory::HEAP_VADDR + offset, 32);
+        }
+    });
+    const double large_seconds = Test::TimePerRun<Seconds>(NumDumps, [&] {
+        for (u32 offset = 0; offset < HeapSize; offset += MAX_READ_SIZE) {
+            client.ReadMemory(Memory::HEAP_VADDR + offset, MAX_READ_SIZE);
+        }
+    });
+
+    const double megabytes = HeapSize / double(1024 * 1024);
+    WARN("Reading the heap: " << megabytes / small_seconds << " MiB/s in 32 byte reads, "
+                              << megabytes / large_seconds << " MiB/s in "
+                              << MAX_READ_SIZE / 1024 << " KiB reads");
+}
+
+} // namespace RPC
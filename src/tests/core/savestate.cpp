@@ -0,0 +1,200 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/hle/hle.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+#include "core/savestate.h"
+
+using Core::MemoryBlock;
+using Core::MemorySnapshot;
+
+/// Writes a byte to random offsets of data, returns the number of distinct pages written
+static std::size_t ScribblePages(std::vector<u8>& data, std::size_t num_writes, u32 seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::size_t> offset(0, data.size() - 1);
+    std::vector<bool> written(data.size() / Memory::PAGE_SIZE);
+    std::size_t num_pages = 0;
+    for (std::size_t i = 0; i < num_writes; ++i) {
+        const std::size_t o = offset(rng);
+        data[o] = static_cast<u8>(data[o] + 1);
+        if (!written[o / Memory::PAGE_SIZE]) {
+            written[o / Memory::PAGE_SIZE] = true;
+            ++num_pages;
+        }
+    }
+    return num_pages;
+}
+
+TEST_CASE("MemorySnapshot shares unchanged pages", "[core][savestate]") {
+    std::vector<u8> first(64 * Memory::PAGE_SIZE);
+    std::vector<u8> second(16 * Memory::PAGE_SIZE);
+    for (std::size_t i = 0; i < first.size(); ++i)
+        first[i] = static_cast<u8>(i * 7);
+    const std::vector<MemoryBlock> blocks{{first.data(), first.size()},
+                                          {second.data(), second.size()}};
+
+    MemorySnapshot base;
+    base.Capture(blocks, nullptr);
+    REQUIRE(base.GetNumCopiedPages() == 80);
+    const std::vector<u8> first_at_base = first;
+    const std::vector<u8> second_at_base = second;
+
+    const std::size_t num_changed = ScribblePages(first, 20, 1) + ScribblePages(second, 3, 2);
+    MemorySnapshot snapshot;
+    snapshot.Capture(blocks, &base);
+    REQUIRE(snapshot.GetNumCopiedPages() == num_changed);
+    const std::vector<u8> first_at_snapshot = first;
+    const std::vector<u8> second_at_snapshot = second;
+
+    ScribblePages(first, 100, 3);
+    ScribblePages(second, 100, 4);
+    snapshot.Restore(blocks);
+    REQUIRE(first == first_at_snapshot);
+    REQUIRE(second == second_at_snapshot);
+
+    base.Restore(blocks);
+    REQUIRE(first == first_at_base);
+    REQUIRE(second == second_at_base);
+
+    // A block which grew only copies its new pages
+    second.resize(second.size() + 2 * Memory::PAGE_SIZE);
+    const std::vector<MemoryBlock> grown_blocks{{first.data(), first.size()},
+                                                {second.data(), second.size()}};
+    snapshot.Capture(grown_blocks, &base);
+    REQUIRE(snapshot.GetNumCopiedPages() == 2);
+
+    // Capturing into the previous snapshot itself is allowed
+    ScribblePages(first, 1, 5);
+    snapshot.Capture(grown_blocks, &snapshot);
+    REQUIRE(snapshot.GetNumCopiedPages() == 1);
+}
+
+TEST_CASE("MemorySnapshot captures blocks ending with a partial page", "[core][savestate]") {
+    // Code loaded from an NCCH isn't padded to a whole page
+    std::vector<u8> code(3 * Memory::PAGE_SIZE + 100);
+    for (std::size_t i = 0; i < code.size(); ++i)
+        code[i] = static_cast<u8>(i * 3);
+    const std::vector<MemoryBlock> blocks{{code.data(), code.size()}};
+
+    MemorySnapshot base;
+    base.Capture(blocks, nullptr);
+    REQUIRE(base.GetNumCopiedPages() == 4);
+    const std::vector<u8> code_at_base = code;
+
+    code.back() = static_cast<u8>(code.back() + 1);
+    MemorySnapshot snapshot;
+    snapshot.Capture(blocks, &base);
+    REQUIRE(snapshot.GetNumCopiedPages() == 1);
+    const std::vector<u8> code_at_snapshot = code;
+
+    base.Restore(blocks);
+    REQUIRE(code == code_at_base);
+    snapshot.Restore(blocks);
+    REQUIRE(code == code_at_snapshot);
+}
+
+TEST_CASE("SaveState restores the system after running", "[core][savestate]") {
+    CoreTiming::Init();
+    auto& system = Core::System::GetInstance();
+    system.kernel = std::make_unique<Kernel::KernelSystem>(0);
+    system.SetCoresForTests(std::make_unique<ARM_DynCom>(USER32MODE),
+                            std::make_unique<AudioCore::DspHle>());
+    auto& kernel = *system.kernel;
+    auto& thread_manager = kernel.GetThreadManager();
+
+    // Counts in r0, and writes the count below the top of the stack
+    const std::array<u32, 3> program{
+        0xE2800001, // loop: add r0, r0, #1
+        0xE50D0004, // str r0, [sp, #-4]
+        0xEAFFFFFC, // b loop
+    };
+    auto codeset = kernel.CreateCodeSet("test", 0);
+    codeset->memory = std::make_shared<std::vector<u8>>(3 * Memory::PAGE_SIZE);
+    std::memcpy(codeset->memory->data(), program.data(), sizeof(program));
+    for (std::size_t i = 0; i < codeset->segments.size(); ++i) {
+        codeset->segments[i].offset = i * Memory::PAGE_SIZE;
+        codeset->segments[i].addr = Memory::PROCESS_IMAGE_VADDR + i * Memory::PAGE_SIZE;
+        codeset->segments[i].size = Memory::PAGE_SIZE;
+    }
+    codeset->entrypoint = Memory::PROCESS_IMAGE_VADDR;
+
+    auto process = kernel.CreateProcess(codeset);
+    process->Run(Kernel::ThreadPrioDefault, Kernel::DEFAULT_STACK_SIZE);
+    thread_manager.Reschedule();
+    const Kernel::SharedPtr<Kernel::Thread> thread = thread_manager.GetCurrentThread();
+    REQUIRE(thread != nullptr);
+
+    auto wait_event = kernel.CreateEvent(Kernel::ResetType::OneShot);
+    auto signal_event = kernel.CreateEvent(Kernel::ResetType::OneShot);
+    process->handle_table.Create(wait_event).Unwrap();
+    process->handle_table.Create(signal_event).Unwrap();
+
+    const auto run = [&system] {
+        for (int i = 0; i < 4; ++i) {
+            CoreTiming::Advance();
+            system.CPU().Run();
+        }
+    };
+    const VAddr count_address = Memory::HEAP_VADDR_END - 4;
+
+    run();
+    auto save_state = Core::SaveState::Capture();
+    const u32 count_at_capture = Memory::Read32(count_address);
+    const u32 r0_at_capture = system.CPU().GetReg(0);
+    REQUIRE(count_at_capture != 0);
+
+    run();
+    const u32 count_after_run = Memory::Read32(count_address);
+    const u32 r0_after_run = system.CPU().GetReg(0);
+    const u64 ticks_after_run = CoreTiming::GetTicks();
+    REQUIRE(count_after_run != count_at_capture);
+
+    // The thread then waits on an event, and another event is signaled, which changes the kernel
+    // state but not its layout
+    thread->status = Kernel::ThreadStatus::WaitSynchAny;
+    thread->wait_objects = {wait_event};
+    wait_event->AddWaitingThread(thread);
+    signal_event->Signal();
+    thread_manager.Reschedule();
+    REQUIRE(thread_manager.GetCurrentThread() == nullptr);
+
+    // The program makes no service requests, so the state can be restored
+    REQUIRE(save_state->Restore() == Core::SaveState::RestoreResult::Success);
+    REQUIRE(thread_manager.GetCurrentThread() == thread.get());
+    REQUIRE(thread->status == Kernel::ThreadStatus::Running);
+    REQUIRE(thread->wait_objects.empty());
+    REQUIRE(wait_event->GetWaitingThreads().empty());
+    REQUIRE(signal_event->ShouldWait(thread.get()));
+    REQUIRE(Memory::Read32(count_address) == count_at_capture);
+    REQUIRE(system.CPU().GetReg(0) == r0_at_capture);
+
+    // Running from the restored state does the same as running from the captured one
+    run();
+    REQUIRE(Memory::Read32(count_address) == count_after_run);
+    REQUIRE(system.CPU().GetReg(0) == r0_after_run);
+    REQUIRE(CoreTiming::GetTicks() == ticks_after_run);
+
+    // A handle created since the capture changes the layout, the state no longer applies
+    process->handle_table.Create(kernel.CreateEvent(Kernel::ResetType::OneShot)).Unwrap();
+    REQUIRE(save_state->Restore() == Core::SaveState::RestoreResult::KernelChanged);
+    REQUIRE(Memory::Read32(count_address) == count_after_run);
+
+    save_state.reset();
+    system.SetCoresForTests(nullptr, nullptr);
+    system.kernel.reset();
+    CoreTiming::Shutdown();
+}
@@ -0,0 +1,174 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "network/network.h"
+
+namespace Network {
+
+namespace {
+
+constexpr u16 BasePort = 24880;
+
+void JoinRoom(RoomMember& member, const std::string& nickname, u16 port) {
+    member.Join(nickname, "127.0.0.1", port);
+    for (int i = 0; i < 500 && member.GetState() == RoomMember::State::Joining; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(member.GetState() == RoomMember::State::Joined);
+}
+
+WifiPacket MakeFrame(WifiPacket::PacketType type, const MacAddress& transmitter,
+                     const MacAddress& destination) {
+    WifiPacket packet{};
+    packet.type = type;
+    packet.channel = 1;
+    packet.transmitter_address = transmitter;
+    packet.destination_address = destination;
+    packet.data = std::vector<u8>(64, 0xAB);
+    return packet;
+}
+
+/// Waits until the count stops changing for a while, returning when it last changed
+std::chrono::steady_clock::time_point WaitForCount(const std::atomic<u64>& count, u64 expected,
+                                                   std::chrono::milliseconds patience) {
+    using Clock = std::chrono::steady_clock;
+    u64 last_count = count;
+    auto last_change = Clock::now();
+    while (last_count != expected && Clock::now() - last_change < patience) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (count != last_count) {
+            last_count = count;
+            last_change = Clock::now();
+        }
+    }
+    return last_change;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RoomPool services many rooms", "[network]") {
+    constexpr int NumRooms = 3;
+    REQUIRE(Init());
+    RoomPool pool(2);
+
+    std::vector<std::unique_ptr<Room>> rooms;
+    std::vector<std::unique_ptr<RoomMember>> members;
+    std::vector<std::atomic<u64>> received(2 * NumRooms);
+    std::vector<RoomMember::CallbackHandle<WifiPacket>> handles;
+    for (int i = 0; i < NumRooms; ++i) {
+        const u16 port = BasePort + i;
+        rooms.push_back(std::make_unique<Room>());
+        REQUIRE(rooms.back()->Create("Room " + std::to_string(i), "127.0.0.1", port, "", 16, "",
+                                     0, &pool));
+        for (int j = 0; j < 2; ++j) {
+            members.push_back(std::make_unique<RoomMember>());
+            JoinRoom(*members.back(), "member" + std::to_string(j), port);
+            std::atomic<u64>& count = received[members.size() - 1];
+            handles.push_back(members.back()->BindOnWifiPacketReceived(
+                [&count](const WifiPacket&) { ++count; }));
+        }
+    }
+
+    // Frames only reach the members of the same room, by broadcast or by MAC address
+    RoomMember& sender = *members[0];
+    RoomMember& receiver = *members[1];
+    sender.SendWifiPacket(MakeFrame(WifiPacket::PacketType::Authentication,
+                                    sender.GetMacAddress(), BroadcastMac));
+    sender.SendWifiPacket(MakeFrame(WifiPacket::PacketType::Authentication,
+                                    sender.GetMacAddress(), receiver.GetMacAddress()));
+    WaitForCount(received[1], 2, std::chrono::seconds(5));
+    REQUIRE(received[1] == 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (std::size_t i = 0; i < received.size(); ++i) {
+        CHECK(received[i] == (i == 1 ? 2 : 0));
+    }
+
+    // Members which leave are removed from the room
+    receiver.Leave();
+    for (int i = 0; i < 500 && rooms[0]->GetRoomMemberList().size() != 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(rooms[0]->GetRoomMemberList().size() == 1);
+    CHECK(rooms[1]->GetRoomMemberList().size() == 2);
+
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        members[i]->Unbind(handles[i]);
+        if (members[i]->IsConnected()) {
+            members[i]->Leave();
+        }
+    }
+    for (const auto& room : rooms) {
+        room->Destroy();
+    }
+    Shutdown();
+}
+
+TEST_CASE("Room load from many members", "[network][.benchmark]") {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    constexpr int NumRooms = 8;
+    constexpr int MembersPerRoom = 32;
+    constexpr int FramesPerMember = 50;
+    constexpr u64 ExpectedFrames =
+        u64(NumRooms) * MembersPerRoom * FramesPerMember * (MembersPerRoom - 1);
+
+    REQUIRE(Init());
+
+    // Every member of every room broadcasts data frames, like a game looking for others
+    const auto run = [&](const char* name, RoomPool* pool, u16 base_port) {
+        std::vector<std::unique_ptr<Room>> rooms;
+        std::vector<std::unique_ptr<RoomMember>> members;
+        std::vector<RoomMember::CallbackHandle<WifiPacket>> handles;
+        std::atomic<u64> received{0};
+        for (int i = 0; i < NumRooms; ++i) {
+            const u16 port = base_port + i;
+            rooms.push_back(std::make_unique<Room>());
+            REQUIRE(rooms.back()->Create("Load " + std::to_string(i), "127.0.0.1", port, "",
+                                         MembersPerRoom, "", 0, pool));
+            for (int j = 0; j < MembersPerRoom; ++j) {
+                members.push_back(std::make_unique<RoomMember>());
+                JoinRoom(*members.back(), "member" + std::to_string(j), port);
+                handles.push_back(members.back()->BindOnWifiPacketReceived(
+                    [&received](const WifiPacket&) { ++received; }));
+            }
+        }
+
+        const auto start = Clock::now();
+        for (int frame = 0; frame < FramesPerMember; ++frame) {
+            for (const auto& member : members) {
+                member->SendWifiPacket(MakeFrame(WifiPacket::PacketType::Data,
+                                                 member->GetMacAddress(), BroadcastMac));
+            }
+        }
+        const auto end = WaitForCount(received, ExpectedFrames, std::chrono::seconds(1));
+
+        const double ms = Ms(end - start).count();
+        WARN(name << ": " << received << " of " << ExpectedFrames << " frames delivered to "
+                  << members.size() << " members in " << ms << " ms, "
+                  << received * 1000 / ms << " frames/s");
+
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            members[i]->Unbind(handles[i]);
+            members[i]->Leave();
+        }
+        for (const auto& room : rooms) {
+            room->Destroy();
+        }
+    };
+
+    run("One thread per room", nullptr, BasePort);
+    RoomPool pool;
+    run("Pool of threads", &pool, BasePort + NumRooms);
+
+    Shutdown();
+}
+
+} // namespace Network
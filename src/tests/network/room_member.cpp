@@ -0,0 +1,177 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "network/network.h"
+
+namespace Network {
+
+namespace {
+
+constexpr u16 TestPort = 24873;
+
+/// Collects the frames a member receives, which arrive on its loop thread
+class FrameQueue {
+public:
+    void Push(const WifiPacket& packet) {
+        std::lock_guard<std::mutex> lock(mutex);
+        frames.push_back(packet);
+        cv.notify_all();
+    }
+
+    std::optional<WifiPacket> Pop(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cv.wait_for(lock, timeout, [this] { return !frames.empty(); })) {
+            return {};
+        }
+        WifiPacket packet = std::move(frames.front());
+        frames.pop_front();
+        return packet;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<WifiPacket> frames;
+};
+
+/// A room on the loopback interface, with two members in it
+class TestRoom {
+public:
+    TestRoom() {
+        REQUIRE(Init());
+        REQUIRE(room.Create("Test", "127.0.0.1", TestPort));
+        Join(first, "first");
+        Join(second, "second");
+    }
+
+    ~TestRoom() {
+        first.Leave();
+        second.Leave();
+        room.Destroy();
+        Shutdown();
+    }
+
+    Room room;
+    RoomMember first;
+    RoomMember second;
+
+private:
+    static void Join(RoomMember& member, const std::string& nickname) {
+        member.Join(nickname, "127.0.0.1", TestPort);
+        for (int i = 0; i < 500 && member.GetState() == RoomMember::State::Joining; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(member.GetState() == RoomMember::State::Joined);
+    }
+};
+
+WifiPacket MakeFrame(WifiPacket::PacketType type, const MacAddress& transmitter,
+                     const MacAddress& destination, u8 value) {
+    WifiPacket packet{};
+    packet.type = type;
+    packet.channel = 1;
+    packet.transmitter_address = transmitter;
+    packet.destination_address = destination;
+    packet.data = std::vector<u8>(64, value);
+    return packet;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RoomMember relays WiFi frames through the room", "[network]") {
+    FrameQueue received;
+    TestRoom test;
+    auto handle = test.second.BindOnWifiPacketReceived(
+        [&received](const WifiPacket& packet) { received.Push(packet); });
+
+    const MacAddress& transmitter = test.first.GetMacAddress();
+    const MacAddress& destination = test.second.GetMacAddress();
+    const std::vector<WifiPacket> frames{
+        // Sent unreliably
+        MakeFrame(WifiPacket::PacketType::Beacon, transmitter, BroadcastMac, 1),
+        MakeFrame(WifiPacket::PacketType::Data, transmitter, destination, 2),
+        // Sent reliably
+        MakeFrame(WifiPacket::PacketType::Authentication, transmitter, destination, 3),
+    };
+    for (const WifiPacket& frame : frames) {
+        test.first.SendWifiPacket(frame);
+    }
+
+    // The channels are ordered separately, so the frames may arrive in any order
+    std::vector<u8> values;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const auto packet = received.Pop(std::chrono::seconds(5));
+        REQUIRE(packet);
+        const WifiPacket& frame = frames.at(packet->data[0] - 1);
+        CHECK(packet->type == frame.type);
+        CHECK(packet->channel == frame.channel);
+        CHECK(packet->transmitter_address == frame.transmitter_address);
+        CHECK(packet->destination_address == frame.destination_address);
+        CHECK(packet->data == frame.data);
+        values.push_back(packet->data[0]);
+    }
+    std::sort(values.begin(), values.end());
+    CHECK(values == std::vector<u8>{1, 2, 3});
+
+    test.second.Unbind(handle);
+}
+
+TEST_CASE("RoomMember round trip over loopback", "[network][.benchmark]") {
+    using Clock = std::chrono::steady_clock;
+    using Us = std::chrono::duration<double, std::micro>;
+    constexpr int NumFrames = 200;
+
+    FrameQueue received;
+    TestRoom test;
+    // The second member echoes every frame back to the first one
+    auto echo = test.second.BindOnWifiPacketReceived([&test](const WifiPacket& packet) {
+        WifiPacket reply = packet;
+        std::swap(reply.transmitter_address, reply.destination_address);
+        test.second.SendWifiPacket(reply);
+    });
+    auto handle = test.first.BindOnWifiPacketReceived(
+        [&received](const WifiPacket& packet) { received.Push(packet); });
+
+    const auto measure = [&](WifiPacket::PacketType type) {
+        std::vector<double> latencies;
+        int lost = 0;
+        for (int i = 0; i < NumFrames; ++i) {
+            const auto start = Clock::now();
+            test.first.SendWifiPacket(MakeFrame(type, test.first.GetMacAddress(),
+                                                test.second.GetMacAddress(), u8(i)));
+            // Unreliable frames may be dropped, and echoes arriving late are skipped
+            std::optional<WifiPacket> packet;
+            do {
+                packet = received.Pop(std::chrono::milliseconds(100));
+            } while (packet && packet->data[0] != u8(i));
+            if (packet) {
+                latencies.push_back(Us(Clock::now() - start).count());
+            } else {
+                ++lost;
+            }
+        }
+        std::sort(latencies.begin(), latencies.end());
+        const double median = latencies.empty() ? 0 : latencies[latencies.size() / 2];
+        const double worst = latencies.empty() ? 0 : latencies.back();
+        WARN("Round trip of " << (type == WifiPacket::PacketType::Data ? "data" : "management")
+                              << " frames: " << median << " us median, " << worst
+                              << " us worst, " << lost << " lost");
+    };
+    measure(WifiPacket::PacketType::Data);
+    measure(WifiPacket::PacketType::Authentication);
+
+    test.first.Unbind(handle);
+    test.second.Unbind(echo);
+}
+
+} // namespace Network
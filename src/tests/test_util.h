@@ -0,0 +1,95 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+/// Helpers shared by the tests
+namespace Test {
+
+/// Returns a buffer of size random bytes
+inline std::vector<u8> RandomBytes(std::size_t size, std::mt19937& rng) {
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(rng());
+    }
+    return bytes;
+}
+
+/**
+ * Runs func num_runs times, for the hidden benchmarks.
+ * @returns the average time of a run, in units of Duration
+ */
+template <typename Duration = std::chrono::duration<double, std::milli>, typename Func>
+double TimePerRun(int num_runs, Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < num_runs; ++run) {
+        func();
+    }
+    return Duration(std::chrono::steady_clock::now() - start).count() / num_runs;
+}
+
+/// A directory for the files of a test, deleted with its contents when the test ends
+class TemporaryDirectory {
+public:
+    /// Creates the directory at path, which ends with a separator
+    explicit TemporaryDirectory(std::string path) : path(std::move(path)) {
+        FileUtil::CreateFullPath(this->path);
+    }
+    ~TemporaryDirectory() {
+        FileUtil::DeleteDirRecursively(path);
+    }
+
+    TemporaryDirectory(const TemporaryDirectory&) = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    const std::string& GetPath() const {
+        return path;
+    }
+
+private:
+    std::string path;
+};
+
+/// Points a user path to a temporary directory, and restores the previous path when destroyed
+class ScopedUserPath {
+public:
+    ScopedUserPath(FileUtil::UserPath user_path, std::string path)
+        : user_path(user_path), original_path(FileUtil::GetUserPath(user_path)),
+          directory(std::move(path)) {
+        FileUtil::GetUserPath(user_path, directory.GetPath());
+    }
+    ~ScopedUserPath() {
+        // GetUserPath only accepts existing directories, so a missing one is created to restore it
+        const bool created = !FileUtil::IsDirectory(original_path);
+        if (created) {
+            FileUtil::CreateFullPath(original_path);
+        }
+        FileUtil::GetUserPath(user_path, original_path);
+        if (created) {
+            FileUtil::DeleteDir(original_path);
+        }
+    }
+
+    ScopedUserPath(const ScopedUserPath&) = delete;
+    ScopedUserPath& operator=(const ScopedUserPath&) = delete;
+
+    const std::string& GetPath() const {
+        return directory.GetPath();
+    }
+
+private:
+    FileUtil::UserPath user_path;
+    std::string original_path;
+    TemporaryDirectory directory;
+};
+
+} // namespace Test
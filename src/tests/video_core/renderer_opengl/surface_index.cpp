@@ -0,0 +1,192 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-local-typedefs"
+#endif
+#include <boost/icl/interval_map.hpp>
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+#include <catch2/catch.hpp>
+#include "tests/test_util.h"
+#include "video_core/renderer_opengl/gl_surface_index.h"
+
+namespace {
+
+struct FakeSurface {
+    PAddr addr;
+    PAddr end;
+};
+using FakeSurfacePtr = std::shared_ptr<FakeSurface>;
+
+constexpr PAddr VRAM_BASE = 0x18000000;
+constexpr u32 VRAM_SIZE = 0x00600000;
+
+/// Generates surfaces of framebuffer and texture sizes in VRAM, like the ones games use
+class SurfaceChurn {
+public:
+    explicit SurfaceChurn(u32 seed) : rng(seed) {}
+
+    FakeSurfacePtr MakeSurface() {
+        static constexpr std::array<u32, 6> sizes{{
+            0x800, 0x2000, 0x8000, 0x20000, 240 * 400 * 3, 240 * 400 * 4,
+        }};
+        const u32 size = sizes[std::uniform_int_distribution<std::size_t>(0, 5)(rng)];
+        const PAddr addr =
+            VRAM_BASE + std::uniform_int_distribution<u32>(0, (VRAM_SIZE - size) / 0x100)(rng) *
+                            0x100;
+        return std::make_shared<FakeSurface>(FakeSurface{addr, addr + size});
+    }
+
+    std::size_t Pick(std::size_t count) {
+        return std::uniform_int_distribution<std::size_t>(0, count - 1)(rng);
+    }
+
+private:
+    std::mt19937 rng;
+};
+
+using IntervalCache = boost::icl::interval_map<PAddr, std::set<FakeSurfacePtr>>;
+
+} // Anonymous namespace
+
+TEST_CASE("SurfaceIndex finds the overlapping surfaces", "[video_core][renderer_opengl]") {
+    SurfaceIndex<FakeSurfacePtr> index;
+    std::vector<FakeSurfacePtr> surfaces;
+    std::vector<int> page_counts(VRAM_SIZE >> Memory::PAGE_BITS);
+    std::vector<bool> pages_used(page_counts.size());
+    SurfaceChurn churn(1234);
+
+    const auto update_pages = [&](const FakeSurfacePtr& surface, int delta) {
+        for (PAddr page = surface->addr >> Memory::PAGE_BITS;
+             page <= (surface->end - 1) >> Memory::PAGE_BITS; ++page) {
+            page_counts[page - (VRAM_BASE >> Memory::PAGE_BITS)] += delta;
+        }
+    };
+    const auto mark_pages = [&](bool used) {
+        return [&pages_used, used](PAddr addr, u32 size) {
+            REQUIRE(size % Memory::PAGE_SIZE == 0);
+            for (u32 offset = 0; offset < size; offset += Memory::PAGE_SIZE) {
+                const std::size_t page = (addr - VRAM_BASE + offset) >> Memory::PAGE_BITS;
+                CHECK(pages_used[page] != used);
+                pages_used[page] = used;
+            }
+        };
+    };
+
+    for (int i = 0; i < 2000; ++i) {
+        if (surfaces.size() < 64 || churn.Pick(2) == 0) {
+            const auto surface = churn.MakeSurface();
+            index.Insert(surface->addr, surface->end, surface, mark_pages(true));
+            update_pages(surface, 1);
+            surfaces.push_back(surface);
+        } else {
+            const std::size_t victim = churn.Pick(surfaces.size());
+            const auto surface = surfaces[victim];
+            index.Erase(surface->addr, surface->end, surface, mark_pages(false));
+            update_pages(surface, -1);
+            surfaces.erase(surfaces.begin() + victim);
+        }
+        REQUIRE(index.Size() == surfaces.size());
+
+        std::vector<bool> expected_pages_used(page_counts.size());
+        std::transform(page_counts.begin(), page_counts.end(), expected_pages_used.begin(),
+                       [](int count) { return count != 0; });
+        REQUIRE(pages_used == expected_pages_used);
+
+        const auto query = churn.MakeSurface();
+        std::vector<FakeSurfacePtr> expected;
+        for (const auto& surface : surfaces) {
+            if (surface->addr < query->end && surface->end > query->addr)
+                expected.push_back(surface);
+        }
+        std::vector<FakeSurfacePtr> found;
+        index.ForEach(query->addr, query->end,
+                      [&](const FakeSurfacePtr& surface) { found.push_back(surface); });
+
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        REQUIRE(found == expected);
+    }
+}
+
+TEST_CASE("SurfaceIndex versus interval_map under surface churn",
+          "[video_core][renderer_opengl][.benchmark]") {
+    using Ns = std::chrono::duration<double, std::nano>;
+    constexpr int NUM_ITERATIONS = 200000;
+    constexpr std::size_t NUM_SURFACES = 512;
+    constexpr int LOOKUPS_PER_CHURN = 16;
+
+    const auto run = [&](auto insert, auto erase, auto lookup) {
+        SurfaceChurn churn(42);
+        std::vector<FakeSurfacePtr> surfaces;
+        while (surfaces.size() < NUM_SURFACES) {
+            surfaces.push_back(churn.MakeSurface());
+            insert(surfaces.back());
+        }
+
+        std::size_t num_found = 0;
+        int i = 0;
+        const double time = Test::TimePerRun<Ns>(NUM_ITERATIONS, [&] {
+            if (i++ % LOOKUPS_PER_CHURN == 0) {
+                const std::size_t victim = churn.Pick(surfaces.size());
+                erase(surfaces[victim]);
+                surfaces[victim] = churn.MakeSurface();
+                insert(surfaces[victim]);
+            }
+            num_found += lookup(*surfaces[churn.Pick(surfaces.size())]);
+        });
+        return std::make_pair(time, num_found);
+    };
+
+    IntervalCache interval_cache;
+    const auto interval_result = run(
+        [&](const FakeSurfacePtr& surface) {
+            interval_cache.add(
+                {IntervalCache::interval_type::right_open(surface->addr, surface->end),
+                 std::set<FakeSurfacePtr>{surface}});
+        },
+        [&](const FakeSurfacePtr& surface) {
+            interval_cache.subtract(
+                {IntervalCache::interval_type::right_open(surface->addr, surface->end),
+                 std::set<FakeSurfacePtr>{surface}});
+        },
+        [&](const FakeSurface& query) {
+            std::size_t count = 0;
+            const auto range = interval_cache.equal_range(
+                IntervalCache::interval_type::right_open(query.addr, query.end));
+            for (auto it = range.first; it != range.second; ++it)
+                count += it->second.size();
+            return count;
+        });
+
+    SurfaceIndex<FakeSurfacePtr> index;
+    const auto index_result = run(
+        [&](const FakeSurfacePtr& surface) {
+            index.Insert(surface->addr, surface->end, surface, [](PAddr, u32) {});
+        },
+        [&](const FakeSurfacePtr& surface) {
+            index.Erase(surface->addr, surface->end, surface, [](PAddr, u32) {});
+        },
+        [&](const FakeSurface& query) {
+            std::size_t count = 0;
+            index.ForEach(query.addr, query.end, [&](const FakeSurfacePtr&) { ++count; });
+            return count;
+        });
+
+    // interval_map visits a surface once per segment it is split into, so only the index result
+    // is an exact count
+    REQUIRE(index_result.second <= interval_result.second);
+    WARN("interval_map: " << interval_result.first << " ns, SurfaceIndex: " << index_result.first
+                          << " ns per lookup");
+}
@@ -0,0 +1,102 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <catch2/catch.hpp>
+#include "video_core/swrasterizer/framebuffer.h"
+#include "video_core/swrasterizer/texturing.h"
+
+using namespace Pica;
+using namespace Pica::Rasterizer;
+
+using Operation = TexturingRegs::TevStageConfig::Operation;
+using ColorModifier = TexturingRegs::TevStageConfig::ColorModifier;
+
+static Math::Vec4<u8> RandomColor(std::mt19937& rng) {
+    std::uniform_int_distribution<int> component(0, 255);
+    return Math::MakeVec(component(rng), component(rng), component(rng), component(rng))
+        .Cast<u8>();
+}
+
+template <typename T>
+static bool Equal(const T& a, const T& b) {
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+TEST_CASE("Specialized combiner functions match the generic ones", "[video_core][swrasterizer]") {
+    std::mt19937 rng(42);
+    const std::array<Operation, 10> ops{{
+        Operation::Replace, Operation::Modulate, Operation::Add, Operation::AddSigned,
+        Operation::Lerp, Operation::Subtract, Operation::Dot3_RGB, Operation::Dot3_RGBA,
+        Operation::MultiplyThenAdd, Operation::AddThenMultiply,
+    }};
+    const std::array<ColorModifier, 10> modifiers{{
+        ColorModifier::SourceColor, ColorModifier::OneMinusSourceColor, ColorModifier::SourceAlpha,
+        ColorModifier::OneMinusSourceAlpha, ColorModifier::SourceRed,
+        ColorModifier::OneMinusSourceRed, ColorModifier::SourceGreen,
+        ColorModifier::OneMinusSourceGreen, ColorModifier::SourceBlue,
+        ColorModifier::OneMinusSourceBlue,
+    }};
+
+    for (int i = 0; i < 1000; ++i) {
+        const Math::Vec4<u8> color = RandomColor(rng);
+        for (const auto modifier : modifiers) {
+            REQUIRE(Equal(GetColorModifierFunction(modifier)(color),
+                          GetColorModifier(modifier, color)));
+        }
+
+        const Math::Vec3<u8> input[3] = {RandomColor(rng).rgb(), RandomColor(rng).rgb(),
+                                         RandomColor(rng).rgb()};
+        const std::array<u8, 3> alpha_input{{input[0].r(), input[1].g(), input[2].b()}};
+        for (const auto op : ops) {
+            REQUIRE(Equal(GetColorCombineFunction(op)(input), ColorCombine(op, input)));
+            if (op != Operation::Dot3_RGB && op != Operation::Dot3_RGBA) {
+                REQUIRE(GetAlphaCombineFunction(op)(alpha_input) == AlphaCombine(op, alpha_input));
+            }
+        }
+    }
+}
+
+TEST_CASE("Specialized output merger functions match the generic ones",
+          "[video_core][swrasterizer]") {
+    std::mt19937 rng(42);
+
+    for (int i = 0; i < 1000; ++i) {
+        const Math::Vec4<u8> src = RandomColor(rng);
+        const Math::Vec4<u8> dest = RandomColor(rng);
+        const Math::Vec4<u8> blend_const = RandomColor(rng);
+
+        for (u32 func = 0; func < 8; ++func) {
+            const auto compare_func = static_cast<FramebufferRegs::CompareFunc>(func);
+            REQUIRE(GetCompareFunction(compare_func)(src.r(), dest.r()) ==
+                    Compare(compare_func, src.r(), dest.r()));
+
+            const auto action = static_cast<FramebufferRegs::StencilAction>(func);
+            REQUIRE(GetStencilActionFunction(action)(src.r(), dest.r()) ==
+                    PerformStencilAction(action, src.r(), dest.r()));
+        }
+
+        for (u32 factor = 0; factor <= 14; ++factor) {
+            const auto blend_factor = static_cast<FramebufferRegs::BlendFactor>(factor);
+            for (unsigned channel = 0; channel < 4; ++channel) {
+                REQUIRE(GetBlendFactorFunction(blend_factor)(channel, src, dest, blend_const) ==
+                        LookupBlendFactor(blend_factor, channel, src, dest, blend_const));
+            }
+        }
+
+        for (u32 equation = 0; equation <= 4; ++equation) {
+            const auto blend_equation = static_cast<FramebufferRegs::BlendEquation>(equation);
+            REQUIRE(Equal(
+                GetBlendEquationFunction(blend_equation)(src, blend_const, dest, blend_const),
+                EvaluateBlendEquation(src, blend_const, dest, blend_const, blend_equation)));
+        }
+
+        for (u32 op = 0; op < 16; ++op) {
+            const auto logic_op = static_cast<FramebufferRegs::LogicOp>(op);
+            REQUIRE(GetLogicOpFunction(logic_op)(src.r(), dest.r()) ==
+                    LogicOp(src.r(), dest.r(), logic_op));
+        }
+    }
+}
@@ -0,0 +1,175 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <catch2/catch.hpp>
+#include "common/x64/cpu_detect.h"
+#include "video_core/pica_types.h"
+#include "video_core/swrasterizer/span.h"
+
+using namespace Pica::Rasterizer;
+
+static SpanSetup RandomSetup(std::mt19937& rng) {
+    std::uniform_int_distribution<s32> step(-0x10 * 400, 0x10 * 400);
+    std::uniform_real_distribution<float> z(-0.5f, 1.5f);
+    std::uniform_real_distribution<float> scale(-1.0f, 1.0f);
+
+    SpanSetup setup;
+    setup.w_step = {{step(rng), step(rng), step(rng)}};
+    setup.screen_z = {{z(rng), z(rng), z(rng)}};
+    setup.depth_scale = scale(rng);
+    setup.depth_offset = scale(rng);
+    setup.depth_max = static_cast<float>((1 << 24) - 1);
+    setup.w_buffer = false;
+    return setup;
+}
+
+static void CompareWithScalar(const SpanKernel& kernel) {
+    const SpanKernel& scalar = GetScalarSpanKernel();
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<s32> edge(-0x10 * 0x10 * 400, 0x10 * 0x10 * 400);
+
+    for (int iteration = 0; iteration < 100000; ++iteration) {
+        const SpanSetup setup = RandomSetup(rng);
+        const std::array<s32, 3> w{{edge(rng), edge(rng), edge(rng)}};
+        const unsigned num_pixels = 1 + iteration % kernel.width;
+
+        SpanResult expected;
+        SpanResult result;
+        const u32 expected_coverage = scalar.function(setup, w, num_pixels, expected);
+        const u32 coverage = kernel.function(setup, w, num_pixels, result);
+        REQUIRE(coverage == expected_coverage);
+
+        for (unsigned i = 0; i < num_pixels; ++i) {
+            for (unsigned j = 0; j < 3; ++j) {
+                REQUIRE(result.w[j][i] == expected.w[j][i]);
+            }
+            if (coverage & (1u << i)) {
+                // Compare the bit patterns, the depth has to be exactly the same
+                REQUIRE(std::memcmp(&result.depth[i], &expected.depth[i], sizeof(float)) == 0);
+                REQUIRE(result.z[i] == expected.z[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Span kernels fully cover the inside of a triangle", "[video_core][swrasterizer]") {
+    SpanSetup setup{};
+    setup.depth_scale = 1.0f;
+    setup.depth_max = static_cast<float>((1 << 16) - 1);
+    setup.screen_z = {{0.5f, 0.5f, 0.5f}};
+
+    SpanResult result;
+    const SpanKernel& scalar = GetScalarSpanKernel();
+    REQUIRE(scalar.function(setup, {{1, 1, 1}}, 5, result) == 0x1F);
+    REQUIRE(scalar.function(setup, {{1, -1, 1}}, 5, result) == 0);
+    REQUIRE(result.w[1][4] == -1);
+
+    setup.w_step = {{0, 0x10, -0x10}};
+    REQUIRE(scalar.function(setup, {{0, 0, 0x30}}, 8, result) == 0xF);
+    REQUIRE(result.depth[0] == 0.5f);
+    REQUIRE(result.z[3] == static_cast<u32>(0.5f * setup.depth_max));
+}
+
+TEST_CASE("SSE4.1 span kernel matches the scalar kernel", "[video_core][swrasterizer]") {
+    if (!Common::GetCPUCaps().sse4_1) {
+        WARN("SSE4.1 is not supported by the host CPU, skipping");
+        return;
+    }
+    CompareWithScalar(GetSSE41SpanKernel());
+}
+
+TEST_CASE("AVX2 span kernel matches the scalar kernel", "[video_core][swrasterizer]") {
+    if (!Common::GetCPUCaps().avx2) {
+        WARN("AVX2 is not supported by the host CPU, skipping");
+        return;
+    }
+    CompareWithScalar(GetAVX2SpanKernel());
+}
+
+/// Random attribute values, including the infinities, zeros and NaNs of degenerate triangles
+static float RandomAttribute(std::mt19937& rng) {
+    std::uniform_real_distribution<float> value(-4.0f, 4.0f);
+    switch (rng() % 16) {
+    case 0:
+        return std::numeric_limits<float>::infinity();
+    case 1:
+        return -std::numeric_limits<float>::infinity();
+    case 2:
+        return 0.0f;
+    case 3:
+        return std::numeric_limits<float>::quiet_NaN();
+    default:
+        return value(rng);
+    }
+}
+
+static void CompareWithScalar(AttributeFunction kernel) {
+    const AttributeFunction scalar = GetScalarAttributeKernel();
+    std::mt19937 rng(5678);
+    std::uniform_int_distribution<s32> edge(0, 0x10 * 0x10 * 400);
+
+    for (int iteration = 0; iteration < 100000; ++iteration) {
+        AttributeSetup setup;
+        for (auto& values : setup.values)
+            for (float& value : values)
+                value = RandomAttribute(rng);
+        const std::array<float, 3> baricentric_coordinates{{static_cast<float>(edge(rng)),
+                                                            static_cast<float>(edge(rng)),
+                                                            static_cast<float>(edge(rng))}};
+        const float w = iteration % 8 == 0 ? RandomAttribute(rng) : 1.0f / edge(rng);
+
+        AttributeValues expected;
+        AttributeValues result;
+        scalar(setup, baricentric_coordinates, w, expected);
+        kernel(setup, baricentric_coordinates, w, result);
+        // Compare the bit patterns, the attributes have to be exactly the same. Only the sign and
+        // payload of NaNs may differ, as they depend on the order of the operands.
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            if (!std::isnan(expected[i]) || !std::isnan(result[i])) {
+                REQUIRE(std::memcmp(&result[i], &expected[i], sizeof(float)) == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("Attribute kernels interpolate like float24", "[video_core][swrasterizer]") {
+    AttributeSetup setup{};
+    setup.values[0][0] = 1.0f;
+    setup.values[1][0] = 2.0f;
+    setup.values[2][0] = 4.0f;
+    setup.values[0][1] = std::numeric_limits<float>::infinity();
+    setup.values[0][2] = std::numeric_limits<float>::quiet_NaN();
+
+    AttributeValues result;
+    GetScalarAttributeKernel()(setup, {{0.0f, 1.0f, 3.0f}}, 0.5f, result);
+    REQUIRE(result[0] == 7.0f);
+    // Infinity times zero is zero, like Pica::float24, but NaNs stay NaNs
+    const float expected = (Pica::float24::FromFloat32(std::numeric_limits<float>::infinity()) *
+                            Pica::float24::FromFloat32(0.0f))
+                               .ToFloat32();
+    REQUIRE(expected == 0.0f);
+    REQUIRE(result[1] == expected);
+    REQUIRE(result[2] != result[2]);
+    REQUIRE(result[3] == 0.0f);
+}
+
+TEST_CASE("SSE4.1 attribute kernel matches the scalar kernel", "[video_core][swrasterizer]") {
+    if (!Common::GetCPUCaps().sse4_1) {
+        WARN("SSE4.1 is not supported by the host CPU, skipping");
+        return;
+    }
+    CompareWithScalar(GetSSE41AttributeKernel());
+}
+
+TEST_CASE("AVX2 attribute kernel matches the scalar kernel", "[video_core][swrasterizer]") {
+    if (!Common::GetCPUCaps().avx2) {
+        WARN("AVX2 is not supported by the host CPU, skipping");
+        return;
+    }
+    CompareWithScalar(GetAVX2AttributeKernel());
+}
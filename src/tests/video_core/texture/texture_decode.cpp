@@ -0,0 +1,134 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/texture/texture_decode.h"
+#include "video_core/utils.h"
+
+using namespace Pica;
+using TextureFormat = TexturingRegs::TextureFormat;
+
+static void CheckDecodedTile(const u8* tile, const Texture::TextureInfo& info, bool disable_alpha) {
+    std::array<Math::Vec4<u8>, 8 * 8> texels;
+    Texture::DecodeTile(tile, info, texels.data(), disable_alpha);
+
+    for (unsigned int y = 0; y < 8; ++y) {
+        for (unsigned int x = 0; x < 8; ++x) {
+            const auto expected = Texture::LookupTexelInTile(tile, x, y, info, disable_alpha);
+            const auto& texel = texels[y * 8 + x];
+            if (std::memcmp(&texel, &expected, sizeof(texel)) != 0) {
+                FAIL("Mismatch for format " << static_cast<u32>(info.format) << " at (" << x
+                                            << ", " << y << ")");
+            }
+        }
+    }
+}
+
+static void CheckDecodedTiles(TextureFormat format, const std::vector<u8>& data) {
+    Texture::TextureInfo info{};
+    info.format = format;
+    const std::size_t tile_size = Texture::CalculateTileSize(format);
+    REQUIRE(data.size() % tile_size == 0);
+
+    for (std::size_t offset = 0; offset < data.size(); offset += tile_size) {
+        CheckDecodedTile(&data[offset], info, false);
+        CheckDecodedTile(&data[offset], info, true);
+    }
+}
+
+TEST_CASE("DecodeTile matches LookupTexelInTile for all texel values", "[video_core][texture]") {
+    // Tiles covering every possible encoding of a texel, or of a channel for RGBA8 and RGB8
+    const std::array<std::pair<TextureFormat, std::size_t>, 12> formats{{
+        {TextureFormat::RGB5A1, 2},
+        {TextureFormat::RGB565, 2},
+        {TextureFormat::RGBA4, 2},
+        {TextureFormat::IA8, 2},
+        {TextureFormat::RG8, 2},
+        {TextureFormat::I8, 1},
+        {TextureFormat::A8, 1},
+        {TextureFormat::IA4, 1},
+        {TextureFormat::I4, 1},
+        {TextureFormat::A4, 1},
+        {TextureFormat::RGBA8, 1},
+        {TextureFormat::RGB8, 1},
+    }};
+
+    for (const auto& [format, value_bytes] : formats) {
+        const u32 num_values = 1u << (8 * value_bytes);
+        std::vector<u8> data;
+        for (u32 value = 0; value < num_values; ++value) {
+            data.push_back(static_cast<u8>(value));
+            if (value_bytes == 2)
+                data.push_back(static_cast<u8>(value >> 8));
+        }
+        data.resize(data.size() - data.size() % Texture::CalculateTileSize(format));
+        CheckDecodedTiles(format, data);
+    }
+}
+
+TEST_CASE("DecodeTile matches LookupTexelInTile for random tiles", "[video_core][texture]") {
+    const std::array<TextureFormat, 14> formats{{
+        TextureFormat::RGBA8,
+        TextureFormat::RGB8,
+        TextureFormat::RGB5A1,
+        TextureFormat::RGB565,
+        TextureFormat::RGBA4,
+        TextureFormat::IA8,
+        TextureFormat::RG8,
+        TextureFormat::I8,
+        TextureFormat::A8,
+        TextureFormat::IA4,
+        TextureFormat::I4,
+        TextureFormat::A4,
+        TextureFormat::ETC1,
+        TextureFormat::ETC1A4,
+    }};
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (const auto format : formats) {
+        std::vector<u8> data(Texture::CalculateTileSize(format) * 4096);
+        for (auto& value : data)
+            value = static_cast<u8>(byte(rng));
+        CheckDecodedTiles(format, data);
+    }
+}
+
+template <u32 bytes_per_pixel>
+static void CheckMortonCopyTile(std::ptrdiff_t linear_pitch) {
+    constexpr std::size_t tile_size = 8 * 8 * bytes_per_pixel;
+    const std::size_t row_size = std::abs(linear_pitch);
+
+    std::array<u8, tile_size> tile;
+    for (std::size_t i = 0; i < tile_size; ++i)
+        tile[i] = static_cast<u8>(i * 7 + 1);
+
+    std::vector<u8> linear(row_size * 8);
+    u8* const first_row = linear_pitch < 0 ? &linear[row_size * 7] : &linear[0];
+    VideoCore::MortonCopyTile<true, bytes_per_pixel>(tile.data(), first_row, linear_pitch);
+
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            const u8* pixel = first_row + y * linear_pitch + x * bytes_per_pixel;
+            const u8* expected = &tile[VideoCore::GetMortonOffset(x, y, bytes_per_pixel)];
+            REQUIRE(std::memcmp(pixel, expected, bytes_per_pixel) == 0);
+        }
+    }
+
+    std::array<u8, tile_size> round_trip{};
+    VideoCore::MortonCopyTile<false, bytes_per_pixel>(round_trip.data(), first_row, linear_pitch);
+    REQUIRE(round_trip == tile);
+}
+
+TEST_CASE("MortonCopyTile", "[video_core][texture]") {
+    CheckMortonCopyTile<1>(8);
+    CheckMortonCopyTile<2>(-16);
+    CheckMortonCopyTile<3>(30);
+    CheckMortonCopyTile<4>(-40);
+}
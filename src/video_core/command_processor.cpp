@@ -2,13 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
@@ -119,6 +122,86 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
+/// Draws with fewer vertices than this are shaded on the emulation thread
+constexpr std::size_t MIN_PARALLEL_VERTICES = 128;
+/// Minimum number of vertices shaded by each worker of a parallel draw
+constexpr std::size_t MIN_VERTICES_PER_WORKER = 32;
+
+/**
+ * Shades the vertices of a non-accelerated draw on the shared thread pool, and submits them
+ * to the geometry pipeline in index order. Every vertex referenced by the draw is shaded exactly
+ * once, each worker using its own shader unit.
+ */
+static void ShadeAndSubmitVerticesParallel(Shader::ShaderEngine* shader_engine,
+                                           const VertexLoader& loader, u32 base_address,
+                                           bool is_indexed, bool index_u16,
+                                           const u8* index_address_8) {
+    const auto& regs = g_state.regs;
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+    const u32 num_vertices = regs.pipeline.num_vertices;
+
+    // These are only touched from the emulation thread, keep them around to avoid reallocating
+    static std::vector<u32> vertex_ids;
+    static std::vector<u32> slot_of_index;
+    static std::vector<u32> slot_of_vertex;
+    static std::vector<Shader::AttributeBuffer> vs_outputs;
+
+    vertex_ids.clear();
+    if (is_indexed) {
+        constexpr u32 INVALID_SLOT = 0xFFFFFFFF;
+        const auto get_vertex = [&](u32 index) -> u32 {
+            return index_u16 ? index_address_16[index] : index_address_8[index];
+        };
+
+        u32 max_vertex = 0;
+        for (u32 index = 0; index < num_vertices; ++index) {
+            max_vertex = std::max(max_vertex, get_vertex(index));
+        }
+
+        // Deduplicate the indices, keeping the vertices in the order of their first use
+        slot_of_vertex.assign(max_vertex + 1, INVALID_SLOT);
+        slot_of_index.resize(num_vertices);
+        for (u32 index = 0; index < num_vertices; ++index) {
+            const u32 vertex = get_vertex(index);
+            u32& slot = slot_of_vertex[vertex];
+            if (slot == INVALID_SLOT) {
+                slot = static_cast<u32>(vertex_ids.size());
+                vertex_ids.push_back(vertex);
+            }
+            slot_of_index[index] = slot;
+        }
+    } else {
+        // Indexed rendering doesn't use the start offset
+        vertex_ids.resize(num_vertices);
+        for (u32 index = 0; index < num_vertices; ++index) {
+            vertex_ids[index] = index + regs.pipeline.vertex_offset;
+        }
+    }
+
+    vs_outputs.resize(vertex_ids.size());
+    Common::ThreadPool::GetShared().ParallelFor(
+        vertex_ids.size(), MIN_VERTICES_PER_WORKER,
+        [&](std::size_t begin, std::size_t end, std::size_t) {
+            Shader::UnitState shader_unit;
+            Shader::AttributeBuffer input;
+            // Only used when recording, which is handled by the sequential path
+            DebugUtils::MemoryAccessTracker memory_accesses;
+
+            for (std::size_t slot = begin; slot < end; ++slot) {
+                loader.LoadVertex(base_address, static_cast<int>(slot), vertex_ids[slot], input,
+                                  memory_accesses);
+                shader_unit.LoadInput(regs.vs, input);
+                shader_engine->Run(g_state.vs, shader_unit);
+                shader_unit.WriteOutput(regs.vs, vs_outputs[slot]);
+            }
+        });
+
+    for (u32 index = 0; index < num_vertices; ++index) {
+        const u32 slot = is_indexed ? slot_of_index[index] : index;
+        g_state.geometry_pipeline.SubmitVertex(vs_outputs[slot]);
+    }
+}
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -149,7 +232,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        VideoCore::g_renderer->Rasterizer()->NotifyCommandListCompleted();
+        GPU::SignalInterrupt(Service::GSP::InterruptId::P3D);
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
@@ -369,58 +453,68 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         if (g_state.geometry_pipeline.NeedIndexInput())
             ASSERT(is_indexed);
 
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
+        // The debugger inspects each vertex shader invocation, which requires the sequential path
+        const bool shade_in_parallel = !g_debug_context &&
+                                       !g_state.geometry_pipeline.NeedIndexInput() &&
+                                       regs.pipeline.num_vertices >= MIN_PARALLEL_VERTICES &&
+                                       Common::ThreadPool::GetShared().GetNumThreads() > 0;
+        if (shade_in_parallel) {
+            ShadeAndSubmitVerticesParallel(shader_engine, loader, base_address, is_indexed,
+                                           index_u16, index_address_8);
+        } else {
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                // Indexed rendering doesn't use the start offset
+                unsigned int vertex =
+                    is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                               : (index + regs.pipeline.vertex_offset);
 
-            bool vertex_cache_hit = false;
+                bool vertex_cache_hit = false;
 
-            if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
-                    continue;
-                }
+                if (is_indexed) {
+                    if (g_state.geometry_pipeline.NeedIndexInput()) {
+                        g_state.geometry_pipeline.SubmitIndex(vertex);
+                        continue;
+                    }
 
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
-                }
+                    if (g_debug_context && Pica::g_debug_context->recorder) {
+                        int size = index_u16 ? 2 : 1;
+                        memory_accesses.AddAccess(base_address + index_info.offset + size * index,
+                                                  size);
+                    }
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
+                    for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
+                        if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
+                            vs_output = vertex_cache[i];
+                            vertex_cache_hit = true;
+                            break;
+                        }
                     }
                 }
-            }
 
-            if (!vertex_cache_hit) {
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+                if (!vertex_cache_hit) {
+                    // Initialize data for the current vertex
+                    Shader::AttributeBuffer input;
+                    loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
 
-                // Send to vertex shader
-                if (g_debug_context)
-                    g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                             (void*)&input);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
+                    // Send to vertex shader
+                    if (g_debug_context)
+                        g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                                 (void*)&input);
+                    shader_unit.LoadInput(regs.vs, input);
+                    shader_engine->Run(g_state.vs, shader_unit);
+                    shader_unit.WriteOutput(regs.vs, vs_output);
 
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                    if (is_indexed) {
+                        vertex_cache[vertex_cache_pos] = vs_output;
+                        vertex_cache_valid[vertex_cache_pos] = true;
+                        vertex_cache_ids[vertex_cache_pos] = vertex;
+                        vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                    }
                 }
-            }
 
-            // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
+                // Send to geometry pipeline
+                g_state.geometry_pipeline.SubmitVertex(vs_output);
+            }
         }
 
         for (auto& range : memory_accesses.ranges) {
@@ -0,0 +1,63 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/gpu_thread.h"
+
+MICROPROFILE_DEFINE(GPU_WaitIdle, "GPU", "Wait for the GPU thread", MP_RGB(128, 128, 192));
+
+namespace VideoCore {
+
+GPUThread::GPUThread(EmuWindow& emu_window)
+    : emu_window(emu_window), thread(&GPUThread::ThreadLoop, this) {}
+
+GPUThread::~GPUThread() {
+    Push(nullptr);
+    thread.join();
+}
+
+void GPUThread::Push(std::function<void()> work) {
+    ASSERT(!IsCurrentThread());
+    ++num_submitted;
+    queue.Push(std::move(work));
+}
+
+void GPUThread::Sync(std::function<void()> work) {
+    Push(std::move(work));
+    WaitIdle();
+}
+
+void GPUThread::WaitIdle() {
+    MICROPROFILE_SCOPE(GPU_WaitIdle);
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    idle_cv.wait(lock, [this] { return num_completed == num_submitted; });
+}
+
+void GPUThread::ThreadLoop() {
+    Common::SetCurrentThreadName("GPUThread");
+    MicroProfileOnThreadCreate("GPUThread");
+    emu_window.MakeCurrent();
+
+    while (true) {
+        std::function<void()> work = queue.PopWait();
+        if (!work)
+            break;
+
+        work();
+
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            ++num_completed;
+        }
+        idle_cv.notify_all();
+    }
+
+    emu_window.DoneCurrent();
+}
+
+} // namespace VideoCore
@@ -0,0 +1,62 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "common/common_types.h"
+#include "common/threadsafe_queue.h"
+
+class EmuWindow;
+
+namespace VideoCore {
+
+/**
+ * Thread owning the graphics context and executing the GPU work (command lists, memory fills,
+ * display transfers and buffer swaps) in submission order, so that the emulated CPU keeps running
+ * while the PICA renders. Work is submitted from the CPU thread only.
+ */
+class GPUThread {
+public:
+    /// Takes the graphics context of emu_window, which must not be current on the calling thread
+    explicit GPUThread(EmuWindow& emu_window);
+    ~GPUThread();
+
+    GPUThread(const GPUThread&) = delete;
+    GPUThread& operator=(const GPUThread&) = delete;
+
+    /// Queues work for execution on the GPU thread
+    void Push(std::function<void()> work);
+
+    /// Runs work on the GPU thread, and waits for it and all the work queued before it to finish
+    void Sync(std::function<void()> work);
+
+    /// Waits for all the queued work to finish
+    void WaitIdle();
+
+    /// Returns whether the calling thread is the GPU thread
+    bool IsCurrentThread() const {
+        return std::this_thread::get_id() == thread.get_id();
+    }
+
+private:
+    void ThreadLoop();
+
+    EmuWindow& emu_window;
+
+    /// Pending work, an empty function stops the thread
+    Common::SPSCQueue<std::function<void()>, false> queue;
+    u64 num_submitted = 0;
+
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    u64 num_completed = 0;
+
+    std::thread thread;
+};
+
+} // namespace VideoCore
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include "common/chunk_file.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
@@ -21,6 +22,24 @@ void Shutdown() {
     Shader::Shutdown();
 }
 
+void DoState(PointerWrap& p) {
+    p.DoVoid(&g_state.regs, sizeof(g_state.regs));
+    p.DoVoid(&g_state.vs, sizeof(g_state.vs));
+    p.DoVoid(&g_state.gs, sizeof(g_state.gs));
+    p.DoVoid(&g_state.input_default_attributes, sizeof(g_state.input_default_attributes));
+    p.DoVoid(&g_state.proctex, sizeof(g_state.proctex));
+    p.DoVoid(&g_state.lighting, sizeof(g_state.lighting));
+    p.DoVoid(&g_state.fog, sizeof(g_state.fog));
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        g_state.vs.MarkProgramCodeDirty();
+        g_state.vs.MarkSwizzleDataDirty();
+        g_state.gs.MarkProgramCodeDirty();
+        g_state.gs.MarkSwizzleDataDirty();
+        g_state.primitive_assembler.Reconfigure(g_state.regs.pipeline.triangle_topology);
+    }
+}
+
 template <typename T>
 void Zero(T& o) {
     memset(&o, 0, sizeof(o));
@@ -5,6 +5,9 @@
 #pragma once
 
 #include "video_core/regs_texturing.h"
+
+class PointerWrap;
+
 namespace Pica {
 
 /// Initialize Pica state
@@ -13,4 +16,10 @@ void Init();
 /// Shutdown Pica state
 void Shutdown();
 
+/**
+ * Saves or loads the Pica registers, shader setups and lookup tables. The state of command list
+ * processing isn't saved, so this must be done between command lists.
+ */
+void DoState(PointerWrap& p);
+
 } // namespace Pica
@@ -71,5 +71,8 @@ public:
     virtual bool AccelerateDrawBatch(bool is_indexed) {
         return false;
     }
+
+    /// Notify rasterizer that the GPU finished a command list, whose results the CPU may soon read
+    virtual void NotifyCommandListCompleted() {}
 };
 } // namespace VideoCore
@@ -0,0 +1,39 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/tracer/recorder.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/renderer_null/renderer_null.h"
+#include "video_core/video_core.h"
+
+RendererNull::RendererNull(EmuWindow& window) : RendererBase{window} {}
+RendererNull::~RendererNull() = default;
+
+void RendererNull::SwapBuffers() {
+    // The frames are still timed and limited as if they were presented
+    Core::System::GetInstance().perf_stats.EndSystemFrame();
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
+    Core::System::GetInstance().perf_stats.BeginSystemFrame();
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->FrameFinished();
+    }
+}
+
+Core::System::ResultStatus RendererNull::Init() {
+    // The hardware rasterizer renders through the graphics context, which there isn't
+    if (VideoCore::g_hw_renderer_enabled) {
+        LOG_CRITICAL(Render, "The null renderer requires the software renderer");
+        return Core::System::ResultStatus::ErrorVideoCore;
+    }
+
+    RefreshRasterizerSetting();
+
+    return Core::System::ResultStatus::Success;
+}
+
+void RendererNull::ShutDown() {}
@@ -0,0 +1,28 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "video_core/renderer_base.h"
+
+class EmuWindow;
+
+/**
+ * Renderer which emulates the PICA with the software rasterizer and never presents the frames, for
+ * running without a graphics context, such as benchmarking on machines without a GPU.
+ */
+class RendererNull : public RendererBase {
+public:
+    explicit RendererNull(EmuWindow& window);
+    ~RendererNull() override;
+
+    /// Ends the frame, without presenting it
+    void SwapBuffers() override;
+
+    /// Initialize the renderer
+    Core::System::ResultStatus Init() override;
+
+    /// Shutdown the renderer
+    void ShutDown() override;
+};
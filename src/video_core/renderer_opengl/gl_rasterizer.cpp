@@ -15,7 +15,10 @@
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/hw/gpu.h"
+#include "core/loader/loader.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/regs_rasterizer.h"
@@ -154,6 +157,13 @@ RasterizerOpenGL::RasterizerOpenGL(EmuWindow& window)
     shader_program_manager =
         std::make_unique<ShaderProgramManager>(GLAD_GL_ARB_separate_shader_objects, is_amd);
 
+    u64 program_id;
+    auto& system = Core::System::GetInstance();
+    if (Settings::values.use_disk_shader_cache && system.IsPoweredOn() &&
+        system.GetAppLoader().ReadProgramId(program_id) == Loader::ResultStatus::Success) {
+        shader_program_manager->LoadDiskCache(program_id);
+    }
+
     glEnable(GL_BLEND);
 
     SyncEntireState();
@@ -1345,6 +1355,11 @@ void RasterizerOpenGL::FlushAll() {
     res_cache.FlushAll();
 }
 
+void RasterizerOpenGL::NotifyCommandListCompleted() {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    res_cache.QueueReadbacks();
+}
+
 void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
     res_cache.FlushRegion(addr, size);
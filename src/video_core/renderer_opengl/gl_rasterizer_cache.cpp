@@ -9,6 +9,7 @@
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -76,6 +77,10 @@ constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
     return boost::make_iterator_range(map.equal_range(interval));
 }
 
+/// Size of the pixel buffers staging the transfers between gl_buffer and the surface textures
+constexpr GLsizeiptr UPLOAD_BUFFER_SIZE = 16 * 1024 * 1024;
+constexpr GLsizeiptr READBACK_BUFFER_SIZE = 16 * 1024 * 1024;
+
 static u16 GetResolutionScaleFactor() {
     return !Settings::values.resolution_factor
                ? VideoCore::g_renderer->GetRenderWindow().GetFramebufferLayout().GetScalingRatio()
@@ -86,6 +91,14 @@ template <bool morton_to_gl, PixelFormat format>
 static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
     constexpr u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
+    if constexpr (format != PixelFormat::D24S8 && bytes_per_pixel == gl_bytes_per_pixel) {
+        // The rows of the tile are stored from bottom to top in gl_buffer
+        constexpr std::ptrdiff_t gl_pitch = -static_cast<std::ptrdiff_t>(gl_bytes_per_pixel);
+        VideoCore::MortonCopyTile<morton_to_gl, bytes_per_pixel>(
+            tile_buffer, gl_buffer + 7 * stride * gl_bytes_per_pixel, gl_pitch * stride);
+        return;
+    }
+
     for (u32 y = 0; y < 8; ++y) {
         for (u32 x = 0; x < 8; ++x) {
             u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
@@ -665,12 +678,29 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
+            // Decode whole tiles at once. Unlike gl_buffer, textures are stored from top to bottom
+            const std::size_t tile_size = Pica::Texture::CalculateTileSize(tex_info.format);
+            const u32 texture_top = height - rect.top;
+            const u32 texture_bottom = height - rect.bottom;
+            std::array<Math::Vec4<u8>, 8 * 8> texels;
+            for (u32 tile_y = Common::AlignDown(texture_top, 8); tile_y < texture_bottom;
+                 tile_y += 8) {
+                const u8* tile_row = texture_src_data + (tile_y / 8) * tex_info.stride;
+                const u32 y_begin = std::max(tile_y, texture_top);
+                const u32 y_end = std::min(tile_y + 8, texture_bottom);
+
+                for (u32 tile_x = Common::AlignDown(rect.left, 8); tile_x < rect.right;
+                     tile_x += 8) {
+                    Pica::Texture::DecodeTile(tile_row + (tile_x / 8) * tile_size, tex_info,
+                                              texels.data());
+
+                    const u32 x_begin = std::max(tile_x, rect.left);
+                    const u32 x_end = std::min(tile_x + 8, rect.right);
+                    for (u32 y = y_begin; y < y_end; ++y) {
+                        const std::size_t offset = (x_begin + width * (height - 1 - y)) * 4;
+                        const auto& first_texel = texels[(y - tile_y) * 8 + x_begin - tile_x];
+                        std::memcpy(&gl_buffer[offset], &first_texel, (x_end - x_begin) * 4);
+                    }
                 }
             }
         } else {
@@ -727,12 +757,15 @@ void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
 
 MICROPROFILE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 64, 192));
 void CachedSurface::UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
-                                    GLuint draw_fb_handle) {
+                                    GLuint draw_fb_handle, OGLStreamBuffer& upload_buffer) {
     if (type == SurfaceType::Fill)
         return;
 
     MICROPROFILE_SCOPE(OpenGL_TextureUL);
 
+    // The texture no longer holds what a prefetched readback captured
+    DiscardReadback();
+
     ASSERT(gl_buffer_size == width * height * GetGLBytesPerPixel(pixel_format));
 
     // Load data from memory to the surface
@@ -766,9 +799,30 @@ void CachedSurface::UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint
     glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(stride));
 
     glActiveTexture(GL_TEXTURE0);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, static_cast<GLsizei>(rect.GetWidth()),
-                    static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
-                    &gl_buffer[buffer_offset]);
+
+    // Stage the rows through the upload buffer so that the driver doesn't have to copy them
+    // synchronously, falling back to a client-side transfer for rectangles which don't fit
+    const GLsizeiptr upload_size =
+        ((rect.GetHeight() - 1) * stride + rect.GetWidth()) * GetGLBytesPerPixel(pixel_format);
+    if (upload_size <= upload_buffer.GetSize()) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_buffer.GetHandle());
+
+        u8* buffer_ptr;
+        GLintptr buffer_pos;
+        std::tie(buffer_ptr, buffer_pos, std::ignore) = upload_buffer.Map(upload_size, 4);
+        std::memcpy(buffer_ptr, &gl_buffer[buffer_offset], upload_size);
+        upload_buffer.Unmap(upload_size);
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, static_cast<GLsizei>(rect.GetWidth()),
+                        static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
+                        reinterpret_cast<const void*>(buffer_pos));
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, static_cast<GLsizei>(rect.GetWidth()),
+                        static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
+                        &gl_buffer[buffer_offset]);
+    }
 
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
@@ -791,7 +845,7 @@ void CachedSurface::UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint
 
 MICROPROFILE_DEFINE(OpenGL_TextureDL, "OpenGL", "Texture Download", MP_RGB(128, 192, 64));
 void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
-                                      GLuint draw_fb_handle) {
+                                      GLuint draw_fb_handle, OGLReadbackBuffer& readback_buffer) {
     if (type == SurfaceType::Fill)
         return;
 
@@ -802,6 +856,19 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
         gl_buffer.reset(new u8[gl_buffer_size]);
     }
 
+    if (ResolveReadback(rect, readback_buffer))
+        return;
+
+    // The CPU had to wait for the GPU, so read this surface back ahead of time from now on
+    prefetch_readbacks = true;
+
+    const std::size_t buffer_offset =
+        (rect.bottom * stride + rect.left) * GetGLBytesPerPixel(pixel_format);
+    ReadGLTexture(rect, read_fb_handle, draw_fb_handle, &gl_buffer[buffer_offset]);
+}
+
+void CachedSurface::ReadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
+                                  GLuint draw_fb_handle, void* pixels) {
     OpenGLState state = OpenGLState::GetCurState();
     OpenGLState prev_state = state;
     SCOPE_EXIT({ prev_state.Apply(); });
@@ -811,8 +878,6 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
     // Ensure no bad interactions with GL_PACK_ALIGNMENT
     ASSERT(stride * GetGLBytesPerPixel(pixel_format) % 4 == 0);
     glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(stride));
-    std::size_t buffer_offset =
-        (rect.bottom * stride + rect.left) * GetGLBytesPerPixel(pixel_format);
 
     // If not 1x scale, blit scaled texture to a new 1x texture and use that to flush
     if (res_scale != 1) {
@@ -834,7 +899,7 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
         state.Apply();
 
         glActiveTexture(GL_TEXTURE0);
-        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, &gl_buffer[buffer_offset]);
+        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, pixels);
     } else {
         state.ResetTexture(texture.handle);
         state.draw.read_framebuffer = read_fb_handle;
@@ -857,12 +922,79 @@ void CachedSurface::DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLui
         }
         glReadPixels(static_cast<GLint>(rect.left), static_cast<GLint>(rect.bottom),
                      static_cast<GLsizei>(rect.GetWidth()), static_cast<GLsizei>(rect.GetHeight()),
-                     tuple.format, tuple.type, &gl_buffer[buffer_offset]);
+                     tuple.format, tuple.type, pixels);
     }
 
     glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 }
 
+void CachedSurface::QueueReadback(GLuint read_fb_handle, GLuint draw_fb_handle,
+                                  OGLReadbackBuffer& readback_buffer) {
+    if (type == SurfaceType::Fill)
+        return;
+
+    if (pending_readback && readback_buffer.IsValid(pending_readback->position))
+        return;
+
+    const GLsizeiptr size = stride * height * GetGLBytesPerPixel(pixel_format);
+    if (size > readback_buffer.GetSize())
+        return;
+
+    // The chunk has the same layout as gl_buffer
+    PendingReadback readback;
+    std::tie(readback.offset, readback.position) = readback_buffer.Allocate(size);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_buffer.GetHandle());
+    ReadGLTexture(GetRect(), read_fb_handle, draw_fb_handle,
+                  reinterpret_cast<void*>(readback.offset));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence.Create();
+    pending_readback = std::move(readback);
+}
+
+void CachedSurface::DiscardReadback() {
+    // Stop prefetching if the texture keeps being modified before the readbacks are used
+    if (pending_readback && !pending_readback->used)
+        prefetch_readbacks = false;
+
+    pending_readback.reset();
+}
+
+bool CachedSurface::ResolveReadback(const MathUtil::Rectangle<u32>& rect,
+                                    OGLReadbackBuffer& readback_buffer) {
+    if (!pending_readback)
+        return false;
+
+    if (!readback_buffer.IsValid(pending_readback->position)) {
+        pending_readback.reset();
+        return false;
+    }
+
+    // A lost context never signals the fence, so the wait is bounded, and the texture is read back
+    // synchronously instead when it runs out
+    constexpr GLuint64 READBACK_TIMEOUT_NS = 100000000;
+    const GLenum result = glClientWaitSync(pending_readback->fence.handle,
+                                           GL_SYNC_FLUSH_COMMANDS_BIT, READBACK_TIMEOUT_NS);
+    if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+        LOG_ERROR(Render_OpenGL, "Failed to wait for a surface readback ({})",
+                  result == GL_TIMEOUT_EXPIRED ? "timed out" : "wait failed");
+        pending_readback.reset();
+        return false;
+    }
+
+    const u32 bytes_per_pixel = GetGLBytesPerPixel(pixel_format);
+    const std::size_t begin = (rect.bottom * stride + rect.left) * bytes_per_pixel;
+    const std::size_t end = ((rect.top - 1) * stride + rect.right) * bytes_per_pixel;
+
+    const u8* data = readback_buffer.Map(pending_readback->offset + begin, end - begin);
+    std::memcpy(&gl_buffer[begin], data, end - begin);
+    readback_buffer.Unmap();
+
+    pending_readback->used = true;
+    return true;
+}
+
 enum MatchFlags {
     Invalid = 1,      // Flag that can be applied to other match types, invalid matches require
                       // validation before they can be used
@@ -879,7 +1011,7 @@ constexpr MatchFlags operator|(MatchFlags lhs, MatchFlags rhs) {
 
 /// Get the best surface match (and its match type) for the given flags
 template <MatchFlags find_flags>
-Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params,
+Surface FindMatch(const SurfaceIndex<Surface>& surface_cache, const SurfaceParams& params,
                   ScaleMatch match_scale_type,
                   std::optional<SurfaceInterval> validate_interval = {}) {
     Surface match_surface = nullptr;
@@ -887,86 +1019,89 @@ Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params
     u32 match_scale = 0;
     SurfaceInterval match_interval{};
 
-    for (auto& pair : RangeFromInterval(surface_cache, params.GetInterval())) {
-        for (auto& surface : pair.second) {
-            bool res_scale_matched = match_scale_type == ScaleMatch::Exact
-                                         ? (params.res_scale == surface->res_scale)
-                                         : (params.res_scale <= surface->res_scale);
-            // validity will be checked in GetCopyableInterval
-            bool is_valid =
-                find_flags & MatchFlags::Copy
-                    ? true
-                    : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
-
-            if (!(find_flags & MatchFlags::Invalid) && !is_valid)
-                continue;
+    surface_cache.ForEach(params.addr, params.end, [&](const Surface& surface) {
+        bool res_scale_matched = match_scale_type == ScaleMatch::Exact
+                                     ? (params.res_scale == surface->res_scale)
+                                     : (params.res_scale <= surface->res_scale);
+        // validity will be checked in GetCopyableInterval
+        bool is_valid =
+            find_flags & MatchFlags::Copy
+                ? true
+                : surface->IsRegionValid(validate_interval.value_or(params.GetInterval()));
+
+        if (!(find_flags & MatchFlags::Invalid) && !is_valid)
+            return;
+
+        auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
+            if (!(find_flags & check_type))
+                return;
+
+            bool matched;
+            SurfaceInterval surface_interval;
+            std::tie(matched, surface_interval) = match_fn();
+            if (!matched)
+                return;
+
+            if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
+                surface->type != SurfaceType::Fill)
+                return;
+
+            // Found a match, update only if this is better than the previous one
+            auto UpdateMatch = [&] {
+                match_surface = surface;
+                match_valid = is_valid;
+                match_scale = surface->res_scale;
+                match_interval = surface_interval;
+            };
 
-            auto IsMatch_Helper = [&](auto check_type, auto match_fn) {
-                if (!(find_flags & check_type))
-                    return;
-
-                bool matched;
-                SurfaceInterval surface_interval;
-                std::tie(matched, surface_interval) = match_fn();
-                if (!matched)
-                    return;
-
-                if (!res_scale_matched && match_scale_type != ScaleMatch::Ignore &&
-                    surface->type != SurfaceType::Fill)
-                    return;
-
-                // Found a match, update only if this is better than the previous one
-                auto UpdateMatch = [&] {
-                    match_surface = surface;
-                    match_valid = is_valid;
-                    match_scale = surface->res_scale;
-                    match_interval = surface_interval;
-                };
-
-                if (surface->res_scale > match_scale) {
-                    UpdateMatch();
-                    return;
-                } else if (surface->res_scale < match_scale) {
-                    return;
-                }
+            if (surface->res_scale > match_scale) {
+                UpdateMatch();
+                return;
+            } else if (surface->res_scale < match_scale) {
+                return;
+            }
 
-                if (is_valid && !match_valid) {
-                    UpdateMatch();
-                    return;
-                } else if (is_valid != match_valid) {
-                    return;
-                }
+            if (is_valid && !match_valid) {
+                UpdateMatch();
+                return;
+            } else if (is_valid != match_valid) {
+                return;
+            }
 
-                if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
-                    UpdateMatch();
-                }
-            };
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
-                return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
-                return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
-                ASSERT(validate_interval);
-                auto copy_interval =
-                    params.FromInterval(*validate_interval).GetCopyableInterval(surface);
-                bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
-                               surface->CanCopy(params, copy_interval);
-                return std::make_pair(matched, copy_interval);
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
-                return std::make_pair(surface->CanExpand(params), surface->GetInterval());
-            });
-            IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
-                return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
-            });
-        }
-    }
+            if (boost::icl::length(surface_interval) > boost::icl::length(match_interval)) {
+                UpdateMatch();
+            }
+        };
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Exact>{}, [&] {
+            return std::make_pair(surface->ExactMatch(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::SubRect>{}, [&] {
+            return std::make_pair(surface->CanSubRect(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Copy>{}, [&] {
+            ASSERT(validate_interval);
+            auto copy_interval =
+                params.FromInterval(*validate_interval).GetCopyableInterval(surface);
+            bool matched = boost::icl::length(copy_interval & *validate_interval) != 0 &&
+                           surface->CanCopy(params, copy_interval);
+            return std::make_pair(matched, copy_interval);
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::Expand>{}, [&] {
+            return std::make_pair(surface->CanExpand(params), surface->GetInterval());
+        });
+        IsMatch_Helper(std::integral_constant<MatchFlags, MatchFlags::TexCopy>{}, [&] {
+            return std::make_pair(surface->CanTexCopy(params), surface->GetInterval());
+        });
+    });
     return match_surface;
 }
 
-RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
+RasterizerCacheOpenGL::RasterizerCacheOpenGL()
+    : upload_buffer(GL_PIXEL_UNPACK_BUFFER, UPLOAD_BUFFER_SIZE, false),
+      readback_buffer(READBACK_BUFFER_SIZE) {
+    // The stream buffer binds itself on creation, which would break client-side transfers
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
     read_framebuffer.Create();
     draw_framebuffer.Create();
 
@@ -1019,8 +1154,7 @@ void main() {
 
 RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
     FlushAll();
-    while (!surface_cache.empty())
-        UnregisterSurface(*surface_cache.begin()->second.begin());
+    UnregisterAll();
 }
 
 bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
@@ -1105,8 +1239,17 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
 
     ASSERT(!params.is_tiled || (params.width % 8 == 0 && params.height % 8 == 0));
 
+    // Repeated lookups of the same surface skip the search
+    Surface surface = FindRecentMatch(params, match_res_scale);
+    if (surface != nullptr) {
+        if (load_if_create) {
+            ValidateSurface(surface, params.addr, params.size);
+        }
+        return surface;
+    }
+
     // Check for an exact match in existing surfaces
-    Surface surface =
+    surface =
         FindMatch<MatchFlags::Exact | MatchFlags::Invalid>(surface_cache, params, match_res_scale);
 
     if (surface == nullptr) {
@@ -1135,6 +1278,7 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
         surface = CreateSurface(new_params);
         RegisterSurface(surface);
     }
+    AddRecentMatch(params, match_res_scale, surface);
 
     if (load_if_create) {
         ValidateSurface(surface, params.addr, params.size);
@@ -1356,8 +1500,7 @@ SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
     if (resolution_scale_factor != GetResolutionScaleFactor()) {
         resolution_scale_factor = GetResolutionScaleFactor();
         FlushAll();
-        while (!surface_cache.empty())
-            UnregisterSurface(*surface_cache.begin()->second.begin());
+        UnregisterAll();
         texture_cube_cache.clear();
     }
 
@@ -1492,19 +1635,15 @@ void RasterizerCacheOpenGL::DuplicateSurface(const Surface& src_surface,
 
     BlitSurfaces(src_surface, src_surface->GetScaledRect(), dest_surface,
                  dest_surface->GetScaledSubRect(*src_surface));
+    dest_surface->DiscardReadback();
 
     dest_surface->invalid_regions -= src_surface->GetInterval();
     dest_surface->invalid_regions += src_surface->invalid_regions;
 
-    SurfaceRegions regions;
-    for (auto& pair : RangeFromInterval(dirty_regions, src_surface->GetInterval())) {
-        if (pair.second == src_surface) {
-            regions += pair.first;
-        }
-    }
-    for (auto& interval : regions) {
-        dirty_regions.set({interval, dest_surface});
-    }
+    dest_surface->dirty_regions += src_surface->dirty_regions;
+    src_surface->dirty_regions.clear();
+    if (!dest_surface->dirty_regions.empty())
+        dirty_surfaces.emplace(dest_surface);
 }
 
 void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr, u32 size) {
@@ -1562,7 +1701,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         FlushRegion(params.addr, params.size);
         surface->LoadGLBuffer(params.addr, params.end);
         surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                 draw_framebuffer.handle);
+                                 draw_framebuffer.handle, upload_buffer);
         surface->invalid_regions.erase(params.GetInterval());
     }
 }
@@ -1572,37 +1711,53 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surf
         return;
 
     const SurfaceInterval flush_interval(addr, addr + size);
-    SurfaceRegions flushed_intervals;
 
-    for (auto& pair : RangeFromInterval(dirty_regions, flush_interval)) {
-        // small sizes imply that this most likely comes from the cpu, flush the entire region
-        // the point is to avoid thousands of small writes every frame if the cpu decides to access
-        // that region, anything higher than 8 you're guaranteed it comes from a service
-        const auto interval = size <= 8 ? pair.first : pair.first & flush_interval;
-        auto& surface = pair.second;
+    const auto flush = [&](const Surface& surface) {
+        SurfaceRegions flushed_intervals;
 
-        if (flush_surface != nullptr && surface != flush_surface)
-            continue;
+        for (auto& dirty_interval : RangeFromInterval(surface->dirty_regions, flush_interval)) {
+            // small sizes imply that this most likely comes from the cpu, flush the entire region
+            // the point is to avoid thousands of small writes every frame if the cpu decides to
+            // access that region, anything higher than 8 you're guaranteed it comes from a service
+            const auto interval = size <= 8 ? dirty_interval : dirty_interval & flush_interval;
 
-        // Sanity check, this surface is the last one that marked this region dirty
-        ASSERT(surface->IsRegionValid(interval));
+            // Sanity check, this surface is the last one that marked this region dirty
+            ASSERT(surface->IsRegionValid(interval));
 
-        if (surface->type != SurfaceType::Fill) {
-            SurfaceParams params = surface->FromInterval(interval);
-            surface->DownloadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
-                                       draw_framebuffer.handle);
+            if (surface->type != SurfaceType::Fill) {
+                SurfaceParams params = surface->FromInterval(interval);
+                surface->DownloadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
+                                           draw_framebuffer.handle, readback_buffer);
+            }
+            surface->FlushGLBuffer(boost::icl::first(interval), boost::icl::last_next(interval));
+            flushed_intervals += interval;
         }
-        surface->FlushGLBuffer(boost::icl::first(interval), boost::icl::last_next(interval));
-        flushed_intervals += interval;
+        // Reset dirty regions
+        surface->dirty_regions -= flushed_intervals;
+    };
+
+    if (flush_surface != nullptr) {
+        flush(flush_surface);
+    } else {
+        surface_cache.ForEach(addr, addr + size, flush);
     }
-    // Reset dirty regions
-    dirty_regions -= flushed_intervals;
 }
 
 void RasterizerCacheOpenGL::FlushAll() {
     FlushRegion(0, 0xFFFFFFFF);
 }
 
+void RasterizerCacheOpenGL::QueueReadbacks() {
+    // The surfaces which weren't drawn to since the last time already have their readback queued
+    for (const Surface& surface : dirty_surfaces) {
+        if (surface->prefetch_readbacks && !surface->dirty_regions.empty()) {
+            surface->QueueReadback(read_framebuffer.handle, draw_framebuffer.handle,
+                                   readback_buffer);
+        }
+    }
+    dirty_surfaces.clear();
+}
+
 void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner) {
     if (size == 0)
         return;
@@ -1615,36 +1770,35 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
         region_owner->invalid_regions.erase(invalid_interval);
+        region_owner->DiscardReadback();
     }
 
-    for (auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
-        for (auto& cached_surface : pair.second) {
-            if (cached_surface == region_owner)
-                continue;
+    surface_cache.ForEach(addr, addr + size, [&](const Surface& cached_surface) {
+        if (cached_surface == region_owner)
+            return;
 
-            // If cpu is invalidating this region we want to remove it
-            // to (likely) mark the memory pages as uncached
-            if (region_owner == nullptr && size <= 8) {
-                FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
-                remove_surfaces.emplace(cached_surface);
-                continue;
-            }
+        // If cpu is invalidating this region we want to remove it
+        // to (likely) mark the memory pages as uncached
+        if (region_owner == nullptr && size <= 8) {
+            FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
+            remove_surfaces.emplace(cached_surface);
+            return;
+        }
 
-            const auto interval = cached_surface->GetInterval() & invalid_interval;
-            cached_surface->invalid_regions.insert(interval);
+        const auto interval = cached_surface->GetInterval() & invalid_interval;
+        cached_surface->invalid_regions.insert(interval);
+        cached_surface->dirty_regions.erase(interval);
 
-            // Remove only "empty" fill surfaces to avoid destroying and recreating OGL textures
-            if (cached_surface->type == SurfaceType::Fill &&
-                cached_surface->IsSurfaceFullyInvalid()) {
-                remove_surfaces.emplace(cached_surface);
-            }
+        // Remove only "empty" fill surfaces to avoid destroying and recreating OGL textures
+        if (cached_surface->type == SurfaceType::Fill && cached_surface->IsSurfaceFullyInvalid()) {
+            remove_surfaces.emplace(cached_surface);
         }
-    }
+    });
 
-    if (region_owner != nullptr)
-        dirty_regions.set({invalid_interval, region_owner});
-    else
-        dirty_regions.erase(invalid_interval);
+    if (region_owner != nullptr) {
+        region_owner->dirty_regions.insert(invalid_interval);
+        dirty_surfaces.emplace(region_owner);
+    }
 
     for (auto& remove_surface : remove_surfaces) {
         if (remove_surface == region_owner) {
@@ -1683,8 +1837,10 @@ void RasterizerCacheOpenGL::RegisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = true;
-    surface_cache.add({surface->GetInterval(), SurfaceSet{surface}});
-    UpdatePagesCachedCount(surface->addr, surface->size, 1);
+    surface_cache.Insert(surface->addr, surface->end, surface, [](PAddr addr, u32 size) {
+        Memory::RasterizerMarkRegionCached(addr, size, true);
+    });
+    recent_matches = {};
 }
 
 void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
@@ -1692,38 +1848,48 @@ void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = false;
-    UpdatePagesCachedCount(surface->addr, surface->size, -1);
-    surface_cache.subtract({surface->GetInterval(), SurfaceSet{surface}});
+    dirty_surfaces.erase(surface);
+    surface_cache.Erase(surface->addr, surface->end, surface, [](PAddr addr, u32 size) {
+        Memory::RasterizerMarkRegionCached(addr, size, false);
+    });
+    recent_matches = {};
 }
 
-void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
-    const u32 num_pages =
-        ((addr + size - 1) >> Memory::PAGE_BITS) - (addr >> Memory::PAGE_BITS) + 1;
-    const u32 page_start = addr >> Memory::PAGE_BITS;
-    const u32 page_end = page_start + num_pages;
-
-    // Interval maps will erase segments if count reaches 0, so if delta is negative we have to
-    // subtract after iterating
-    const auto pages_interval = PageMap::interval_type::right_open(page_start, page_end);
-    if (delta > 0)
-        cached_pages.add({pages_interval, delta});
-
-    for (auto& pair : RangeFromInterval(cached_pages, pages_interval)) {
-        const auto interval = pair.first & pages_interval;
-        const int count = pair.second;
-
-        const PAddr interval_start_addr = boost::icl::first(interval) << Memory::PAGE_BITS;
-        const PAddr interval_end_addr = boost::icl::last_next(interval) << Memory::PAGE_BITS;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-
-        if (delta > 0 && count == delta)
-            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
-        else if (delta < 0 && count == -delta)
-            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
-        else
-            ASSERT(count >= 0);
+void RasterizerCacheOpenGL::UnregisterAll() {
+    std::vector<Surface> surfaces;
+    surfaces.reserve(surface_cache.Size());
+    surface_cache.ForEach(0, 0xFFFFFFFF,
+                          [&](const Surface& surface) { surfaces.push_back(surface); });
+
+    for (const auto& surface : surfaces)
+        UnregisterSurface(surface);
+}
+
+Surface RasterizerCacheOpenGL::FindRecentMatch(const SurfaceParams& params,
+                                               ScaleMatch match_res_scale) {
+    for (auto it = recent_matches.begin(); it != recent_matches.end(); ++it) {
+        if (it->surface != nullptr && it->match_res_scale == match_res_scale &&
+            it->params.res_scale == params.res_scale && it->params.ExactMatch(params)) {
+            std::rotate(recent_matches.begin(), it, it + 1);
+            return recent_matches.front().surface;
+        }
     }
+    return nullptr;
+}
+
+void RasterizerCacheOpenGL::AddRecentMatch(const SurfaceParams& params, ScaleMatch match_res_scale,
+                                           const Surface& surface) {
+    // FindMatch only depends on the validity of the surfaces to choose between several exact
+    // matches, so its result can't change before a surface is registered or unregistered if there
+    // is a single one
+    std::size_t num_exact_matches = 0;
+    surface_cache.ForEach(params.addr, params.end, [&](const Surface& cached_surface) {
+        if (cached_surface->ExactMatch(params))
+            ++num_exact_matches;
+    });
+    if (num_exact_matches != 1)
+        return;
 
-    if (delta < 0)
-        cached_pages.add({pages_interval, delta});
+    std::rotate(recent_matches.begin(), recent_matches.end() - 1, recent_matches.end());
+    recent_matches.front() = {params, match_res_scale, surface};
 }
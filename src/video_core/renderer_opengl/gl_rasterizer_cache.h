@@ -7,13 +7,13 @@
 #include <array>
 #include <list>
 #include <memory>
+#include <optional>
 #include <set>
 #include <tuple>
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-local-typedefs"
 #endif
-#include <boost/icl/interval_map.hpp>
 #include <boost/icl/interval_set.hpp>
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
@@ -28,7 +28,10 @@
 #include "core/hw/gpu.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/regs_texturing.h"
+#include "video_core/renderer_opengl/gl_readback_buffer.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_stream_buffer.h"
+#include "video_core/renderer_opengl/gl_surface_index.h"
 #include "video_core/texture/texture_decode.h"
 
 struct CachedSurface;
@@ -36,19 +39,11 @@ using Surface = std::shared_ptr<CachedSurface>;
 using SurfaceSet = std::set<Surface>;
 
 using SurfaceRegions = boost::icl::interval_set<PAddr>;
-using SurfaceMap = boost::icl::interval_map<PAddr, Surface>;
-using SurfaceCache = boost::icl::interval_map<PAddr, SurfaceSet>;
-
-using SurfaceInterval = SurfaceCache::interval_type;
-static_assert(std::is_same<SurfaceRegions::interval_type, SurfaceCache::interval_type>() &&
-                  std::is_same<SurfaceMap::interval_type, SurfaceCache::interval_type>(),
-              "incorrect interval types");
+using SurfaceInterval = SurfaceRegions::interval_type;
 
 using SurfaceRect_Tuple = std::tuple<Surface, MathUtil::Rectangle<u32>>;
 using SurfaceSurfaceRect_Tuple = std::tuple<Surface, Surface, MathUtil::Rectangle<u32>>;
 
-using PageMap = boost::icl::interval_map<u32, int>;
-
 enum class ScaleMatch {
     Exact,   // only accept same res scale
     Upscale, // only allow higher scale than params
@@ -305,6 +300,8 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
 
     bool registered = false;
     SurfaceRegions invalid_regions;
+    /// Regions where this surface holds the most recent data, which must be flushed to memory
+    SurfaceRegions dirty_regions;
 
     u32 fill_size = 0; /// Number of bytes to read from fill_data
     std::array<u8, 4> fill_data;
@@ -329,9 +326,19 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
 
     // Upload/Download data in gl_buffer in/to this surface's texture
     void UploadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
-                         GLuint draw_fb_handle);
+                         GLuint draw_fb_handle, OGLStreamBuffer& upload_buffer);
     void DownloadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
-                           GLuint draw_fb_handle);
+                           GLuint draw_fb_handle, OGLReadbackBuffer& readback_buffer);
+
+    // Start an asynchronous download of the whole texture, which DownloadGLTexture uses instead of
+    // reading the texture back as long as the texture isn't modified in the meantime
+    void QueueReadback(GLuint read_fb_handle, GLuint draw_fb_handle,
+                       OGLReadbackBuffer& readback_buffer);
+    // Drop the asynchronous download, must be called whenever the texture is modified
+    void DiscardReadback();
+
+    /// Whether the texture had to be read back synchronously since the last readback was queued
+    bool prefetch_readbacks = false;
 
     std::shared_ptr<SurfaceWatcher> CreateWatcher() {
         auto watcher = std::make_shared<SurfaceWatcher>(weak_from_this());
@@ -348,6 +355,18 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     }
 
 private:
+    void ReadGLTexture(const MathUtil::Rectangle<u32>& rect, GLuint read_fb_handle,
+                       GLuint draw_fb_handle, void* pixels);
+    bool ResolveReadback(const MathUtil::Rectangle<u32>& rect, OGLReadbackBuffer& readback_buffer);
+
+    struct PendingReadback {
+        GLintptr offset;
+        u64 position;
+        OGLSync fence;
+        bool used = false;
+    };
+    std::optional<PendingReadback> pending_readback;
+
     std::list<std::weak_ptr<SurfaceWatcher>> watchers;
 };
 
@@ -451,6 +470,9 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /// Start reading back the dirty surfaces which are likely to be flushed soon
+    void QueueReadbacks();
+
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
@@ -466,17 +488,33 @@ private:
     /// Remove surface from the cache
     void UnregisterSurface(const Surface& surface);
 
-    /// Increase/decrease the number of surface in pages touching the specified region
-    void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
+    /// Remove all surfaces from the cache
+    void UnregisterAll();
+
+    /// Look up the result of a previous GetSurface call with the same parameters
+    Surface FindRecentMatch(const SurfaceParams& params, ScaleMatch match_res_scale);
+    void AddRecentMatch(const SurfaceParams& params, ScaleMatch match_res_scale,
+                        const Surface& surface);
 
-    SurfaceCache surface_cache;
-    PageMap cached_pages;
-    SurfaceMap dirty_regions;
+    SurfaceIndex<Surface> surface_cache;
     SurfaceSet remove_surfaces;
+    /// Surfaces drawn to since the last readbacks were queued
+    SurfaceSet dirty_surfaces;
+
+    struct RecentMatch {
+        SurfaceParams params;
+        ScaleMatch match_res_scale;
+        Surface surface;
+    };
+    /// Most recently used exact matches, cleared whenever surfaces are registered or unregistered
+    std::array<RecentMatch, 4> recent_matches{};
 
     OGLFramebuffer read_framebuffer;
     OGLFramebuffer draw_framebuffer;
 
+    OGLStreamBuffer upload_buffer;
+    OGLReadbackBuffer readback_buffer;
+
     OGLVertexArray attributeless_vao;
     OGLBuffer d24s8_abgr_buffer;
     GLsizeiptr d24s8_abgr_buffer_size;
@@ -0,0 +1,81 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "video_core/renderer_opengl/gl_readback_buffer.h"
+
+OGLReadbackBuffer::OGLReadbackBuffer(GLsizeiptr size) : buffer_size(size) {
+    gl_buffer.Create();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, gl_buffer.handle);
+
+    if (GLAD_GL_ARB_buffer_storage) {
+        // Keep the buffer mapped, the coherent mapping makes the transfers visible to the CPU as
+        // soon as their fence is signaled
+        persistent = true;
+        const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, size, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+        mapped_ptr =
+            static_cast<const u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, flags));
+    } else {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+OGLReadbackBuffer::~OGLReadbackBuffer() {
+    if (persistent) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, gl_buffer.handle);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    gl_buffer.Release();
+}
+
+GLuint OGLReadbackBuffer::GetHandle() const {
+    return gl_buffer.handle;
+}
+
+GLsizeiptr OGLReadbackBuffer::GetSize() const {
+    return buffer_size;
+}
+
+std::tuple<GLintptr, u64> OGLReadbackBuffer::Allocate(GLsizeiptr size) {
+    ASSERT(size <= buffer_size);
+
+    GLintptr offset = static_cast<GLintptr>(buffer_pos % buffer_size);
+    if (offset + size > buffer_size) {
+        // Chunks are contiguous, skip the end of the buffer
+        buffer_pos += buffer_size - offset;
+        offset = 0;
+    }
+
+    const u64 position = buffer_pos;
+    buffer_pos += size;
+    return std::make_tuple(offset, position);
+}
+
+bool OGLReadbackBuffer::IsValid(u64 position) const {
+    // The chunk is overwritten once newer chunks extend a whole buffer past its start
+    return buffer_pos <= position + buffer_size;
+}
+
+const u8* OGLReadbackBuffer::Map(GLintptr offset, GLsizeiptr size) {
+    if (persistent) {
+        return mapped_ptr + offset;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, gl_buffer.handle);
+    return static_cast<const u8*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, offset, size, GL_MAP_READ_BIT));
+}
+
+void OGLReadbackBuffer::Unmap() {
+    if (persistent) {
+        return;
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
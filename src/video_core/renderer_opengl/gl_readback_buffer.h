@@ -0,0 +1,51 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <tuple>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+/**
+ * Ring of GPU memory receiving asynchronous transfers from the GPU, such as glReadPixels with the
+ * buffer bound to GL_PIXEL_PACK_BUFFER. Chunks are never freed explicitly: once the ring wraps
+ * around, newer chunks overwrite the oldest ones.
+ */
+class OGLReadbackBuffer : private NonCopyable {
+public:
+    explicit OGLReadbackBuffer(GLsizeiptr size);
+    ~OGLReadbackBuffer();
+
+    GLuint GetHandle() const;
+    GLsizeiptr GetSize() const;
+
+    /*
+     * Allocates a linear chunk of "size" bytes in the GPU buffer.
+     * The return values are the offset of the chunk within the buffer, and the position of the
+     * chunk in the ring, which identifies it in later calls.
+     */
+    std::tuple<GLintptr, u64> Allocate(GLsizeiptr size);
+
+    /// Returns whether the chunk at the given position has not been overwritten by newer chunks
+    bool IsValid(u64 position) const;
+
+    /*
+     * Maps a chunk for reading. The caller must make sure that the GPU has finished writing it,
+     * e.g. by waiting on a fence created after the transfer.
+     */
+    const u8* Map(GLintptr offset, GLsizeiptr size);
+
+    void Unmap();
+
+private:
+    OGLBuffer gl_buffer;
+
+    bool persistent = false;
+
+    GLsizeiptr buffer_size = 0;
+    u64 buffer_pos = 0;
+    const u8* mapped_ptr = nullptr;
+};
@@ -0,0 +1,168 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace GLShader {
+
+/// Version of the on-disk layout of the entries, bump this whenever it changes
+constexpr u32 DISK_CACHE_VERSION = 1;
+
+/// Size of the [type, key size] header of a raw entry
+constexpr std::size_t RAW_HEADER_SIZE = 2 * sizeof(u32);
+
+static u32 HashString(const char* str) {
+    return static_cast<u32>(Common::ComputeHash64(str, std::strlen(str)));
+}
+
+static const char* GetGLString(GLenum name) {
+    const auto str = reinterpret_cast<const char*>(glGetString(name));
+    return str != nullptr ? str : "";
+}
+
+/// The generated GLSL depends on the emulator build, so entries of other builds are discarded
+static u32 GetRawVersion(bool separable) {
+    return DISK_CACHE_VERSION ^ HashString(Common::g_scm_rev) ^ (separable ? 1 : 0);
+}
+
+/// Program binaries are only valid for the driver that produced them
+static u32 GetBinaryVersion(bool separable) {
+    return GetRawVersion(separable) ^ HashString(GetGLString(GL_VENDOR)) ^
+           HashString(GetGLString(GL_RENDERER)) ^ HashString(GetGLString(GL_VERSION));
+}
+
+namespace {
+
+class RawReader final : public LinearDiskCacheReader<u64, u8> {
+public:
+    void Read(const u64& key, const u8* value, u32 value_size) override {
+        if (value_size < RAW_HEADER_SIZE) {
+            return;
+        }
+
+        u32 type;
+        u32 key_size;
+        std::memcpy(&type, value, sizeof(u32));
+        std::memcpy(&key_size, value + sizeof(u32), sizeof(u32));
+        if (type > static_cast<u32>(ProgramType::FS) ||
+            key_size > value_size - RAW_HEADER_SIZE) {
+            return;
+        }
+
+        const u8* key_data = value + RAW_HEADER_SIZE;
+        const u8* source_data = key_data + key_size;
+        const u8* end = value + value_size;
+        raws.push_back({static_cast<ProgramType>(type), std::vector<u8>(key_data, source_data),
+                        std::string(source_data, end)});
+    }
+
+    std::vector<ShaderDiskCacheRaw> raws;
+};
+
+class BinaryReader final : public LinearDiskCacheReader<u64, u8> {
+public:
+    void Read(const u64& key, const u8* value, u32 value_size) override {
+        if (value_size <= sizeof(GLenum)) {
+            return;
+        }
+
+        GLenum format;
+        std::memcpy(&format, value, sizeof(GLenum));
+        binaries[key] = {format, std::vector<u8>(value + sizeof(GLenum), value + value_size)};
+    }
+
+    std::unordered_map<u64, ShaderDiskCacheBinary> binaries;
+};
+
+} // Anonymous namespace
+
+ShaderDiskCache::ShaderDiskCache(u64 program_id, bool separable)
+    : program_id(program_id), separable(separable) {
+    GLint num_formats = 0;
+    if (separable && GLAD_GL_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    }
+    binaries_supported = num_formats > 0;
+}
+
+std::string ShaderDiskCache::GetBasePath() const {
+    return fmt::format("{}{:016X}", FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir),
+                       program_id);
+}
+
+std::vector<ShaderDiskCacheRaw> ShaderDiskCache::LoadRaws() {
+    if (!FileUtil::CreateFullPath(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir))) {
+        LOG_ERROR(Render_OpenGL, "Failed to create shader cache directory");
+        return {};
+    }
+
+    RawReader reader;
+    const std::string path = GetBasePath() + "_gl_raw.bin";
+    raw_cache.OpenAndRead(path, GetRawVersion(separable), reader);
+    LOG_INFO(Render_OpenGL, "Loaded {} shaders from {}", reader.raws.size(), path);
+    return std::move(reader.raws);
+}
+
+std::unordered_map<u64, ShaderDiskCacheBinary> ShaderDiskCache::LoadBinaries() {
+    if (!binaries_supported) {
+        return {};
+    }
+
+    BinaryReader reader;
+    const std::string path = GetBasePath() + "_gl_binary.bin";
+    binary_cache.OpenAndRead(path, GetBinaryVersion(separable), reader);
+    LOG_INFO(Render_OpenGL, "Loaded {} program binaries from {}", reader.binaries.size(), path);
+    return std::move(reader.binaries);
+}
+
+void ShaderDiskCache::SaveRaw(ProgramType type, const void* key, std::size_t key_size,
+                              const std::string& source) {
+    if (!raw_cache.IsOpen()) {
+        return;
+    }
+
+    std::vector<u8> value(RAW_HEADER_SIZE + key_size + source.size());
+    const u32 type_value = static_cast<u32>(type);
+    const u32 key_size_value = static_cast<u32>(key_size);
+    std::memcpy(value.data(), &type_value, sizeof(u32));
+    std::memcpy(value.data() + sizeof(u32), &key_size_value, sizeof(u32));
+    std::memcpy(value.data() + RAW_HEADER_SIZE, key, key_size);
+    std::memcpy(value.data() + RAW_HEADER_SIZE + key_size, source.data(), source.size());
+
+    raw_cache.Append(Common::ComputeHash64(value.data(), value.size()), value.data(),
+                     static_cast<u32>(value.size()));
+    raw_cache.Sync();
+}
+
+void ShaderDiskCache::SaveBinary(const std::string& source, GLuint program) {
+    if (!binaries_supported || !binary_cache.IsOpen()) {
+        return;
+    }
+
+    GLint binary_length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0) {
+        return;
+    }
+
+    std::vector<u8> value(sizeof(GLenum) + binary_length);
+    GLenum format;
+    glGetProgramBinary(program, binary_length, nullptr, &format, value.data() + sizeof(GLenum));
+    std::memcpy(value.data(), &format, sizeof(GLenum));
+
+    binary_cache.Append(GetSourceHash(source), value.data(), static_cast<u32>(value.size()));
+    binary_cache.Sync();
+}
+
+u64 ShaderDiskCache::GetSourceHash(const std::string& source) {
+    return Common::ComputeHash64(source.data(), source.size());
+}
+
+} // namespace GLShader
@@ -0,0 +1,69 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/linear_disk_cache.h"
+
+namespace GLShader {
+
+/// Identifies which shader cache of the ShaderProgramManager a disk cache entry belongs to
+enum class ProgramType : u32 { VS, GS, FixedGS, FS };
+
+/// A shader recorded on disk: the config used as cache key and the GLSL generated from it
+struct ShaderDiskCacheRaw {
+    ProgramType type;
+    std::vector<u8> key;
+    std::string source;
+};
+
+/// A linked separable program retrieved with glGetProgramBinary
+struct ShaderDiskCacheBinary {
+    GLenum format;
+    std::vector<u8> data;
+};
+
+/**
+ * Per-title on-disk storage of the shaders generated by the ShaderProgramManager. The generated
+ * GLSL is stored along with its cache key, so that the shaders can be rebuilt at boot without
+ * regenerating them from the PICA state. When the driver supports it, the program binaries of
+ * separable programs are stored in a second file that is invalidated on driver changes.
+ */
+class ShaderDiskCache {
+public:
+    ShaderDiskCache(u64 program_id, bool separable);
+
+    /// Reads all the shaders that have been recorded for this title
+    std::vector<ShaderDiskCacheRaw> LoadRaws();
+
+    /// Reads all the program binaries recorded for this title, keyed by the hash of their source
+    std::unordered_map<u64, ShaderDiskCacheBinary> LoadBinaries();
+
+    /// Records a newly generated shader
+    void SaveRaw(ProgramType type, const void* key, std::size_t key_size,
+                 const std::string& source);
+
+    /// Records the binary of a linked separable program generated from the given source
+    void SaveBinary(const std::string& source, GLuint program);
+
+    /// Returns the key used to look up the binary of a program generated from the given source
+    static u64 GetSourceHash(const std::string& source);
+
+private:
+    std::string GetBasePath() const;
+
+    u64 program_id;
+    bool separable;
+    bool binaries_supported;
+
+    LinearDiskCache<u64, u8> raw_cache;
+    LinearDiskCache<u64, u8> binary_cache;
+};
+
+} // namespace GLShader
@@ -166,6 +166,8 @@ struct PicaShaderConfigCommon {
  * shader.
  */
 struct PicaVSConfig : Common::HashableStruct<PicaShaderConfigCommon> {
+    PicaVSConfig() = default;
+
     explicit PicaVSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
         state.Init(regs.vs, setup);
     }
@@ -191,6 +193,8 @@ struct PicaGSConfigCommonRaw {
  * shader pipeline
  */
 struct PicaFixedGSConfig : Common::HashableStruct<PicaGSConfigCommonRaw> {
+    PicaFixedGSConfig() = default;
+
     explicit PicaFixedGSConfig(const Pica::Regs& regs) {
         state.Init(regs);
     }
@@ -211,6 +215,8 @@ struct PicaGSConfigRaw : PicaShaderConfigCommon, PicaGSConfigCommonRaw {
  * shader.
  */
 struct PicaGSConfig : Common::HashableStruct<PicaGSConfigRaw> {
+    PicaGSConfig() = default;
+
     explicit PicaGSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setups) {
         state.Init(regs, setups);
     }
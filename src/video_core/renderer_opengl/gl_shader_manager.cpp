@@ -3,11 +3,18 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <unordered_map>
 #include <boost/functional/hash.hpp>
 #include <boost/variant.hpp>
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 
+using GLShader::ProgramType;
+using GLShader::ShaderDiskCache;
+using GLShader::ShaderDiskCacheBinary;
+
 static void SetShaderUniformBlockBinding(GLuint shader, const char* name, UniformBindings binding,
                                          std::size_t expected_size) {
     GLuint ub_index = glGetUniformBlockIndex(shader, name);
@@ -112,6 +119,33 @@ public:
         }
     }
 
+    /**
+     * Creates a separable program from a binary stored in the disk cache.
+     * @returns false if the stage is not separable or if the driver rejected the binary
+     */
+    bool CreateFromBinary(const ShaderDiskCacheBinary& binary) {
+        if (!IsSeparable()) {
+            return false;
+        }
+
+        OGLProgram& program = boost::get<OGLProgram>(shader_or_program);
+        program.handle = glCreateProgram();
+        glProgramParameteri(program.handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        glProgramBinary(program.handle, binary.format, binary.data.data(),
+                        static_cast<GLsizei>(binary.data.size()));
+
+        GLint link_status = GL_FALSE;
+        glGetProgramiv(program.handle, GL_LINK_STATUS, &link_status);
+        if (link_status != GL_TRUE) {
+            program.Release();
+            return false;
+        }
+
+        SetShaderUniformBlockBindings(program.handle);
+        SetShaderSamplerBindings(program.handle);
+        return true;
+    }
+
     GLuint GetHandle() const {
         if (shader_or_program.which() == 0) {
             return boost::get<OGLShader>(shader_or_program).handle;
@@ -120,10 +154,53 @@ public:
         }
     }
 
+    bool IsSeparable() const {
+        return shader_or_program.which() == 1;
+    }
+
 private:
     boost::variant<OGLShader, OGLProgram> shader_or_program;
 };
 
+/// Creates a shader stage from a disk cache entry, preferring the binary if there is one
+static void CreateStageFromDiskCache(OGLShaderStage& stage, const std::string& source,
+                                     GLenum type, const ShaderDiskCacheBinary* binary,
+                                     ShaderDiskCache& disk_cache) {
+    if (binary != nullptr && stage.CreateFromBinary(*binary)) {
+        return;
+    }
+
+    stage.Create(source.c_str(), type);
+    if (stage.IsSeparable()) {
+        disk_cache.SaveBinary(source, stage.GetHandle());
+    }
+}
+
+/// Records a newly generated shader stage in the disk cache
+template <typename KeyConfigType>
+static void SaveStageToDiskCache(ShaderDiskCache* disk_cache, ProgramType type,
+                                 const KeyConfigType& config, const std::string& source,
+                                 const OGLShaderStage* new_stage) {
+    if (disk_cache == nullptr) {
+        return;
+    }
+
+    disk_cache->SaveRaw(type, &config.state, sizeof(config.state), source);
+    if (new_stage != nullptr && new_stage->IsSeparable()) {
+        disk_cache->SaveBinary(source, new_stage->GetHandle());
+    }
+}
+
+/// Rebuilds a shader cache key from its representation in the disk cache
+template <typename KeyConfigType>
+static bool KeyFromDiskCache(KeyConfigType& config, const std::vector<u8>& key) {
+    if (key.size() != sizeof(config.state)) {
+        return false;
+    }
+    std::memcpy(&config.state, key.data(), sizeof(config.state));
+    return true;
+}
+
 class TrivialVertexShader {
 public:
     explicit TrivialVertexShader(bool separable) : program(separable) {
@@ -138,19 +215,35 @@ private:
 };
 
 template <typename KeyConfigType, std::string (*CodeGenerator)(const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ProgramType DiskCacheType>
 class ShaderCache {
 public:
     explicit ShaderCache(bool separable) : separable(separable) {}
-    GLuint Get(const KeyConfigType& config) {
+    GLuint Get(const KeyConfigType& config, ShaderDiskCache* disk_cache) {
         auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
-            cached_shader.Create(CodeGenerator(config, separable).c_str(), ShaderType);
+            const std::string source = CodeGenerator(config, separable);
+            cached_shader.Create(source.c_str(), ShaderType);
+            SaveStageToDiskCache(disk_cache, DiskCacheType, config, source, &cached_shader);
         }
         return cached_shader.GetHandle();
     }
 
+    bool Inject(const std::vector<u8>& key, const std::string& source,
+                const ShaderDiskCacheBinary* binary, ShaderDiskCache& disk_cache) {
+        KeyConfigType config;
+        if (!KeyFromDiskCache(config, key)) {
+            return false;
+        }
+
+        auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
+        if (new_shader) {
+            CreateStageFromDiskCache(iter->second, source, ShaderType, binary, disk_cache);
+        }
+        return true;
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage> shaders;
@@ -164,11 +257,12 @@ private:
 template <typename KeyConfigType,
           std::optional<std::string> (*CodeGenerator)(const Pica::Shader::ShaderSetup&,
                                                       const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ProgramType DiskCacheType>
 class ShaderDoubleCache {
 public:
     explicit ShaderDoubleCache(bool separable) : separable(separable) {}
-    GLuint Get(const KeyConfigType& key, const Pica::Shader::ShaderSetup& setup) {
+    GLuint Get(const KeyConfigType& key, const Pica::Shader::ShaderSetup& setup,
+               ShaderDiskCache* disk_cache) {
         auto map_it = shader_map.find(key);
         if (map_it == shader_map.end()) {
             auto program_opt = CodeGenerator(setup, key, separable);
@@ -184,6 +278,8 @@ public:
                 cached_shader.Create(program.c_str(), ShaderType);
             }
             shader_map[key] = &cached_shader;
+            SaveStageToDiskCache(disk_cache, DiskCacheType, key, program,
+                                 new_shader ? &cached_shader : nullptr);
             return cached_shader.GetHandle();
         }
 
@@ -194,6 +290,21 @@ public:
         return map_it->second->GetHandle();
     }
 
+    bool Inject(const std::vector<u8>& key, const std::string& source,
+                const ShaderDiskCacheBinary* binary, ShaderDiskCache& disk_cache) {
+        KeyConfigType config;
+        if (!KeyFromDiskCache(config, key)) {
+            return false;
+        }
+
+        auto [iter, new_shader] = shader_cache.emplace(source, OGLShaderStage{separable});
+        if (new_shader) {
+            CreateStageFromDiskCache(iter->second, source, ShaderType, binary, disk_cache);
+        }
+        shader_map[config] = &iter->second;
+        return true;
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage*> shader_map;
@@ -201,18 +312,19 @@ private:
 };
 
 using ProgrammableVertexShaders =
-    ShaderDoubleCache<GLShader::PicaVSConfig, &GLShader::GenerateVertexShader, GL_VERTEX_SHADER>;
+    ShaderDoubleCache<GLShader::PicaVSConfig, &GLShader::GenerateVertexShader, GL_VERTEX_SHADER,
+                      ProgramType::VS>;
 
 using ProgrammableGeometryShaders =
     ShaderDoubleCache<GLShader::PicaGSConfig, &GLShader::GenerateGeometryShader,
-                      GL_GEOMETRY_SHADER>;
+                      GL_GEOMETRY_SHADER, ProgramType::GS>;
 
 using FixedGeometryShaders =
     ShaderCache<GLShader::PicaFixedGSConfig, &GLShader::GenerateFixedGeometryShader,
-                GL_GEOMETRY_SHADER>;
+                GL_GEOMETRY_SHADER, ProgramType::FixedGS>;
 
-using FragmentShaders =
-    ShaderCache<GLShader::PicaFSConfig, &GLShader::GenerateFragmentShader, GL_FRAGMENT_SHADER>;
+using FragmentShaders = ShaderCache<GLShader::PicaFSConfig, &GLShader::GenerateFragmentShader,
+                                    GL_FRAGMENT_SHADER, ProgramType::FS>;
 
 class ShaderProgramManager::Impl {
 public:
@@ -263,6 +375,8 @@ public:
     bool separable;
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
+
+    std::unique_ptr<ShaderDiskCache> disk_cache;
 };
 
 ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
@@ -270,9 +384,52 @@ ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
+void ShaderProgramManager::LoadDiskCache(u64 program_id) {
+    impl->disk_cache = std::make_unique<ShaderDiskCache>(program_id, impl->separable);
+    ShaderDiskCache& disk_cache = *impl->disk_cache;
+
+    const auto raws = disk_cache.LoadRaws();
+    const auto binaries = disk_cache.LoadBinaries();
+
+    std::size_t num_loaded = 0;
+    for (const auto& raw : raws) {
+        const auto binary_it = binaries.find(ShaderDiskCache::GetSourceHash(raw.source));
+        const ShaderDiskCacheBinary* binary =
+            binary_it != binaries.end() ? &binary_it->second : nullptr;
+
+        bool loaded = false;
+        switch (raw.type) {
+        case ProgramType::VS:
+            loaded = impl->programmable_vertex_shaders.Inject(raw.key, raw.source, binary,
+                                                               disk_cache);
+            break;
+        case ProgramType::GS:
+            loaded = impl->programmable_geometry_shaders.Inject(raw.key, raw.source, binary,
+                                                                 disk_cache);
+            break;
+        case ProgramType::FixedGS:
+            loaded =
+                impl->fixed_geometry_shaders.Inject(raw.key, raw.source, binary, disk_cache);
+            break;
+        case ProgramType::FS:
+            loaded = impl->fragment_shaders.Inject(raw.key, raw.source, binary, disk_cache);
+            break;
+        }
+
+        if (loaded) {
+            ++num_loaded;
+        } else {
+            LOG_WARNING(Render_OpenGL, "Skipping shader disk cache entry with mismatching key");
+        }
+    }
+
+    LOG_INFO(Render_OpenGL, "Precompiled {} of {} cached shaders", num_loaded, raws.size());
+}
+
 bool ShaderProgramManager::UseProgrammableVertexShader(const GLShader::PicaVSConfig& config,
                                                        const Pica::Shader::ShaderSetup setup) {
-    GLuint handle = impl->programmable_vertex_shaders.Get(config, setup);
+    GLuint handle =
+        impl->programmable_vertex_shaders.Get(config, setup, impl->disk_cache.get());
     if (handle == 0)
         return false;
     impl->current.vs = handle;
@@ -285,7 +442,8 @@ void ShaderProgramManager::UseTrivialVertexShader() {
 
 bool ShaderProgramManager::UseProgrammableGeometryShader(const GLShader::PicaGSConfig& config,
                                                          const Pica::Shader::ShaderSetup setup) {
-    GLuint handle = impl->programmable_geometry_shaders.Get(config, setup);
+    GLuint handle =
+        impl->programmable_geometry_shaders.Get(config, setup, impl->disk_cache.get());
     if (handle == 0)
         return false;
     impl->current.gs = handle;
@@ -293,7 +451,7 @@ bool ShaderProgramManager::UseProgrammableGeometryShader(const GLShader::PicaGSC
 }
 
 void ShaderProgramManager::UseFixedGeometryShader(const GLShader::PicaFixedGSConfig& config) {
-    impl->current.gs = impl->fixed_geometry_shaders.Get(config);
+    impl->current.gs = impl->fixed_geometry_shaders.Get(config, impl->disk_cache.get());
 }
 
 void ShaderProgramManager::UseTrivialGeometryShader() {
@@ -301,7 +459,7 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
 }
 
 void ShaderProgramManager::UseFragmentShader(const GLShader::PicaFSConfig& config) {
-    impl->current.fs = impl->fragment_shaders.Get(config);
+    impl->current.fs = impl->fragment_shaders.Get(config, impl->disk_cache.get());
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
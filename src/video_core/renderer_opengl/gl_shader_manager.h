@@ -102,6 +102,14 @@ public:
     ShaderProgramManager(bool separable, bool is_amd);
     ~ShaderProgramManager();
 
+    /**
+     * Opens the on-disk shader cache of a title and builds every shader recorded in it, so that
+     * these don't need to be generated and compiled at draw time. Shaders generated afterwards
+     * are appended to the cache.
+     * @param program_id Program ID of the running title, used to name the cache files
+     */
+    void LoadDiskCache(u64 program_id);
+
     bool UseProgrammableVertexShader(const GLShader::PicaVSConfig& config,
                                      const Pica::Shader::ShaderSetup setup);
 
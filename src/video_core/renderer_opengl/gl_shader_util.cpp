@@ -64,6 +64,10 @@ GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
 
     if (separable_program) {
         glProgramParameteri(program_id, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        if (GLAD_GL_ARB_get_program_binary) {
+            // Separable programs may be stored in the shader disk cache
+            glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
     }
 
     glLinkProgram(program_id);
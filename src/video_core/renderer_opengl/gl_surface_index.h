@@ -0,0 +1,162 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/assert.h"
+#include "common/common_types.h"
+#include "core/memory.h"
+
+/**
+ * Index of values covering ranges of the physical address space, such as cached surfaces.
+ * The address space is split in fixed-size blocks, and every value is stored in the bucket of each
+ * block its range touches, so finding the values overlapping a range only needs to look at the
+ * buckets of that range. The index also counts the values touching each page, to report the pages
+ * which start or stop being covered.
+ * The index must not be modified while it is being iterated by ForEach.
+ */
+template <typename Value>
+class SurfaceIndex : NonCopyable {
+public:
+    /**
+     * Adds a value covering [start, end).
+     * @param on_pages_used Called with the address and size of each run of pages which weren't
+     * touched by any value before
+     */
+    template <typename Func>
+    void Insert(PAddr start, PAddr end, const Value& value, Func&& on_pages_used) {
+        ASSERT(start < end);
+        for (u32 block = start >> BLOCK_BITS; block <= (end - 1) >> BLOCK_BITS; ++block) {
+            GetBucket(block).push_back({start, end, value});
+        }
+        UpdatePageCounts(start, end, 1, on_pages_used);
+        ++num_values;
+    }
+
+    /**
+     * Removes a value previously added with the same range.
+     * @param on_pages_unused Called with the address and size of each run of pages which aren't
+     * touched by any value anymore
+     */
+    template <typename Func>
+    void Erase(PAddr start, PAddr end, const Value& value, Func&& on_pages_unused) {
+        ASSERT(start < end);
+        for (u32 block = start >> BLOCK_BITS; block <= (end - 1) >> BLOCK_BITS; ++block) {
+            Bucket& bucket = GetBucket(block);
+            const auto it = std::find_if(bucket.begin(), bucket.end(),
+                                         [&](const Entry& entry) { return entry.value == value; });
+            ASSERT(it != bucket.end());
+            // Keep the order of the bucket, it decides between equivalent matches
+            bucket.erase(it);
+        }
+        UpdatePageCounts(start, end, -1, on_pages_unused);
+        --num_values;
+    }
+
+    /// Calls func once for each value whose range overlaps [start, end)
+    template <typename Func>
+    void ForEach(PAddr start, PAddr end, Func&& func) const {
+        if (start >= end)
+            return;
+
+        const u32 first_block = start >> BLOCK_BITS;
+        const u32 last_block = (end - 1) >> BLOCK_BITS;
+        for (u32 block = first_block; block <= last_block; ++block) {
+            const auto& chunk = chunks[block / BLOCKS_PER_CHUNK];
+            if (chunk == nullptr) {
+                // Skip to the last block of the chunk
+                block |= BLOCKS_PER_CHUNK - 1;
+                continue;
+            }
+
+            for (const Entry& entry : chunk->buckets[block % BLOCKS_PER_CHUNK]) {
+                if (entry.end <= start || entry.start >= end)
+                    continue;
+                // A value is in the buckets of all its blocks, only visit it in the first one
+                // which is part of the range
+                if (std::max(entry.start >> BLOCK_BITS, first_block) != block)
+                    continue;
+                func(entry.value);
+            }
+        }
+    }
+
+    bool Empty() const {
+        return num_values == 0;
+    }
+
+    std::size_t Size() const {
+        return num_values;
+    }
+
+private:
+    struct Entry {
+        PAddr start;
+        PAddr end;
+        Value value;
+    };
+    using Bucket = std::vector<Entry>;
+
+    /// Size of the blocks, a trade-off between the number of buckets holding the large surfaces
+    /// and the number of small surfaces sharing a bucket
+    static constexpr u32 BLOCK_BITS = 16;
+    /// Buckets and page counts are allocated in chunks covering a part of the address space
+    static constexpr u32 CHUNK_BITS = 22;
+    static constexpr u32 BLOCKS_PER_CHUNK = 1 << (CHUNK_BITS - BLOCK_BITS);
+    static constexpr u32 PAGES_PER_CHUNK = 1 << (CHUNK_BITS - Memory::PAGE_BITS);
+    static constexpr std::size_t NUM_CHUNKS = std::size_t{1} << (32 - CHUNK_BITS);
+
+    struct Chunk {
+        std::array<Bucket, BLOCKS_PER_CHUNK> buckets;
+        std::array<u32, PAGES_PER_CHUNK> page_counts{};
+    };
+
+    Chunk& GetChunk(u32 chunk_index) {
+        auto& chunk = chunks[chunk_index];
+        if (chunk == nullptr)
+            chunk = std::make_unique<Chunk>();
+        return *chunk;
+    }
+
+    Bucket& GetBucket(u32 block) {
+        return GetChunk(block / BLOCKS_PER_CHUNK).buckets[block % BLOCKS_PER_CHUNK];
+    }
+
+    /**
+     * Adds delta to the count of the pages touched by [start, end), and calls on_run with the
+     * address and size of each run of consecutive pages whose count went from or to zero.
+     */
+    template <typename Func>
+    void UpdatePageCounts(PAddr start, PAddr end, int delta, Func&& on_run) {
+        const u32 first_page = start >> Memory::PAGE_BITS;
+        const u32 last_page = (end - 1) >> Memory::PAGE_BITS;
+
+        u32 run_start = 0;
+        u32 run_length = 0;
+        for (u32 page = first_page; page <= last_page; ++page) {
+            u32& count = GetChunk(page / PAGES_PER_CHUNK).page_counts[page % PAGES_PER_CHUNK];
+            ASSERT(delta > 0 || count > 0);
+            count += delta;
+
+            if (count == (delta > 0 ? 1 : 0)) {
+                if (run_length == 0)
+                    run_start = page;
+                ++run_length;
+            } else if (run_length != 0) {
+                on_run(run_start << Memory::PAGE_BITS, run_length << Memory::PAGE_BITS);
+                run_length = 0;
+            }
+        }
+        if (run_length != 0)
+            on_run(run_start << Memory::PAGE_BITS, run_length << Memory::PAGE_BITS);
+    }
+
+    std::array<std::unique_ptr<Chunk>, NUM_CHUNKS> chunks;
+    std::size_t num_values = 0;
+};
@@ -7,6 +7,9 @@
 #include "common/bit_set.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_rasterizer.h"
 #include "video_core/regs_shader.h"
@@ -147,6 +150,13 @@ ShaderEngine* GetEngine() {
     if (VideoCore::g_shader_jit_enabled) {
         if (jit_engine == nullptr) {
             jit_engine = std::make_unique<JitX64Engine>();
+
+            u64 program_id;
+            auto& system = Core::System::GetInstance();
+            if (Settings::values.use_disk_shader_cache && system.IsPoweredOn() &&
+                system.GetAppLoader().ReadProgramId(program_id) == Loader::ResultStatus::Success) {
+                jit_engine->LoadDiskCache(program_id);
+            }
         }
         return jit_engine.get();
     }
@@ -2,6 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <vector>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
@@ -10,9 +16,82 @@
 namespace Pica {
 namespace Shader {
 
+/// Version of the on-disk cache format, bump this whenever the layout of the entries changes
+constexpr u32 DISK_CACHE_VERSION = 1;
+
+template <std::size_t N>
+static u64 ComputeCacheHash(const std::array<u32, N>& data) {
+    return Common::ComputeHash64(data.data(), sizeof(data));
+}
+
+/// Returns the number of words in data up to and including the last non-zero one
+template <std::size_t N>
+static u32 GetUsedLength(const std::array<u32, N>& data) {
+    auto last = std::find_if(data.rbegin(), data.rend(), [](u32 word) { return word != 0; });
+    return static_cast<u32>(std::distance(last, data.rend()));
+}
+
+class JitX64Engine::DiskCacheReader final : public LinearDiskCacheReader<u64, u32> {
+public:
+    explicit DiskCacheReader(JitX64Engine& engine) : engine(engine) {}
+
+    void Read(const u64& key, const u32* value, u32 value_size) override {
+        if (value_size == 0 || value[0] > MAX_PROGRAM_CODE_LENGTH ||
+            value_size - 1 - value[0] > MAX_SWIZZLE_DATA_LENGTH) {
+            LOG_WARNING(HW_GPU, "Skipping malformed shader cache entry {:016X}", key);
+            return;
+        }
+
+        const u32 code_length = value[0];
+        const u32 swizzle_length = value_size - 1 - code_length;
+        program_code.fill(0);
+        swizzle_data.fill(0);
+        std::copy_n(value + 1, code_length, program_code.begin());
+        std::copy_n(value + 1 + code_length, swizzle_length, swizzle_data.begin());
+
+        // Entries written by another version of the hash function would never be looked up again
+        if (key != (ComputeCacheHash(program_code) ^ ComputeCacheHash(swizzle_data))) {
+            LOG_WARNING(HW_GPU, "Skipping stale shader cache entry {:016X}", key);
+            return;
+        }
+
+        if (engine.cache.find(key) == engine.cache.end()) {
+            engine.Compile(key, program_code, swizzle_data);
+        }
+    }
+
+private:
+    JitX64Engine& engine;
+    std::array<u32, MAX_PROGRAM_CODE_LENGTH> program_code;
+    std::array<u32, MAX_SWIZZLE_DATA_LENGTH> swizzle_data;
+};
+
 JitX64Engine::JitX64Engine() = default;
 JitX64Engine::~JitX64Engine() = default;
 
+void JitX64Engine::LoadDiskCache(u64 program_id) {
+    const std::string& dir = FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir);
+    if (!FileUtil::CreateFullPath(dir)) {
+        LOG_ERROR(HW_GPU, "Failed to create shader cache directory {}", dir);
+        return;
+    }
+
+    const std::string path = fmt::format("{}{:016X}_jit.bin", dir, program_id);
+    DiskCacheReader reader(*this);
+    const u32 num_entries = disk_cache.OpenAndRead(path, DISK_CACHE_VERSION, reader);
+    LOG_INFO(HW_GPU, "Loaded {} shader programs from {}", num_entries, path);
+}
+
+JitShader* JitX64Engine::Compile(u64 cache_key,
+                                 const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data) {
+    auto shader = std::make_unique<JitShader>();
+    shader->Compile(&program_code, &swizzle_data);
+    JitShader* compiled = shader.get();
+    cache.emplace(cache_key, std::move(shader));
+    return compiled;
+}
+
 void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
@@ -24,11 +103,23 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     auto iter = cache.find(cache_key);
     if (iter != cache.end()) {
         setup.engine_data.cached_shader = iter->second.get();
-    } else {
-        auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.engine_data.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        return;
+    }
+
+    setup.engine_data.cached_shader = Compile(cache_key, setup.program_code, setup.swizzle_data);
+
+    if (disk_cache.IsOpen()) {
+        const u32 code_length = GetUsedLength(setup.program_code);
+        const u32 swizzle_length = GetUsedLength(setup.swizzle_data);
+        std::vector<u32> entry;
+        entry.reserve(1 + code_length + swizzle_length);
+        entry.push_back(code_length);
+        entry.insert(entry.end(), setup.program_code.begin(),
+                     setup.program_code.begin() + code_length);
+        entry.insert(entry.end(), setup.swizzle_data.begin(),
+                     setup.swizzle_data.begin() + swizzle_length);
+        disk_cache.Append(cache_key, entry.data(), static_cast<u32>(entry.size()));
+        disk_cache.Sync();
     }
 }
 
@@ -7,6 +7,7 @@
 #include <memory>
 #include <unordered_map>
 #include "common/common_types.h"
+#include "common/linear_disk_cache.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica {
@@ -19,11 +20,27 @@ public:
     JitX64Engine();
     ~JitX64Engine() override;
 
+    /**
+     * Opens the on-disk shader cache of a title and compiles every program recorded in it, so that
+     * these don't need to be compiled on first use. Programs compiled afterwards are appended to
+     * the cache.
+     * @param program_id Program ID of the running title, used to name the cache file
+     */
+    void LoadDiskCache(u64 program_id);
+
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
 
 private:
+    class DiskCacheReader;
+
+    JitShader* Compile(u64 cache_key, const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                       const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data);
+
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+
+    /// Programs are stored as [program code length, program code..., swizzle data...]
+    LinearDiskCache<u64, u32> disk_cache;
 };
 
 } // namespace Shader
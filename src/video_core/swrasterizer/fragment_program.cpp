@@ -0,0 +1,108 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <unordered_map>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "video_core/swrasterizer/fragment_program.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+FragmentConfig FragmentConfig::BuildFromRegs(const Regs& regs) {
+    FragmentConfig res;
+    auto& state = res.state;
+
+    const auto tev_stages = regs.texturing.GetTevStages();
+    for (std::size_t i = 0; i < tev_stages.size(); ++i) {
+        state.tev_sources_raw[i] = tev_stages[i].sources_raw;
+        state.tev_modifiers_raw[i] = tev_stages[i].modifiers_raw;
+        state.tev_ops_raw[i] = tev_stages[i].ops_raw;
+    }
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    state.alpha_test_func = output_merger.alpha_test.func;
+    state.stencil_test_func = output_merger.stencil_test.func;
+    state.stencil_fail_action = output_merger.stencil_test.action_stencil_fail;
+    state.depth_fail_action = output_merger.stencil_test.action_depth_fail;
+    state.depth_pass_action = output_merger.stencil_test.action_depth_pass;
+    state.depth_test_func = output_merger.depth_test_func;
+
+    const auto& blending = output_merger.alpha_blending;
+    state.blend_factor_source_rgb = blending.factor_source_rgb;
+    state.blend_factor_source_a = blending.factor_source_a;
+    state.blend_factor_dest_rgb = blending.factor_dest_rgb;
+    state.blend_factor_dest_a = blending.factor_dest_a;
+    state.blend_equation_rgb = blending.blend_equation_rgb;
+    state.blend_equation_a = blending.blend_equation_a;
+    state.logic_op = output_merger.logic_op;
+
+    return res;
+}
+
+static bool IsValidTevSource(TexturingRegs::TevStageConfig::Source source) {
+    using Source = TexturingRegs::TevStageConfig::Source;
+    return source <= Source::Texture3 || source >= Source::PreviousBuffer;
+}
+
+FragmentProgram::FragmentProgram(const FragmentConfig& config) {
+    const auto& state = config.state;
+
+    for (std::size_t i = 0; i < tev_stages.size(); ++i) {
+        TexturingRegs::TevStageConfig stage;
+        stage.sources_raw = state.tev_sources_raw[i];
+        stage.modifiers_raw = state.tev_modifiers_raw[i];
+        stage.ops_raw = state.tev_ops_raw[i];
+
+        // The rasterizer reads invalid sources as zero
+        for (const auto source : {stage.color_source1.Value(), stage.color_source2.Value(),
+                                  stage.color_source3.Value(), stage.alpha_source1.Value(),
+                                  stage.alpha_source2.Value(), stage.alpha_source3.Value()}) {
+            if (!IsValidTevSource(source)) {
+                LOG_ERROR(HW_GPU, "Unknown color combiner source {}", static_cast<int>(source));
+                UNIMPLEMENTED();
+            }
+        }
+
+        auto& program = tev_stages[i];
+        program.color_modifiers = {{GetColorModifierFunction(stage.color_modifier1),
+                                    GetColorModifierFunction(stage.color_modifier2),
+                                    GetColorModifierFunction(stage.color_modifier3)}};
+        program.alpha_modifiers = {{GetAlphaModifierFunction(stage.alpha_modifier1),
+                                    GetAlphaModifierFunction(stage.alpha_modifier2),
+                                    GetAlphaModifierFunction(stage.alpha_modifier3)}};
+        program.color_combine = GetColorCombineFunction(stage.color_op);
+        program.alpha_combine = GetAlphaCombineFunction(stage.alpha_op);
+    }
+
+    alpha_test = GetCompareFunction(state.alpha_test_func);
+    stencil_test = GetCompareFunction(state.stencil_test_func);
+    stencil_fail_action = GetStencilActionFunction(state.stencil_fail_action);
+    depth_fail_action = GetStencilActionFunction(state.depth_fail_action);
+    depth_pass_action = GetStencilActionFunction(state.depth_pass_action);
+    depth_test = GetCompareFunction(state.depth_test_func);
+
+    blend_factor_source_rgb = GetBlendFactorFunction(state.blend_factor_source_rgb);
+    blend_factor_source_a = GetBlendFactorFunction(state.blend_factor_source_a);
+    blend_factor_dest_rgb = GetBlendFactorFunction(state.blend_factor_dest_rgb);
+    blend_factor_dest_a = GetBlendFactorFunction(state.blend_factor_dest_a);
+    blend_equation_rgb = GetBlendEquationFunction(state.blend_equation_rgb);
+    blend_equation_a = GetBlendEquationFunction(state.blend_equation_a);
+    logic_op = GetLogicOpFunction(state.logic_op);
+}
+
+const FragmentProgram& GetFragmentProgram(const FragmentConfig& config) {
+    static std::unordered_map<FragmentConfig, FragmentProgram> program_cache;
+
+    auto it = program_cache.find(config);
+    if (it == program_cache.end()) {
+        it = program_cache.emplace(config, FragmentProgram(config)).first;
+        LOG_DEBUG(HW_GPU, "Built fragment program {} for config {:016X}", program_cache.size(),
+                  config.Hash());
+    }
+    return it->second;
+}
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -0,0 +1,95 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/regs.h"
+#include "video_core/swrasterizer/framebuffer.h"
+#include "video_core/swrasterizer/texturing.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+struct FragmentConfigState {
+    std::array<u32, 6> tev_sources_raw;
+    std::array<u32, 6> tev_modifiers_raw;
+    std::array<u32, 6> tev_ops_raw;
+
+    FramebufferRegs::CompareFunc alpha_test_func;
+    FramebufferRegs::CompareFunc stencil_test_func;
+    FramebufferRegs::StencilAction stencil_fail_action;
+    FramebufferRegs::StencilAction depth_fail_action;
+    FramebufferRegs::StencilAction depth_pass_action;
+    FramebufferRegs::CompareFunc depth_test_func;
+
+    FramebufferRegs::BlendFactor blend_factor_source_rgb;
+    FramebufferRegs::BlendFactor blend_factor_source_a;
+    FramebufferRegs::BlendFactor blend_factor_dest_rgb;
+    FramebufferRegs::BlendFactor blend_factor_dest_a;
+    FramebufferRegs::BlendEquation blend_equation_rgb;
+    FramebufferRegs::BlendEquation blend_equation_a;
+    FramebufferRegs::LogicOp logic_op;
+};
+
+/**
+ * The register state a FragmentProgram is specialized for, used as the key of the program cache.
+ * Values that do not change the code path taken by a fragment, such as reference values or
+ * constant colors, are not part of it and are read from the registers by the rasterizer.
+ */
+struct FragmentConfig : Common::HashableStruct<FragmentConfigState> {
+    static FragmentConfig BuildFromRegs(const Regs& regs);
+};
+
+/**
+ * The per-fragment operations of the combiners and the output merger, specialized for a register
+ * configuration so that the rasterizer does not branch on the configuration for every fragment.
+ */
+struct FragmentProgram {
+    explicit FragmentProgram(const FragmentConfig& config);
+
+    struct TevStage {
+        std::array<ColorModifierFunction, 3> color_modifiers;
+        std::array<AlphaModifierFunction, 3> alpha_modifiers;
+        ColorCombineFunction color_combine;
+        AlphaCombineFunction alpha_combine;
+    };
+    std::array<TevStage, 6> tev_stages;
+
+    CompareFunction alpha_test;
+    CompareFunction stencil_test;
+    StencilActionFunction stencil_fail_action;
+    StencilActionFunction depth_fail_action;
+    StencilActionFunction depth_pass_action;
+    CompareFunction depth_test;
+
+    BlendFactorFunction blend_factor_source_rgb;
+    BlendFactorFunction blend_factor_source_a;
+    BlendFactorFunction blend_factor_dest_rgb;
+    BlendFactorFunction blend_factor_dest_a;
+    BlendEquationFunction blend_equation_rgb;
+    BlendEquationFunction blend_equation_a;
+    LogicOpFunction logic_op;
+};
+
+/**
+ * Returns the program for the given configuration, building it on first use. The returned
+ * reference stays valid for the lifetime of the emulator.
+ */
+const FragmentProgram& GetFragmentProgram(const FragmentConfig& config);
+
+} // namespace Rasterizer
+} // namespace Pica
+
+namespace std {
+template <>
+struct hash<Pica::Rasterizer::FragmentConfig> {
+    std::size_t operator()(const Pica::Rasterizer::FragmentConfig& k) const {
+        return k.Hash();
+    }
+};
+} // namespace std
@@ -13,6 +13,7 @@
 #include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/swrasterizer/framebuffer.h"
+#include "video_core/swrasterizer/specialization.h"
 #include "video_core/utils.h"
 
 namespace Pica {
@@ -357,6 +358,99 @@ u8 LogicOp(u8 src, u8 dest, FramebufferRegs::LogicOp op) {
     UNREACHABLE();
 };
 
+bool Compare(FramebufferRegs::CompareFunc func, u32 value, u32 ref) {
+    switch (func) {
+    case FramebufferRegs::CompareFunc::Never:
+        return false;
+
+    case FramebufferRegs::CompareFunc::Always:
+        return true;
+
+    case FramebufferRegs::CompareFunc::Equal:
+        return value == ref;
+
+    case FramebufferRegs::CompareFunc::NotEqual:
+        return value != ref;
+
+    case FramebufferRegs::CompareFunc::LessThan:
+        return value < ref;
+
+    case FramebufferRegs::CompareFunc::LessThanOrEqual:
+        return value <= ref;
+
+    case FramebufferRegs::CompareFunc::GreaterThan:
+        return value > ref;
+
+    case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+        return value >= ref;
+    }
+
+    return false;
+}
+
+u8 LookupBlendFactor(FramebufferRegs::BlendFactor factor, unsigned channel,
+                     const Math::Vec4<u8>& src, const Math::Vec4<u8>& dest,
+                     const Math::Vec4<u8>& blend_const) {
+    DEBUG_ASSERT(channel < 4);
+
+    switch (factor) {
+    case FramebufferRegs::BlendFactor::Zero:
+        return 0;
+
+    case FramebufferRegs::BlendFactor::One:
+        return 255;
+
+    case FramebufferRegs::BlendFactor::SourceColor:
+        return src[channel];
+
+    case FramebufferRegs::BlendFactor::OneMinusSourceColor:
+        return 255 - src[channel];
+
+    case FramebufferRegs::BlendFactor::DestColor:
+        return dest[channel];
+
+    case FramebufferRegs::BlendFactor::OneMinusDestColor:
+        return 255 - dest[channel];
+
+    case FramebufferRegs::BlendFactor::SourceAlpha:
+        return src.a();
+
+    case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
+        return 255 - src.a();
+
+    case FramebufferRegs::BlendFactor::DestAlpha:
+        return dest.a();
+
+    case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
+        return 255 - dest.a();
+
+    case FramebufferRegs::BlendFactor::ConstantColor:
+        return blend_const[channel];
+
+    case FramebufferRegs::BlendFactor::OneMinusConstantColor:
+        return 255 - blend_const[channel];
+
+    case FramebufferRegs::BlendFactor::ConstantAlpha:
+        return blend_const.a();
+
+    case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
+        return 255 - blend_const.a();
+
+    case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
+        // Returns 1.0 for the alpha channel
+        if (channel == 3)
+            return 255;
+        return std::min(src.a(), static_cast<u8>(255 - dest.a()));
+
+    default:
+        LOG_CRITICAL(HW_GPU, "Unknown blend factor {:x}", static_cast<u32>(factor));
+        UNIMPLEMENTED();
+        break;
+    }
+
+    return src[channel];
+}
+
 // Decode/Encode for shadow map format. It is similar to D24S8 format, but the depth field is in
 // big-endian
 static const Math::Vec2<u32> DecodeD24S8Shadow(const u8* bytes) {
@@ -406,5 +500,65 @@ void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil) {
     }
 }
 
+template <u32 func>
+struct CompareSpecialization {
+    static bool Run(u32 value, u32 ref) {
+        return Compare(static_cast<FramebufferRegs::CompareFunc>(func), value, ref);
+    }
+};
+
+template <u32 action>
+struct StencilActionSpecialization {
+    static u8 Run(u8 old_stencil, u8 ref) {
+        return PerformStencilAction(static_cast<FramebufferRegs::StencilAction>(action),
+                                    old_stencil, ref);
+    }
+};
+
+template <u32 factor>
+struct BlendFactorSpecialization {
+    static u8 Run(unsigned channel, const Math::Vec4<u8>& src, const Math::Vec4<u8>& dest,
+                  const Math::Vec4<u8>& blend_const) {
+        return LookupBlendFactor(static_cast<FramebufferRegs::BlendFactor>(factor), channel, src,
+                                 dest, blend_const);
+    }
+};
+
+template <u32 equation>
+struct BlendEquationSpecialization {
+    static Math::Vec4<u8> Run(const Math::Vec4<u8>& src, const Math::Vec4<u8>& srcfactor,
+                              const Math::Vec4<u8>& dest, const Math::Vec4<u8>& destfactor) {
+        return EvaluateBlendEquation(src, srcfactor, dest, destfactor,
+                                     static_cast<FramebufferRegs::BlendEquation>(equation));
+    }
+};
+
+template <u32 op>
+struct LogicOpSpecialization {
+    static u8 Run(u8 src, u8 dest) {
+        return LogicOp(src, dest, static_cast<FramebufferRegs::LogicOp>(op));
+    }
+};
+
+CompareFunction GetCompareFunction(FramebufferRegs::CompareFunc func) {
+    return GetSpecialization<3, CompareSpecialization>(func);
+}
+
+StencilActionFunction GetStencilActionFunction(FramebufferRegs::StencilAction action) {
+    return GetSpecialization<3, StencilActionSpecialization>(action);
+}
+
+BlendFactorFunction GetBlendFactorFunction(FramebufferRegs::BlendFactor factor) {
+    return GetSpecialization<4, BlendFactorSpecialization>(factor);
+}
+
+BlendEquationFunction GetBlendEquationFunction(FramebufferRegs::BlendEquation equation) {
+    return GetSpecialization<3, BlendEquationSpecialization>(equation);
+}
+
+LogicOpFunction GetLogicOpFunction(FramebufferRegs::LogicOp op) {
+    return GetSpecialization<4, LogicOpSpecialization>(op);
+}
+
 } // namespace Rasterizer
 } // namespace Pica
@@ -25,7 +25,45 @@ Math::Vec4<u8> EvaluateBlendEquation(const Math::Vec4<u8>& src, const Math::Vec4
 
 u8 LogicOp(u8 src, u8 dest, FramebufferRegs::LogicOp op);
 
+/// Returns whether the comparison "value <func> ref" holds
+bool Compare(FramebufferRegs::CompareFunc func, u32 value, u32 ref);
+
+/**
+ * Returns the given blend factor for a channel of the fragment.
+ * @param src Color output by the combiners
+ * @param dest Color currently in the framebuffer
+ * @param blend_const Blend constant color
+ */
+u8 LookupBlendFactor(FramebufferRegs::BlendFactor factor, unsigned channel,
+                     const Math::Vec4<u8>& src, const Math::Vec4<u8>& dest,
+                     const Math::Vec4<u8>& blend_const);
+
 void DrawShadowMapPixel(int x, int y, u32 depth, u8 stencil);
 
+using CompareFunction = bool (*)(u32 value, u32 ref);
+using StencilActionFunction = u8 (*)(u8 old_stencil, u8 ref);
+using BlendFactorFunction = u8 (*)(unsigned channel, const Math::Vec4<u8>& src,
+                                   const Math::Vec4<u8>& dest, const Math::Vec4<u8>& blend_const);
+using BlendEquationFunction = Math::Vec4<u8> (*)(const Math::Vec4<u8>& src,
+                                                 const Math::Vec4<u8>& srcfactor,
+                                                 const Math::Vec4<u8>& dest,
+                                                 const Math::Vec4<u8>& destfactor);
+using LogicOpFunction = u8 (*)(u8 src, u8 dest);
+
+/// Returns Compare specialized for the given function
+CompareFunction GetCompareFunction(FramebufferRegs::CompareFunc func);
+
+/// Returns PerformStencilAction specialized for the given action
+StencilActionFunction GetStencilActionFunction(FramebufferRegs::StencilAction action);
+
+/// Returns LookupBlendFactor specialized for the given factor
+BlendFactorFunction GetBlendFactorFunction(FramebufferRegs::BlendFactor factor);
+
+/// Returns EvaluateBlendEquation specialized for the given equation
+BlendEquationFunction GetBlendEquationFunction(FramebufferRegs::BlendEquation equation);
+
+/// Returns LogicOp specialized for the given operation
+LogicOpFunction GetLogicOpFunction(FramebufferRegs::LogicOp op);
+
 } // namespace Rasterizer
 } // namespace Pica
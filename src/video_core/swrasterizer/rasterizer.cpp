@@ -4,15 +4,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <tuple>
+#include <vector>
 #include "common/assert.h"
 #include "common/bit_field.h"
+#include "common/bit_set.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/quaternion.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
@@ -23,10 +27,12 @@
 #include "video_core/regs_rasterizer.h"
 #include "video_core/regs_texturing.h"
 #include "video_core/shader/shader.h"
+#include "video_core/swrasterizer/fragment_program.h"
 #include "video_core/swrasterizer/framebuffer.h"
 #include "video_core/swrasterizer/lighting.h"
 #include "video_core/swrasterizer/proctex.h"
 #include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/swrasterizer/span.h"
 #include "video_core/swrasterizer/texturing.h"
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
@@ -119,6 +125,67 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+/// Scissor box in 12.4 fixed point, x2 and y2 being exclusive
+struct ScissorBox {
+    u16 x1;
+    u16 y1;
+    u16 x2;
+    u16 y2;
+};
+
+static ScissorBox GetScissorBox(const RasterizerRegs& regs) {
+    // x2,y2 have +1 added to cover the entire sub-pixel area
+    return {static_cast<u16>(regs.scissor_test.x1 << 4),
+            static_cast<u16>(regs.scissor_test.y1 << 4),
+            static_cast<u16>((regs.scissor_test.x2 + 1) << 4),
+            static_cast<u16>((regs.scissor_test.y2 + 1) << 4)};
+}
+
+/// A triangle which passed culling, along with the setup data shared by all the pixels it covers
+struct Triangle {
+    Triangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) : v0(v0), v1(v1), v2(v2) {}
+
+    Vertex v0;
+    Vertex v1;
+    Vertex v2;
+    Math::Vec3<Fix12P4> vtxpos[3];
+    int bias0;
+    int bias1;
+    int bias2;
+    const FragmentProgram* program;
+
+    // Bounding box in 12.4 fixed point, aligned to pixel boundaries and clipped to the scissor box
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
+
+/// Size of the screen tiles triangles are binned into, in pixels
+constexpr unsigned TILE_SIZE = 32;
+/// Draws whose triangles cover fewer pixels than this in total are rasterized on a single thread
+constexpr std::size_t MIN_PARALLEL_AREA = 128 * 128;
+
+/// Triangles of the current draw, in submission order, waiting for Flush to rasterize them
+static std::vector<Triangle> queued_triangles;
+/// Indices into queued_triangles of the triangles overlapping each screen tile, in order
+static std::vector<std::vector<u32>> tile_bins;
+/// Tiles with a non-empty bin
+static std::vector<u32> active_tiles;
+
+/// Configuration of the fragment program used by the last submitted triangle
+static FragmentConfig current_fragment_config;
+static const FragmentProgram* current_fragment_program = nullptr;
+
+/// Whether triangles are binned and rasterized in Flush rather than as soon as they are submitted
+static bool IsBinningEnabled() {
+    // The debugger expects the framebuffer to be up to date at each of its breakpoints
+    return !g_debug_context && Common::ThreadPool::GetShared().GetNumThreads() > 0;
+}
+
+static void RasterizeTriangle(const Triangle& triangle, u16 min_x, u16 min_y, u16 max_x,
+                              u16 max_y);
+
 /**
  * Helper function for ProcessTriangle with the "reversed" flag to allow for implementing
  * culling via recursion.
@@ -165,19 +232,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
     u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
 
-    // Convert the scissor box coordinates to 12.4 fixed point
-    u16 scissor_x1 = (u16)(regs.rasterizer.scissor_test.x1 << 4);
-    u16 scissor_y1 = (u16)(regs.rasterizer.scissor_test.y1 << 4);
-    // x2,y2 have +1 added to cover the entire sub-pixel area
-    u16 scissor_x2 = (u16)((regs.rasterizer.scissor_test.x2 + 1) << 4);
-    u16 scissor_y2 = (u16)((regs.rasterizer.scissor_test.y2 + 1) << 4);
-
     if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
         // Calculate the new bounds
-        min_x = std::max(min_x, scissor_x1);
-        min_y = std::max(min_y, scissor_y1);
-        max_x = std::min(max_x, scissor_x2);
-        max_y = std::min(max_y, scissor_y2);
+        const ScissorBox scissor = GetScissorBox(regs.rasterizer);
+        min_x = std::max(min_x, scissor.x1);
+        min_y = std::max(min_y, scissor.y1);
+        max_x = std::min(max_x, scissor.x2);
+        max_y = std::min(max_y, scissor.y2);
     }
 
     min_x &= Fix12P4::IntMask();
@@ -185,6 +246,9 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
 
+    if (min_x >= max_x || min_y >= max_y)
+        return;
+
     // Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
     // drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
     // values which are added to the barycentric coordinates w0, w1 and w2, respectively.
@@ -203,45 +267,239 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                                                    ((int)line2.y - (int)line1.y);
         }
     };
-    int bias0 =
+    Triangle triangle(v0, v1, v2);
+    std::copy(std::begin(vtxpos), std::end(vtxpos), std::begin(triangle.vtxpos));
+    triangle.bias0 =
         IsRightSideOrFlatBottomEdge(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) ? -1 : 0;
-    int bias1 =
+    triangle.bias1 =
         IsRightSideOrFlatBottomEdge(vtxpos[1].xy(), vtxpos[2].xy(), vtxpos[0].xy()) ? -1 : 0;
-    int bias2 =
+    triangle.bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
+    triangle.min_x = min_x;
+    triangle.min_y = min_y;
+    triangle.max_x = max_x;
+    triangle.max_y = max_y;
+
+    // Only look the program up in the cache when the configuration changed since the last triangle
+    const FragmentConfig fragment_config = FragmentConfig::BuildFromRegs(regs);
+    if (current_fragment_program == nullptr || fragment_config != current_fragment_config) {
+        current_fragment_config = fragment_config;
+        current_fragment_program = &GetFragmentProgram(fragment_config);
+    }
+    triangle.program = current_fragment_program;
+
+    if (IsBinningEnabled()) {
+        queued_triangles.push_back(std::move(triangle));
+    } else {
+        RasterizeTriangle(triangle, min_x, min_y, max_x, max_y);
+    }
+}
+
+/**
+ * Keeps the last decoded tiles of a texture while a triangle is rasterized. A tile is only decoded
+ * as a whole once it is sampled a second time, so that minified textures, which rarely sample the
+ * same tile twice in a row, keep decoding single texels.
+ */
+class TextureTileCache {
+public:
+    Math::Vec4<u8> LookupTexture(const u8* source, unsigned int s, unsigned int t,
+                                 const Texture::TextureInfo& info) {
+        const unsigned int coarse_s = s / 8;
+        const unsigned int coarse_t = t / 8;
+        const u8* tile = source + coarse_t * info.stride +
+                         coarse_s * Texture::CalculateTileSize(info.format);
+
+        // Neighbouring tiles use different entries, so that sampling along tile edges hits
+        Entry& entry = entries[coarse_s % 2 + (coarse_t % 2) * 2];
+        if (entry.tile != tile) {
+            entry.tile = tile;
+            entry.decoded = false;
+            return Texture::LookupTexelInTile(tile, s % 8, t % 8, info, false);
+        }
+
+        if (!entry.decoded) {
+            Texture::DecodeTile(tile, info, entry.texels.data());
+            entry.decoded = true;
+        }
+        return entry.texels[(t % 8) * 8 + s % 8];
+    }
+
+private:
+    struct Entry {
+        const u8* tile = nullptr;
+        bool decoded = false;
+        std::array<Math::Vec4<u8>, 8 * 8> texels;
+    };
+
+    std::array<Entry, 4> entries;
+};
+
+/**
+ * Rasterizes the pixels of the given triangle which lie in the given rectangle, in 12.4 fixed point
+ * and aligned to pixel boundaries. Pixels are independent from each other, so disjoint rectangles
+ * of the screen may be rasterized concurrently.
+ */
+static void RasterizeTriangle(const Triangle& triangle, u16 min_x, u16 min_y, u16 max_x,
+                              u16 max_y) {
+    const auto& regs = g_state.regs;
+    const Vertex& v0 = triangle.v0;
+    const Vertex& v1 = triangle.v1;
+    const Vertex& v2 = triangle.v2;
+    const auto& vtxpos = triangle.vtxpos;
+    const FragmentProgram& program = *triangle.program;
+    const ScissorBox scissor = GetScissorBox(regs.rasterizer);
 
     auto w_inverse = Math::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
 
     auto textures = regs.texturing.GetTextures();
     auto tev_stages = regs.texturing.GetTevStages();
 
+    // Texture memory is not written while the triangle is rasterized, so decoded tiles stay valid
+    std::array<TextureTileCache, 3> texture_caches;
+
     bool stencil_action_enable =
         g_state.regs.framebuffer.output_merger.stencil_test.enable &&
         g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
     const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
+    const auto& output_merger = regs.framebuffer.output_merger;
+
+    // Performs the stencil and depth tests of a fragment along with the resulting buffer updates,
+    // returns whether the fragment passed both
+    auto DepthStencilTest = [&](u16 x, u16 y, u32 z) {
+        u8 old_stencil = 0;
+
+        auto UpdateStencil = [stencil_test, x, y, &old_stencil](StencilActionFunction action) {
+            u8 new_stencil = action(old_stencil, stencil_test.reference_value);
+            if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
+                SetStencil(x >> 4, y >> 4,
+                           (new_stencil & stencil_test.write_mask) |
+                               (old_stencil & ~stencil_test.write_mask));
+        };
+
+        if (stencil_action_enable) {
+            old_stencil = GetStencil(x >> 4, y >> 4);
+            u8 dest = old_stencil & stencil_test.input_mask;
+            u8 ref = stencil_test.reference_value & stencil_test.input_mask;
+
+            if (!program.stencil_test(ref, dest)) {
+                UpdateStencil(program.stencil_fail_action);
+                return false;
+            }
+        }
+
+        if (output_merger.depth_test_enable) {
+            u32 ref_z = GetDepth(x >> 4, y >> 4);
+            if (!program.depth_test(z, ref_z)) {
+                if (stencil_action_enable)
+                    UpdateStencil(program.depth_fail_action);
+                return false;
+            }
+        }
+
+        if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
+            output_merger.depth_write_enable) {
+
+            SetDepth(x >> 4, y >> 4, z);
+        }
+
+        // The stencil depth_pass action is executed even if depth testing is disabled
+        if (stencil_action_enable)
+            UpdateStencil(program.depth_pass_action);
+
+        return true;
+    };
+
+    // The stencil and depth tests only depend on the fragment depth. Unless the fragment may still
+    // be discarded or bypass them, they can run before texturing and the combiners, which are then
+    // skipped for hidden fragments.
+    const bool early_depth_stencil =
+        output_merger.fragment_operation_mode != FramebufferRegs::FragmentOperationMode::Shadow &&
+        !output_merger.alpha_test.enable;
+
+    SpanSetup span_setup;
+    span_setup.w_step = {{
+        -0x10 * (vtxpos[2].y - vtxpos[1].y),
+        -0x10 * (vtxpos[0].y - vtxpos[2].y),
+        -0x10 * (vtxpos[1].y - vtxpos[0].y),
+    }};
+    span_setup.screen_z = {{v0.screenpos[2].ToFloat32(), v1.screenpos[2].ToFloat32(),
+                            v2.screenpos[2].ToFloat32()}};
+    span_setup.w_inverse = {{v0.pos.w, v1.pos.w, v2.pos.w}};
+    span_setup.depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    span_setup.depth_offset =
+        float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+    unsigned num_bits =
+        FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format);
+    span_setup.depth_max = static_cast<float>((1 << num_bits) - 1);
+    span_setup.w_buffer =
+        regs.rasterizer.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering;
+
+    const SpanKernel& span_kernel = GetSpanKernel(span_setup);
+    SpanResult span;
+    u32 coverage = 0;
+
+    AttributeSetup attribute_setup;
+    const std::array<const Vertex*, 3> vertices{{&v0, &v1, &v2}};
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex& v = *vertices[i];
+        attribute_setup.values[i] = {{v.color.r().ToFloat32(), v.color.g().ToFloat32(),
+                                      v.color.b().ToFloat32(), v.color.a().ToFloat32(),
+                                      v.tc0.u().ToFloat32(), v.tc0.v().ToFloat32(),
+                                      v.tc1.u().ToFloat32(), v.tc1.v().ToFloat32(),
+                                      v.tc2.u().ToFloat32(), v.tc2.v().ToFloat32(),
+                                      v.tc0_w.ToFloat32(), v.quat.x.ToFloat32(),
+                                      v.quat.y.ToFloat32(), v.quat.z.ToFloat32(),
+                                      v.quat.w.ToFloat32(), v.view.x.ToFloat32(),
+                                      v.view.y.ToFloat32(), v.view.z.ToFloat32()}};
+    }
+    const AttributeFunction interpolate_attributes = GetAttributeKernel();
+    AttributeValues attributes;
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
     for (u16 y = min_y + 8; y < max_y; y += 0x10) {
         for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+            const unsigned lane = ((x - min_x) >> 4) & (span_kernel.width - 1);
+            if (lane == 0) {
+                // Calculate the barycentric coordinates w0, w1 and w2 of the first pixel, and let
+                // the kernel derive the coverage and depth of the next pixels of the row from them
+                const std::array<s32, 3> w{{
+                    triangle.bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y}),
+                    triangle.bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y}),
+                    triangle.bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y}),
+                }};
+                const unsigned num_pixels =
+                    std::min<unsigned>(span_kernel.width, (max_x - x + 0xF) >> 4);
+                coverage = span_kernel.function(span_setup, w, num_pixels, span);
+
+                for (u32 pending = coverage; pending != 0; pending &= pending - 1) {
+                    const unsigned i = Common::LeastSignificantSetBit(pending);
+                    const u16 pixel_x = x + i * 0x10;
+
+                    // Do not process the pixel if it's inside the scissor box and the scissor
+                    // mode is set to Exclude
+                    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude &&
+                        pixel_x >= scissor.x1 && pixel_x < scissor.x2 && y >= scissor.y1 &&
+                        y < scissor.y2) {
+                        coverage &= ~(1u << i);
+                        continue;
+                    }
 
-            // Do not process the pixel if it's inside the scissor box and the scissor mode is set
-            // to Exclude
-            if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
-                if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2)
-                    continue;
+                    if (early_depth_stencil && !DepthStencilTest(pixel_x, y, span.z[i]))
+                        coverage &= ~(1u << i);
+                }
             }
 
-            // Calculate the barycentric coordinates w0, w1 and w2
-            int w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-            int w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-            int w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-            int wsum = w0 + w1 + w2;
-
             // If current pixel is not covered by the current primitive
-            if (w0 < 0 || w1 < 0 || w2 < 0)
+            if ((coverage & (1u << lane)) == 0)
                 continue;
 
+            const int w0 = span.w[0][lane];
+            const int w1 = span.w[1][lane];
+            const int w2 = span.w[2][lane];
+            const float depth = span.depth[lane];
+            const u32 z = span.z[lane];
+
             auto baricentric_coordinates =
                 Math::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
                               float24::FromFloat32(static_cast<float>(w1)),
@@ -249,29 +507,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             float24 interpolated_w_inverse =
                 float24::FromFloat32(1.0f) / Math::Dot(w_inverse, baricentric_coordinates);
 
-            // interpolated_z = z / w
-            float interpolated_z_over_w =
-                (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                 v2.screenpos[2].ToFloat32() * w2) /
-                wsum;
-
-            // Not fully accurate. About 3 bits in precision are missing.
-            // Z-Buffer (z / w * scale + offset)
-            float depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-            float depth_offset =
-                float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-            float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-            // Potentially switch to W-Buffer
-            if (regs.rasterizer.depthmap_enable ==
-                Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                depth *= interpolated_w_inverse.ToFloat32() * wsum;
-            }
-
-            // Clamp the result
-            depth = std::clamp(depth, 0.0f, 1.0f);
-
             // Perspective correct attribute interpolation:
             // Attribute values cannot be calculated by simple linear interpolation since
             // they are not linear in screen space. For example, when interpolating a
@@ -287,34 +522,33 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             //     u = u_over_w / one_over_w
             //
             // The generalization to three vertices is straightforward in baricentric coordinates.
-            auto GetInterpolatedAttribute = [&](float24 attr0, float24 attr1, float24 attr2) {
-                auto attr_over_w = Math::MakeVec(attr0, attr1, attr2);
-                float24 interpolated_attr_over_w = Math::Dot(attr_over_w, baricentric_coordinates);
-                return interpolated_attr_over_w * interpolated_w_inverse;
+            // All the attributes are interpolated at once by a vector kernel.
+            interpolate_attributes(
+                attribute_setup,
+                {{static_cast<float>(w0), static_cast<float>(w1), static_cast<float>(w2)}},
+                interpolated_w_inverse.ToFloat32(), attributes);
+            auto GetInterpolatedAttribute = [&attributes](Attribute attribute) {
+                return float24::FromFloat32(attributes[static_cast<std::size_t>(attribute)]);
             };
 
             Math::Vec4<u8> primary_color{
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.r(), v1.color.r(), v2.color.r()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.g(), v1.color.g(), v2.color.g()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.b(), v1.color.b(), v2.color.b()).ToFloat32() *
-                    255)),
-                static_cast<u8>(round(
-                    GetInterpolatedAttribute(v0.color.a(), v1.color.a(), v2.color.a()).ToFloat32() *
-                    255)),
+                static_cast<u8>(
+                    round(GetInterpolatedAttribute(Attribute::ColorR).ToFloat32() * 255)),
+                static_cast<u8>(
+                    round(GetInterpolatedAttribute(Attribute::ColorG).ToFloat32() * 255)),
+                static_cast<u8>(
+                    round(GetInterpolatedAttribute(Attribute::ColorB).ToFloat32() * 255)),
+                static_cast<u8>(
+                    round(GetInterpolatedAttribute(Attribute::ColorA).ToFloat32() * 255)),
             };
 
             Math::Vec2<float24> uv[3];
-            uv[0].u() = GetInterpolatedAttribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
-            uv[0].v() = GetInterpolatedAttribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
-            uv[1].u() = GetInterpolatedAttribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
-            uv[1].v() = GetInterpolatedAttribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
-            uv[2].u() = GetInterpolatedAttribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
-            uv[2].v() = GetInterpolatedAttribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+            uv[0].u() = GetInterpolatedAttribute(Attribute::Tc0U);
+            uv[0].v() = GetInterpolatedAttribute(Attribute::Tc0V);
+            uv[1].u() = GetInterpolatedAttribute(Attribute::Tc1U);
+            uv[1].v() = GetInterpolatedAttribute(Attribute::Tc1V);
+            uv[2].u() = GetInterpolatedAttribute(Attribute::Tc2U);
+            uv[2].v() = GetInterpolatedAttribute(Attribute::Tc2V);
 
             Math::Vec4<u8> texture_color[4]{};
             for (int i = 0; i < 3; ++i) {
@@ -339,19 +573,19 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                         break;
                     case TexturingRegs::TextureConfig::ShadowCube:
                     case TexturingRegs::TextureConfig::TextureCube: {
-                        auto w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+                        auto w = GetInterpolatedAttribute(Attribute::Tc0W);
                         std::tie(u, v, shadow_z, texture_address) =
                             ConvertCubeCoord(u, v, w, regs.texturing);
                         break;
                     }
                     case TexturingRegs::TextureConfig::Projection2D: {
-                        auto tc0_w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+                        auto tc0_w = GetInterpolatedAttribute(Attribute::Tc0W);
                         u /= tc0_w;
                         v /= tc0_w;
                         break;
                     }
                     case TexturingRegs::TextureConfig::Shadow2D: {
-                        auto tc0_w = GetInterpolatedAttribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+                        auto tc0_w = GetInterpolatedAttribute(Attribute::Tc0W);
                         if (!regs.texturing.shadow.orthographic) {
                             u /= tc0_w;
                             v /= tc0_w;
@@ -407,7 +641,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                         Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
 
                     // TODO: Apply the min and mag filters to the texture
-                    texture_color[i] = Texture::LookupTexture(texture_data, s, t, info);
+                    texture_color[i] = texture_caches[i].LookupTexture(texture_data, s, t, info);
                 }
 
                 if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -456,66 +690,48 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             if (!g_state.regs.lighting.disable) {
                 Math::Quaternion<float> normquat =
                     Math::Quaternion<float>{
-                        {GetInterpolatedAttribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
-                         GetInterpolatedAttribute(v0.quat.y, v1.quat.y, v2.quat.y).ToFloat32(),
-                         GetInterpolatedAttribute(v0.quat.z, v1.quat.z, v2.quat.z).ToFloat32()},
-                        GetInterpolatedAttribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
+                        {GetInterpolatedAttribute(Attribute::QuatX).ToFloat32(),
+                         GetInterpolatedAttribute(Attribute::QuatY).ToFloat32(),
+                         GetInterpolatedAttribute(Attribute::QuatZ).ToFloat32()},
+                        GetInterpolatedAttribute(Attribute::QuatW).ToFloat32(),
                     }
                         .Normalized();
 
                 Math::Vec3<float> view{
-                    GetInterpolatedAttribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
-                    GetInterpolatedAttribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
-                    GetInterpolatedAttribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
+                    GetInterpolatedAttribute(Attribute::ViewX).ToFloat32(),
+                    GetInterpolatedAttribute(Attribute::ViewY).ToFloat32(),
+                    GetInterpolatedAttribute(Attribute::ViewZ).ToFloat32(),
                 };
                 std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
                     g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
             }
 
+            // Inputs of the combiners, indexed by source. Invalid sources read as zero.
+            using Source = TexturingRegs::TevStageConfig::Source;
+            std::array<Math::Vec4<u8>, 16> tev_inputs{};
+            tev_inputs[static_cast<u32>(Source::PrimaryColor)] = primary_color;
+            tev_inputs[static_cast<u32>(Source::PrimaryFragmentColor)] = primary_fragment_color;
+            tev_inputs[static_cast<u32>(Source::SecondaryFragmentColor)] =
+                secondary_fragment_color;
+            tev_inputs[static_cast<u32>(Source::Texture0)] = texture_color[0];
+            tev_inputs[static_cast<u32>(Source::Texture1)] = texture_color[1];
+            tev_inputs[static_cast<u32>(Source::Texture2)] = texture_color[2];
+            tev_inputs[static_cast<u32>(Source::Texture3)] = texture_color[3];
+
             for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
                  ++tev_stage_index) {
                 const auto& tev_stage = tev_stages[tev_stage_index];
-                using Source = TexturingRegs::TevStageConfig::Source;
-
-                auto GetSource = [&](Source source) -> Math::Vec4<u8> {
-                    switch (source) {
-                    case Source::PrimaryColor:
-                        return primary_color;
-
-                    case Source::PrimaryFragmentColor:
-                        return primary_fragment_color;
-
-                    case Source::SecondaryFragmentColor:
-                        return secondary_fragment_color;
-
-                    case Source::Texture0:
-                        return texture_color[0];
-
-                    case Source::Texture1:
-                        return texture_color[1];
+                const auto& stage_program = program.tev_stages[tev_stage_index];
 
-                    case Source::Texture2:
-                        return texture_color[2];
+                tev_inputs[static_cast<u32>(Source::PreviousBuffer)] = combiner_buffer;
+                tev_inputs[static_cast<u32>(Source::Constant)] =
+                    Math::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                  tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                        .Cast<u8>();
+                tev_inputs[static_cast<u32>(Source::Previous)] = combiner_output;
 
-                    case Source::Texture3:
-                        return texture_color[3];
-
-                    case Source::PreviousBuffer:
-                        return combiner_buffer;
-
-                    case Source::Constant:
-                        return Math::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                             tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                            .Cast<u8>();
-
-                    case Source::Previous:
-                        return combiner_output;
-
-                    default:
-                        LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
-                        UNIMPLEMENTED();
-                        return {0, 0, 0, 0};
-                    }
+                auto GetSource = [&](Source source) -> const Math::Vec4<u8>& {
+                    return tev_inputs[static_cast<u32>(source)];
                 };
 
                 // color combiner
@@ -524,11 +740,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 //       combiner_output.rgb(), but instead store it in a temporary variable until
                 //       alpha combining has been done.
                 Math::Vec3<u8> color_result[3] = {
-                    GetColorModifier(tev_stage.color_modifier1, GetSource(tev_stage.color_source1)),
-                    GetColorModifier(tev_stage.color_modifier2, GetSource(tev_stage.color_source2)),
-                    GetColorModifier(tev_stage.color_modifier3, GetSource(tev_stage.color_source3)),
+                    stage_program.color_modifiers[0](GetSource(tev_stage.color_source1)),
+                    stage_program.color_modifiers[1](GetSource(tev_stage.color_source2)),
+                    stage_program.color_modifiers[2](GetSource(tev_stage.color_source3)),
                 };
-                auto color_output = ColorCombine(tev_stage.color_op, color_result);
+                auto color_output = stage_program.color_combine(color_result);
 
                 u8 alpha_output;
                 if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
@@ -537,14 +753,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 } else {
                     // alpha combiner
                     std::array<u8, 3> alpha_result = {{
-                        GetAlphaModifier(tev_stage.alpha_modifier1,
-                                         GetSource(tev_stage.alpha_source1)),
-                        GetAlphaModifier(tev_stage.alpha_modifier2,
-                                         GetSource(tev_stage.alpha_source2)),
-                        GetAlphaModifier(tev_stage.alpha_modifier3,
-                                         GetSource(tev_stage.alpha_source3)),
+                        stage_program.alpha_modifiers[0](GetSource(tev_stage.alpha_source1)),
+                        stage_program.alpha_modifiers[1](GetSource(tev_stage.alpha_source2)),
+                        stage_program.alpha_modifiers[2](GetSource(tev_stage.alpha_source3)),
                     }};
-                    alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+                    alpha_output = stage_program.alpha_combine(alpha_result);
                 }
 
                 combiner_output[0] =
@@ -571,8 +784,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 }
             }
 
-            const auto& output_merger = regs.framebuffer.output_merger;
-
             if (output_merger.fragment_operation_mode ==
                 FramebufferRegs::FragmentOperationMode::Shadow) {
                 u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
@@ -584,45 +795,9 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             }
 
             // TODO: Does alpha testing happen before or after stencil?
-            if (output_merger.alpha_test.enable) {
-                bool pass = false;
-
-                switch (output_merger.alpha_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = combiner_output.a() == output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = combiner_output.a() != output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = combiner_output.a() < output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = combiner_output.a() <= output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = combiner_output.a() > output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = combiner_output.a() >= output_merger.alpha_test.ref;
-                    break;
-                }
-
-                if (!pass)
-                    continue;
+            if (output_merger.alpha_test.enable &&
+                !program.alpha_test(combiner_output.a(), output_merger.alpha_test.ref)) {
+                continue;
             }
 
             // Apply fog combiner
@@ -657,221 +832,43 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 }
             }
 
-            u8 old_stencil = 0;
-
-            auto UpdateStencil = [stencil_test, x, y,
-                                  &old_stencil](Pica::FramebufferRegs::StencilAction action) {
-                u8 new_stencil =
-                    PerformStencilAction(action, old_stencil, stencil_test.reference_value);
-                if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
-                    SetStencil(x >> 4, y >> 4,
-                               (new_stencil & stencil_test.write_mask) |
-                                   (old_stencil & ~stencil_test.write_mask));
-            };
-
-            if (stencil_action_enable) {
-                old_stencil = GetStencil(x >> 4, y >> 4);
-                u8 dest = old_stencil & stencil_test.input_mask;
-                u8 ref = stencil_test.reference_value & stencil_test.input_mask;
-
-                bool pass = false;
-                switch (stencil_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = (ref == dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = (ref != dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = (ref < dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = (ref <= dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = (ref > dest);
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = (ref >= dest);
-                    break;
-                }
-
-                if (!pass) {
-                    UpdateStencil(stencil_test.action_stencil_fail);
-                    continue;
-                }
-            }
-
-            // Convert float to integer
-            unsigned num_bits =
-                FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format);
-            u32 z = (u32)(depth * ((1 << num_bits) - 1));
-
-            if (output_merger.depth_test_enable) {
-                u32 ref_z = GetDepth(x >> 4, y >> 4);
-
-                bool pass = false;
-
-                switch (output_merger.depth_test_func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = z == ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = z != ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = z < ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = z <= ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = z > ref_z;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = z >= ref_z;
-                    break;
-                }
-
-                if (!pass) {
-                    if (stencil_action_enable)
-                        UpdateStencil(stencil_test.action_depth_fail);
-                    continue;
-                }
-            }
-
-            if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
-                output_merger.depth_write_enable) {
-
-                SetDepth(x >> 4, y >> 4, z);
-            }
-
-            // The stencil depth_pass action is executed even if depth testing is disabled
-            if (stencil_action_enable)
-                UpdateStencil(stencil_test.action_depth_pass);
+            if (!early_depth_stencil && !DepthStencilTest(x, y, z))
+                continue;
 
             auto dest = GetPixel(x >> 4, y >> 4);
             Math::Vec4<u8> blend_output = combiner_output;
 
             if (output_merger.alphablend_enable) {
-                auto params = output_merger.alpha_blending;
-
-                auto LookupFactor = [&](unsigned channel,
-                                        FramebufferRegs::BlendFactor factor) -> u8 {
-                    DEBUG_ASSERT(channel < 4);
-
-                    const Math::Vec4<u8> blend_const =
-                        Math::MakeVec(output_merger.blend_const.r.Value(),
-                                      output_merger.blend_const.g.Value(),
-                                      output_merger.blend_const.b.Value(),
-                                      output_merger.blend_const.a.Value())
-                            .Cast<u8>();
-
-                    switch (factor) {
-                    case FramebufferRegs::BlendFactor::Zero:
-                        return 0;
-
-                    case FramebufferRegs::BlendFactor::One:
-                        return 255;
-
-                    case FramebufferRegs::BlendFactor::SourceColor:
-                        return combiner_output[channel];
-
-                    case FramebufferRegs::BlendFactor::OneMinusSourceColor:
-                        return 255 - combiner_output[channel];
-
-                    case FramebufferRegs::BlendFactor::DestColor:
-                        return dest[channel];
-
-                    case FramebufferRegs::BlendFactor::OneMinusDestColor:
-                        return 255 - dest[channel];
-
-                    case FramebufferRegs::BlendFactor::SourceAlpha:
-                        return combiner_output.a();
-
-                    case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
-                        return 255 - combiner_output.a();
-
-                    case FramebufferRegs::BlendFactor::DestAlpha:
-                        return dest.a();
-
-                    case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
-                        return 255 - dest.a();
-
-                    case FramebufferRegs::BlendFactor::ConstantColor:
-                        return blend_const[channel];
-
-                    case FramebufferRegs::BlendFactor::OneMinusConstantColor:
-                        return 255 - blend_const[channel];
-
-                    case FramebufferRegs::BlendFactor::ConstantAlpha:
-                        return blend_const.a();
-
-                    case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
-                        return 255 - blend_const.a();
-
-                    case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
-                        // Returns 1.0 for the alpha channel
-                        if (channel == 3)
-                            return 255;
-                        return std::min(combiner_output.a(), static_cast<u8>(255 - dest.a()));
+                const Math::Vec4<u8> blend_const =
+                    Math::MakeVec(output_merger.blend_const.r.Value(),
+                                  output_merger.blend_const.g.Value(),
+                                  output_merger.blend_const.b.Value(),
+                                  output_merger.blend_const.a.Value())
+                        .Cast<u8>();
+
+                auto LookupFactor = [&](unsigned channel, BlendFactorFunction factor) -> u8 {
+                    return factor(channel, combiner_output, dest, blend_const);
+                };
 
-                    default:
-                        LOG_CRITICAL(HW_GPU, "Unknown blend factor {:x}", static_cast<u32>(factor));
-                        UNIMPLEMENTED();
-                        break;
-                    }
+                auto srcfactor = Math::MakeVec(LookupFactor(0, program.blend_factor_source_rgb),
+                                               LookupFactor(1, program.blend_factor_source_rgb),
+                                               LookupFactor(2, program.blend_factor_source_rgb),
+                                               LookupFactor(3, program.blend_factor_source_a));
 
-                    return combiner_output[channel];
-                };
+                auto dstfactor = Math::MakeVec(LookupFactor(0, program.blend_factor_dest_rgb),
+                                               LookupFactor(1, program.blend_factor_dest_rgb),
+                                               LookupFactor(2, program.blend_factor_dest_rgb),
+                                               LookupFactor(3, program.blend_factor_dest_a));
 
-                auto srcfactor = Math::MakeVec(LookupFactor(0, params.factor_source_rgb),
-                                               LookupFactor(1, params.factor_source_rgb),
-                                               LookupFactor(2, params.factor_source_rgb),
-                                               LookupFactor(3, params.factor_source_a));
-
-                auto dstfactor = Math::MakeVec(LookupFactor(0, params.factor_dest_rgb),
-                                               LookupFactor(1, params.factor_dest_rgb),
-                                               LookupFactor(2, params.factor_dest_rgb),
-                                               LookupFactor(3, params.factor_dest_a));
-
-                blend_output = EvaluateBlendEquation(combiner_output, srcfactor, dest, dstfactor,
-                                                     params.blend_equation_rgb);
-                blend_output.a() = EvaluateBlendEquation(combiner_output, srcfactor, dest,
-                                                         dstfactor, params.blend_equation_a)
-                                       .a();
-            } else {
                 blend_output =
-                    Math::MakeVec(LogicOp(combiner_output.r(), dest.r(), output_merger.logic_op),
-                                  LogicOp(combiner_output.g(), dest.g(), output_merger.logic_op),
-                                  LogicOp(combiner_output.b(), dest.b(), output_merger.logic_op),
-                                  LogicOp(combiner_output.a(), dest.a(), output_merger.logic_op));
+                    program.blend_equation_rgb(combiner_output, srcfactor, dest, dstfactor);
+                blend_output.a() =
+                    program.blend_equation_a(combiner_output, srcfactor, dest, dstfactor).a();
+            } else {
+                blend_output = Math::MakeVec(program.logic_op(combiner_output.r(), dest.r()),
+                                             program.logic_op(combiner_output.g(), dest.g()),
+                                             program.logic_op(combiner_output.b(), dest.b()),
+                                             program.logic_op(combiner_output.a(), dest.a()));
             }
 
             const Math::Vec4<u8> result = {
@@ -891,5 +888,87 @@ void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
     ProcessTriangleInternal(v0, v1, v2);
 }
 
+/// Rasterizes the triangles binned into the given tile, clipped to the tile bounds
+static void RasterizeTile(u32 tile, unsigned tiles_x) {
+    const unsigned tile_min_x = (tile % tiles_x) * TILE_SIZE << 4;
+    const unsigned tile_min_y = (tile / tiles_x) * TILE_SIZE << 4;
+    const unsigned tile_max_x = tile_min_x + (TILE_SIZE << 4);
+    const unsigned tile_max_y = tile_min_y + (TILE_SIZE << 4);
+
+    auto& bin = tile_bins[tile];
+    for (u32 index : bin) {
+        const Triangle& triangle = queued_triangles[index];
+        const u16 min_x = static_cast<u16>(std::max<unsigned>(triangle.min_x, tile_min_x));
+        const u16 min_y = static_cast<u16>(std::max<unsigned>(triangle.min_y, tile_min_y));
+        const u16 max_x = static_cast<u16>(std::min<unsigned>(triangle.max_x, tile_max_x));
+        const u16 max_y = static_cast<u16>(std::min<unsigned>(triangle.max_y, tile_max_y));
+        RasterizeTriangle(triangle, min_x, min_y, max_x, max_y);
+    }
+    bin.clear();
+}
+
+void Flush() {
+    if (queued_triangles.empty())
+        return;
+
+    MICROPROFILE_SCOPE(GPU_Rasterization);
+
+    unsigned max_x = 0;
+    unsigned max_y = 0;
+    std::size_t area = 0;
+    for (const auto& triangle : queued_triangles) {
+        max_x = std::max<unsigned>(max_x, triangle.max_x >> 4);
+        max_y = std::max<unsigned>(max_y, triangle.max_y >> 4);
+        area += static_cast<std::size_t>((triangle.max_x - triangle.min_x) >> 4) *
+                ((triangle.max_y - triangle.min_y) >> 4);
+    }
+
+    if (area < MIN_PARALLEL_AREA) {
+        for (const auto& triangle : queued_triangles) {
+            RasterizeTriangle(triangle, triangle.min_x, triangle.min_y, triangle.max_x,
+                              triangle.max_y);
+        }
+        queued_triangles.clear();
+        return;
+    }
+
+    // Bin the triangles into the tiles their bounding box overlaps. Each tile then only sees its
+    // triangles in submission order, so rasterizing the tiles concurrently yields the same result
+    // as rasterizing the triangles one after the other.
+    const unsigned tiles_x = (max_x + TILE_SIZE - 1) / TILE_SIZE;
+    const unsigned tiles_y = (max_y + TILE_SIZE - 1) / TILE_SIZE;
+    if (tile_bins.size() < tiles_x * tiles_y)
+        tile_bins.resize(tiles_x * tiles_y);
+
+    for (u32 index = 0; index < queued_triangles.size(); ++index) {
+        const Triangle& triangle = queued_triangles[index];
+        const unsigned first_x = (triangle.min_x >> 4) / TILE_SIZE;
+        const unsigned first_y = (triangle.min_y >> 4) / TILE_SIZE;
+        const unsigned last_x = ((triangle.max_x >> 4) - 1) / TILE_SIZE;
+        const unsigned last_y = ((triangle.max_y >> 4) - 1) / TILE_SIZE;
+        for (unsigned tile_y = first_y; tile_y <= last_y; ++tile_y) {
+            for (unsigned tile_x = first_x; tile_x <= last_x; ++tile_x) {
+                const u32 tile = tile_y * tiles_x + tile_x;
+                if (tile_bins[tile].empty())
+                    active_tiles.push_back(tile);
+                tile_bins[tile].push_back(index);
+            }
+        }
+    }
+
+    // Tiles vary a lot in cost, so the workers pick them one at a time instead of splitting the
+    // list upfront
+    auto& pool = Common::ThreadPool::GetShared();
+    std::atomic<std::size_t> next_tile{0};
+    pool.ParallelFor(pool.GetMaxChunks(), 1, [&](std::size_t, std::size_t, std::size_t) {
+        for (std::size_t i = next_tile++; i < active_tiles.size(); i = next_tile++) {
+            RasterizeTile(active_tiles[i], tiles_x);
+        }
+    });
+
+    active_tiles.clear();
+    queued_triangles.clear();
+}
+
 } // namespace Rasterizer
 } // namespace Pica
@@ -40,7 +40,14 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
+/**
+ * Rasterizes a triangle. When multiple threads are available, the triangle is only queued and gets
+ * rasterized along with the other triangles of the draw on the next call to Flush.
+ */
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/// Rasterizes all the queued triangles. Must be called before the PICA state or memory changes.
+void Flush();
+
 } // namespace Rasterizer
 } // namespace Pica
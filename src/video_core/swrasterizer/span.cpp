@@ -0,0 +1,126 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "common/vector_math.h"
+#include "video_core/swrasterizer/span.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Pica {
+namespace Rasterizer {
+
+static u32 RasterizeSpanScalar(const SpanSetup& setup, const std::array<s32, 3>& w,
+                               unsigned num_pixels, SpanResult& result) {
+    u32 coverage = 0;
+    for (unsigned i = 0; i < num_pixels; ++i) {
+        for (unsigned edge = 0; edge < 3; ++edge) {
+            result.w[edge][i] = static_cast<s32>(static_cast<u32>(w[edge]) +
+                                                 i * static_cast<u32>(setup.w_step[edge]));
+        }
+        const s32 w0 = result.w[0][i];
+        const s32 w1 = result.w[1][i];
+        const s32 w2 = result.w[2][i];
+
+        // If current pixel is not covered by the current primitive
+        if (w0 < 0 || w1 < 0 || w2 < 0)
+            continue;
+
+        coverage |= 1u << i;
+
+        // interpolated_z = z / w
+        const int wsum = w0 + w1 + w2;
+        float interpolated_z_over_w =
+            (setup.screen_z[0] * w0 + setup.screen_z[1] * w1 + setup.screen_z[2] * w2) / wsum;
+
+        // Not fully accurate. About 3 bits in precision are missing.
+        // Z-Buffer (z / w * scale + offset)
+        float depth = interpolated_z_over_w * setup.depth_scale + setup.depth_offset;
+
+        // Potentially switch to W-Buffer
+        if (setup.w_buffer) {
+            const auto w_inverse =
+                Math::MakeVec(setup.w_inverse[0], setup.w_inverse[1], setup.w_inverse[2]);
+            const auto baricentric_coordinates =
+                Math::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
+                              float24::FromFloat32(static_cast<float>(w1)),
+                              float24::FromFloat32(static_cast<float>(w2)));
+            const float24 interpolated_w_inverse =
+                float24::FromFloat32(1.0f) / Math::Dot(w_inverse, baricentric_coordinates);
+
+            // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+            depth *= interpolated_w_inverse.ToFloat32() * wsum;
+        }
+
+        // Clamp the result
+        depth = std::clamp(depth, 0.0f, 1.0f);
+
+        result.depth[i] = depth;
+        result.z[i] = static_cast<u32>(depth * setup.depth_max);
+    }
+    return coverage;
+}
+
+const SpanKernel& GetScalarSpanKernel() {
+    static const SpanKernel kernel{MAX_SPAN_WIDTH, RasterizeSpanScalar};
+    return kernel;
+}
+
+/// Multiplication of float24, see Pica::Float::operator*
+static float MultiplyFloat24(float a, float b) {
+    const float result = a * b;
+    if (std::isnan(result) && !std::isnan(a) && !std::isnan(b))
+        return 0.0f;
+    return result;
+}
+
+static void InterpolateAttributesScalar(const AttributeSetup& setup,
+                                        const std::array<float, 3>& baricentric_coordinates,
+                                        float w, AttributeValues& result) {
+    for (std::size_t i = 0; i < NUM_ATTRIBUTE_VALUES; ++i) {
+        // Same order of operations as Math::Dot
+        const float attr_over_w =
+            MultiplyFloat24(setup.values[0][i], baricentric_coordinates[0]) +
+            MultiplyFloat24(setup.values[1][i], baricentric_coordinates[1]) +
+            MultiplyFloat24(setup.values[2][i], baricentric_coordinates[2]);
+        result[i] = MultiplyFloat24(attr_over_w, w);
+    }
+}
+
+AttributeFunction GetScalarAttributeKernel() {
+    return InterpolateAttributesScalar;
+}
+
+const SpanKernel& GetSpanKernel(const SpanSetup& setup) {
+    if (setup.w_buffer)
+        return GetScalarSpanKernel();
+
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.avx2)
+        return GetAVX2SpanKernel();
+    if (caps.sse4_1)
+        return GetSSE41SpanKernel();
+#endif
+
+    return GetScalarSpanKernel();
+}
+
+AttributeFunction GetAttributeKernel() {
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.avx2)
+        return GetAVX2AttributeKernel();
+    if (caps.sse4_1)
+        return GetSSE41AttributeKernel();
+#endif
+
+    return GetScalarAttributeKernel();
+}
+
+} // namespace Rasterizer
+} // namespace Pica
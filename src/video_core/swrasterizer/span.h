@@ -0,0 +1,141 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+#include "video_core/pica_types.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+/// Maximum number of horizontally adjacent pixels handled by a single span kernel call
+constexpr std::size_t MAX_SPAN_WIDTH = 8;
+
+/// Per-triangle constants used by the span kernels
+struct SpanSetup {
+    /// Change of each edge function when moving one pixel to the right
+    std::array<s32, 3> w_step;
+
+    /// Screen space z of each vertex
+    std::array<float, 3> screen_z;
+    /// Clip space 1/w of each vertex, only used for W-buffering
+    std::array<float24, 3> w_inverse;
+
+    float depth_scale;
+    float depth_offset;
+    /// Largest value representable by the depth buffer format
+    float depth_max;
+    /// Whether depth is taken from the W-buffer rather than the Z-buffer
+    bool w_buffer;
+};
+
+/// Per-pixel outputs of a span kernel, only meaningful for the covered pixels
+struct SpanResult {
+    /// Edge functions, i.e. the unnormalized barycentric coordinates
+    std::array<std::array<s32, MAX_SPAN_WIDTH>, 3> w;
+    /// Depth in the [0, 1] range
+    std::array<float, MAX_SPAN_WIDTH> depth;
+    /// Depth converted to the depth buffer format
+    std::array<u32, MAX_SPAN_WIDTH> z;
+};
+
+/**
+ * Computes the coverage and depth of a horizontal span of pixels.
+ * @param setup Constants of the triangle being rasterized
+ * @param w Edge functions at the first pixel of the span, including the fill rule biases
+ * @param num_pixels Number of pixels in the span, at most the width of the kernel
+ * @param result Per-pixel outputs
+ * @returns Mask with bit i set if the i-th pixel of the span is covered by the triangle
+ */
+using SpanFunction = u32 (*)(const SpanSetup& setup, const std::array<s32, 3>& w,
+                             unsigned num_pixels, SpanResult& result);
+
+struct SpanKernel {
+    /// Number of pixels processed per call, a power of two no larger than MAX_SPAN_WIDTH
+    unsigned width;
+    SpanFunction function;
+};
+
+/// Portable kernel, processing one pixel after the other with the same math as the vector kernels
+const SpanKernel& GetScalarSpanKernel();
+
+#ifdef ARCHITECTURE_x86_64
+/// Kernel processing 4 pixels at once, requires SSE4.1
+const SpanKernel& GetSSE41SpanKernel();
+/// Kernel processing 8 pixels at once, requires AVX2
+const SpanKernel& GetAVX2SpanKernel();
+#endif
+
+/**
+ * Returns the fastest kernel supported by the host CPU. Vector kernels do not implement
+ * W-buffering, so the scalar kernel is returned for triangles which need it.
+ */
+const SpanKernel& GetSpanKernel(const SpanSetup& setup);
+
+/// Vertex attributes interpolated for each pixel, indexing AttributeSetup::values
+enum class Attribute : std::size_t {
+    ColorR,
+    ColorG,
+    ColorB,
+    ColorA,
+    Tc0U,
+    Tc0V,
+    Tc1U,
+    Tc1V,
+    Tc2U,
+    Tc2V,
+    Tc0W,
+    QuatX,
+    QuatY,
+    QuatZ,
+    QuatW,
+    ViewX,
+    ViewY,
+    ViewZ,
+    Count,
+};
+
+/// Number of interpolated values, the attributes padded to a multiple of MAX_SPAN_WIDTH
+constexpr std::size_t NUM_ATTRIBUTE_VALUES =
+    (static_cast<std::size_t>(Attribute::Count) + MAX_SPAN_WIDTH - 1) / MAX_SPAN_WIDTH *
+    MAX_SPAN_WIDTH;
+
+using AttributeValues = std::array<float, NUM_ATTRIBUTE_VALUES>;
+
+/// Per-triangle constants used by the attribute kernels
+struct AttributeSetup {
+    /// Attributes of each vertex, divided by its clip space w. The padding is zero.
+    std::array<AttributeValues, 3> values;
+};
+
+/**
+ * Interpolates all the vertex attributes at a pixel, with perspective correction. The products
+ * follow the float24 multiplication, which gives 0 instead of NaN when multiplying by infinity.
+ * @param setup Constants of the triangle being rasterized
+ * @param baricentric_coordinates Edge functions of the pixel, converted to float
+ * @param w Interpolated clip space w of the pixel, the inverse of the interpolated 1/w
+ * @param result Interpolated attributes, indexed by Attribute
+ */
+using AttributeFunction = void (*)(const AttributeSetup& setup,
+                                   const std::array<float, 3>& baricentric_coordinates, float w,
+                                   AttributeValues& result);
+
+/// Portable attribute kernel, with the same math as the vector kernels
+AttributeFunction GetScalarAttributeKernel();
+
+#ifdef ARCHITECTURE_x86_64
+/// Attribute kernel interpolating 4 values at once, requires SSE4.1
+AttributeFunction GetSSE41AttributeKernel();
+/// Attribute kernel interpolating 8 values at once, requires AVX2
+AttributeFunction GetAVX2AttributeKernel();
+#endif
+
+/// Returns the fastest attribute kernel supported by the host CPU
+AttributeFunction GetAttributeKernel();
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -0,0 +1,172 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <immintrin.h>
+#include "common/x64/target.h"
+#include "video_core/swrasterizer/span.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+// The vector kernels evaluate the exact same float operations, in the same order, as the scalar
+// kernel, so that both produce bit-identical results.
+
+TARGET_SSE41 static u32 RasterizeSpanSSE41(const SpanSetup& setup, const std::array<s32, 3>& w,
+                                           unsigned num_pixels, SpanResult& result) {
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    __m128i w_vec[3];
+    __m128i negative = _mm_setzero_si128();
+    for (unsigned edge = 0; edge < 3; ++edge) {
+        w_vec[edge] = _mm_add_epi32(_mm_set1_epi32(w[edge]),
+                                    _mm_mullo_epi32(lanes, _mm_set1_epi32(setup.w_step[edge])));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(result.w[edge].data()), w_vec[edge]);
+        negative = _mm_or_si128(negative, w_vec[edge]);
+    }
+
+    const u32 coverage = ~_mm_movemask_ps(_mm_castsi128_ps(negative)) & ((1u << num_pixels) - 1);
+    if (coverage == 0)
+        return 0;
+
+    const __m128 w0 = _mm_cvtepi32_ps(w_vec[0]);
+    const __m128 w1 = _mm_cvtepi32_ps(w_vec[1]);
+    const __m128 w2 = _mm_cvtepi32_ps(w_vec[2]);
+    const __m128 wsum =
+        _mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(w_vec[0], w_vec[1]), w_vec[2]));
+
+    const __m128 interpolated_z_over_w =
+        _mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(setup.screen_z[0]), w0),
+                                         _mm_mul_ps(_mm_set1_ps(setup.screen_z[1]), w1)),
+                              _mm_mul_ps(_mm_set1_ps(setup.screen_z[2]), w2)),
+                   wsum);
+    __m128 depth = _mm_add_ps(_mm_mul_ps(interpolated_z_over_w, _mm_set1_ps(setup.depth_scale)),
+                              _mm_set1_ps(setup.depth_offset));
+
+    // Same as std::clamp, which leaves NaNs untouched
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    depth = _mm_blendv_ps(depth, zero, _mm_cmplt_ps(depth, zero));
+    depth = _mm_blendv_ps(depth, one, _mm_cmplt_ps(one, depth));
+
+    _mm_storeu_ps(result.depth.data(), depth);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result.z.data()),
+                     _mm_cvttps_epi32(_mm_mul_ps(depth, _mm_set1_ps(setup.depth_max))));
+    return coverage;
+}
+
+TARGET_AVX2 static u32 RasterizeSpanAVX2(const SpanSetup& setup, const std::array<s32, 3>& w,
+                                         unsigned num_pixels, SpanResult& result) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256i w_vec[3];
+    __m256i negative = _mm256_setzero_si256();
+    for (unsigned edge = 0; edge < 3; ++edge) {
+        w_vec[edge] =
+            _mm256_add_epi32(_mm256_set1_epi32(w[edge]),
+                             _mm256_mullo_epi32(lanes, _mm256_set1_epi32(setup.w_step[edge])));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result.w[edge].data()), w_vec[edge]);
+        negative = _mm256_or_si256(negative, w_vec[edge]);
+    }
+
+    const u32 coverage =
+        ~_mm256_movemask_ps(_mm256_castsi256_ps(negative)) & ((1u << num_pixels) - 1);
+    if (coverage == 0)
+        return 0;
+
+    const __m256 w0 = _mm256_cvtepi32_ps(w_vec[0]);
+    const __m256 w1 = _mm256_cvtepi32_ps(w_vec[1]);
+    const __m256 w2 = _mm256_cvtepi32_ps(w_vec[2]);
+    const __m256 wsum =
+        _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(w_vec[0], w_vec[1]), w_vec[2]));
+
+    const __m256 interpolated_z_over_w = _mm256_div_ps(
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(setup.screen_z[0]), w0),
+                                    _mm256_mul_ps(_mm256_set1_ps(setup.screen_z[1]), w1)),
+                      _mm256_mul_ps(_mm256_set1_ps(setup.screen_z[2]), w2)),
+        wsum);
+    __m256 depth =
+        _mm256_add_ps(_mm256_mul_ps(interpolated_z_over_w, _mm256_set1_ps(setup.depth_scale)),
+                      _mm256_set1_ps(setup.depth_offset));
+
+    // Same as std::clamp, which leaves NaNs untouched
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    depth = _mm256_blendv_ps(depth, zero, _mm256_cmp_ps(depth, zero, _CMP_LT_OQ));
+    depth = _mm256_blendv_ps(depth, one, _mm256_cmp_ps(one, depth, _CMP_LT_OQ));
+
+    _mm256_storeu_ps(result.depth.data(), depth);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result.z.data()),
+                        _mm256_cvttps_epi32(_mm256_mul_ps(depth, _mm256_set1_ps(setup.depth_max))));
+    return coverage;
+}
+
+/// Multiplication of float24, see Pica::Float::operator*
+TARGET_SSE41 static __m128 MultiplyFloat24SSE41(__m128 a, __m128 b) {
+    const __m128 result = _mm_mul_ps(a, b);
+    // PICA gives 0 instead of NaN when multiplying by inf
+    const __m128 inf_times_zero = _mm_and_ps(_mm_cmpunord_ps(result, result), _mm_cmpord_ps(a, b));
+    return _mm_andnot_ps(inf_times_zero, result);
+}
+
+TARGET_SSE41 static void InterpolateAttributesSSE41(
+    const AttributeSetup& setup, const std::array<float, 3>& baricentric_coordinates, float w,
+    AttributeValues& result) {
+    const __m128 b0 = _mm_set1_ps(baricentric_coordinates[0]);
+    const __m128 b1 = _mm_set1_ps(baricentric_coordinates[1]);
+    const __m128 b2 = _mm_set1_ps(baricentric_coordinates[2]);
+    const __m128 w_vec = _mm_set1_ps(w);
+    for (std::size_t i = 0; i < NUM_ATTRIBUTE_VALUES; i += 4) {
+        const __m128 attr_over_w = _mm_add_ps(
+            _mm_add_ps(MultiplyFloat24SSE41(_mm_loadu_ps(&setup.values[0][i]), b0),
+                       MultiplyFloat24SSE41(_mm_loadu_ps(&setup.values[1][i]), b1)),
+            MultiplyFloat24SSE41(_mm_loadu_ps(&setup.values[2][i]), b2));
+        _mm_storeu_ps(&result[i], MultiplyFloat24SSE41(attr_over_w, w_vec));
+    }
+}
+
+/// Multiplication of float24, see Pica::Float::operator*
+TARGET_AVX2 static __m256 MultiplyFloat24AVX2(__m256 a, __m256 b) {
+    const __m256 result = _mm256_mul_ps(a, b);
+    // PICA gives 0 instead of NaN when multiplying by inf
+    const __m256 inf_times_zero = _mm256_and_ps(_mm256_cmp_ps(result, result, _CMP_UNORD_Q),
+                                                _mm256_cmp_ps(a, b, _CMP_ORD_Q));
+    return _mm256_andnot_ps(inf_times_zero, result);
+}
+
+TARGET_AVX2 static void InterpolateAttributesAVX2(
+    const AttributeSetup& setup, const std::array<float, 3>& baricentric_coordinates, float w,
+    AttributeValues& result) {
+    const __m256 b0 = _mm256_set1_ps(baricentric_coordinates[0]);
+    const __m256 b1 = _mm256_set1_ps(baricentric_coordinates[1]);
+    const __m256 b2 = _mm256_set1_ps(baricentric_coordinates[2]);
+    const __m256 w_vec = _mm256_set1_ps(w);
+    for (std::size_t i = 0; i < NUM_ATTRIBUTE_VALUES; i += 8) {
+        const __m256 attr_over_w = _mm256_add_ps(
+            _mm256_add_ps(MultiplyFloat24AVX2(_mm256_loadu_ps(&setup.values[0][i]), b0),
+                          MultiplyFloat24AVX2(_mm256_loadu_ps(&setup.values[1][i]), b1)),
+            MultiplyFloat24AVX2(_mm256_loadu_ps(&setup.values[2][i]), b2));
+        _mm256_storeu_ps(&result[i], MultiplyFloat24AVX2(attr_over_w, w_vec));
+    }
+}
+
+const SpanKernel& GetSSE41SpanKernel() {
+    static const SpanKernel kernel{4, RasterizeSpanSSE41};
+    return kernel;
+}
+
+const SpanKernel& GetAVX2SpanKernel() {
+    static const SpanKernel kernel{8, RasterizeSpanAVX2};
+    return kernel;
+}
+
+AttributeFunction GetSSE41AttributeKernel() {
+    return InterpolateAttributesSSE41;
+}
+
+AttributeFunction GetAVX2AttributeKernel() {
+    return InterpolateAttributesAVX2;
+}
+
+} // namespace Rasterizer
+} // namespace Pica
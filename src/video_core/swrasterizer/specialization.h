@@ -0,0 +1,37 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include "common/common_types.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+namespace detail {
+template <template <u32> typename Specialization, std::size_t... Values>
+constexpr auto MakeSpecializationTable(std::index_sequence<Values...>) {
+    return std::array{&Specialization<static_cast<u32>(Values)>::Run...};
+}
+} // namespace detail
+
+/**
+ * Returns the implementation of an operation specialized for the given value of the register field
+ * configuring it, so that per-fragment code can call it without branching on the constant state.
+ * Specialization<value>::Run is instantiated for all the values the field can hold, including the
+ * invalid ones, so that the specialized code behaves exactly like the generic one.
+ * @tparam Bits Width of the register field
+ */
+template <std::size_t Bits, template <u32> typename Specialization, typename Enum>
+auto GetSpecialization(Enum value) {
+    static constexpr auto table = detail::MakeSpecializationTable<Specialization>(
+        std::make_index_sequence<std::size_t{1} << Bits>{});
+    return table[static_cast<std::size_t>(value) & ((std::size_t{1} << Bits) - 1)];
+}
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "video_core/swrasterizer/clipper.h"
+#include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/swrasterizer.h"
 
 namespace VideoCore {
@@ -13,4 +14,8 @@ void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
 
+void SWRasterizer::DrawTriangles() {
+    Pica::Rasterizer::Flush();
+}
+
 } // namespace VideoCore
@@ -7,6 +7,7 @@
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_texturing.h"
+#include "video_core/swrasterizer/specialization.h"
 #include "video_core/swrasterizer/texturing.h"
 
 namespace Pica {
@@ -238,5 +239,49 @@ u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
     }
 };
 
+template <u32 factor>
+struct ColorModifierSpecialization {
+    static Math::Vec3<u8> Run(const Math::Vec4<u8>& values) {
+        return GetColorModifier(static_cast<TevStageConfig::ColorModifier>(factor), values);
+    }
+};
+
+template <u32 factor>
+struct AlphaModifierSpecialization {
+    static u8 Run(const Math::Vec4<u8>& values) {
+        return GetAlphaModifier(static_cast<TevStageConfig::AlphaModifier>(factor), values);
+    }
+};
+
+template <u32 op>
+struct ColorCombineSpecialization {
+    static Math::Vec3<u8> Run(const Math::Vec3<u8> input[3]) {
+        return ColorCombine(static_cast<TevStageConfig::Operation>(op), input);
+    }
+};
+
+template <u32 op>
+struct AlphaCombineSpecialization {
+    static u8 Run(const std::array<u8, 3>& input) {
+        return AlphaCombine(static_cast<TevStageConfig::Operation>(op), input);
+    }
+};
+
+ColorModifierFunction GetColorModifierFunction(TevStageConfig::ColorModifier factor) {
+    return GetSpecialization<4, ColorModifierSpecialization>(factor);
+}
+
+AlphaModifierFunction GetAlphaModifierFunction(TevStageConfig::AlphaModifier factor) {
+    return GetSpecialization<3, AlphaModifierSpecialization>(factor);
+}
+
+ColorCombineFunction GetColorCombineFunction(TevStageConfig::Operation op) {
+    return GetSpecialization<4, ColorCombineSpecialization>(op);
+}
+
+AlphaCombineFunction GetAlphaCombineFunction(TevStageConfig::Operation op) {
+    return GetSpecialization<4, AlphaCombineSpecialization>(op);
+}
+
 } // namespace Rasterizer
 } // namespace Pica
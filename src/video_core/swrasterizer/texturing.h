@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_texturing.h"
@@ -24,5 +25,24 @@ Math::Vec3<u8> ColorCombine(TexturingRegs::TevStageConfig::Operation op,
 
 u8 AlphaCombine(TexturingRegs::TevStageConfig::Operation op, const std::array<u8, 3>& input);
 
+using ColorModifierFunction = Math::Vec3<u8> (*)(const Math::Vec4<u8>& values);
+using AlphaModifierFunction = u8 (*)(const Math::Vec4<u8>& values);
+using ColorCombineFunction = Math::Vec3<u8> (*)(const Math::Vec3<u8> input[3]);
+using AlphaCombineFunction = u8 (*)(const std::array<u8, 3>& input);
+
+/// Returns GetColorModifier specialized for the given factor
+ColorModifierFunction GetColorModifierFunction(
+    TexturingRegs::TevStageConfig::ColorModifier factor);
+
+/// Returns GetAlphaModifier specialized for the given factor
+AlphaModifierFunction GetAlphaModifierFunction(
+    TexturingRegs::TevStageConfig::AlphaModifier factor);
+
+/// Returns ColorCombine specialized for the given operation
+ColorCombineFunction GetColorCombineFunction(TexturingRegs::TevStageConfig::Operation op);
+
+/// Returns AlphaCombine specialized for the given operation
+AlphaCombineFunction GetAlphaCombineFunction(TexturingRegs::TevStageConfig::Operation op);
+
 } // namespace Rasterizer
 } // namespace Pica
@@ -70,19 +70,14 @@ union ETC1Tile {
         BitField<60, 4, u64> r1;
     } separate;
 
-    const Math::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
-        int texel = 4 * x + y;
-
-        if (flip)
-            std::swap(x, y);
-
-        // Lookup base value
+    /// Returns the base color of the first or second half of the subtile
+    Math::Vec3<int> GetBaseColor(bool second_half) const {
         Math::Vec3<int> ret;
         if (differential_mode) {
             ret.r() = static_cast<int>(differential.r);
             ret.g() = static_cast<int>(differential.g);
             ret.b() = static_cast<int>(differential.b);
-            if (x >= 2) {
+            if (second_half) {
                 ret.r() += static_cast<int>(differential.dr);
                 ret.g() += static_cast<int>(differential.dg);
                 ret.b() += static_cast<int>(differential.db);
@@ -91,7 +86,7 @@ union ETC1Tile {
             ret.g() = Color::Convert5To8(ret.g());
             ret.b() = Color::Convert5To8(ret.b());
         } else {
-            if (x < 2) {
+            if (!second_half) {
                 ret.r() = Color::Convert4To8(static_cast<u8>(separate.r1));
                 ret.g() = Color::Convert4To8(static_cast<u8>(separate.g1));
                 ret.b() = Color::Convert4To8(static_cast<u8>(separate.b1));
@@ -101,21 +96,37 @@ union ETC1Tile {
                 ret.b() = Color::Convert4To8(static_cast<u8>(separate.b2));
             }
         }
+        return ret;
+    }
 
-        // Add modifier
-        unsigned table_index =
-            static_cast<int>((x < 2) ? table_index_1.Value() : table_index_2.Value());
+    unsigned GetTableIndex(bool second_half) const {
+        return static_cast<unsigned>(second_half ? table_index_2.Value() : table_index_1.Value());
+    }
 
+    /// Adds the modifier of the given texel to the base color of its half of the subtile
+    Math::Vec3<u8> ApplyModifier(const Math::Vec3<int>& base, unsigned table_index,
+                                 unsigned texel) const {
         int modifier = etc1_modifier_table[table_index][GetTableSubIndex(texel)];
         if (GetNegationFlag(texel))
             modifier *= -1;
 
-        ret.r() = std::clamp(ret.r() + modifier, 0, 255);
-        ret.g() = std::clamp(ret.g() + modifier, 0, 255);
-        ret.b() = std::clamp(ret.b() + modifier, 0, 255);
+        Math::Vec3<int> ret;
+        ret.r() = std::clamp(base.r() + modifier, 0, 255);
+        ret.g() = std::clamp(base.g() + modifier, 0, 255);
+        ret.b() = std::clamp(base.b() + modifier, 0, 255);
 
         return ret.Cast<u8>();
     }
+
+    const Math::Vec3<u8> GetRGB(unsigned int x, unsigned int y) const {
+        int texel = 4 * x + y;
+
+        if (flip)
+            std::swap(x, y);
+
+        const bool second_half = x >= 2;
+        return ApplyModifier(GetBaseColor(second_half), GetTableIndex(second_half), texel);
+    }
 };
 
 } // anonymous namespace
@@ -125,5 +136,23 @@ Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, std::array<Math::Vec3<u8>, 16>& texels) {
+    const ETC1Tile tile{value};
+
+    // The base colors and the modifier tables only depend on the half the texel is in
+    const std::array<Math::Vec3<int>, 2> base_colors{{tile.GetBaseColor(false),
+                                                      tile.GetBaseColor(true)}};
+    const std::array<unsigned, 2> table_indices{{tile.GetTableIndex(false),
+                                                 tile.GetTableIndex(true)}};
+
+    for (unsigned int y = 0; y < 4; ++y) {
+        for (unsigned int x = 0; x < 4; ++x) {
+            const bool second_half = (tile.flip ? y : x) >= 2;
+            texels[y * 4 + x] = tile.ApplyModifier(base_colors[second_half],
+                                                   table_indices[second_half], 4 * x + y);
+        }
+    }
+}
+
 } // namespace Texture
 } // namespace Pica
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 
@@ -12,5 +13,12 @@ namespace Texture {
 
 Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/**
+ * Decodes all the texels of a 4x4 ETC1 subtile at once.
+ * @param value Encoded subtile
+ * @param texels Decoded colors, the texel at (x, y) being stored at index y * 4 + x
+ */
+void DecodeETC1Subtile(u64 value, std::array<Math::Vec3<u8>, 16>& texels);
+
 } // namespace Texture
 } // namespace Pica
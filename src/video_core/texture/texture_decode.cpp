@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -13,6 +15,10 @@
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
 using TextureFormat = Pica::TexturingRegs::TextureFormat;
 
 namespace Pica {
@@ -21,6 +27,8 @@ namespace Texture {
 constexpr std::size_t TILE_SIZE = 8 * 8;
 constexpr std::size_t ETC1_SUBTILES = 2 * 2;
 
+static_assert(sizeof(Math::Vec4<u8>) == 4, "Decoded tiles are copied as arrays of RGBA8 texels");
+
 size_t CalculateTileSize(TextureFormat format) {
     switch (format) {
     case TextureFormat::RGBA8:
@@ -72,41 +80,37 @@ Math::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
     return LookupTexelInTile(tile, fine_x, fine_y, info, disable_alpha);
 }
 
-Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
-                                 const TextureInfo& info, bool disable_alpha) {
-    DEBUG_ASSERT(x < 8);
-    DEBUG_ASSERT(y < 8);
-
-    using VideoCore::MortonInterleave;
-
-    switch (info.format) {
+/// Decodes the texel at the given offset, in texels, from the beginning of a non-ETC1 tile
+template <TextureFormat format>
+static Math::Vec4<u8> DecodeTexel(const u8* source, u32 morton_offset, bool disable_alpha) {
+    switch (format) {
     case TextureFormat::RGBA8: {
-        auto res = Color::DecodeRGBA8(source + MortonInterleave(x, y) * 4);
+        auto res = Color::DecodeRGBA8(source + morton_offset * 4);
         return {res.r(), res.g(), res.b(), static_cast<u8>(disable_alpha ? 255 : res.a())};
     }
 
     case TextureFormat::RGB8: {
-        auto res = Color::DecodeRGB8(source + MortonInterleave(x, y) * 3);
+        auto res = Color::DecodeRGB8(source + morton_offset * 3);
         return {res.r(), res.g(), res.b(), 255};
     }
 
     case TextureFormat::RGB5A1: {
-        auto res = Color::DecodeRGB5A1(source + MortonInterleave(x, y) * 2);
+        auto res = Color::DecodeRGB5A1(source + morton_offset * 2);
         return {res.r(), res.g(), res.b(), static_cast<u8>(disable_alpha ? 255 : res.a())};
     }
 
     case TextureFormat::RGB565: {
-        auto res = Color::DecodeRGB565(source + MortonInterleave(x, y) * 2);
+        auto res = Color::DecodeRGB565(source + morton_offset * 2);
         return {res.r(), res.g(), res.b(), 255};
     }
 
     case TextureFormat::RGBA4: {
-        auto res = Color::DecodeRGBA4(source + MortonInterleave(x, y) * 2);
+        auto res = Color::DecodeRGBA4(source + morton_offset * 2);
         return {res.r(), res.g(), res.b(), static_cast<u8>(disable_alpha ? 255 : res.a())};
     }
 
     case TextureFormat::IA8: {
-        const u8* source_ptr = source + MortonInterleave(x, y) * 2;
+        const u8* source_ptr = source + morton_offset * 2;
 
         if (disable_alpha) {
             // Show intensity as red, alpha as green
@@ -117,17 +121,17 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 
     case TextureFormat::RG8: {
-        auto res = Color::DecodeRG8(source + MortonInterleave(x, y) * 2);
+        auto res = Color::DecodeRG8(source + morton_offset * 2);
         return {res.r(), res.g(), 0, 255};
     }
 
     case TextureFormat::I8: {
-        const u8* source_ptr = source + MortonInterleave(x, y);
+        const u8* source_ptr = source + morton_offset;
         return {*source_ptr, *source_ptr, *source_ptr, 255};
     }
 
     case TextureFormat::A8: {
-        const u8* source_ptr = source + MortonInterleave(x, y);
+        const u8* source_ptr = source + morton_offset;
 
         if (disable_alpha) {
             return {*source_ptr, *source_ptr, *source_ptr, 255};
@@ -137,7 +141,7 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 
     case TextureFormat::IA4: {
-        const u8* source_ptr = source + MortonInterleave(x, y);
+        const u8* source_ptr = source + morton_offset;
 
         u8 i = Color::Convert4To8(((*source_ptr) & 0xF0) >> 4);
         u8 a = Color::Convert4To8((*source_ptr) & 0xF);
@@ -151,7 +155,6 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 
     case TextureFormat::I4: {
-        u32 morton_offset = MortonInterleave(x, y);
         const u8* source_ptr = source + morton_offset / 2;
 
         u8 i = (morton_offset % 2) ? ((*source_ptr & 0xF0) >> 4) : (*source_ptr & 0xF);
@@ -161,7 +164,6 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 
     case TextureFormat::A4: {
-        u32 morton_offset = MortonInterleave(x, y);
         const u8* source_ptr = source + morton_offset / 2;
 
         u8 a = (morton_offset % 2) ? ((*source_ptr & 0xF0) >> 4) : (*source_ptr & 0xF);
@@ -174,6 +176,53 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
         }
     }
 
+    default:
+        UNREACHABLE();
+        return {};
+    }
+}
+
+/// Decodes all the texels of a non-ETC1 tile, in Morton order
+template <TextureFormat format>
+static void DecodeTexels(const u8* source, Math::Vec4<u8>* dest, bool disable_alpha) {
+    for (u32 i = 0; i < TILE_SIZE; ++i) {
+        dest[i] = DecodeTexel<format>(source, i, disable_alpha);
+    }
+}
+
+Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
+                                 const TextureInfo& info, bool disable_alpha) {
+    DEBUG_ASSERT(x < 8);
+    DEBUG_ASSERT(y < 8);
+
+    const u32 morton_offset = VideoCore::MortonInterleave(x, y);
+
+    switch (info.format) {
+    case TextureFormat::RGBA8:
+        return DecodeTexel<TextureFormat::RGBA8>(source, morton_offset, disable_alpha);
+    case TextureFormat::RGB8:
+        return DecodeTexel<TextureFormat::RGB8>(source, morton_offset, disable_alpha);
+    case TextureFormat::RGB5A1:
+        return DecodeTexel<TextureFormat::RGB5A1>(source, morton_offset, disable_alpha);
+    case TextureFormat::RGB565:
+        return DecodeTexel<TextureFormat::RGB565>(source, morton_offset, disable_alpha);
+    case TextureFormat::RGBA4:
+        return DecodeTexel<TextureFormat::RGBA4>(source, morton_offset, disable_alpha);
+    case TextureFormat::IA8:
+        return DecodeTexel<TextureFormat::IA8>(source, morton_offset, disable_alpha);
+    case TextureFormat::RG8:
+        return DecodeTexel<TextureFormat::RG8>(source, morton_offset, disable_alpha);
+    case TextureFormat::I8:
+        return DecodeTexel<TextureFormat::I8>(source, morton_offset, disable_alpha);
+    case TextureFormat::A8:
+        return DecodeTexel<TextureFormat::A8>(source, morton_offset, disable_alpha);
+    case TextureFormat::IA4:
+        return DecodeTexel<TextureFormat::IA4>(source, morton_offset, disable_alpha);
+    case TextureFormat::I4:
+        return DecodeTexel<TextureFormat::I4>(source, morton_offset, disable_alpha);
+    case TextureFormat::A4:
+        return DecodeTexel<TextureFormat::A4>(source, morton_offset, disable_alpha);
+
     case TextureFormat::ETC1:
     case TextureFormat::ETC1A4: {
         bool has_alpha = (info.format == TextureFormat::ETC1A4);
@@ -212,6 +261,110 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 }
 
+static void DecodeETC1Tile(const u8* source, bool has_alpha, Math::Vec4<u8>* dest,
+                           bool disable_alpha) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+
+        u64_le packed_alpha = 0;
+        if (has_alpha) {
+            memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+
+        std::array<Math::Vec3<u8>, 16> colors;
+        DecodeETC1Subtile(subtile_data, colors);
+
+        const unsigned int subtile_x = (subtile_index % 2) * 4;
+        const unsigned int subtile_y = (subtile_index / 2) * 4;
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                u8 alpha = 255;
+                if (has_alpha && !disable_alpha) {
+                    alpha = Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                }
+                dest[(subtile_y + y) * 8 + subtile_x + x] =
+                    Math::MakeVec(colors[y * 4 + x], alpha);
+            }
+        }
+    }
+}
+
+void DecodeTile(const u8* source, const TextureInfo& info, Math::Vec4<u8>* dest,
+                bool disable_alpha) {
+    if (info.format == TextureFormat::ETC1 || info.format == TextureFormat::ETC1A4) {
+        // ETC1 tiles are made of four 4x4 subtiles in row order rather than in Morton order
+        DecodeETC1Tile(source, info.format == TextureFormat::ETC1A4, dest, disable_alpha);
+        return;
+    }
+
+    std::array<Math::Vec4<u8>, TILE_SIZE> texels;
+
+#ifdef ARCHITECTURE_x86_64
+    const bool decoded =
+        !disable_alpha && Common::GetCPUCaps().sse4_1 &&
+        DecodeTexelsSSE41(source, info.format, texels.data());
+#else
+    constexpr bool decoded = false;
+#endif
+
+    if (!decoded) {
+        switch (info.format) {
+        case TextureFormat::RGBA8:
+            DecodeTexels<TextureFormat::RGBA8>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::RGB8:
+            DecodeTexels<TextureFormat::RGB8>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::RGB5A1:
+            DecodeTexels<TextureFormat::RGB5A1>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::RGB565:
+            DecodeTexels<TextureFormat::RGB565>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::RGBA4:
+            DecodeTexels<TextureFormat::RGBA4>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::IA8:
+            DecodeTexels<TextureFormat::IA8>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::RG8:
+            DecodeTexels<TextureFormat::RG8>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::I8:
+            DecodeTexels<TextureFormat::I8>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::A8:
+            DecodeTexels<TextureFormat::A8>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::IA4:
+            DecodeTexels<TextureFormat::IA4>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::I4:
+            DecodeTexels<TextureFormat::I4>(source, texels.data(), disable_alpha);
+            break;
+        case TextureFormat::A4:
+            DecodeTexels<TextureFormat::A4>(source, texels.data(), disable_alpha);
+            break;
+
+        default:
+            LOG_ERROR(HW_GPU, "Unknown texture format: {:x}", (u32)info.format);
+            DEBUG_ASSERT(false);
+            std::fill_n(dest, TILE_SIZE, Math::Vec4<u8>{});
+            return;
+        }
+    }
+
+    VideoCore::MortonCopyTile<true, sizeof(Math::Vec4<u8>)>(
+        reinterpret_cast<u8*>(texels.data()), reinterpret_cast<u8*>(dest),
+        8 * sizeof(Math::Vec4<u8>));
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
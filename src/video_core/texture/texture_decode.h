@@ -56,5 +56,29 @@ Math::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
 Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
                                  const TextureInfo& info, bool disable_alpha);
 
+/**
+ * Decodes all the texels of a 8x8 texture tile at once, giving the same results as calling
+ * LookupTexelInTile for each of them.
+ *
+ * @param source Pointer to the beginning of the tile.
+ * @param info TextureInfo describing the texture format.
+ * @param dest Array of 64 texels receiving the tile, the texel at in-tile coordinates (x, y) being
+ *             stored at index y * 8 + x.
+ * @param disable_alpha See LookupTexelInTile.
+ */
+void DecodeTile(const u8* source, const TextureInfo& info, Math::Vec4<u8>* dest,
+                bool disable_alpha = false);
+
+#ifdef ARCHITECTURE_x86_64
+/**
+ * Vectorized implementation of the decoding of the texels of a non-ETC1 tile, requires SSE4.1.
+ *
+ * @param dest Array of 64 texels receiving the tile in Morton order.
+ * @returns false if the format has no vectorized decoder, in which case dest is left untouched.
+ */
+bool DecodeTexelsSSE41(const u8* source, TexturingRegs::TextureFormat format,
+                       Math::Vec4<u8>* dest);
+#endif
+
 } // namespace Texture
 } // namespace Pica
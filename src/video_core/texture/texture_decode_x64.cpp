@@ -0,0 +1,202 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <immintrin.h>
+#include "common/common_types.h"
+#include "common/x64/target.h"
+#include "video_core/texture/texture_decode.h"
+
+using TextureFormat = Pica::TexturingRegs::TextureFormat;
+
+namespace Pica {
+namespace Texture {
+
+constexpr std::size_t TILE_SIZE = 8 * 8;
+
+// All decoders read the texels of a tile in memory (i.e. Morton) order and write them as RGBA8
+// texels in the same order.
+
+TARGET_SSE41 static __m128i LoadTexels(const u8* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+TARGET_SSE41 static void StoreTexels(u8* dest, __m128i texels) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), texels);
+}
+
+/// Decoders for formats with 8-bit channels, which only need their bytes to be rearranged
+TARGET_SSE41 static void DecodeRGBA8(const u8* source, u8* dest) {
+    const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 4) {
+        StoreTexels(dest + i * 4, _mm_shuffle_epi8(LoadTexels(source + i * 4), shuffle));
+    }
+}
+
+TARGET_SSE41 static void DecodeRGB8(const u8* source, u8* dest) {
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 4) {
+        __m128i texels;
+        if (i + 4 < TILE_SIZE) {
+            texels = LoadTexels(source + i * 3);
+        } else {
+            // Don't read past the end of the tile
+            u8 last_texels[16] = {};
+            std::memcpy(last_texels, source + i * 3, 4 * 3);
+            texels = LoadTexels(last_texels);
+        }
+        StoreTexels(dest + i * 4, _mm_or_si128(_mm_shuffle_epi8(texels, shuffle), alpha));
+    }
+}
+
+TARGET_SSE41 static void DecodeIA8(const u8* source, u8* dest) {
+    const __m128i shuffle_low = _mm_setr_epi8(1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6);
+    const __m128i shuffle_high =
+        _mm_setr_epi8(9, 9, 9, 8, 11, 11, 11, 10, 13, 13, 13, 12, 15, 15, 15, 14);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i texels = LoadTexels(source + i * 2);
+        StoreTexels(dest + i * 4, _mm_shuffle_epi8(texels, shuffle_low));
+        StoreTexels(dest + i * 4 + 16, _mm_shuffle_epi8(texels, shuffle_high));
+    }
+}
+
+TARGET_SSE41 static void DecodeRG8(const u8* source, u8* dest) {
+    const __m128i shuffle_low =
+        _mm_setr_epi8(1, 0, -1, -1, 3, 2, -1, -1, 5, 4, -1, -1, 7, 6, -1, -1);
+    const __m128i shuffle_high =
+        _mm_setr_epi8(9, 8, -1, -1, 11, 10, -1, -1, 13, 12, -1, -1, 15, 14, -1, -1);
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i texels = LoadTexels(source + i * 2);
+        StoreTexels(dest + i * 4, _mm_or_si128(_mm_shuffle_epi8(texels, shuffle_low), alpha));
+        StoreTexels(dest + i * 4 + 16,
+                    _mm_or_si128(_mm_shuffle_epi8(texels, shuffle_high), alpha));
+    }
+}
+
+TARGET_SSE41 static void DecodeI8(const u8* source, u8* dest) {
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+        const __m128i texels = LoadTexels(source + i);
+        for (int j = 0; j < 4; ++j) {
+            const char k = static_cast<char>(j * 4);
+            const __m128i shuffle = _mm_setr_epi8(k, k, k, -1, k + 1, k + 1, k + 1, -1, k + 2,
+                                                  k + 2, k + 2, -1, k + 3, k + 3, k + 3, -1);
+            StoreTexels(dest + (i + j * 4) * 4,
+                        _mm_or_si128(_mm_shuffle_epi8(texels, shuffle), alpha));
+        }
+    }
+}
+
+TARGET_SSE41 static void DecodeA8(const u8* source, u8* dest) {
+    for (std::size_t i = 0; i < TILE_SIZE; i += 16) {
+        const __m128i texels = LoadTexels(source + i);
+        for (int j = 0; j < 4; ++j) {
+            const char k = static_cast<char>(j * 4);
+            const __m128i shuffle = _mm_setr_epi8(-1, -1, -1, k, -1, -1, -1, k + 1, -1, -1, -1,
+                                                  k + 2, -1, -1, -1, k + 3);
+            StoreTexels(dest + (i + j * 4) * 4, _mm_shuffle_epi8(texels, shuffle));
+        }
+    }
+}
+
+/// Decoders for the 16-bit packed formats, working on the channels of 8 texels in 16-bit lanes
+TARGET_SSE41 static __m128i Convert5To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+TARGET_SSE41 static __m128i Convert6To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+}
+
+TARGET_SSE41 static __m128i Convert4To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 4), value);
+}
+
+/// Interleaves 8-bit channels held in 16-bit lanes into 8 RGBA8 texels
+TARGET_SSE41 static void StorePackedTexels(u8* dest, __m128i r, __m128i g, __m128i b, __m128i a) {
+    const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+    StoreTexels(dest, _mm_unpacklo_epi16(rg, ba));
+    StoreTexels(dest + 16, _mm_unpackhi_epi16(rg, ba));
+}
+
+TARGET_SSE41 static void DecodeRGB565(const u8* source, u8* dest) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    const __m128i alpha = _mm_set1_epi16(0xFF);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i texels = LoadTexels(source + i * 2);
+        const __m128i r = Convert5To8(_mm_srli_epi16(texels, 11));
+        const __m128i g = Convert6To8(_mm_and_si128(_mm_srli_epi16(texels, 5), mask6));
+        const __m128i b = Convert5To8(_mm_and_si128(texels, mask5));
+        StorePackedTexels(dest + i * 4, r, g, b, alpha);
+    }
+}
+
+TARGET_SSE41 static void DecodeRGB5A1(const u8* source, u8* dest) {
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask1 = _mm_set1_epi16(0x1);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i texels = LoadTexels(source + i * 2);
+        const __m128i r = Convert5To8(_mm_srli_epi16(texels, 11));
+        const __m128i g = Convert5To8(_mm_and_si128(_mm_srli_epi16(texels, 6), mask5));
+        const __m128i b = Convert5To8(_mm_and_si128(_mm_srli_epi16(texels, 1), mask5));
+        const __m128i a = _mm_mullo_epi16(_mm_and_si128(texels, mask1), _mm_set1_epi16(0xFF));
+        StorePackedTexels(dest + i * 4, r, g, b, a);
+    }
+}
+
+TARGET_SSE41 static void DecodeRGBA4(const u8* source, u8* dest) {
+    const __m128i mask4 = _mm_set1_epi16(0xF);
+    for (std::size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i texels = LoadTexels(source + i * 2);
+        const __m128i r = Convert4To8(_mm_srli_epi16(texels, 12));
+        const __m128i g = Convert4To8(_mm_and_si128(_mm_srli_epi16(texels, 8), mask4));
+        const __m128i b = Convert4To8(_mm_and_si128(_mm_srli_epi16(texels, 4), mask4));
+        const __m128i a = Convert4To8(_mm_and_si128(texels, mask4));
+        StorePackedTexels(dest + i * 4, r, g, b, a);
+    }
+}
+
+bool DecodeTexelsSSE41(const u8* source, TextureFormat format, Math::Vec4<u8>* dest) {
+    u8* const dest_bytes = reinterpret_cast<u8*>(dest);
+
+    switch (format) {
+    case TextureFormat::RGBA8:
+        DecodeRGBA8(source, dest_bytes);
+        return true;
+    case TextureFormat::RGB8:
+        DecodeRGB8(source, dest_bytes);
+        return true;
+    case TextureFormat::RGB5A1:
+        DecodeRGB5A1(source, dest_bytes);
+        return true;
+    case TextureFormat::RGB565:
+        DecodeRGB565(source, dest_bytes);
+        return true;
+    case TextureFormat::RGBA4:
+        DecodeRGBA4(source, dest_bytes);
+        return true;
+    case TextureFormat::IA8:
+        DecodeIA8(source, dest_bytes);
+        return true;
+    case TextureFormat::RG8:
+        DecodeRG8(source, dest_bytes);
+        return true;
+    case TextureFormat::I8:
+        DecodeI8(source, dest_bytes);
+        return true;
+    case TextureFormat::A8:
+        DecodeA8(source, dest_bytes);
+        return true;
+    default:
+        // The 4-bit formats are cheap enough to decode with the generic code
+        return false;
+    }
+}
+
+} // namespace Texture
+} // namespace Pica
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstring>
 #include "common/common_types.h"
 
 namespace VideoCore {
@@ -49,4 +51,30 @@ static inline u32 GetMortonOffset(u32 x, u32 y, u32 bytes_per_pixel) {
     return (i + offset) * bytes_per_pixel;
 }
 
+/**
+ * Copies a whole 8x8 tile between Morton order and a linear layout.
+ * @param tile Pointer to the tile in Morton order
+ * @param linear Pointer to the first pixel of the y = 0 row of the tile in the linear buffer
+ * @param linear_pitch Distance in bytes between two rows of the linear buffer, negative when the
+ *                     rows are stored from bottom to top
+ */
+template <bool morton_to_linear, u32 bytes_per_pixel>
+inline void MortonCopyTile(u8* tile, u8* linear, std::ptrdiff_t linear_pitch) {
+    // Pixels x and x + 1 are adjacent in Morton order when x is even, so each row is copied as
+    // four pairs of pixels of constant size
+    constexpr u32 pair_size = 2 * bytes_per_pixel;
+    for (u32 y = 0; y < 8; ++y) {
+        u8* linear_row = linear + static_cast<std::ptrdiff_t>(y) * linear_pitch;
+        for (u32 x = 0; x < 8; x += 2) {
+            u8* tile_ptr = tile + MortonInterleave(x, y) * bytes_per_pixel;
+            u8* linear_ptr = linear_row + x * bytes_per_pixel;
+            if (morton_to_linear) {
+                std::memcpy(linear_ptr, tile_ptr, pair_size);
+            } else {
+                std::memcpy(tile_ptr, linear_ptr, pair_size);
+            }
+        }
+    }
+}
+
 } // namespace VideoCore
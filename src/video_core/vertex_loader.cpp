@@ -72,7 +72,7 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
 
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
                               Shader::AttributeBuffer& input,
-                              DebugUtils::MemoryAccessTracker& memory_accesses) {
+                              DebugUtils::MemoryAccessTracker& memory_accesses) const {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
     for (int i = 0; i < num_total_attributes; ++i) {
@@ -3,9 +3,13 @@
 // Refer to the license.txt file included.
 
 #include <memory>
+#include <utility>
 #include "common/logging/log.h"
+#include "core/frontend/emu_window.h"
+#include "core/settings.h"
 #include "video_core/pica.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_null/renderer_null.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
 
@@ -15,6 +19,7 @@
 namespace VideoCore {
 
 std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+std::unique_ptr<GPUThread> g_gpu_thread;
 
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
@@ -27,13 +32,23 @@ std::atomic<bool> g_renderer_bg_color_update_requested;
 Core::System::ResultStatus Init(EmuWindow& emu_window) {
     Pica::Init();
 
-    g_renderer = std::make_unique<RendererOpenGL>(emu_window);
+    if (Settings::values.use_null_renderer) {
+        g_renderer = std::make_unique<RendererNull>(emu_window);
+    } else {
+        g_renderer = std::make_unique<RendererOpenGL>(emu_window);
+    }
     Core::System::ResultStatus result = g_renderer->Init();
 
     if (result != Core::System::ResultStatus::Success) {
         LOG_ERROR(Render, "initialization failed !");
     } else {
         LOG_DEBUG(Render, "initialized OK");
+
+        if (Settings::values.use_asynchronous_gpu) {
+            // The GPU thread takes over the graphics context
+            emu_window.DoneCurrent();
+            g_gpu_thread = std::make_unique<GPUThread>(emu_window);
+        }
     }
 
     return result;
@@ -41,6 +56,12 @@ Core::System::ResultStatus Init(EmuWindow& emu_window) {
 
 /// Shutdown the video core
 void Shutdown() {
+    if (g_gpu_thread != nullptr) {
+        // Take the graphics context back to destroy the renderer
+        g_gpu_thread.reset();
+        g_renderer->GetRenderWindow().MakeCurrent();
+    }
+
     Pica::Shutdown();
 
     g_renderer.reset();
@@ -48,4 +69,12 @@ void Shutdown() {
     LOG_DEBUG(Render, "shutdown OK");
 }
 
+void RunAsync(std::function<void()> work) {
+    if (g_gpu_thread != nullptr) {
+        g_gpu_thread->Push(std::move(work));
+    } else {
+        work();
+    }
+}
+
 } // namespace VideoCore
@@ -5,8 +5,11 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <utility>
 #include "core/core.h"
+#include "video_core/gpu_thread.h"
 
 class EmuWindow;
 class RendererBase;
@@ -17,6 +20,8 @@ class RendererBase;
 namespace VideoCore {
 
 extern std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
+/// Thread running the GPU work, null when it runs on the CPU thread
+extern std::unique_ptr<GPUThread> g_gpu_thread;
 
 // TODO: Wrap these in a user settings struct along with any other graphics settings (often set from
 // qt ui)
@@ -33,4 +38,20 @@ Core::System::ResultStatus Init(EmuWindow& emu_window);
 /// Shutdown the video core
 void Shutdown();
 
+/// Runs GPU work on the GPU thread if there is one, or right away otherwise
+void RunAsync(std::function<void()> work);
+
+/**
+ * Runs work needing the renderer, such as flushing cached surfaces, once the GPU work submitted
+ * before it is done, and waits for it to finish.
+ */
+template <typename Func>
+void RunSync(Func&& work) {
+    if (g_gpu_thread != nullptr && !g_gpu_thread->IsCurrentThread()) {
+        g_gpu_thread->Sync(std::forward<Func>(work));
+    } else {
+        work();
+    }
+}
+
 } // namespace VideoCore